@@ -72,9 +72,15 @@ on).  Valid options are pdFREERTOS_BIG_ENDIAN and pdFREERTOS_LITTLE_ENDIAN. */
 
 /* If the network card/driver includes checksum offloading (IP/TCP/UDP checksums)
 then set ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM to 1 to prevent the software
-stack repeating the checksum calculations. */
-#define ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM   ( 0 )
+stack repeating the checksum calculations. The received checksums are 
+verified by the mac task while the frames are copied, see tcpip_checksumFrame(). */
+#define ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM   ( 1 )
 #define ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM   ( 0 )
+
+/* The checksums the stack calculates itself are summed by checksum_add() of
+the checksum module, with an adcs chain on the cortex-m4. Set to 0 for the 
+generic usGenerateChecksum(). */
+#define ipconfigUSE_CHECKSUM_MODULE              ( 1 )
 #define ipconfigHAS_RX_CRC_OFFLOADING            ( 0 )
 #define ipconfigHAS_TX_CRC_OFFLOADING            ( 0 )
 
@@ -292,6 +298,23 @@ This has to do with the contents of the IP-packets: all 32-bit fields are
 32-bit-aligned, plus 16-bit(!) */
 #define ipconfigPACKET_FILLER_SIZE           2
 
+/* The received tcp frames are passed to the stack in their usbQueue slot
+instead of being copied into a network buffer, see tcpip_canLend(). The out
+transfers of the rndis driver start at the same 32-bit-aligned plus 16-bits
+offset. */
+#define ipconfigZERO_COPY_RX_DRIVER          ( 1 )
+
+/* The network buffers are sent to the usb in endpoint without being copied
+into the tcpQueue and released after the transfer, see tcpip_enqueueRef(). The
+44 byte rndis packet header is written directly in front of the frame, into the
+10 bytes of ipBUFFER_PADDING and 34 bytes of the headroom, which is rounded up
+to a multiple of 4. So the header overwrites the pointer to the descriptor at 
+frame - 10 while the buffer is in the driver. Nothing reads it meanwhile, the 
+buffer is released by its descriptor and the pointer is set again when the 
+buffer is allocated. */
+#define ipconfigZERO_COPY_TX_DRIVER          ( 1 )
+#define ipconfigBUFFER_HEADROOM              ( 36 )
+
 /* Define the size of the pool of TCP window descriptors.  On the average, each
 TCP socket will use up to 2 x 6 descriptors, meaning that it can have 2 x 6
 outstanding packets (for Rx and Tx).  When using up to 10 TP sockets
@@ -323,6 +346,10 @@ disconnecting stage will timeout after a period of non-activity. */
 
 #define ipconfigUSE_LINKED_RX_MESSAGES    ( 1 )
 
+/* Track the lowest free space of the ip task event queue, which is reported
+by uxGetMinimumIPQueueSpace(). */
+#define ipconfigCHECK_IP_QUEUE_SPACE      ( 1 )
+
 //#define portINLINE inline
 
 #endif /* FREERTOS_IP_CONFIG_H */
\ No newline at end of file
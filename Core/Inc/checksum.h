@@ -0,0 +1,65 @@
+// ****************************************************************************
+/// \file      checksum.h
+///
+/// \brief     Internet Checksum C Header File
+///
+/// \details   Module to calculate the ones complement sum of the internet 
+///            checksum (rfc 1071), optionally while copying the data.
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+/// 
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person 
+///            obtaining a copy of this software and associated documentation 
+///            files (the "Software"), to deal in the Software without 
+///            restriction, including without limitation the rights to use, 
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the 
+///            Software is furnished to do so, subject to the following 
+///            conditions:
+///            
+///            The above copyright notice and this permission notice shall be 
+///            included in all copies or substantial portions of the Software.
+///            
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES 
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR 
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __CHECKSUM_H
+#define __CHECKSUM_H
+
+// Include ********************************************************************
+#include <stdint.h>
+
+// Exported defines ***********************************************************
+#define CHECKSUM_CORRECT      ( 0xFFFFu )   // folded sum of data with a valid checksum
+
+// Exported types *************************************************************
+
+// Exported functions *********************************************************
+uint32_t checksum_add      ( const uint8_t* data, uint32_t length, uint32_t sum );
+uint32_t checksum_copy     ( uint8_t* dst, const uint8_t* src, uint32_t length, uint32_t sum );
+uint32_t checksum_combine  ( uint32_t sum1, uint32_t sum2 );
+uint16_t checksum_fold     ( uint32_t sum );
+#endif // __CHECKSUM_H
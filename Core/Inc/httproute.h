@@ -0,0 +1,124 @@
+// ****************************************************************************
+/// \file      httproute.h
+///
+/// \brief     Route lookup of the http server
+///
+/// \details   Looks up the route of a request in the perfect hash table of
+///            webroutes.h. Included by httpserver.c behind webroutes.h, and
+///            by the host benchmark Core/Test/route_test.c behind a table
+///            generated with "webassets.py --bench". The includer defines
+///            httpserver_route_t.
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+/// 
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person 
+///            obtaining a copy of this software and associated documentation 
+///            files (the "Software"), to deal in the Software without 
+///            restriction, including without limitation the rights to use, 
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the 
+///            Software is furnished to do so, subject to the following 
+///            conditions:
+///            
+///            The above copyright notice and this permission notice shall be 
+///            included in all copies or substantial portions of the Software.
+///            
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES 
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR 
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __HTTPROUTE_H
+#define __HTTPROUTE_H
+
+// Include ********************************************************************
+#include <stdint.h>
+#include <string.h>
+
+// Functions ******************************************************************
+
+// ----------------------------------------------------------------------------
+/// \brief     Looks up the route of a request in place. The key of a route
+///            is the method and the path of the request line, without the
+///            query. It is hashed in one pass, the hash up to the last slash
+///            is kept for the routes with a parameter. The table is a perfect
+///            hash, one compare tells if the route is there.
+///
+/// \param     [in]  const uint8_t* request
+/// \param     [in]  uint16_t requestLength
+/// \param     [out] const uint8_t** parameter, last segment of the path
+/// \param     [out] uint16_t* parameterLength
+///
+/// \return    route, NULL if there is no route for the request
+static const httpserver_route_t* httpserver_route( const uint8_t* request, uint16_t requestLength, const uint8_t** parameter, uint16_t* parameterLength )
+{
+   const httpserver_route_t   *route;
+   const uint8_t              *end;
+   const uint8_t              *slash   = NULL;
+   uint32_t                   hash     = WEBROUTES_SEED;
+   uint32_t                   slashHash = 0;
+   uint8_t                    spaces   = 0;
+
+   *parameter        = NULL;
+   *parameterLength  = 0;
+
+   // the key ends at the second space or at the query
+   for( end = request; end < request + requestLength && *end != '?' && *end != '\r'; end++ )
+   {
+      if( *end == ' ' && ++spaces == 2 )
+      {
+         break;
+      }
+      hash = ( hash ^ *end ) * 16777619u;
+      if( *end == '/' )
+      {
+         slash       = end;
+         slashHash   = hash;
+      }
+   }
+   if( spaces == 0 || slash == NULL )
+   {
+      return NULL;
+   }
+
+   route = &webroutes[hash & ( WEBROUTES_SIZE - 1u )];
+   if( route->keyLength == end - request && route->prefix == 0 && memcmp( route->key, request, route->keyLength ) == 0 )
+   {
+      return route;
+   }
+
+   // a route with a parameter
+   route = &webroutes[slashHash & ( WEBROUTES_SIZE - 1u )];
+   if( route->keyLength == slash + 1 - request && route->prefix == 1 && memcmp( route->key, request, route->keyLength ) == 0 )
+   {
+      *parameter        = slash + 1;
+      *parameterLength  = end - slash - 1;
+      return route;
+   }
+
+   return NULL;
+}
+
+#endif // __HTTPROUTE_H
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
@@ -52,6 +52,25 @@
 #define __WEBSERVER_H
 
 // Exported defines ***********************************************************
+#define HTTPSERVER_SELECT        ( 1u )   // 1: one task serves all connections with FreeRTOS_select(), 0: one task per connection
+#define HTTPSERVER_CONNECTIONS   ( 6u )   // connections served at once by the select server, the page keeps two open
+#define HTTPSERVER_EVENTS_PERIOD ( 1000u ) // ms between two events of the /events stream, select server only
+
+// Binary messages of the /ws websocket, select server only. A command is
+// answered with the command | HTTPSERVER_WS_REPLY and the duty cycle after
+// it, an unknown command or a wrong argument with HTTPSERVER_WS_INVALID.
+#define HTTPSERVER_WS_DUTY       ( 0x01u ) // duty cycle 0 to 40 follows, dims the led
+#define HTTPSERVER_WS_PULSE      ( 0x02u ) // sets the led into the pulse state
+#define HTTPSERVER_WS_TOGGLE     ( 0x03u ) // toggles the led
+#define HTTPSERVER_WS_TELEMETRY  ( 0x04u ) // 1 follows to get the telemetry, 0 to stop it
+#define HTTPSERVER_WS_REPLY      ( 0x80u )
+#define HTTPSERVER_WS_INVALID    ( 0xFFu )
+
+// Telemetry message, pushed every HTTPSERVER_EVENTS_PERIOD, little endian:
+// id, uptime in s (u32), temperature in 0.1 C (i16), voltage in mV (u16),
+// button pushed (u8), duty cycle (u8), rx frames (u32), tx frames (u32)
+#define HTTPSERVER_WS_PUSH       ( 0x90u )
+#define HTTPSERVER_WS_PUSHLENGTH ( 19u )
 
 // Exported types *************************************************************
 
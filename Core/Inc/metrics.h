@@ -0,0 +1,110 @@
+// ****************************************************************************
+/// \file      metrics.h
+///
+/// \brief     Metrics C Header File
+///
+/// \details   Registry of the counters and gauges of the modules, which are
+///            served as prometheus text by the http server (/metrics).
+///
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+/// 
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person 
+///            obtaining a copy of this software and associated documentation 
+///            files (the "Software"), to deal in the Software without 
+///            restriction, including without limitation the rights to use, 
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the 
+///            Software is furnished to do so, subject to the following 
+///            conditions:
+///            
+///            The above copyright notice and this permission notice shall be 
+///            included in all copies or substantial portions of the Software.
+///            
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES 
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR 
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __METRICS_H
+#define __METRICS_H
+
+// Include ********************************************************************
+#include <stddef.h>
+#include <stdint.h>
+
+// Exported defines ***********************************************************
+#define METRICS_FIELD( type, member )  offsetof( type, member ), sizeof( ( (type*)0 )->member )   // offset and size of a value in a statistic
+#define METRICS_SOCKET        ( 6u )   // entries of metrics_socket
+
+// Exported types *************************************************************
+typedef enum
+{
+   METRICS_COUNTER = 0,    // counts up and wraps around
+   METRICS_GAUGE           // current value, goes up and down
+} metrics_type_t;
+
+// One value of a module. The entries of a metric family have the same name
+// and follow each other, they differ in the labels.
+typedef struct
+{
+   const char*             name;          // e.g. queue_drops_total
+   const char*             labels;        // of the entry, e.g. policy="tail", NULL if none
+   const char*             help;          // of the family, taken from its first entry
+   metrics_type_t          type;
+   uint16_t                offset;        // of the value in the statistic of the group
+   uint8_t                 size;          // of the value, 1, 2 or 4 bytes
+   uint32_t                (*read)( void ); // reads the value instead of the statistic, NULL if not used
+} metrics_t;
+
+// The values of a module or of an instance, e.g. of a queue. The groups are
+// statically allocated by the modules, the registry links them.
+typedef struct metrics_group
+{
+   const metrics_t*        metrics;
+   uint8_t                 count;
+   const volatile void*    statistic;     // the values, NULL if all entries are read
+   const char*             labels;        // of the instance, e.g. queue="tcp", NULL if none
+   struct metrics_group*   next;          // set by metrics_register()
+} metrics_group_t;
+
+// The errors of FreeRTOS_recv() of a server task, see metrics_socket.
+typedef struct
+{
+   uint32_t                etimeout;
+   uint32_t                enomem;
+   uint32_t                enotconn;
+   uint32_t                eintr;
+   uint32_t                einval;
+   uint32_t                eelse;
+} metrics_socket_t;
+
+// Exported variables *********************************************************
+extern const metrics_t     metrics_socket[METRICS_SOCKET];
+
+// Exported functions *********************************************************
+void                    metrics_register  ( metrics_group_t* group );
+const metrics_group_t*  metrics_first     ( void );
+uint32_t                metrics_read      ( const metrics_group_t* group, const metrics_t* metric );
+#endif // __METRICS_H
@@ -47,6 +47,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx.h"
+#include "metrics.h"
 
 /* Define to prevent recursive inclusion -------------------------------------*/
 #ifndef __QUEUE_H
@@ -54,7 +55,44 @@
 
 // Exported defines ***********************************************************
 #define QUEUEBUFFERLENGTH                 ( 1562u )
-#define QUEUELENGTH                       ( 7u )
+#define QUEUESLOTSIZE                     ( ( QUEUEBUFFERLENGTH + 3u ) & ~3u ) // word aligned buffer length
+
+// Memory layout of the queues:
+// 0 = fixed slots, every message takes a whole buffer of the lane pool.
+// 1 = bip-buffer, every message takes its own length (word aligned) of the
+//     lane pool. The head buffer is still a contiguous region of the lane
+//     buffer length, so writing directly into the queue works in both modes.
+#define QUEUE_BIPBUFFER                   ( 1u )
+
+// Lanes: the control lane takes small latency sensitive messages and is 
+// served first, the bulk lane takes everything else. After QUEUECONTROLBURST
+// control messages in a row, one waiting bulk message is sent.
+#define QUEUECONTROLBUFFERLENGTH          ( 644u )
+#define QUEUECONTROLBURST                 ( 8u )
+#define QUEUEBULKPOOLSIZE                 ( 5u * QUEUESLOTSIZE )
+#define QUEUECONTROLPOOLSIZE              ( 4u * QUEUECONTROLBUFFERLENGTH )
+
+// The capacity are the pool bytes which always take waiting messages of the
+// bulk lane. The head buffer needs a buffer length, in the bip-buffer up to
+// one more buffer length at the end of the pool stays unused if it wraps.
+#if( QUEUE_BIPBUFFER == 1u )
+#define QUEUEBULKLENGTH                   ( 40u )
+#define QUEUECONTROLLENGTH                ( 16u )
+#define QUEUEBULKCAPACITY                 ( QUEUEBULKPOOLSIZE - 2u * QUEUESLOTSIZE )
+#else
+#define QUEUEBULKLENGTH                   ( QUEUEBULKPOOLSIZE / QUEUESLOTSIZE )
+#define QUEUECONTROLLENGTH                ( QUEUECONTROLPOOLSIZE / QUEUECONTROLBUFFERLENGTH )
+#define QUEUEBULKCAPACITY                 ( QUEUEBULKPOOLSIZE - QUEUESLOTSIZE )
+#endif
+// Sojourn time measurement with the DWT cycle counter. Every message gets a
+// timestamp, the wait time (enqueue to dispatch) and the service time 
+// (dispatch to release) are counted in log2 histograms. Bucket n counts the
+// times from 2^(n-1) to 2^n - 1 cycles, the last bucket all longer times.
+#define QUEUE_SOJOURN                     ( 1u )
+#define QUEUEHISTOGRAMBUCKETS             ( 24u )
+
+#define QUEUEINFLIGHTMAX                  ( QUEUEBULKLENGTH + QUEUECONTROLLENGTH - 2u ) // one slot per lane is always receiving
+#define QUEUE_METRICS                     ( 13u )   // entries of queue_metrics
 
 // Exported types *************************************************************
 typedef enum
@@ -83,13 +121,59 @@ typedef enum
    RECEIVING_RX
 } message_status_t;
 
+typedef enum
+{
+   QUEUE_DROP_TAIL = 0,    // a new message is dropped if the lane is full
+   QUEUE_DROP_HEAD,        // the oldest waiting message is dropped above the watermark
+   QUEUE_DROP_EARLY        // new messages are dropped randomly above the watermark
+} queue_drop_policy_t;
+
+typedef enum
+{
+   QUEUE_LANE_CONTROL = 0,
+   QUEUE_LANE_BULK,
+   QUEUELANES
+} queue_lane_id_t;
+
 typedef struct queue_obj{
-    uint8_t             data[QUEUEBUFFERLENGTH];
+    uint8_t*            data;
     uint8_t*            dataStart;
     uint16_t            dataLength;
+    void*               reference;          // owner of a message enqueued by reference, NULL otherwise
     message_status_t    messageStatus;
+    uint32_t            dispatchSequence;
+#if( QUEUE_SOJOURN == 1u )
+    uint32_t            enqueueTime;
+    uint32_t            dispatchTime;
+#endif
 } queue_obj_t;
 
+// A lane is a single producer single consumer ringbuffer. The head index
+// is only written by the producer (enqueue side) and the tail index is only
+// written by the consumer (manager/dequeue side), so no interrupt masking is
+// needed as long as each side stays in its own context.
+// The messages between tail and dispatch index have been handed to the output
+// function and are in flight.
+typedef struct queue_lane
+{
+   queue_obj_t*         queue;
+   uint32_t             length;
+   uint8_t*             pool;
+   uint32_t             poolSize;
+   uint32_t             bufferLength;
+   volatile uint32_t    headIndex;
+   volatile uint32_t    tailIndex;
+   volatile uint32_t    dispatchIndex;
+   uint32_t             dataPacketsIN;
+   uint32_t             dataPacketsOUT;
+   uint32_t             queueFull;
+   uint32_t             queueLength;
+   uint32_t             queueLengthPeak;
+} queue_lane_t;
+
+// Up to inFlightMax messages of all lanes may be in flight at once, they are
+// released in dispatch order by queue_dequeue() or in any order by 
+// queue_release(). Releases of one queue have to come from one context.
 typedef struct queue 
 {
    queue_status_t       queueStatus;
@@ -102,22 +186,57 @@ typedef struct queue
    uint32_t             queueLength;
    uint32_t             queueLengthPeak;
    message_direction_t  messageDirection;   
-   queue_obj_t          queue[QUEUELENGTH];
-   uint32_t             headIndex;
-   uint32_t             tailIndex;
+   queue_lane_t         lane[QUEUELANES];
+   queue_obj_t          controlQueue[QUEUECONTROLLENGTH];
+   queue_obj_t          bulkQueue[QUEUEBULKLENGTH];
+   uint32_t             controlPool[QUEUECONTROLPOOLSIZE / 4u];
+   uint32_t             bulkPool[QUEUEBULKPOOLSIZE / 4u];
+   uint32_t             inFlightMax;
+   queue_drop_policy_t  dropPolicy;          // bulk lane only, the control lane uses tail drop
+   uint32_t             dropWatermark;       // bulk lane pool bytes, 0 = 3/4 of QUEUEBULKCAPACITY
+   uint32_t             dropTail;
+   uint32_t             dropHead;
+   uint32_t             dropEarly;
+   volatile uint32_t    headDropRequest;     // written by the producer
+   uint32_t             headDropDone;        // written by the queue manager
+   uint32_t             randomState;
+   uint32_t             dispatchCounter;
+   uint32_t             controlBurst;
+   volatile uint8_t     flushRequest;
    uint32_t             tailError;
    uint32_t             spuriousError;
+#if( QUEUE_SOJOURN == 1u )
+   uint32_t             waitHistogram[QUEUEHISTOGRAMBUCKETS];      // written by the queue manager
+   uint32_t             serviceHistogram[QUEUEHISTOGRAMBUCKETS];   // written by the release side
+#endif
    uint8_t              (*output)( uint8_t*, uint16_t );
+   void                 (*notify)( void );   // optional, called if the queue manager has work to do
+   queue_lane_id_t      (*classify)( uint8_t*, uint16_t );   // optional, selects the lane of a message
+   void                 (*release)( void* );   // called with the reference of a released or dropped message, needed for queue_enqueueLaneRef
 } queue_handle_t;
 
+// Exported variables *********************************************************
+extern const metrics_t  queue_metrics[QUEUE_METRICS];   // of a queue_handle_t, registered per queue
+
 // Exported functions *********************************************************
-void     queue_init              ( queue_handle_t *queueHandle );
-void     queue_manager           ( queue_handle_t *queueHandle );
-void     queue_dequeue           ( queue_handle_t *queueHandle );
-uint8_t* queue_enqueue           ( uint8_t* dataStart, uint16_t dataLength, queue_handle_t *queueHandle );
-uint8_t* queue_getHeadBuffer     ( queue_handle_t *queueHandle );
-uint8_t* queue_getTailBuffer     ( queue_handle_t *queueHandle );
-uint8_t  queue_isFull            ( queue_handle_t *queueHandle );
+void              queue_init              ( queue_handle_t *queueHandle );
+void              queue_flush             ( queue_handle_t *queueHandle );
+void              queue_manager           ( queue_handle_t *queueHandle );
+void              queue_dequeue           ( queue_handle_t *queueHandle );
+void              queue_release           ( uint8_t* dataStart, queue_handle_t *queueHandle );
+uint8_t*          queue_enqueue           ( uint8_t* dataStart, uint16_t dataLength, queue_handle_t *queueHandle );
+uint8_t*          queue_enqueueLane       ( uint8_t* dataStart, uint16_t dataLength, queue_lane_id_t laneId, queue_handle_t *queueHandle );
+uint8_t*          queue_enqueueLaneAt     ( uint8_t* dataStart, uint16_t dataLength, uint8_t* nextBuffer, queue_lane_id_t laneId, queue_handle_t *queueHandle );
+uint8_t           queue_enqueueLaneRef    ( uint8_t* dataStart, uint16_t dataLength, void* reference, queue_lane_id_t laneId, queue_handle_t *queueHandle );
+uint8_t*          queue_reserveLane       ( uint8_t* end, queue_lane_id_t laneId, queue_handle_t *queueHandle );
+void              queue_setLaneHeadBuffer ( uint8_t* buffer, queue_lane_id_t laneId, queue_handle_t *queueHandle );
+uint8_t*          queue_getHeadBuffer     ( queue_handle_t *queueHandle );
+uint8_t*          queue_getLaneHeadBuffer ( queue_lane_id_t laneId, queue_handle_t *queueHandle );
+uint8_t*          queue_getTailBuffer     ( queue_handle_t *queueHandle );
+uint8_t           queue_isFull            ( queue_handle_t *queueHandle );
+uint8_t           queue_isLaneFull        ( queue_lane_id_t laneId, queue_handle_t *queueHandle );
+uint8_t           queue_admit             ( queue_lane_id_t laneId, queue_handle_t *queueHandle );
+queue_lane_id_t   queue_classify          ( uint8_t* data, uint16_t length, queue_handle_t *queueHandle );
 
 #endif /* __QUEUE_H */
 
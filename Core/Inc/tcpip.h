@@ -50,6 +50,7 @@
 
 // Include ********************************************************************
 #include "stm32f4xx_hal.h"
+#include "queuex.h"
 
 // Exported defines ***********************************************************
 #define IP1             ( 192u )
@@ -78,4 +79,18 @@ void                    tcpip_deinit                  ( void );
 uint8_t                 tcpip_output                  ( uint8_t* buffer, uint16_t length );
 const char*             pcApplicationHostnameHookCAP  ( void );
 uint8_t                 tcpip_enqueue                 ( uint8_t* data, uint16_t length );
+queue_lane_id_t         tcpip_classify                ( uint8_t* frame, uint16_t length );
+void                    tcpip_waitTxSpace             ( uint32_t timeout );
+void                    tcpip_notifyTxSpace           ( void );
+void                    tcpip_countTxError            ( void );
+uint32_t                tcpip_getTxWaits              ( void );
+uint32_t                tcpip_getTxErrors             ( void );
+uint32_t                tcpip_getRxLent               ( void );
+uint32_t                tcpip_getRxCopyCycles         ( void );
+uint8_t                 tcpip_releaseRxBuffer         ( uint8_t* buffer );
+uint8_t                 tcpip_enqueueRef              ( uint8_t* data, uint16_t length, void* reference );
+void                    tcpip_releaseTxBuffer         ( void* reference );
+uint32_t                tcpip_getTxRef                ( void );
+uint32_t                tcpip_getRxEvents             ( void );
+uint32_t                tcpip_getRxChecksumErrors     ( void );
 #endif // __TCP_H
\ No newline at end of file
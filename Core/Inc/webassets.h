@@ -0,0 +1,118 @@
+// ****************************************************************************
+/// \file      webassets.h
+///
+/// \brief     Web Assets C Header File
+///
+/// \details   Static files of the web page. The files in Core/Web are gzip
+///            compressed by Core/Web/webassets.py into webassets.c, together
+///            with the complete http response headers. They are sent by the
+///            http server straight out of the flash.
+///            The templates in Core/Web/templates are split into flash text
+///            and typed placeholders, the http server fills in the values
+///            while it streams the response.
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+///
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person
+///            obtaining a copy of this software and associated documentation
+///            files (the "Software"), to deal in the Software without
+///            restriction, including without limitation the rights to use,
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the
+///            Software is furnished to do so, subject to the following
+///            conditions:
+///
+///            The above copyright notice and this permission notice shall be
+///            included in all copies or substantial portions of the Software.
+///
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre
+///
+/// \bug
+///
+/// \warning   webassets.c is generated, edit the files in Core/Web and run
+///            python Core/Web/webassets.py instead.
+///
+/// \todo
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __WEBASSETS_H
+#define __WEBASSETS_H
+
+// Include ********************************************************************
+#include <stddef.h>
+#include <stdint.h>
+
+// Exported defines ***********************************************************
+
+// Exported types *************************************************************
+typedef struct
+{
+   const char*       uri;                 // request path, e.g. "/style.css"
+   const char*       etag;                // quoted entity tag of the file
+   const char*       header;              // 200 response header with content length
+   uint16_t          headerLength;
+   const char*       notModified;         // 304 response header
+   uint16_t          notModifiedLength;
+   const uint8_t*    data;                // gzip compressed file
+   uint32_t          length;
+} webasset_t;
+
+typedef enum
+{
+   WEBTEMPLATE_TEXT = 0,   // flash text
+   WEBTEMPLATE_U32,        // unsigned decimal
+   WEBTEMPLATE_I32,        // signed decimal
+   WEBTEMPLATE_X2,         // two hex digits, e.g. of a mac address
+   WEBTEMPLATE_F1,         // float with one decimal
+   WEBTEMPLATE_F2,         // float with two decimals
+   WEBTEMPLATE_STR,        // zero terminated string
+} webtemplate_type_t;
+
+typedef struct
+{
+   webtemplate_type_t   type;
+   uint16_t             value;            // index of the value of a placeholder
+   uint16_t             length;           // of the text
+   const char*          text;
+} webtemplate_part_t;
+
+typedef union
+{
+   uint32_t             u;                // WEBTEMPLATE_U32, WEBTEMPLATE_X2
+   int32_t              i;                // WEBTEMPLATE_I32
+   float                f;                // WEBTEMPLATE_F1, WEBTEMPLATE_F2
+   const char*          s;                // WEBTEMPLATE_STR
+} webtemplate_value_t;
+
+typedef struct
+{
+   const webtemplate_part_t*  parts;
+   uint16_t                   partsCount;
+   const char* const*         names;            // of the values, the placeholder names
+   const webtemplate_type_t*  types;            // of the values
+   uint16_t                   valuesCount;
+} webtemplate_t;
+
+// Exported variables *********************************************************
+extern const webasset_t webassets[];
+extern const uint16_t   webassetsCount;
+
+#endif // __WEBASSETS_H
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
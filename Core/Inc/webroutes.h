@@ -0,0 +1,144 @@
+// ****************************************************************************
+/// \file      webroutes.h
+///
+/// \brief     Web Routes C Header File
+///
+/// \details   Generated by Core/Web/webassets.py, do not edit. Included by
+///            httpserver.c only, the handlers are static there.
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __WEBROUTES_H
+#define __WEBROUTES_H
+
+// Exported defines ***********************************************************
+#define WEBROUTES_SEED          ( 0x811c9dc5u )
+#define WEBROUTES_SIZE          ( 64u )
+#define WEBROUTES_HOME          ( 46u )        // GET /
+
+// Exported variables *********************************************************
+// 16 routes, the slot is the hash of the key
+static const httpserver_route_t webroutes[WEBROUTES_SIZE] = {
+   [4] = {
+      .key                 = "POST /led_toggle",
+      .keyLength           = 16,
+      .prefix              = 0,
+      .handler             = httpserver_ledToggle,
+      .asset               = NULL,
+   },
+   [9] = {
+      .key                 = "GET /time.json",
+      .keyLength           = 14,
+      .prefix              = 0,
+      .handler             = httpserver_fetchTimeJSON,
+      .asset               = NULL,
+   },
+   [13] = {
+      .key                 = "GET /favicon.ico",
+      .keyLength           = 16,
+      .prefix              = 0,
+      .handler             = NULL,
+      .asset               = &webassets[3],
+   },
+   [14] = {
+      .key                 = "GET /rtos.json",
+      .keyLength           = 14,
+      .prefix              = 0,
+      .handler             = httpserver_fetchRtosJSON,
+      .asset               = NULL,
+   },
+   [22] = {
+      .key                 = "GET /app.js",
+      .keyLength           = 11,
+      .prefix              = 0,
+      .handler             = NULL,
+      .asset               = &webassets[2],
+   },
+   [28] = {
+      .key                 = "GET /sensor.json",
+      .keyLength           = 16,
+      .prefix              = 0,
+      .handler             = httpserver_fetchSensorJSON,
+      .asset               = NULL,
+   },
+#if( QUEUE_SOJOURN == 1u )
+   [40] = {
+      .key                 = "GET /latency.json",
+      .keyLength           = 17,
+      .prefix              = 0,
+      .handler             = httpserver_fetchLatencyJSON,
+      .asset               = NULL,
+   },
+#endif
+   [41] = {
+      .key                 = "POST /led_pulse",
+      .keyLength           = 15,
+      .prefix              = 0,
+      .handler             = httpserver_ledPulse,
+      .asset               = NULL,
+   },
+   [42] = {
+      .key                 = "GET /style.css",
+      .keyLength           = 14,
+      .prefix              = 0,
+      .handler             = NULL,
+      .asset               = &webassets[1],
+   },
+#if( HTTPSERVER_SELECT == 1u )
+   [43] = {
+      .key                 = "GET /events",
+      .keyLength           = 11,
+      .prefix              = 0,
+      .handler             = httpserver_fetchEvents,
+      .asset               = NULL,
+   },
+#endif
+   [46] = {
+      .key                 = "GET /",
+      .keyLength           = 5,
+      .prefix              = 0,
+      .handler             = NULL,
+      .asset               = &webassets[0],
+   },
+   [48] = {
+      .key                 = "GET /tcpip.json",
+      .keyLength           = 15,
+      .prefix              = 0,
+      .handler             = httpserver_fetchTcpIpJSON,
+      .asset               = NULL,
+   },
+   [50] = {
+      .key                 = "GET /info.json",
+      .keyLength           = 14,
+      .prefix              = 0,
+      .handler             = httpserver_fetchInfoJSON,
+      .asset               = NULL,
+   },
+#if( HTTPSERVER_SELECT == 1u )
+   [56] = {
+      .key                 = "GET /ws",
+      .keyLength           = 7,
+      .prefix              = 0,
+      .handler             = httpserver_fetchWebSocket,
+      .asset               = NULL,
+   },
+#endif
+   [59] = {
+      .key                 = "GET /metrics",
+      .keyLength           = 12,
+      .prefix              = 0,
+      .handler             = httpserver_fetchMetrics,
+      .asset               = NULL,
+   },
+   [63] = {
+      .key                 = "POST /led_set_value/",
+      .keyLength           = 20,
+      .prefix              = 1,
+      .handler             = httpserver_ledSetValue,
+      .asset               = NULL,
+   },
+};
+
+#endif // __WEBROUTES_H
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
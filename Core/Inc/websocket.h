@@ -0,0 +1,91 @@
+// ****************************************************************************
+/// \file      websocket.h
+///
+/// \brief     WebSocket C Header File
+///
+/// \details   Module for the websocket protocol (rfc 6455), the opening 
+///            handshake and the framing of the messages.
+///
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+/// 
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person 
+///            obtaining a copy of this software and associated documentation 
+///            files (the "Software"), to deal in the Software without 
+///            restriction, including without limitation the rights to use, 
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the 
+///            Software is furnished to do so, subject to the following 
+///            conditions:
+///            
+///            The above copyright notice and this permission notice shall be 
+///            included in all copies or substantial portions of the Software.
+///            
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES 
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR 
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __WEBSOCKET_H
+#define __WEBSOCKET_H
+
+// Include ********************************************************************
+#include <stdint.h>
+
+// Exported defines ***********************************************************
+#define WEBSOCKET_ACCEPT         ( 28u )     // length of the accept key, base64 of the sha-1 digest
+#define WEBSOCKET_HEADERMAX      ( 4u )      // header of a server frame with up to 65535 bytes payload
+#define WEBSOCKET_CONTINUATION   ( 0x0u )    // opcodes of the frames
+#define WEBSOCKET_TEXT           ( 0x1u )
+#define WEBSOCKET_BINARY         ( 0x2u )
+#define WEBSOCKET_CLOSE          ( 0x8u )
+#define WEBSOCKET_PING           ( 0x9u )
+#define WEBSOCKET_PONG           ( 0xAu )
+#define WEBSOCKET_CLOSE_NORMAL   ( 1000u )   // status codes of a close frame
+#define WEBSOCKET_CLOSE_PROTOCOL ( 1002u )
+#define WEBSOCKET_CLOSE_DATA     ( 1003u )
+#define WEBSOCKET_CLOSE_TOOBIG   ( 1009u )
+
+// Exported types *************************************************************
+typedef enum
+{
+   WEBSOCKET_INCOMPLETE = 0,  // the frame is not received completely yet
+   WEBSOCKET_COMPLETE,        // the payload of the frame is unmasked
+   WEBSOCKET_INVALID          // not a valid frame of a client
+} websocket_status_t;
+
+typedef struct
+{
+   uint8_t              fin;              // 1 if it is the last frame of a message
+   uint8_t              opcode;
+   uint8_t*             payload;
+   uint16_t             payloadLength;
+   uint16_t             length;           // of the whole frame
+} websocket_frame_t;
+
+// Exported functions *********************************************************
+uint8_t              websocket_accept  ( const uint8_t* key, uint16_t keyLength, char* accept );
+websocket_status_t   websocket_parse   ( uint8_t* data, uint16_t length, websocket_frame_t* frame );
+uint16_t             websocket_header  ( uint8_t* buffer, uint8_t opcode, uint16_t payloadLength );
+#endif // __WEBSOCKET_H
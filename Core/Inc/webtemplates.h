@@ -0,0 +1,112 @@
+// ****************************************************************************
+/// \file      webtemplates.h
+///
+/// \brief     Web Templates C Header File
+///
+/// \details   Generated by Core/Web/webassets.py, do not edit.
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __WEBTEMPLATES_H
+#define __WEBTEMPLATES_H
+
+// Include ********************************************************************
+#include "webassets.h"
+
+// info.json
+enum
+{
+   INFO_JSON_IP0,                 // u32
+   INFO_JSON_IP1,                 // u32
+   INFO_JSON_IP2,                 // u32
+   INFO_JSON_IP3,                 // u32
+   INFO_JSON_MAC0,                // x2
+   INFO_JSON_MAC1,                // x2
+   INFO_JSON_MAC2,                // x2
+   INFO_JSON_MAC3,                // x2
+   INFO_JSON_MAC4,                // x2
+   INFO_JSON_MAC5,                // x2
+   INFO_JSON_GUESTS,              // u32
+   INFO_JSON_RTOS,                // str
+   INFO_JSON_DUTY,                // u32
+   INFO_JSON_VALUES
+};
+extern const webtemplate_t webtemplate_info_json;
+
+// time.json
+enum
+{
+   TIME_JSON_D,                   // u32
+   TIME_JSON_H,                   // u32
+   TIME_JSON_M,                   // u32
+   TIME_JSON_S,                   // u32
+   TIME_JSON_VALUES
+};
+extern const webtemplate_t webtemplate_time_json;
+
+// rtos.json
+enum
+{
+   RTOS_JSON_HEAP,                // u32
+   RTOS_JSON_T1N,                 // str
+   RTOS_JSON_T2N,                 // str
+   RTOS_JSON_T3N,                 // str
+   RTOS_JSON_T4N,                 // str
+   RTOS_JSON_T5N,                 // str
+   RTOS_JSON_T6N,                 // str
+   RTOS_JSON_T7N,                 // str
+   RTOS_JSON_T1P,                 // u32
+   RTOS_JSON_T2P,                 // u32
+   RTOS_JSON_T3P,                 // u32
+   RTOS_JSON_T4P,                 // u32
+   RTOS_JSON_T5P,                 // u32
+   RTOS_JSON_T6P,                 // u32
+   RTOS_JSON_T7P,                 // u32
+   RTOS_JSON_VALUES
+};
+extern const webtemplate_t webtemplate_rtos_json;
+
+// sensor.json
+enum
+{
+   SENSOR_JSON_BTN,               // str
+   SENSOR_JSON_TEMP,              // f1
+   SENSOR_JSON_VOLT,              // f2
+   SENSOR_JSON_VALUES
+};
+extern const webtemplate_t webtemplate_sensor_json;
+
+// tcpip.json
+enum
+{
+   TCPIP_JSON_RXF,                // u32
+   TCPIP_JSON_TXF,                // u32
+   TCPIP_JSON_RXD,                // u32
+   TCPIP_JSON_TXD,                // u32
+   TCPIP_JSON_TXIRQ,              // u32
+   TCPIP_JSON_TXDROPTAIL,         // u32
+   TCPIP_JSON_TXDROPHEAD,         // u32
+   TCPIP_JSON_TXDROPEARLY,        // u32
+   TCPIP_JSON_TXWAIT,             // u32
+   TCPIP_JSON_TXLOST,             // u32
+   TCPIP_JSON_RXDROPTAIL,         // u32
+   TCPIP_JSON_RXDROPHEAD,         // u32
+   TCPIP_JSON_RXDROPEARLY,        // u32
+   TCPIP_JSON_RXARMMAX,           // u32
+   TCPIP_JSON_RXISRMAX,           // u32
+   TCPIP_JSON_RXFILTERED,         // u32
+   TCPIP_JSON_RXLENT,             // u32
+   TCPIP_JSON_RXCOPYCYC,          // u32
+   TCPIP_JSON_TXREF,              // u32
+   TCPIP_JSON_RXNOTETHII,         // u32
+   TCPIP_JSON_RXETHERTYPE,        // u32
+   TCPIP_JSON_RXEVENTS,           // u32
+   TCPIP_JSON_IPQUEUEMIN,         // u32
+   TCPIP_JSON_RXCHECKSUMERR,      // u32
+   TCPIP_JSON_VALUES
+};
+extern const webtemplate_t webtemplate_tcpip_json;
+
+#endif // __WEBTEMPLATES_H
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
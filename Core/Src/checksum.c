@@ -0,0 +1,260 @@
+// ****************************************************************************
+/// \file      checksum.c
+///
+/// \brief     Internet Checksum C Source File
+///
+/// \details   Module to calculate the ones complement sum of the internet 
+///            checksum (rfc 1071), optionally while copying the data. The
+///            data is summed in 32 bit words and the carries are folded at 
+///            the end. On a cortex-m4 the words are added with a chain of 
+///            adcs instructions, which adds the carry of the previous word,
+///            elsewhere the carries are collected in the upper half of a 64 
+///            bit accumulator.
+///            The partial sums are in memory byte order, like the sums of 
+///            usGenerateChecksum, and have to be started at an even offset
+///            of the checksummed data.
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+/// 
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person 
+///            obtaining a copy of this software and associated documentation 
+///            files (the "Software"), to deal in the Software without 
+///            restriction, including without limitation the rights to use, 
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the 
+///            Software is furnished to do so, subject to the following 
+///            conditions:
+///            
+///            The above copyright notice and this permission notice shall be 
+///            included in all copies or substantial portions of the Software.
+///            
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES 
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR 
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include <string.h>
+#include "checksum.h"
+
+// Private define *************************************************************
+#define CHECKSUM_UNROLL       ( 16u )   // bytes per iteration of the main loop
+#ifndef CHECKSUM_ARM_ADC                 // 1: adcs chain, 0: portable c
+#if defined( __ARM_ARCH_7EM__ ) || defined( __ARM7EM__ )
+#define CHECKSUM_ARM_ADC      ( 1u )
+#else
+#define CHECKSUM_ARM_ADC      ( 0u )
+#endif
+#endif
+
+// Private types     **********************************************************
+#if( CHECKSUM_ARM_ADC == 1u )
+typedef uint32_t checksum_acc_t;         // carries are added back right away
+#else
+typedef uint64_t checksum_acc_t;         // carries are collected in the upper half
+#endif
+
+// Private variables **********************************************************
+
+// Private function prototypes ************************************************
+static inline uint32_t  checksum_load     ( const uint8_t* data );
+static inline uint32_t  checksum_loadTail ( const uint8_t* data, uint32_t length );
+static inline checksum_acc_t checksum_add4( checksum_acc_t acc, uint32_t w0, uint32_t w1, uint32_t w2, uint32_t w3 );
+static inline uint32_t  checksum_reduce   ( uint64_t sum );
+
+// Private functions **********************************************************
+
+// ----------------------------------------------------------------------------
+/// \brief     Adds data to a partial checksum. The data may be unaligned.
+///
+/// \param     [in]  const uint8_t* data
+/// \param     [in]  uint32_t length
+/// \param     [in]  uint32_t sum, partial sum of the preceding data or 0
+///
+/// \return    uint32_t partial sum
+uint32_t checksum_add( const uint8_t* data, uint32_t length, uint32_t sum )
+{
+   checksum_acc_t acc = sum;
+   
+   while( length >= CHECKSUM_UNROLL )
+   {
+      acc = checksum_add4( acc, checksum_load( data ), checksum_load( data + 4u ), checksum_load( data + 8u ), checksum_load( data + 12u ) );
+      data   += CHECKSUM_UNROLL;
+      length -= CHECKSUM_UNROLL;
+   }
+   while( length >= 4u )
+   {
+      acc = checksum_add4( acc, checksum_load( data ), 0, 0, 0 );
+      data   += 4u;
+      length -= 4u;
+   }
+   acc = checksum_add4( acc, checksum_loadTail( data, length ), 0, 0, 0 );
+   
+   return checksum_reduce( acc );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Copies data and adds it to a partial checksum in the same pass.
+///            Source and destination may be unaligned.
+///
+/// \param     [out] uint8_t* dst
+/// \param     [in]  const uint8_t* src
+/// \param     [in]  uint32_t length
+/// \param     [in]  uint32_t sum, partial sum of the preceding data or 0
+///
+/// \return    uint32_t partial sum
+uint32_t checksum_copy( uint8_t* dst, const uint8_t* src, uint32_t length, uint32_t sum )
+{
+   checksum_acc_t acc = sum;
+   uint32_t       w0, w1, w2, w3;
+   
+   while( length >= CHECKSUM_UNROLL )
+   {
+      w0 = checksum_load( src );
+      w1 = checksum_load( src + 4u );
+      w2 = checksum_load( src + 8u );
+      w3 = checksum_load( src + 12u );
+      memcpy( dst,       &w0, 4u );
+      memcpy( dst + 4u,  &w1, 4u );
+      memcpy( dst + 8u,  &w2, 4u );
+      memcpy( dst + 12u, &w3, 4u );
+      acc = checksum_add4( acc, w0, w1, w2, w3 );
+      src    += CHECKSUM_UNROLL;
+      dst    += CHECKSUM_UNROLL;
+      length -= CHECKSUM_UNROLL;
+   }
+   while( length >= 4u )
+   {
+      w0 = checksum_load( src );
+      memcpy( dst, &w0, 4u );
+      acc = checksum_add4( acc, w0, 0, 0, 0 );
+      src    += 4u;
+      dst    += 4u;
+      length -= 4u;
+   }
+   memcpy( dst, src, length );
+   acc = checksum_add4( acc, checksum_loadTail( src, length ), 0, 0, 0 );
+   
+   return checksum_reduce( acc );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Adds two partial sums.
+///
+/// \param     [in]  uint32_t sum1
+/// \param     [in]  uint32_t sum2
+///
+/// \return    uint32_t partial sum
+uint32_t checksum_combine( uint32_t sum1, uint32_t sum2 )
+{
+   return checksum_reduce( (uint64_t)sum1 + sum2 );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Folds a partial sum to the 16 bit ones complement sum. The 
+///            complement of it is the checksum, data with a valid checksum
+///            folds to CHECKSUM_CORRECT.
+///
+/// \param     [in]  uint32_t sum
+///
+/// \return    uint16_t ones complement sum in memory byte order
+uint16_t checksum_fold( uint32_t sum )
+{
+   sum = ( sum & 0xFFFFu ) + ( sum >> 16 );
+   sum = ( sum & 0xFFFFu ) + ( sum >> 16 );
+   return (uint16_t)sum;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Loads a 32 bit word in memory byte order from an unaligned 
+///            address. Compiles to a single ldr on the cortex-m4.
+///
+/// \param     [in]  const uint8_t* data
+///
+/// \return    uint32_t word
+static inline uint32_t checksum_load( const uint8_t* data )
+{
+   uint32_t word;
+   memcpy( &word, data, 4u );
+   return word;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Loads the last 0..3 bytes of the data, padded with zeros.
+///
+/// \param     [in]  const uint8_t* data
+/// \param     [in]  uint32_t length
+///
+/// \return    uint32_t word
+static inline uint32_t checksum_loadTail( const uint8_t* data, uint32_t length )
+{
+   uint32_t word = 0;
+   memcpy( &word, data, length );
+   return word;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Adds four words to the accumulator. The adcs chain takes one
+///            instruction per word, the carry of the last word is added back
+///            with the final adc. This is cheaper than summing the halfwords
+///            with the uadd16 simd instruction, which needs a sel and another 
+///            uadd16 to count the carries of the lanes.
+///
+/// \param     [in]  checksum_acc_t acc
+/// \param     [in]  uint32_t w0
+/// \param     [in]  uint32_t w1
+/// \param     [in]  uint32_t w2
+/// \param     [in]  uint32_t w3
+///
+/// \return    checksum_acc_t accumulator
+static inline checksum_acc_t checksum_add4( checksum_acc_t acc, uint32_t w0, uint32_t w1, uint32_t w2, uint32_t w3 )
+{
+#if( CHECKSUM_ARM_ADC == 1u )
+   __asm volatile( "adds %0, %0, %1 \n"
+                   "adcs %0, %0, %2 \n"
+                   "adcs %0, %0, %3 \n"
+                   "adcs %0, %0, %4 \n"
+                   "adc  %0, %0, #0 \n"
+                   : "+r" ( acc )
+                   : "r" ( w0 ), "r" ( w1 ), "r" ( w2 ), "r" ( w3 )
+                   : "cc" );
+   return acc;
+#else
+   return acc + w0 + w1 + w2 + w3;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Folds the carries of the accumulator into a 32 bit partial sum.
+///
+/// \param     [in]  uint64_t sum
+///
+/// \return    uint32_t partial sum
+static inline uint32_t checksum_reduce( uint64_t sum )
+{
+   sum = ( sum & 0xFFFFFFFFu ) + ( sum >> 32 );
+   sum = ( sum & 0xFFFFFFFFu ) + ( sum >> 32 );
+   return (uint32_t)sum;
+}
+
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
@@ -49,6 +49,7 @@
 #include  <stdlib.h>
 #include "dhcpserver.h"
 #include "printf.h"
+#include "metrics.h"
 
 #include "cmsis_os.h"
 #include "FreeRTOS_IP.h"
@@ -139,6 +140,8 @@ static DHCP_MSG_t   *dhcpMsg;
 static TickType_t             xReceiveTimeOut   = pdMS_TO_TICKS( 4000 );
 static TickType_t             xSendTimeOut      = pdMS_TO_TICKS( 4000 );
 static char                   magic_cookie[]    = {0x63,0x82,0x53,0x63};
+static metrics_socket_t       socketErrors;
+static metrics_group_t        socketMetrics     = { metrics_socket, METRICS_SOCKET, &socketErrors, "server=\"dhcp\"", NULL };
 
 // Global variables ***********************************************************
 
@@ -167,6 +170,9 @@ void dhcpserver_init( dhcpconf_t *dhcpconf_param )
    // register leasing pool
    dhcpconf = dhcpconf_param;
    
+   // register the socket errors
+   metrics_register( &socketMetrics );
+   
    // initialise dhcp handle task
    dhcpserverHandleTaskToNotify = osThreadNew( dhcpserver_handle, NULL, &dhcpserverHandleTask_attributes );
 }
@@ -196,12 +202,6 @@ static void dhcpserver_handle( void *pvParameters )
    static uint32_t   errorDisco;
    static uint32_t   errorReq;
    uint8_t*          ptr;
-   static uint16_t   etimeout;  
-   static uint16_t   enomem;  
-   static uint16_t   enotconn;
-   static uint16_t   eintr;   
-   static uint16_t   einval; 
-   static uint16_t   eelse;
    long              lBytes;
    struct            freertos_sockaddr xClient, xBindAddress;
    uint32_t          xClientLength = sizeof( xClient );
@@ -238,12 +238,12 @@ static void dhcpserver_handle( void *pvParameters )
                                    &xClient,
                                    &xClientLength );
 
-      // check lengthOfbytes ------------- lengthOfbytes > 0                           --> data received
-      //                                   lengthOfbytes = 0                           --> timeout
-      //                                   lengthOfbytes = pdFREERTOS_ERRNO_ENOMEM     --> not enough memory on socket
-      //                                   lengthOfbytes = pdFREERTOS_ERRNO_ENOTCONN   --> socket was or got closed
-      //                                   lengthOfbytes = pdFREERTOS_ERRNO_EINTR      --> if the socket received a signal, causing the read operation to be aborted
-      //                                   lengthOfbytes = pdFREERTOS_ERRNO_EINVAL     --> socket is not valid
+      // check lengthOfbytes ------------- lengthOfbytes > 0                             --> data received
+      //                                   lengthOfbytes = -pdFREERTOS_ERRNO_EWOULDBLOCK --> timeout
+      //                                   lengthOfbytes = -pdFREERTOS_ERRNO_ENOMEM      --> not enough memory on socket
+      //                                   lengthOfbytes = -pdFREERTOS_ERRNO_ENOTCONN    --> socket was or got closed
+      //                                   lengthOfbytes = -pdFREERTOS_ERRNO_EINTR       --> if the socket received a signal, causing the read operation to be aborted
+      //                                   lengthOfbytes = -pdFREERTOS_ERRNO_EINVAL      --> socket is not valid
       if( lengthOfbytes > 0 )
       {         
          // local variables
@@ -354,35 +354,35 @@ static void dhcpserver_handle( void *pvParameters )
                   break;
          }
       }
-      else if( lengthOfbytes == 0 )
+      else if( lengthOfbytes == 0 || lengthOfbytes == -pdFREERTOS_ERRNO_EWOULDBLOCK )
       {
-         // No data was received, but FreeRTOS_recv() did not return an error. Timeout?
-         etimeout++;
+         // No data was received, FreeRTOS_recvfrom() timed out
+         socketErrors.etimeout++;
       }
-      else if( lengthOfbytes == pdFREERTOS_ERRNO_ENOMEM )                                                                                        
+      else if( lengthOfbytes == -pdFREERTOS_ERRNO_ENOMEM )                                                                                        
       {                                                                                                                    
          // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                   
-         enomem++;
+         socketErrors.enomem++;
       } 
-      else if( lengthOfbytes == pdFREERTOS_ERRNO_ENOTCONN )                                                                   
+      else if( lengthOfbytes == -pdFREERTOS_ERRNO_ENOTCONN )                                                                   
       {                                                                                                                       
          // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         enotconn++;
+         socketErrors.enotconn++;
       } 
-      else if( lengthOfbytes == pdFREERTOS_ERRNO_EINTR )                                                                      
+      else if( lengthOfbytes == -pdFREERTOS_ERRNO_EINTR )                                                                      
       {                                                                                                                       
          // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         eintr++;
+         socketErrors.eintr++;
       } 
-      else if( lengthOfbytes == pdFREERTOS_ERRNO_EINVAL )                                                                      
+      else if( lengthOfbytes == -pdFREERTOS_ERRNO_EINVAL )                                                                      
       {                                                                                                                       
          // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         einval++;
+         socketErrors.einval++;
       } 
       else
       {                                                                                                                       
          // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         eelse++;
+         socketErrors.eelse++;
       } 
    }
 }
@@ -50,6 +50,7 @@
 #include "dnsserver.h"
 #include "tcpip.h"
 #include "printf.h"
+#include "metrics.h"
 
 #include "cmsis_os.h"
 #include "FreeRTOS_IP.h"
@@ -106,6 +107,8 @@ const osThreadAttr_t dnsserverHandleTask_attributes = {
   .priority = (osPriority_t) osPriorityNormal,
 };
 static void dnsserver_handle( void *pvParameters );
+static metrics_socket_t socketErrors;
+static metrics_group_t socketMetrics = { metrics_socket, METRICS_SOCKET, &socketErrors, "server=\"dns\"", NULL };
 
 // Global variables ***********************************************************
 
@@ -123,6 +126,9 @@ static uint8_t    dnsserver_parseQuery ( uint8_t *data, uint16_t length, DNS_QUE
 /// \return    none
 void dnsserver_init( void )
 {
+   // register the socket errors
+   metrics_register( &socketMetrics );
+   
    // initialise dns handle task
    dnsserverHandleTaskToNotify = osThreadNew( dnsserver_handle, NULL, &dnsserverHandleTask_attributes );
 }
@@ -152,12 +158,6 @@ static void dnsserver_handle( void *pvParameters )
    static uint32_t   errorDisco;
    static uint32_t   errorReq;
    uint8_t*          ptr;
-   static uint16_t   etimeout;  
-   static uint16_t   enomem;  
-   static uint16_t   enotconn;
-   static uint16_t   eintr;   
-   static uint16_t   einval; 
-   static uint16_t   eelse;
    long              lBytes;
    struct            freertos_sockaddr xClient, xBindAddress;
    uint32_t          xClientLength = sizeof( xClient );
@@ -195,12 +195,12 @@ static void dnsserver_handle( void *pvParameters )
                                    &xClient,
                                    &xClientLength );
 
-      // check lengthOfbytes ------------- lengthOfbytes > 0                           --> data received
-      //                                   lengthOfbytes = 0                           --> timeout
-      //                                   lengthOfbytes = pdFREERTOS_ERRNO_ENOMEM     --> not enough memory on socket
-      //                                   lengthOfbytes = pdFREERTOS_ERRNO_ENOTCONN   --> socket was or got closed
-      //                                   lengthOfbytes = pdFREERTOS_ERRNO_EINTR      --> if the socket received a signal, causing the read operation to be aborted
-      //                                   lengthOfbytes = pdFREERTOS_ERRNO_EINVAL     --> socket is not valid
+      // check lengthOfbytes ------------- lengthOfbytes > 0                             --> data received
+      //                                   lengthOfbytes = -pdFREERTOS_ERRNO_EWOULDBLOCK --> timeout
+      //                                   lengthOfbytes = -pdFREERTOS_ERRNO_ENOMEM      --> not enough memory on socket
+      //                                   lengthOfbytes = -pdFREERTOS_ERRNO_ENOTCONN    --> socket was or got closed
+      //                                   lengthOfbytes = -pdFREERTOS_ERRNO_EINTR       --> if the socket received a signal, causing the read operation to be aborted
+      //                                   lengthOfbytes = -pdFREERTOS_ERRNO_EINVAL      --> socket is not valid
       if( lengthOfbytes > 0 )
       {         
          if( lengthOfbytes <= sizeof(DNS_HEADER_t) )
@@ -262,35 +262,35 @@ static void dnsserver_handle( void *pvParameters )
          // send the query response
          FreeRTOS_sendto( xListeningSocket, pucTxRxBuffer, lengthOfbytes+sizeof(DNS_RESPONSE_t), 0, &xClient, sizeof( xClient ) );
       }
-      else if( lengthOfbytes == 0 )
+      else if( lengthOfbytes == 0 || lengthOfbytes == -pdFREERTOS_ERRNO_EWOULDBLOCK )
       {
-         // No data was received, but FreeRTOS_recv() did not return an error. Timeout?
-         etimeout++;
+         // No data was received, FreeRTOS_recvfrom() timed out
+         socketErrors.etimeout++;
       }
-      else if( lengthOfbytes == pdFREERTOS_ERRNO_ENOMEM )                                                                                        
+      else if( lengthOfbytes == -pdFREERTOS_ERRNO_ENOMEM )                                                                                        
       {                                                                                                                    
          // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                   
-         enomem++;
+         socketErrors.enomem++;
       } 
-      else if( lengthOfbytes == pdFREERTOS_ERRNO_ENOTCONN )                                                                   
+      else if( lengthOfbytes == -pdFREERTOS_ERRNO_ENOTCONN )                                                                   
       {                                                                                                                       
          // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         enotconn++;
+         socketErrors.enotconn++;
       } 
-      else if( lengthOfbytes == pdFREERTOS_ERRNO_EINTR )                                                                      
+      else if( lengthOfbytes == -pdFREERTOS_ERRNO_EINTR )                                                                      
       {                                                                                                                       
          // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         eintr++;
+         socketErrors.eintr++;
       } 
-      else if( lengthOfbytes == pdFREERTOS_ERRNO_EINVAL )                                                                      
+      else if( lengthOfbytes == -pdFREERTOS_ERRNO_EINVAL )                                                                      
       {                                                                                                                       
          // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         einval++;
+         socketErrors.einval++;
       } 
       else
       {                                                                                                                       
          // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         eelse++;
+         socketErrors.eelse++;
       } 
    }
 }
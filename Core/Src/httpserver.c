@@ -49,9 +49,15 @@
 #include  <stdlib.h>
 #include "httpserver.h"
 #include "led.h"
+#include "metrics.h"
 #include "monitor.h"
 #include "printf.h"
 #include "usb_device.h"
+#include "tcpip.h"
+#include "queuex.h"
+#include "webassets.h"
+#include "webtemplates.h"
+#include "websocket.h"
 
 #include "cmsis_os.h"
 #include "FreeRTOS_IP.h"
@@ -62,13 +68,100 @@
 #include "FreeRTOS_DHCP.h"
 
 // Private defines ************************************************************
-#define URIBUFFER       ( 500u )
-#define TXBIG           ( 7000u )
-#define TXSMALL         ( 256u )
-#define TXMEDIUM        ( 512u )
-#define FAVICON         "<link href='data:image/x-icon;base64,AAABAAEAEBAQAAEABAAoAQAAFgAAACgAAAAQAAAAIAAAAAEABAAAAAAAgAAAAAAAAAAAAAAAEAAAAAAAAAAA4f8AAAAAAPo+GQCBs/8AAAD/ABYtUAAFESgADAz6AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAERVVURVVUREREVVRFVURERERd3EXdxERETN3d3d3MxERMzcHB3MzEREzInd3IjMRESIiciciIhEREiJyJyIhERERInIiERERERETMzMzERERFmMzNmZhEREWNmMzYzMRERY2MzEzMREREWZjMTERERERREREREEREREUREQRERHhhwAA8Y8AAPGPAADAAwAAwAMAAMADAADAAwAA4AcAAPA/AAD4DwAA4AcAAOADAADgBwAA8B8AAPAHAAD4PwAA' rel='icon' type='image/x-icon' />"
+#define RXBUFFER        ( ipconfigTCP_MSS )   // requests of a connection
+#define TXBUFFER        ( 1536u )            // responses of a connection
+#define KEEPALIVE_MAX   ( 100u )             // requests per connection
+#define SELECT_PERIOD   ( pdMS_TO_TICKS( 250u ) ) // check of the timeouts by the select server
+#define PENDINGMAX      ( 16384u )           // response bytes held back by the select server, of all connections
+#define STREAMRESERVE   ( 64u )              // header fields and chunk framing of a streamed response
+#define CHUNKLINE       ( 6u )               // chunk size line, four hex digits
+#define VALUETEXT       ( 16u )              // formatted value with the terminating zero
+#define EVENTSFIELDS    ( TIME_JSON_VALUES + RTOS_JSON_VALUES + SENSOR_JSON_VALUES + TCPIP_JSON_VALUES )
+#define NOCONTENT       "HTTP/1.1 204 No Content\r\n\r\n"
+#define BADREQUEST      "HTTP/1.1 400 Bad Request\r\n\r\n"
+#define EVENTSHEADER    "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n\r\n"
+#define WEBSOCKETHEADER "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: "
 #define JSONHEADER      "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nX-Content-Type-Options: nosniff\r\nCache-Control: no-cache\r\n\r\n"
+#define METRICSHEADER   "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nCache-Control: no-cache\r\n\r\n"
 // Private types     **********************************************************
+typedef enum
+{
+   HTTP_FREE = 0,       // slot is not used
+   HTTP_OPEN,           // waiting for requests
+   HTTP_EVENTS,         // event stream, gets the changes of the snapshot
+   HTTP_WEBSOCKET,      // websocket, gets the commands of the page
+   HTTP_SENDING,        // sends the held back output, then shuts down
+   HTTP_CLOSING         // shut down, waiting for the client to close
+} httpserver_state_t;
+
+typedef struct
+{
+   Socket_t             socket;
+   uint8_t*             buffer;
+   uint16_t             bufferSize;
+   uint16_t             size;             // of the pieces sent
+   uint16_t             length;
+   uint16_t             start;            // of the chunk size line
+   uint8_t              keepAlive;
+   uint8_t              streaming;        // 1 once the header is sent
+   uint8_t              error;
+   httpserver_state_t   upgrade;          // HTTP_EVENTS or HTTP_WEBSOCKET if the connection changes the protocol
+   const uint8_t*       request;          // the request which is answered
+   uint16_t             requestLength;
+} httpserver_stream_t;
+
+typedef struct
+{
+   const char*          key;              // method and path, e.g. "GET /time.json"
+   uint16_t             keyLength;
+   uint8_t              prefix;           // 1 if the last segment of the path is a parameter
+   void                 (*handler)( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+   const webasset_t*    asset;            // static file, instead of the handler
+} httpserver_route_t;
+
+#if( HTTPSERVER_SELECT == 1u )
+// A piece of a response which did not fit into the socket. It is sent out of
+// the flash or out of the copy behind the piece.
+typedef struct httpserver_pending
+{
+   struct httpserver_pending* next;
+   const uint8_t*       data;
+   uint16_t             length;
+   uint16_t             size;             // of the copy, 0 for a piece in the flash
+} httpserver_pending_t;
+
+typedef struct
+{
+   Socket_t             socket;
+   httpserver_state_t   state;
+   TickType_t           timestamp;        // last request, last piece sent or begin of the shutdown
+   uint16_t             rxLength;
+   uint16_t             requests;
+   uint8_t              resync;           // 1 if the event stream needs the whole snapshot
+   uint8_t              telemetry;        // 1 if the websocket gets the telemetry
+   uint8_t              deferred;         // 1 if requests wait for the held back output
+   uint8_t              error;            // 1 if a response could not be held back
+   httpserver_pending_t* pending;         // output held back until the socket has space
+   uint8_t              rxBuffer[RXBUFFER];
+} httpserver_connection_t;
+
+typedef struct
+{
+   const webtemplate_t* webtemplate;      // the placeholder names are the json keys
+   void                 (*values)( webtemplate_value_t* values );
+} httpserver_section_t;
+#endif
+
+typedef struct
+{
+   uint32_t             connectionsRefused;  // all slots of the select server in use
+   uint32_t             requestTooLong;      // request larger than the receive buffer
+   uint32_t             eventsMissed;        // event not sent, no space in the socket
+   uint32_t             framesDropped;       // websocket frame not sent, no space in the socket
+   uint32_t             responsesHeld;       // response held back, no space in the socket
+   uint32_t             responsesAborted;    // response not held back, the connection was closed
+   uint32_t             mallocErrors;        // buffers of a connection task not allocated
+} httpserver_statistic_t;
 
 // Private variables **********************************************************
 osThreadId_t webserverListenTaskToNotify;
@@ -85,76 +178,123 @@ const osThreadAttr_t webserverHandleTask_attributes = {
   .priority = (osPriority_t) osPriorityNormal,
 };
 
+#if( HTTPSERVER_SELECT == 1u )
+// the connection table and the responses of the select server
+static httpserver_connection_t   connections[HTTPSERVER_CONNECTIONS];
+static uint8_t                   txBuffer[TXBUFFER];
+static const TickType_t          xNoTimeOut = 0;
+static httpserver_connection_t   *responding;   // answered by the select task, see httpserver_write()
+static uint32_t                  pendingBytes;  // copies of the held back output
+
+// the values of the last event, as sent to the event streams
+static char                      snapshot[EVENTSFIELDS][VALUETEXT];
+#endif
+
 static TickType_t xReceiveTimeOut         = pdMS_TO_TICKS( 4000 );
+#if( HTTPSERVER_SELECT == 0u )
 static TickType_t xSendTimeOut            = pdMS_TO_TICKS( 4000 );
+#endif
 static BaseType_t xTrueValue              = 1;
 static uint32_t   guestCounter;
+extern queue_handle_t   tcpQueue;
+extern queue_handle_t   usbQueue;
 
-// the webpage top header
-static const char *webpage_top = {
-   "HTTP/1.1 200 OK\r\n"
-   "Content-Type: text/html; charset=utf-8\r\n\r\n"
-   //"Keep-Alive: timeout=20\r\n" 
-   //"Connection: keep-alive\r\n\r\n"
-
-   "<!DOCTYPE html>"
-   "<html lang='en'><head>"
-   "<meta charset='utf-8'>"
-   "<style type='text/css'>"
-   // header text
-   "#box1 {"
-      "background-image:linear-gradient(#34ace0, #227093);"
-      "padding:10px;"
-      "margin:10px;"
-   "}"
-   "</style>"
-      
-   FAVICON
-   "<title>RNDIS HTTP Server Example</title>"
-   "<style> div.main {"
-   "font-family: Arial;"
-   "padding: 0.01em 30px;"
-   "box-shadow: 2px 2px 1px 1px #d2d2d2;"
-   "background-color: #f1f1f1;}"
-   "</style>"
-   "</head>"
-   "<body><div class='main'>"
-   // Top header bar ////////////////////////////////////////////////////////
-   "<p><div id='box1' style='height:55;'>"
-   "<font size='20' font color='white'><b>RNDIS HTTP Server Example - v0.3.0.2</b></font>"
-   "</div></p>"
-   //////////////////////////////////////////////////////////////////////////
-   "<br />"
-};
-
-static const char *webpage_bottom_no_btn = {
-   "<br>"    
-   "<p style=\"text-align:center;\">&#169 Copyright 2021 by Nico Korn</p>" 
-   "</div></body></html>"
+// the values on /metrics
+static httpserver_statistic_t statistic;
+static const metrics_t httpserver_metrics[] =
+{
+   { "http_connections_refused_total",      NULL, "Connections refused by the select server, all slots in use",     METRICS_COUNTER, METRICS_FIELD( httpserver_statistic_t, connectionsRefused ), NULL },
+   { "http_requests_too_long_total",        NULL, "Requests refused because they do not fit into the buffer",       METRICS_COUNTER, METRICS_FIELD( httpserver_statistic_t, requestTooLong ),     NULL },
+   { "http_events_missed_total",            NULL, "Events not sent to a stream, the stream gets the whole snapshot", METRICS_COUNTER, METRICS_FIELD( httpserver_statistic_t, eventsMissed ),       NULL },
+   { "http_websocket_frames_dropped_total", NULL, "Websocket frames not sent, no space in the socket",              METRICS_COUNTER, METRICS_FIELD( httpserver_statistic_t, framesDropped ),      NULL },
+   { "http_responses_held_total",           NULL, "Responses held back until the socket had space",                 METRICS_COUNTER, METRICS_FIELD( httpserver_statistic_t, responsesHeld ),      NULL },
+   { "http_responses_aborted_total",        NULL, "Responses aborted, too much output held back or client gone",    METRICS_COUNTER, METRICS_FIELD( httpserver_statistic_t, responsesAborted ),   NULL },
+   { "http_task_malloc_errors_total",       NULL, "Connection tasks which did not get their buffers",               METRICS_COUNTER, METRICS_FIELD( httpserver_statistic_t, mallocErrors ),       NULL },
 };
+static metrics_group_t httpMetrics = { httpserver_metrics, sizeof( httpserver_metrics ) / sizeof( httpserver_metrics[0] ), &statistic, NULL, NULL };
+#if( HTTPSERVER_SELECT == 0u )
+static metrics_socket_t socketErrors;
+static metrics_group_t socketMetrics = { metrics_socket, METRICS_SOCKET, &socketErrors, "server=\"http\"", NULL };
+#endif
 
 // Global variables ***********************************************************
 
 // Private function prototypes ************************************************
+static Socket_t   httpserver_socket          ( BaseType_t xBacklog, TickType_t timeout );
+#if( HTTPSERVER_SELECT == 1u )
+static void       httpserver_select          ( void *pvParameters );
+static void       httpserver_shutdown        ( httpserver_connection_t* connection, SocketSet_t xSocketSet, TickType_t now );
+static void       httpserver_drain           ( httpserver_connection_t* connection, SocketSet_t xSocketSet, TickType_t now );
+static void       httpserver_events          ( SocketSet_t xSocketSet, TickType_t now );
+static uint16_t   httpserver_event           ( const httpserver_section_t* section, char (*values)[VALUETEXT], uint8_t all );
+static void       httpserver_eventSend       ( httpserver_connection_t* connection, SocketSet_t xSocketSet, uint16_t length, TickType_t now );
+static void       httpserver_fetchEvents     ( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static void       httpserver_fetchWebSocket  ( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static void       httpserver_webSocket       ( httpserver_connection_t* connection, SocketSet_t xSocketSet, TickType_t now );
+static void       httpserver_webSocketCommand( httpserver_connection_t* connection, SocketSet_t xSocketSet, const uint8_t* command, uint16_t length, TickType_t now );
+static void       httpserver_webSocketClose  ( httpserver_connection_t* connection, SocketSet_t xSocketSet, uint16_t code, TickType_t now );
+static void       httpserver_webSocketSend   ( httpserver_connection_t* connection, SocketSet_t xSocketSet, uint8_t opcode, const uint8_t* payload, uint16_t payloadLength, TickType_t now );
+static void       httpserver_telemetry       ( SocketSet_t xSocketSet, TickType_t now );
+#else
 static void       httpserver_listen          ( void *pvParameters );
 static void       httpserver_handle          ( void *pvParameters );
-static void       httpserver_homepage        ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_homepageFetch   ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_fetchTime       ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_fetchTimeJSON   ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_fetchRtosJSON   ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_fetchSensorJSON ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_fetchTcpIpJSON  ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static uint16_t   httpserver_favicon         ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_205             ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_204             ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_204Refresh      ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_201             ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_200             ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_301             ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
-static void       httpserver_400             ( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket );
+#endif
+static httpserver_state_t httpserver_receive( uint8_t* rxBuffer, uint16_t* rxLength, uint8_t* txBuffer, uint16_t* requests, Socket_t xConnectedSocket );
+static httpserver_state_t httpserver_request( const uint8_t* request, uint16_t requestLength, uint8_t* pageBuffer, uint16_t pageBufferSize, uint8_t keepAlive, Socket_t xConnectedSocket );
+static uint16_t   httpserver_requestLength   ( const uint8_t* request, uint16_t length );
+static uint8_t    httpserver_keepAlive       ( const uint8_t* request, uint16_t requestLength, uint16_t requests );
+static const httpserver_route_t* httpserver_route( const uint8_t* request, uint16_t requestLength, const uint8_t** parameter, uint16_t* parameterLength );
+static void       httpserver_sendAsset       ( const webasset_t* asset, const uint8_t* request, uint16_t requestLength, uint8_t* pageBuffer, uint16_t pageBufferSize, uint8_t keepAlive, Socket_t xConnectedSocket );
+static void       httpserver_send            ( uint8_t* pageBuffer, uint16_t pageBufferSize, uint16_t stringLength, uint8_t keepAlive, Socket_t xConnectedSocket );
+static BaseType_t httpserver_write           ( Socket_t xConnectedSocket, const void* data, uint16_t length, uint8_t copy );
+static uint16_t   httpserver_completeHeader  ( uint8_t* pageBuffer, uint16_t pageBufferSize, uint16_t stringLength, uint8_t keepAlive );
+static uint8_t    httpserver_ifNoneMatch     ( const uint8_t* request, uint16_t requestLength, const char* etag );
+static const uint8_t* httpserver_findHeader  ( const uint8_t* request, uint16_t requestLength, const char* name, uint16_t* valueLength );
+static const uint8_t* httpserver_search      ( const uint8_t* data, uint16_t length, const char* string );
+static uint8_t    httpserver_token           ( const uint8_t* value, uint16_t valueLength, const char* token );
+static void       httpserver_streamBegin     ( httpserver_stream_t* stream, uint8_t* pageBuffer, uint16_t pageBufferSize, uint8_t keepAlive, Socket_t xConnectedSocket );
+static void       httpserver_streamWrite     ( httpserver_stream_t* stream, const void* data, uint16_t length );
+static void       httpserver_streamValue     ( httpserver_stream_t* stream, webtemplate_type_t type, webtemplate_value_t value );
+static uint8_t    httpserver_format          ( char* text, webtemplate_type_t type, webtemplate_value_t value );
+static void       httpserver_streamFlush     ( httpserver_stream_t* stream, uint8_t last );
+static void       httpserver_streamEnd       ( httpserver_stream_t* stream );
+static void       httpserver_render          ( httpserver_stream_t* stream, const webtemplate_t* webtemplate, const webtemplate_value_t* values );
+static void       httpserver_fetchInfoJSON   ( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static void       httpserver_fetchTimeJSON   ( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static void       httpserver_fetchRtosJSON   ( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static void       httpserver_fetchSensorJSON ( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static void       httpserver_fetchTcpIpJSON  ( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static void       httpserver_timeValues      ( webtemplate_value_t* values );
+static void       httpserver_rtosValues      ( webtemplate_value_t* values );
+static void       httpserver_sensorValues    ( webtemplate_value_t* values );
+static void       httpserver_tcpIpValues     ( webtemplate_value_t* values );
+#if( QUEUE_SOJOURN == 1u )
+static void       httpserver_fetchLatencyJSON( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static void       httpserver_histogramJSON   ( httpserver_stream_t* stream, const char* name, const uint32_t* histogram );
+#endif
+static void       httpserver_fetchMetrics    ( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static void       httpserver_metricsSample   ( httpserver_stream_t* stream, const metrics_group_t* group, const metrics_t* metric );
+static void       httpserver_ledToggle       ( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static void       httpserver_ledSetValue     ( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static void       httpserver_ledPulse        ( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength );
+static uint16_t   httpserver_400             ( uint8_t* pageBuffer, uint16_t pageBufferSize );
+static uint16_t   httpserver_500             ( uint8_t* pageBuffer, uint16_t pageBufferSize );
 static void       httpserver_lastPacket      ( Socket_t xConnectedSocket );
 
+// the route table, generated by Core/Web/webassets.py, and its lookup
+#include "webroutes.h"
+#include "httproute.h"
+
+#if( HTTPSERVER_SELECT == 1u )
+// the sections of the events snapshot, in the order of the snapshot
+static const httpserver_section_t sections[] = {
+   { &webtemplate_time_json,     httpserver_timeValues },
+   { &webtemplate_rtos_json,     httpserver_rtosValues },
+   { &webtemplate_sensor_json,   httpserver_sensorValues },
+   { &webtemplate_tcpip_json,    httpserver_tcpIpValues },
+};
+#endif
+
 // Functions ******************************************************************
 
 //------------------------------------------------------------------------------
@@ -165,8 +305,18 @@ static void       httpserver_lastPacket      ( Socket_t xConnectedSocket );
 /// \return    none
 void httpserver_init( void )
 {
+   // publish the statistic on /metrics
+   metrics_register( &httpMetrics );
+#if( HTTPSERVER_SELECT == 0u )
+   metrics_register( &socketMetrics );
+#endif
+   
    // initialise webserver task
+#if( HTTPSERVER_SELECT == 1u )
+   webserverListenTaskToNotify = osThreadNew( httpserver_select, NULL, &webserverHandleTask_attributes );
+#else
    webserverListenTaskToNotify = osThreadNew( httpserver_listen, NULL, &webserverListenTask_attributes );
+#endif
 }
 
 //------------------------------------------------------------------------------
@@ -181,18 +331,16 @@ void httpserver_deinit( void )
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Creates a task which listen on http port 80 for requests
+/// \brief     Opens the socket which listens on http port 80 for requests.
 ///
-/// \param     [in]  void *pvParameters
+/// \param     [in]  BaseType_t xBacklog
+/// \param     [in]  TickType_t timeout, of accept()
 ///
-/// \return    none
-static void httpserver_listen( void *pvParameters )
+/// \return    xListeningSocket
+static Socket_t httpserver_socket( BaseType_t xBacklog, TickType_t timeout )
 {
-   struct freertos_sockaddr   xClient, xBindAddress;
-   Socket_t                   xListeningSocket, xConnectedSocket;
-   socklen_t                  xSize          = sizeof( xClient );
-   const TickType_t           timeout        = portMAX_DELAY;
-   const BaseType_t           xBacklog       = 4;
+   struct freertos_sockaddr   xBindAddress;
+   Socket_t                   xListeningSocket;
    
    /* Attempt to open the socket. */
    xListeningSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
@@ -211,8 +359,26 @@ static void httpserver_listen( void *pvParameters )
    FreeRTOS_bind( xListeningSocket, &xBindAddress, sizeof( xBindAddress ) );
 
    /* Set the socket into a listening state so it can accept connections.
-   The maximum number of simultaneous connections is limited to 20. */
+   The maximum number of simultaneous connections is limited to xBacklog. */
    FreeRTOS_listen( xListeningSocket, xBacklog );
+   
+   return xListeningSocket;
+}
+
+#if( HTTPSERVER_SELECT == 0u )
+// ----------------------------------------------------------------------------
+/// \brief     Creates a task which listen on http port 80 for requests
+///
+/// \param     [in]  void *pvParameters
+///
+/// \return    none
+static void httpserver_listen( void *pvParameters )
+{
+   struct freertos_sockaddr   xClient;
+   Socket_t                   xListeningSocket, xConnectedSocket;
+   socklen_t                  xSize          = sizeof( xClient );
+   
+   xListeningSocket = httpserver_socket( 4, portMAX_DELAY );
 
    for( ;; )
    {
@@ -226,7 +392,11 @@ static void httpserver_listen( void *pvParameters )
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Handles REST API GET and POST request to the http server.
+/// \brief     Handles REST API GET and POST request to the http server. The
+///            connection is kept open for further requests until the client
+///            closes it, it is idle for xReceiveTimeOut or KEEPALIVE_MAX
+///            requests are served. Requests which arrive together are
+///            answered back to back.
 ///
 /// \param     [in]  void *pvParameters
 ///
@@ -234,55 +404,37 @@ static void httpserver_listen( void *pvParameters )
 static void httpserver_handle( void *pvParameters )
 {
    Socket_t          xConnectedSocket;
-   uint8_t           uri[URIBUFFER];
-   uint8_t           *sp1, *sp2; 
    TickType_t        xTimeOnShutdown;
    uint8_t           *pucRxBuffer;
-   uint8_t           *pageBuffer;
    uint8_t           *pucTxBuffer;
    BaseType_t        lengthOfbytes;
-   static uint16_t   etimeout;  
-   static uint16_t   enomem;  
-   static uint16_t   enotconn;
-   static uint16_t   eintr;   
-   static uint16_t   einval; 
-   static uint16_t   eelse;
-   static uint16_t   uriTooLongError;
-   static uint8_t    serverInstanceMallocError;
-   FlagStatus        jumpToAppFlag = RESET;
-   
+   uint16_t          rxLength       = 0;
+   uint16_t          requests       = 0;
+   uint8_t           keepAlive      = 1;
+
    // get the socket
    xConnectedSocket = ( Socket_t ) pvParameters;
-   
-   // allocate heap for frame reception
-	pucRxBuffer = ( uint8_t * ) pvPortMalloc( ipconfigTCP_MSS );
 
-   if( pucRxBuffer == NULL )
+   // the idle timeout of the connection
+   FreeRTOS_setsockopt( xConnectedSocket, 0, FREERTOS_SO_RCVTIMEO, &xReceiveTimeOut, sizeof( xReceiveTimeOut ) );
+   FreeRTOS_setsockopt( xConnectedSocket, 0, FREERTOS_SO_SNDTIMEO, &xSendTimeOut, sizeof( xSendTimeOut ) );
+
+   // allocate heap for frame reception and the responses, once per connection
+	pucRxBuffer = ( uint8_t * ) pvPortMalloc( RXBUFFER );
+   pucTxBuffer = ( uint8_t * ) pvPortMalloc( TXBUFFER );
+
+   if( pucRxBuffer == NULL || pucTxBuffer == NULL )
    {
-      memset(uri,0x00,URIBUFFER);
-      httpserver_400(uri, TXBIG, xConnectedSocket);
-      memset(uri,0x00,URIBUFFER);
-      FreeRTOS_shutdown( xConnectedSocket, FREERTOS_SHUT_RDWR );    
-      xTimeOnShutdown = xTaskGetTickCount();
-      do
-      {
-         if( FreeRTOS_recv( xConnectedSocket, uri, URIBUFFER, 0 ) < 0 )
-         {
-            vTaskDelay( pdMS_TO_TICKS( 250 ) );
-            break; 
-         }
-      } while( ( xTaskGetTickCount() - xTimeOnShutdown ) < pdMS_TO_TICKS( 5000 ) );
-      serverInstanceMallocError++;
-      FreeRTOS_closesocket( xConnectedSocket );
-      vTaskDelete( NULL );
-      return;
+      statistic.mallocErrors++;
+      keepAlive = 0;
    }
 
-   for( ;; )
+   while( keepAlive == 1 )
    {
-      // Receive data on the socket.
-      lengthOfbytes = FreeRTOS_recv( xConnectedSocket, pucRxBuffer, ipconfigTCP_MSS, 0 );
-         
+      // Receive data on the socket, behind a part of a request which is
+      // already in the buffer.
+      lengthOfbytes = FreeRTOS_recv( xConnectedSocket, pucRxBuffer + rxLength, RXBUFFER - rxLength, 0 );
+
       // check lengthOfbytes ------------- lengthOfbytes > 0                           --> data received
       //                                   lengthOfbytes = 0                           --> timeout
       //                                   lengthOfbytes = pdFREERTOS_ERRNO_ENOMEM     --> not enough memory on socket
@@ -290,948 +442,1684 @@ static void httpserver_handle( void *pvParameters )
       //                                   lengthOfbytes = pdFREERTOS_ERRNO_EINTR      --> if the socket received a signal, causing the read operation to be aborted
       //                                   lengthOfbytes = pdFREERTOS_ERRNO_EINVAL     --> socket is not valid
       if( lengthOfbytes > 0 )
-      {         
-         // check for a GET request
-         if (!strncmp((char const*)pucRxBuffer, "GET ", 4))
-         {
-            // extract URI
-            sp1 = pucRxBuffer + 4;
-            sp2 = memchr(sp1, ' ', URIBUFFER);
-            uint16_t len = sp2 - sp1;
-            if(len>URIBUFFER)
-            {
-               // uri too long
-               uriTooLongError++;
-
-               // listen to the socket again
-               continue; 
-            }
-            memset(uri, 0x00, URIBUFFER);
-            memcpy(uri, sp1, len);
-            uri[len] = '\0';
-            
-            if(memcmp((char const*)uri, "/home", 5u) == 0)
-            {
-               // mainpage
-               pucTxBuffer = ( uint8_t * ) pvPortMalloc( TXBIG );
-               httpserver_homepageFetch( pucTxBuffer, TXBIG, xConnectedSocket );
-               vPortFree( pucTxBuffer );
-               
-               // listen to the socket again
-               continue;
-            }
-            else if(memcmp((char const*)uri, "/time.json", 10u) == 0)
-            {
-               // send time json object
-               pucTxBuffer = ( uint8_t * ) pvPortMalloc( TXSMALL );
-               httpserver_fetchTimeJSON( pucTxBuffer, TXSMALL, xConnectedSocket );
-               vPortFree( pucTxBuffer );
-               
-               // listen to the socket again
-               continue;
-            }
-            else if(memcmp((char const*)uri, "/rtos.json", 10u) == 0)
-            {
-               // send rtos data json object
-               pucTxBuffer = ( uint8_t * ) pvPortMalloc( TXMEDIUM );
-               httpserver_fetchRtosJSON( pucTxBuffer, TXMEDIUM, xConnectedSocket );
-               vPortFree( pucTxBuffer );
-               
-               // listen to the socket again
-               continue;
-            }
-            else if(memcmp((char const*)uri, "/sensor.json", 12u) == 0)
-            {
-               // send sensor json object
-               pucTxBuffer = ( uint8_t * ) pvPortMalloc( TXSMALL );
-               httpserver_fetchSensorJSON( pucTxBuffer, TXSMALL, xConnectedSocket );
-               vPortFree( pucTxBuffer );
-               
-               // listen to the socket again
-               continue;
-            }
-            else if(memcmp((char const*)uri, "/tcpip.json", 11u) == 0)
-            {
-               // send sensor json object
-               pucTxBuffer = ( uint8_t * ) pvPortMalloc( TXSMALL );
-               httpserver_fetchTcpIpJSON( pucTxBuffer, TXSMALL, xConnectedSocket );
-               vPortFree( pucTxBuffer );
-               
-               // listen to the socket again
-               continue;
-            }
-            else
-            {
-               // send homepage
-               pucTxBuffer = ( uint8_t * ) pvPortMalloc( TXBIG );
-               httpserver_homepageFetch( pucTxBuffer, TXBIG, xConnectedSocket );
-               vPortFree( pucTxBuffer );
-               
-               // listen to the socket again
-               continue;
-            }
-         }
-         
-         // check for a POST request
-         if (!strncmp((char const*)pucRxBuffer, "POST ", 5u))
-         {
-            
-            // extract URI
-            sp1 = pucRxBuffer + 5;
-            sp2 = memchr(sp1, ' ', URIBUFFER);
-            uint16_t len = sp2 - sp1;
-            if(len>URIBUFFER)
-            {
-               // uri too long
-               uriTooLongError++;
-
-               // listen to the socket again
-               continue; 
-            }
-            memset(uri, 0x00, URIBUFFER);
-            memcpy(uri, sp1, len);
-            uri[len] = '\0';
-            
-            if (strncmp((char const*)uri, "/led_toggle", 10u) == 0)
-            {
-               // toggle led
-               led_toggle();
-               
-               pucTxBuffer = ( uint8_t * ) pvPortMalloc( TXSMALL );
-               httpserver_204(pucTxBuffer, TXSMALL, xConnectedSocket);
-               vPortFree( pucTxBuffer );
-
-               // listen to the socket again
-               continue; 
-            }
-            else if (strncmp((char const*)uri, "/led_set_value/", 15u) == 0)
-            {
-               uint8_t value;
-               
-               // set led into dim state
-               led_setDim();
-               
-               // toggle led
-               value = strtol( (char const*)&uri[15u], NULL, 10u );
-               
-               // check if value is valid
-               if( value <= 40 )
-               {
-                  // set led pwm
-                  led_setDuty(value);
-               }
-               
-               // send ok rest api
-               pucTxBuffer = ( uint8_t * ) pvPortMalloc( TXSMALL );
-               httpserver_204(pucTxBuffer, TXSMALL, xConnectedSocket);
-               vPortFree( pucTxBuffer );
-
-               // listen to the socket again
-               continue; 
-            }
-            else if (strncmp((char const*)uri, "/led_pulse", 9u) == 0)
-            {
-               // set led into pulse state
-               led_setPulse();
-               
-               // send ok rest api
-               pucTxBuffer = ( uint8_t * ) pvPortMalloc( TXSMALL );
-               httpserver_204(pucTxBuffer, TXSMALL, xConnectedSocket);
-               vPortFree( pucTxBuffer );
-
-
-               // listen to the socket again
-               continue; 
-            }
-            else
-            {
-               // send bad request if the uri is faulty
-               pucTxBuffer = ( uint8_t * ) pvPortMalloc( TXSMALL );
-               httpserver_400(pucTxBuffer, TXSMALL, xConnectedSocket);
-               vPortFree( pucTxBuffer );
-               
-               // listen to the socket again
-               continue; 
-            }
-         }
+      {
+         rxLength += lengthOfbytes;
+         keepAlive = ( httpserver_receive( pucRxBuffer, &rxLength, pucTxBuffer, &requests, xConnectedSocket ) == HTTP_OPEN );
       }
       else if( lengthOfbytes == 0 )
       {
          // No data was received, but FreeRTOS_recv() did not return an error. Timeout?
-         etimeout++;                                                       
-         break;    
+         socketErrors.etimeout++;
+         break;
       }
       else if( lengthOfbytes == -pdFREERTOS_ERRNO_ENOMEM )
-      {                                                                                                                    
-         // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                   
-         enomem++;                                                      
+      {
+         // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.
+         socketErrors.enomem++;
          break;
-      } 
+      }
       else if( lengthOfbytes == -pdFREERTOS_ERRNO_ENOTCONN )
-      {                                                                                                                       
-         // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         enotconn++;                                                        
+      {
+         // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.
+         socketErrors.enotconn++;
          break;
-      } 
+      }
       else if( lengthOfbytes == -pdFREERTOS_ERRNO_EINTR )
-      {                                                                                                                       
-         // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         eintr++;                                                        
+      {
+         // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.
+         socketErrors.eintr++;
          break;
-      } 
+      }
       else if( lengthOfbytes == -pdFREERTOS_ERRNO_EINVAL )
-      {                                                                                                                       
-         // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         einval++;                                                          
+      {
+         // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.
+         socketErrors.einval++;
          break;
-      } 
+      }
       else
-      {                                                                                                                       
-         // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.                      
-         eelse++;                                                        
+      {
+         // Error (maybe the connected socket already shut down the socket?). Attempt graceful shutdown.
+         socketErrors.eelse++;
          break;
-      } 
+      }
    }
-   
-   // The RTOS task will get here if an error is received on a read.  Ensure the
-   // socket has shut down (indicated by FreeRTOS_recv() returning a FREERTOS_EINVAL
-   // error before closing the socket).
-   // Wait for the shutdown to take effect, indicated by FreeRTOS_recv()
-   // returning an error.
+
+   // The RTOS task will get here if the connection is finished or an error is
+   // received on a read. Initiate a graceful shutdown, the fin is sent after
+   // the last response. Wait for the shutdown to take effect, indicated by
+   // FreeRTOS_recv() returning an error.
+   FreeRTOS_shutdown( xConnectedSocket, FREERTOS_SHUT_RDWR );
    xTimeOnShutdown = xTaskGetTickCount();
    do
    {
-      if( FreeRTOS_recv( xConnectedSocket, pucRxBuffer, ipconfigTCP_MSS, 0 ) < 0 )
+      if( pucRxBuffer == NULL || FreeRTOS_recv( xConnectedSocket, pucRxBuffer, RXBUFFER, 0 ) < 0 )
       {
          vTaskDelay( pdMS_TO_TICKS( 250 ) );
          break;
       }
    } while( ( xTaskGetTickCount() - xTimeOnShutdown ) < pdMS_TO_TICKS( 5000 ) );
-   
+
    /* Finished with the socket, buffer, the task. */
    vPortFree( pucRxBuffer );
+   vPortFree( pucTxBuffer );
    FreeRTOS_closesocket( xConnectedSocket );
-   
+
    vTaskDelete( NULL );
 }
+#endif
 
+
+#if( HTTPSERVER_SELECT == 1u )
 // ----------------------------------------------------------------------------
-/// \brief     Main page of the device. With an overview of important data.
+/// \brief     Serves the listening socket and all connections in one task.
+///            The task waits with FreeRTOS_select() for new connections,
+///            requests and closed connections. Every connection has a slot
+///            in the connection table, a connection is refused if all slots
+///            are in use. The slots are checked for the idle and shutdown
+///            timeouts at least every SELECT_PERIOD. The event streams get
+///            an event and the websockets the telemetry every 
+///            HTTPSERVER_EVENTS_PERIOD.
+///            The task never waits for a socket. A response which does not
+///            fit into the socket is held back and sent when the socket has
+///            space again, the next requests of the connection wait for it.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [in]  void *pvParameters
 ///
 /// \return    none
-static void httpserver_homepage( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
-{
-   uint16_t 		   stringLength;
-   uint32_t 		   totalSeconds;
-   uint32_t 		   days;
-   uint32_t 		   hours;
-   uint32_t 		   minutes;
-   uint32_t 		   seconds;
-   uint8_t  		   *ipAddress8b;
-   uint32_t 		   ipAddress;
-   uint32_t 		   netMask;
-   uint32_t 		   dnsAddress;
-   uint32_t 		   gatewayAddress;
-   size_t 		      freeheap;
-   const uint8_t* 	stackMacAddress;
-   osThreadId_t      tasks[7] = {0};
-   uint32_t          tasksNr = 7;
-   uint8_t           dutyCycle;
-   uint8_t           taskCount;
-   TaskStatus_t      *task;
-   float             temperature;
-   float             voltage;
-   
-   static const char *webpage_panelcontrollerMonitor = {
-      
-      "<style type='text/css'>"
-         
-      // header text
-      "#box1 {background-color: orange; background-image: linear-gradient(red, black);}"
-         
-      // slider
-      ".slidecontainer {width: 100%;}"
-      ".slider {-webkit-appearance: none;width: 250px;height: 15px;border-radius: 5px;background: #d3d3d3;outline: none;opacity: 0.7;-webkit-transition: .2s;transition: opacity .2s;}"
-      ".slider:hover {opacity: 1;}"
-      ".slider::-moz-range-thumb {width: 25px;height: 25px;border-radius: 50%;background: #04AA6D;cursor: pointer;}"
-      "</style>"
-      
-      "<p><h3>Homepage</h3></p>"
-      "<p>___</p>"
-      "<p>IP: %d.%d.%d.%d</p>"
-      "<p>MAC: %02x:%02x:%02x:%02x:%02x:%02x</p>"
-      "<p>Uptime: %d days, %d hours, %d minutes, %d seconds</p>"
-      "<p>___</p>"
-      "<p>FreeRTOS Version: %s</p>"
-      "<p>Free Heap: %d bytes</p>"
-      "<p>Running Tasks</p>"
-      "<p>- Task 1: %s, Priority: %d</p>"
-      "<p>- Task 2: %s, Priority: %d</p>"
-      "<p>- Task 3: %s, Priority: %d</p>"
-      "<p>- Task 4: %s, Priority: %d</p>"
-      "<p>- Task 5: %s, Priority: %d</p>"
-      "<p>- Task 6: %s, Priority: %d</p>"
-      "<p>- Task 7: %s, Priority: %d</p>"
-      "<p>___</p>"
-         
-      "<p><div class='slidecontainer'>"
-         "Led Dimmer<input type='range' min='2' max='40' value=%d class='slider' id='myRange'>"
-      "</div></p>" 
-         
-      "<script>"
-      "var xhr=new XMLHttpRequest();"
-      "var slider=document.getElementById('myRange');"
-      "var block=0;"
-         
-      "function unblock(){block=0;}"
-      
-      // block next post request triggert by the slider for 250 ms to avoid "spamming"
-      "slider.oninput=function(){"
-         "if(block==0){"
-            "block=1;"
-            "var urlpost='/led_set_value/'+this.value;"
-            "xhr.open('POST', urlpost, true);"
-            "xhr.setRequestHeader('Content-Type', 'application/x-www-form-urlencoded; charset=UTF-8');"
-            "xhr.send('zero');"
-            "setTimeout(unblock, 150);"
-         "}"
-      "}"
-      "</script>"
-          
-      "<p><form action='led_pulse' method='post'><button  style='width:200px'>Led Pulse</button></form></p>"
-      "<p>Temperature: %.1f C</p>"
-      "<p>Voltage: %.2f V</p>"
-      "<p>___</p>"
-      "<p>Guest counter: %d</p>" 
-      "<br />"
-   };
-   
-   // set the placeholder in every webpage fragment and put all fragments together
-   // top header
-   stringLength = snprintf(0, 0, webpage_top);
-   snprintf((char*)pageBuffer, stringLength+1, webpage_top);
-   
-   // send fragment of the webpage//////////////////////////////////////////////
-   if( stringLength < pageBufferSize )
+static void httpserver_select( void *pvParameters )
+{
+   struct freertos_sockaddr   xClient;
+   socklen_t                  xSize          = sizeof( xClient );
+   Socket_t                   xListeningSocket, xConnectedSocket;
+   SocketSet_t                xSocketSet;
+   httpserver_connection_t    *connection;
+   BaseType_t                 lengthOfbytes;
+   TickType_t                 now;
+   TickType_t                 timeout;
+   TickType_t                 elapsed;
+   TickType_t                 lastEvent      = 0;
+   const TickType_t           eventsPeriod   = pdMS_TO_TICKS( HTTPSERVER_EVENTS_PERIOD );
+   uint8_t                    eventStreams   = 0;
+   uint8_t                    newStream      = 0;
+
+   xSocketSet = FreeRTOS_CreateSocketSet();
+   configASSERT( xSocketSet != NULL );
+
+   // accept() must not block, the task waits in select()
+   xListeningSocket = httpserver_socket( HTTPSERVER_CONNECTIONS, 0 );
+   FreeRTOS_FD_SET( xListeningSocket, xSocketSet, eSELECT_READ );
+
+   for( ;; )
    {
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+      // wake up in time for the next event
+      timeout = SELECT_PERIOD;
+      if( eventStreams > 0 )
+      {
+         elapsed = xTaskGetTickCount() - lastEvent;
+         if( elapsed >= eventsPeriod )
+         {
+            timeout = 0;
+         }
+         else if( eventsPeriod - elapsed < timeout )
+         {
+            timeout = eventsPeriod - elapsed;
+         }
+      }
+      FreeRTOS_select( xSocketSet, timeout );
+      now = xTaskGetTickCount();
+
+      // take the new connections into a free slot
+      while( ( xConnectedSocket = FreeRTOS_accept( xListeningSocket, &xClient, &xSize ) ) != NULL && xConnectedSocket != FREERTOS_INVALID_SOCKET )
+      {
+         for( connection = connections; connection < &connections[HTTPSERVER_CONNECTIONS] && connection->state != HTTP_FREE; connection++ );
+         if( connection == &connections[HTTPSERVER_CONNECTIONS] )
+         {
+            statistic.connectionsRefused++;
+            FreeRTOS_closesocket( xConnectedSocket );
+            continue;
+         }
+
+         // send() and recv() do not block
+         FreeRTOS_setsockopt( xConnectedSocket, 0, FREERTOS_SO_RCVTIMEO, &xNoTimeOut, sizeof( xNoTimeOut ) );
+         FreeRTOS_setsockopt( xConnectedSocket, 0, FREERTOS_SO_SNDTIMEO, &xNoTimeOut, sizeof( xNoTimeOut ) );
+         FreeRTOS_FD_SET( xConnectedSocket, xSocketSet, eSELECT_READ | eSELECT_EXCEPT );
+         connection->socket      = xConnectedSocket;
+         connection->state       = HTTP_OPEN;
+         connection->timestamp   = now;
+         connection->rxLength    = 0;
+         connection->requests    = 0;
+         connection->resync      = 0;
+         connection->telemetry   = 0;
+         connection->deferred    = 0;
+         connection->error       = 0;
+         connection->pending     = NULL;
+      }
+
+      // serve the connections
+      eventStreams = 0;
+      for( connection = connections; connection < &connections[HTTPSERVER_CONNECTIONS]; connection++ )
+      {
+         if( connection->pending != NULL )
+         {
+            httpserver_drain( connection, xSocketSet, now );
+         }
+
+         if( connection->state == HTTP_OPEN && connection->pending == NULL )
+         {
+            lengthOfbytes = FreeRTOS_recv( connection->socket, connection->rxBuffer + connection->rxLength, RXBUFFER - connection->rxLength, 0 );
+            if( lengthOfbytes > 0 || ( lengthOfbytes == 0 && connection->deferred == 1 ) )
+            {
+               connection->timestamp = now;
+               connection->rxLength += lengthOfbytes;
+               responding            = connection;
+               switch( httpserver_receive( connection->rxBuffer, &connection->rxLength, txBuffer, &connection->requests, connection->socket ) )
+               {
+                  case HTTP_CLOSING:
+                     httpserver_shutdown( connection, xSocketSet, now );
+                     break;
+                  case HTTP_EVENTS:
+                     // a stream without space for an event gets the whole
+                     // snapshot later
+                     connection->state    = HTTP_EVENTS;
+                     connection->resync   = 1;
+                     newStream            = 1;
+                     break;
+                  case HTTP_WEBSOCKET:
+                     // a frame without space is dropped
+                     connection->state    = HTTP_WEBSOCKET;
+                     break;
+                  default:
+                     break;
+               }
+
+               if( connection->error == 1 )
+               {
+                  statistic.responsesAborted++;
+                  httpserver_shutdown( connection, xSocketSet, now );
+               }
+               else if( connection->pending != NULL )
+               {
+                  // the connection waits until the socket has space, the
+                  // requests which arrived together are answered after it
+                  statistic.responsesHeld++;
+                  if( connection->state == HTTP_OPEN )
+                  {
+                     FreeRTOS_FD_CLR( connection->socket, xSocketSet, eSELECT_READ | eSELECT_EXCEPT );
+                  }
+                  FreeRTOS_FD_SET( connection->socket, xSocketSet, eSELECT_WRITE );
+               }
+               connection->deferred = ( connection->state == HTTP_OPEN && connection->pending != NULL && connection->rxLength > 0 ) ? 1u : 0u;
+            }
+            else if( lengthOfbytes < 0 || ( now - connection->timestamp ) >= xReceiveTimeOut )
+            {
+               // closed by the client or idle
+               httpserver_shutdown( connection, xSocketSet, now );
+            }
+         }
+         else if( connection->state == HTTP_EVENTS )
+         {
+            // the client does not send anything on an event stream, it is
+            // only checked for the close
+            if( FreeRTOS_recv( connection->socket, connection->rxBuffer, RXBUFFER, 0 ) < 0 )
+            {
+               httpserver_shutdown( connection, xSocketSet, now );
+            }
+         }
+         else if( connection->state == HTTP_WEBSOCKET )
+         {
+            // the commands of the page, a websocket has no idle timeout
+            lengthOfbytes = FreeRTOS_recv( connection->socket, connection->rxBuffer + connection->rxLength, RXBUFFER - connection->rxLength, 0 );
+            if( lengthOfbytes > 0 )
+            {
+               connection->rxLength += lengthOfbytes;
+               httpserver_webSocket( connection, xSocketSet, now );
+            }
+            else if( lengthOfbytes < 0 )
+            {
+               httpserver_shutdown( connection, xSocketSet, now );
+            }
+         }
+         else if( connection->state == HTTP_CLOSING )
+         {
+            // wait for the shutdown to take effect, indicated by recv()
+            // returning an error
+            lengthOfbytes = FreeRTOS_recv( connection->socket, connection->rxBuffer, RXBUFFER, 0 );
+            if( ( lengthOfbytes < 0 && ( now - connection->timestamp ) >= pdMS_TO_TICKS( 250 ) ) ||
+                ( now - connection->timestamp ) >= pdMS_TO_TICKS( 5000 ) )
+            {
+               FreeRTOS_closesocket( connection->socket );
+               connection->state = HTTP_FREE;
+            }
+         }
+
+         if( connection->state == HTTP_EVENTS || ( connection->state == HTTP_WEBSOCKET && connection->telemetry == 1 ) )
+         {
+            eventStreams++;
+         }
+      }
+
+      // one snapshot for all event streams, a new stream gets it at once
+      if( eventStreams > 0 && ( newStream == 1 || ( now - lastEvent ) >= eventsPeriod ) )
+      {
+         httpserver_events( xSocketSet, now );
+         httpserver_telemetry( xSocketSet, now );
+         lastEvent   = now;
+         newStream   = 0;
+      }
    }
-   /////////////////////////////////////////////////////////////////////////////
-   
-   // panelcontroller monitor
-   FreeRTOS_GetAddressConfiguration( &ipAddress, &netMask, &gatewayAddress, &dnsAddress );
-   ipAddress8b       = (uint8_t*)(&ipAddress);
-   temperature       = monitor_getTemperature();
-   voltage           = monitor_getVoltage();
-   stackMacAddress   = FreeRTOS_GetMACAddress();
-   totalSeconds      = xTaskGetTickCount() * portTICK_PERIOD_MS / 1000;
-   days              = (totalSeconds / 86400);       
-   hours             = (totalSeconds / 3600) % 24;   
-   minutes           = (totalSeconds / 60) % 60;     
-   seconds           = totalSeconds % 60;  
-   freeheap          = xPortGetFreeHeapSize();
-   taskCount         = uxTaskGetNumberOfTasks();
-   task              = pvPortMalloc(taskCount * sizeof(TaskStatus_t));
-   if (task != NULL)
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Shuts a connection down. The connection is no longer in the
+///            socket set, the shutdown is checked every SELECT_PERIOD. A
+///            connection with held back output sends it first.
+///
+/// \param     [in]  httpserver_connection_t* connection
+/// \param     [in]  SocketSet_t xSocketSet
+/// \param     [in]  TickType_t now
+///
+/// \return    none
+static void httpserver_shutdown( httpserver_connection_t* connection, SocketSet_t xSocketSet, TickType_t now )
+{
+   connection->timestamp   = now;
+   if( connection->pending != NULL )
    {
-      taskCount = uxTaskGetSystemState(task, taskCount, NULL);
+      FreeRTOS_FD_CLR( connection->socket, xSocketSet, eSELECT_READ | eSELECT_EXCEPT );
+      connection->state    = HTTP_SENDING;
+      return;
    }
-   else
+
+   FreeRTOS_FD_CLR( connection->socket, xSocketSet, eSELECT_ALL );
+   FreeRTOS_shutdown( connection->socket, FREERTOS_SHUT_RDWR );
+   connection->state       = HTTP_CLOSING;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sends the held back output of a connection, as much as the
+///            socket takes. The connection waits for write events until all
+///            is sent. The output is dropped and the connection is shut down
+///            if the socket fails or takes nothing for xReceiveTimeOut.
+///
+/// \param     [in]  httpserver_connection_t* connection
+/// \param     [in]  SocketSet_t xSocketSet
+/// \param     [in]  TickType_t now
+///
+/// \return    none
+static void httpserver_drain( httpserver_connection_t* connection, SocketSet_t xSocketSet, TickType_t now )
+{
+   httpserver_pending_t *piece;
+   BaseType_t           sent = 0;
+
+   while( ( piece = connection->pending ) != NULL )
+   {
+      // no space in the socket is not an error
+      sent = FreeRTOS_send( connection->socket, piece->data, piece->length, 0 );
+      if( sent == -pdFREERTOS_ERRNO_ENOSPC )
+      {
+         sent = 0;
+      }
+      if( sent <= 0 )
+      {
+         break;
+      }
+      connection->timestamp = now;
+      if( sent < piece->length )
+      {
+         piece->data    += sent;
+         piece->length  -= sent;
+         break;
+      }
+      connection->pending = piece->next;
+      pendingBytes -= piece->size;
+      vPortFree( piece );
+   }
+
+   if( connection->pending != NULL && ( sent < 0 || ( now - connection->timestamp ) >= xReceiveTimeOut ) )
    {
+      statistic.responsesAborted++;
+      while( ( piece = connection->pending ) != NULL )
+      {
+         connection->pending = piece->next;
+         pendingBytes -= piece->size;
+         vPortFree( piece );
+      }
+      connection->deferred = 0;
+      httpserver_shutdown( connection, xSocketSet, now );
       return;
    }
-   dutyCycle = led_getDuty();
-   guestCounter++;
-   stringLength = snprintf(0, 0, webpage_panelcontrollerMonitor, 
-                           ipAddress8b[0], ipAddress8b[1], ipAddress8b[2], ipAddress8b[3], 
-                           stackMacAddress[0], stackMacAddress[1], stackMacAddress[2], stackMacAddress[3], stackMacAddress[4], stackMacAddress[5], 
-                           days, hours, minutes, seconds, 
-                           tskKERNEL_VERSION_NUMBER,
-                           freeheap, 
-                           task[0].pcTaskName, task[0].uxCurrentPriority, 
-                           task[1].pcTaskName, task[1].uxCurrentPriority,  
-                           task[2].pcTaskName, task[2].uxCurrentPriority,  
-                           task[3].pcTaskName, task[3].uxCurrentPriority,  
-                           task[4].pcTaskName, task[4].uxCurrentPriority,  
-                           task[5].pcTaskName, task[5].uxCurrentPriority, 
-                           task[6].pcTaskName, task[6].uxCurrentPriority, 
-                           dutyCycle, 
-                           temperature,
-                           voltage,
-                           guestCounter );
-   snprintf((char*)pageBuffer, stringLength+1, webpage_panelcontrollerMonitor, 
-                           ipAddress8b[0], ipAddress8b[1], ipAddress8b[2], ipAddress8b[3], 
-                           stackMacAddress[0], stackMacAddress[1], stackMacAddress[2], stackMacAddress[3], stackMacAddress[4], stackMacAddress[5], 
-                           days, hours, minutes, seconds, 
-                           tskKERNEL_VERSION_NUMBER,
-                           freeheap, 
-                           task[0].pcTaskName, task[0].uxCurrentPriority, 
-                           task[1].pcTaskName, task[1].uxCurrentPriority,  
-                           task[2].pcTaskName, task[2].uxCurrentPriority,  
-                           task[3].pcTaskName, task[3].uxCurrentPriority,  
-                           task[4].pcTaskName, task[4].uxCurrentPriority,  
-                           task[5].pcTaskName, task[5].uxCurrentPriority, 
-                           task[6].pcTaskName, task[6].uxCurrentPriority,         
-                           dutyCycle, 
-                           temperature,
-                           voltage,
-                           guestCounter );
-   
-   // send fragment of the webpage//////////////////////////////////////////////
-   if( stringLength < pageBufferSize )
+
+   if( connection->pending == NULL )
+   {
+      FreeRTOS_FD_CLR( connection->socket, xSocketSet, eSELECT_WRITE );
+      if( connection->state == HTTP_SENDING )
+      {
+         httpserver_shutdown( connection, xSocketSet, now );
+      }
+      else if( connection->state == HTTP_OPEN )
+      {
+         FreeRTOS_FD_SET( connection->socket, xSocketSet, eSELECT_READ | eSELECT_EXCEPT );
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Opens an event stream, GET /events. The values of the page are
+///            pushed as server-sent events, every event has the fields which
+///            changed since the last one. The events are sent by the select
+///            task, see httpserver_events().
+///
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, none
+/// \param     [in]  uint16_t parameterLength
+///
+/// \return    none
+static void httpserver_fetchEvents( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
+{
+   httpserver_streamWrite( stream, EVENTSHEADER, strlen( EVENTSHEADER ) );
+   stream->upgrade = HTTP_EVENTS;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Takes a snapshot of the values and sends the changes to every
+///            event stream. The events are rendered once for all streams.
+///            The streams which are new or missed an event get the whole
+///            snapshot instead.
+///
+/// \param     [in]  SocketSet_t xSocketSet
+/// \param     [in]  TickType_t now
+///
+/// \return    none
+static void httpserver_events( SocketSet_t xSocketSet, TickType_t now )
+{
+   const httpserver_section_t *section;
+   httpserver_connection_t    *connection;
+   char                       (*values)[VALUETEXT];
+   uint16_t                   length;
+
+   // the changes, for the streams which got every event
+   values = snapshot;
+   for( section = sections; section < &sections[sizeof( sections ) / sizeof( sections[0] )]; section++ )
+   {
+      length = httpserver_event( section, values, 0 );
+      values += section->webtemplate->valuesCount;
+      for( connection = connections; connection < &connections[HTTPSERVER_CONNECTIONS] && length > 0; connection++ )
+      {
+         if( connection->state == HTTP_EVENTS && connection->resync == 0 )
+         {
+            httpserver_eventSend( connection, xSocketSet, length, now );
+         }
+      }
+   }
+
+   // the whole snapshot, for the other streams
+   for( connection = connections; connection < &connections[HTTPSERVER_CONNECTIONS]; connection++ )
+   {
+      if( connection->state == HTTP_EVENTS && connection->resync == 1 )
+      {
+         connection->resync = 2;
+      }
+   }
+   values = snapshot;
+   for( section = sections; section < &sections[sizeof( sections ) / sizeof( sections[0] )]; section++ )
+   {
+      length = 0;
+      for( connection = connections; connection < &connections[HTTPSERVER_CONNECTIONS]; connection++ )
+      {
+         if( connection->state == HTTP_EVENTS && connection->resync == 2 )
+         {
+            if( length == 0 )
+            {
+               length = httpserver_event( section, values, 1 );
+            }
+            httpserver_eventSend( connection, xSocketSet, length, now );
+         }
+      }
+      values += section->webtemplate->valuesCount;
+   }
+   for( connection = connections; connection < &connections[HTTPSERVER_CONNECTIONS]; connection++ )
+   {
+      if( connection->resync == 2 )
+      {
+         connection->resync = 0;
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Renders one section of the snapshot as event into the tx
+///            buffer, e.g. data: {"s": "12","rxF": "345"}. The values are
+///            compared as text, so only the changes which are visible on
+///            the page are sent.
+///
+/// \param     [in]  const httpserver_section_t* section
+/// \param     [in]  char (*values)[VALUETEXT], of the section in the snapshot
+/// \param     [in]  uint8_t all, 0 to read the values and send the changes,
+///                  1 to send the snapshot
+///
+/// \return    length of the event, 0 if nothing changed
+static uint16_t httpserver_event( const httpserver_section_t* section, char (*values)[VALUETEXT], uint8_t all )
+{
+   const webtemplate_t  *webtemplate = section->webtemplate;
+   webtemplate_value_t  current[EVENTSFIELDS];
+   char                 text[VALUETEXT];
+   uint16_t             length      = 6u;
+   uint16_t             nameLength;
+   uint8_t              textLength;
+
+   if( all == 0 )
+   {
+      section->values( current );
+   }
+
+   memcpy( txBuffer, "data: ", 6u );
+   for( uint16_t i = 0; i < webtemplate->valuesCount; i++ )
+   {
+      if( all == 0 )
+      {
+         textLength = httpserver_format( text, webtemplate->types[i], current[i] );
+         if( strcmp( text, values[i] ) == 0 )
+         {
+            continue;
+         }
+      }
+      else
+      {
+         textLength = strlen( values[i] );
+         memcpy( text, values[i], textLength + 1u );
+      }
+
+      // ,"name": "text" and the closing bracket with the empty line
+      nameLength = strlen( webtemplate->names[i] );
+      if( length + nameLength + textLength + 11u > TXBUFFER )
+      {
+         break;
+      }
+      memcpy( values[i], text, textLength + 1u );
+      txBuffer[length] = ( length == 6u ) ? '{' : ',';
+      length++;
+      txBuffer[length++] = '"';
+      memcpy( &txBuffer[length], webtemplate->names[i], nameLength );
+      length += nameLength;
+      memcpy( &txBuffer[length], "\": \"", 4u );
+      length += 4u;
+      memcpy( &txBuffer[length], text, textLength );
+      length += textLength;
+      txBuffer[length++] = '"';
+   }
+
+   if( length == 6u )
+   {
+      return 0;
+   }
+   memcpy( &txBuffer[length], "}\n\n", 3u );
+   return length + 3u;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sends the event in the tx buffer to a stream. The event is not
+///            sent in parts, a stream without space for it gets the whole
+///            snapshot with the next event.
+///
+/// \param     [in]  httpserver_connection_t* connection
+/// \param     [in]  SocketSet_t xSocketSet
+/// \param     [in]  uint16_t length
+/// \param     [in]  TickType_t now
+///
+/// \return    none
+static void httpserver_eventSend( httpserver_connection_t* connection, SocketSet_t xSocketSet, uint16_t length, TickType_t now )
+{
+   if( connection->pending != NULL || FreeRTOS_tx_space( connection->socket ) < length )
+   {
+      statistic.eventsMissed++;
+      connection->resync = 1;
+      return;
+   }
+   if( FreeRTOS_send( connection->socket, txBuffer, length, 0 ) < 0 )
+   {
+      httpserver_shutdown( connection, xSocketSet, now );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Opens a websocket, GET /ws. The request has to ask for the
+///            upgrade to the websocket protocol in version 13. The commands
+///            and the telemetry are binary messages, see httpserver.h, the
+///            frames are served by the select task, see httpserver_webSocket().
+///
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, none
+/// \param     [in]  uint16_t parameterLength
+///
+/// \return    none
+static void httpserver_fetchWebSocket( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
+{
+   const uint8_t  *value;
+   uint16_t       valueLength;
+   char           accept[WEBSOCKET_ACCEPT + 1u];
+
+   value = httpserver_findHeader( stream->request, stream->requestLength, "upgrade:", &valueLength );
+   if( value == NULL || httpserver_token( value, valueLength, "websocket" ) == 0 )
+   {
+      httpserver_streamWrite( stream, BADREQUEST, strlen( BADREQUEST ) );
+      return;
+   }
+   value = httpserver_findHeader( stream->request, stream->requestLength, "connection:", &valueLength );
+   if( value == NULL || httpserver_token( value, valueLength, "upgrade" ) == 0 )
+   {
+      httpserver_streamWrite( stream, BADREQUEST, strlen( BADREQUEST ) );
+      return;
+   }
+   value = httpserver_findHeader( stream->request, stream->requestLength, "sec-websocket-version:", &valueLength );
+   if( value == NULL || httpserver_token( value, valueLength, "13" ) == 0 )
+   {
+      httpserver_streamWrite( stream, BADREQUEST, strlen( BADREQUEST ) );
+      return;
+   }
+   value = httpserver_findHeader( stream->request, stream->requestLength, "sec-websocket-key:", &valueLength );
+   if( value == NULL || websocket_accept( value, valueLength, accept ) == 0 )
+   {
+      httpserver_streamWrite( stream, BADREQUEST, strlen( BADREQUEST ) );
+      return;
+   }
+
+   httpserver_streamWrite( stream, WEBSOCKETHEADER, strlen( WEBSOCKETHEADER ) );
+   httpserver_streamWrite( stream, accept, WEBSOCKET_ACCEPT );
+   httpserver_streamWrite( stream, "\r\n\r\n", 4u );
+   stream->upgrade = HTTP_WEBSOCKET;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Serves every complete frame in the receive buffer of a
+///            websocket. A ping is answered with a pong and a close with a
+///            close, messages which are not binary or are fragmented are
+///            not part of the protocol and close the websocket.
+///
+/// \param     [in]  httpserver_connection_t* connection
+/// \param     [in]  SocketSet_t xSocketSet
+/// \param     [in]  TickType_t now
+///
+/// \return    none
+static void httpserver_webSocket( httpserver_connection_t* connection, SocketSet_t xSocketSet, TickType_t now )
+{
+   websocket_frame_t    frame;
+   websocket_status_t   status      = WEBSOCKET_INCOMPLETE;
+
+   while( connection->state == HTTP_WEBSOCKET && ( status = websocket_parse( connection->rxBuffer, connection->rxLength, &frame ) ) == WEBSOCKET_COMPLETE )
+   {
+      switch( frame.opcode )
+      {
+         case WEBSOCKET_BINARY:
+            if( frame.fin == 0 )
+            {
+               httpserver_webSocketClose( connection, xSocketSet, WEBSOCKET_CLOSE_DATA, now );
+            }
+            else if( frame.payloadLength > 0 )
+            {
+               httpserver_webSocketCommand( connection, xSocketSet, frame.payload, frame.payloadLength, now );
+            }
+            break;
+         case WEBSOCKET_PING:
+            httpserver_webSocketSend( connection, xSocketSet, WEBSOCKET_PONG, frame.payload, frame.payloadLength, now );
+            break;
+         case WEBSOCKET_PONG:
+            break;
+         case WEBSOCKET_CLOSE:
+            httpserver_webSocketClose( connection, xSocketSet, WEBSOCKET_CLOSE_NORMAL, now );
+            break;
+         default:
+            httpserver_webSocketClose( connection, xSocketSet, WEBSOCKET_CLOSE_DATA, now );
+            break;
+      }
+
+      // move a following frame to the front
+      connection->rxLength -= frame.length;
+      memmove( connection->rxBuffer, connection->rxBuffer + frame.length, connection->rxLength );
+   }
+
+   if( connection->state != HTTP_WEBSOCKET )
+   {
+      return;
+   }
+   if( status == WEBSOCKET_INVALID )
+   {
+      httpserver_webSocketClose( connection, xSocketSet, WEBSOCKET_CLOSE_PROTOCOL, now );
+   }
+   else if( connection->rxLength == RXBUFFER )
+   {
+      // a frame which does not fit into the buffer
+      httpserver_webSocketClose( connection, xSocketSet, WEBSOCKET_CLOSE_TOOBIG, now );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Executes a command of the page and answers it with the duty
+///            cycle of the led, the page measures the round trip with it.
+///
+/// \param     [in]  httpserver_connection_t* connection
+/// \param     [in]  SocketSet_t xSocketSet
+/// \param     [in]  const uint8_t* command, the id and the argument
+/// \param     [in]  uint16_t length
+/// \param     [in]  TickType_t now
+///
+/// \return    none
+static void httpserver_webSocketCommand( httpserver_connection_t* connection, SocketSet_t xSocketSet, const uint8_t* command, uint16_t length, TickType_t now )
+{
+   uint8_t reply[2];
+
+   reply[0] = command[0] | HTTPSERVER_WS_REPLY;
+   switch( command[0] )
+   {
+      case HTTPSERVER_WS_DUTY:
+         if( length == 2u && command[1] <= 40u )
+         {
+            led_setDim();
+            led_setDuty( command[1] );
+         }
+         else
+         {
+            reply[0] = HTTPSERVER_WS_INVALID;
+         }
+         break;
+      case HTTPSERVER_WS_PULSE:
+         led_setPulse();
+         break;
+      case HTTPSERVER_WS_TOGGLE:
+         led_toggle();
+         break;
+      case HTTPSERVER_WS_TELEMETRY:
+         if( length == 2u && command[1] <= 1u )
+         {
+            connection->telemetry = command[1];
+         }
+         else
+         {
+            reply[0] = HTTPSERVER_WS_INVALID;
+         }
+         break;
+      default:
+         reply[0] = HTTPSERVER_WS_INVALID;
+         break;
+   }
+   reply[1] = led_getDuty();
+
+   httpserver_webSocketSend( connection, xSocketSet, WEBSOCKET_BINARY, reply, sizeof( reply ), now );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sends a close frame with the status code and shuts the 
+///            connection down.
+///
+/// \param     [in]  httpserver_connection_t* connection
+/// \param     [in]  SocketSet_t xSocketSet
+/// \param     [in]  uint16_t code
+/// \param     [in]  TickType_t now
+///
+/// \return    none
+static void httpserver_webSocketClose( httpserver_connection_t* connection, SocketSet_t xSocketSet, uint16_t code, TickType_t now )
+{
+   uint8_t payload[2];
+
+   payload[0] = code >> 8;
+   payload[1] = code & 0xFFu;
+   httpserver_webSocketSend( connection, xSocketSet, WEBSOCKET_CLOSE, payload, sizeof( payload ), now );
+   if( connection->state == HTTP_WEBSOCKET )
+   {
+      httpserver_shutdown( connection, xSocketSet, now );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sends a frame to a websocket. The frame is not sent in parts,
+///            it is dropped if the socket has no space for it.
+///
+/// \param     [in]  httpserver_connection_t* connection
+/// \param     [in]  SocketSet_t xSocketSet
+/// \param     [in]  uint8_t opcode
+/// \param     [in]  const uint8_t* payload
+/// \param     [in]  uint16_t payloadLength, at most TXBUFFER - WEBSOCKET_HEADERMAX
+/// \param     [in]  TickType_t now
+///
+/// \return    none
+static void httpserver_webSocketSend( httpserver_connection_t* connection, SocketSet_t xSocketSet, uint8_t opcode, const uint8_t* payload, uint16_t payloadLength, TickType_t now )
+{
+   uint16_t          length;
+
+   length = websocket_header( txBuffer, opcode, payloadLength );
+   memcpy( &txBuffer[length], payload, payloadLength );
+   length += payloadLength;
+
+   if( connection->pending != NULL || FreeRTOS_tx_space( connection->socket ) < length )
+   {
+      statistic.framesDropped++;
+      return;
+   }
+   if( FreeRTOS_send( connection->socket, txBuffer, length, 0 ) < 0 )
+   {
+      httpserver_shutdown( connection, xSocketSet, now );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Pushes the telemetry to every websocket which asked for it, 
+///            the message is packed once for all websockets.
+///
+/// \param     [in]  SocketSet_t xSocketSet
+/// \param     [in]  TickType_t now
+///
+/// \return    none
+static void httpserver_telemetry( SocketSet_t xSocketSet, TickType_t now )
+{
+   httpserver_connection_t    *connection;
+   uint8_t                    message[HTTPSERVER_WS_PUSHLENGTH];
+   uint32_t                   u32;
+   int16_t                    i16;
+   uint16_t                   u16;
+
+   for( connection = connections; connection < &connections[HTTPSERVER_CONNECTIONS]; connection++ )
+   {
+      if( connection->state == HTTP_WEBSOCKET && connection->telemetry == 1 )
+      {
+         break;
+      }
+   }
+   if( connection == &connections[HTTPSERVER_CONNECTIONS] )
+   {
+      return;
+   }
+
+   // the cortex-m4 is little endian, the fields are copied as they are
+   message[0]  = HTTPSERVER_WS_PUSH;
+   u32         = xTaskGetTickCount() * portTICK_PERIOD_MS / 1000;
+   memcpy( &message[1], &u32, 4u );
+   i16         = (int16_t)( monitor_getTemperature() * 10.0f );
+   memcpy( &message[5], &i16, 2u );
+   u16         = (uint16_t)( monitor_getVoltage() * 1000.0f );
+   memcpy( &message[7], &u16, 2u );
+   message[9]  = ( HAL_GPIO_ReadPin( GPIOA, GPIO_PIN_0 ) == GPIO_PIN_RESET ) ? 1u : 0u;
+   message[10] = led_getDuty();
+   u32         = usb_getRxFrames();
+   memcpy( &message[11], &u32, 4u );
+   u32         = usb_getTxFrames();
+   memcpy( &message[15], &u32, 4u );
+
+   for( ; connection < &connections[HTTPSERVER_CONNECTIONS]; connection++ )
+   {
+      if( connection->state == HTTP_WEBSOCKET && connection->telemetry == 1 )
+      {
+         httpserver_webSocketSend( connection, xSocketSet, WEBSOCKET_BINARY, message, sizeof( message ), now );
+      }
+   }
+}
+#endif
+
+// ----------------------------------------------------------------------------
+/// \brief     Answers every complete request in the receive buffer of a
+///            connection. The rest of the buffer is moved to the front.
+///
+/// \param     [in]  uint8_t* rxBuffer
+/// \param     [in]  uint16_t* rxLength
+/// \param     [in]  uint8_t* txBuffer
+/// \param     [in]  uint16_t* requests, served on this connection
+/// \param     [in]  Socket_t xConnectedSocket
+///
+/// \return    HTTP_OPEN if the connection is kept open, HTTP_CLOSING if not,
+///            HTTP_EVENTS or HTTP_WEBSOCKET if it changed the protocol
+static httpserver_state_t httpserver_receive( uint8_t* rxBuffer, uint16_t* rxLength, uint8_t* txBuffer, uint16_t* requests, Socket_t xConnectedSocket )
+{
+   uint16_t             requestLength;
+   uint8_t              keepAlive = 1;
+   httpserver_state_t   upgrade;
+
+   while( keepAlive == 1 && ( requestLength = httpserver_requestLength( rxBuffer, *rxLength ) ) > 0 )
+   {
+      (*requests)++;
+      keepAlive = httpserver_keepAlive( rxBuffer, requestLength, *requests );
+      upgrade = httpserver_request( rxBuffer, requestLength, txBuffer, TXBUFFER, keepAlive, xConnectedSocket );
+      if( upgrade != HTTP_OPEN )
+      {
+         // no more requests are answered after a change of the protocol,
+         // the client waits for the response before it sends anything
+         *rxLength = 0;
+         return upgrade;
+      }
+
+      // move a following request to the front
+      *rxLength -= requestLength;
+      memmove( rxBuffer, rxBuffer + requestLength, *rxLength );
+#if( HTTPSERVER_SELECT == 1u )
+      // the following requests wait for the held back output
+      if( responding->pending != NULL || responding->error == 1 )
+      {
+         break;
+      }
+#endif
+   }
+
+   // a request which does not fit into the buffer is refused
+   if( keepAlive == 1 && *rxLength == RXBUFFER )
+   {
+      statistic.requestTooLong++;
+      keepAlive = 0;
+      httpserver_send( txBuffer, TXBUFFER, httpserver_400( txBuffer, TXBUFFER ), keepAlive, xConnectedSocket );
+   }
+
+   return ( keepAlive == 1 ) ? HTTP_OPEN : HTTP_CLOSING;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Answers one request.
+///
+/// \param     [in]  const uint8_t* request
+/// \param     [in]  uint16_t requestLength
+/// \param     [in]  uint8_t* pageBuffer
+/// \param     [in]  uint16_t pageBufferSize
+/// \param     [in]  uint8_t keepAlive
+/// \param     [in]  Socket_t xConnectedSocket
+///
+/// \return    HTTP_EVENTS or HTTP_WEBSOCKET if the connection changes the
+///            protocol, HTTP_OPEN if not
+static httpserver_state_t httpserver_request( const uint8_t* request, uint16_t requestLength, uint8_t* pageBuffer, uint16_t pageBufferSize, uint8_t keepAlive, Socket_t xConnectedSocket )
+{
+   const httpserver_route_t   *route;
+   const uint8_t              *parameter;
+   uint16_t                   parameterLength;
+   httpserver_stream_t        stream;
+
+   route = httpserver_route( request, requestLength, &parameter, &parameterLength );
+   if( route == NULL )
+   {
+      // send bad request for any other method or a faulty uri
+      if( memcmp( request, "GET ", 4u ) != 0 )
+      {
+         httpserver_send( pageBuffer, pageBufferSize, httpserver_400( pageBuffer, pageBufferSize ), keepAlive, xConnectedSocket );
+         return HTTP_OPEN;
+      }
+
+      // the homepage for any unknown uri
+      route = &webroutes[WEBROUTES_HOME];
+   }
+
+   if( route->asset != NULL )
+   {
+      // send a static file out of the flash
+      httpserver_sendAsset( route->asset, request, requestLength, pageBuffer, pageBufferSize, keepAlive, xConnectedSocket );
+      return HTTP_OPEN;
+   }
+
+   // the response is rendered straight into the socket
+   httpserver_streamBegin( &stream, pageBuffer, pageBufferSize, keepAlive, xConnectedSocket );
+   stream.request       = request;
+   stream.requestLength = requestLength;
+   route->handler( &stream, parameter, parameterLength );
+   httpserver_streamEnd( &stream );
+   return stream.upgrade;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Returns the length of the first request in the buffer, the
+///            header and the body given by the content length.
+///
+/// \param     [in]  const uint8_t* request
+/// \param     [in]  uint16_t length
+///
+/// \return    requestLength, 0 if the request is not complete yet
+static uint16_t httpserver_requestLength( const uint8_t* request, uint16_t length )
+{
+   const uint8_t  *end;
+   const uint8_t  *value;
+   uint16_t       valueLength;
+   uint32_t       requestLength;
+
+   end = httpserver_search( request, length, "\r\n\r\n" );
+   if( end == NULL )
+   {
+      return 0;
+   }
+   requestLength = end + 4u - request;
+
+   // a body follows the header
+   value = httpserver_findHeader( request, requestLength, "content-length:", &valueLength );
+   if( value != NULL )
+   {
+      requestLength += strtoul( (char const*)value, NULL, 10u );
+   }
+
+   return ( requestLength <= length ) ? requestLength : 0;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Checks if the connection is kept open after the request.
+///            HTTP/1.1 connections are persistent unless the client sends
+///            Connection: close. HTTP/1.0 connections are always closed.
+///
+/// \param     [in]  const uint8_t* request
+/// \param     [in]  uint16_t requestLength
+/// \param     [in]  uint16_t requests, served on this connection
+///
+/// \return    1 if the connection is kept open, 0 if not
+static uint8_t httpserver_keepAlive( const uint8_t* request, uint16_t requestLength, uint16_t requests )
+{
+   const uint8_t  *value;
+   const uint8_t  *end;
+   uint16_t       valueLength;
+
+   if( requests >= KEEPALIVE_MAX )
+   {
+      return 0;
+   }
+
+   // the version at the end of the request line
+   end = memchr( request, '\r', requestLength );
+   if( end == NULL || end - request < 8 || memcmp( end - 8, "HTTP/1.1", 8u ) != 0 )
+   {
+      return 0;
+   }
+
+   value = httpserver_findHeader( request, requestLength, "connection:", &valueLength );
+   if( value != NULL && httpserver_token( value, valueLength, "close" ) == 1 )
+   {
+      return 0;
+   }
+
+   return 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sends a static file straight out of the flash. The header with
+///            the content length is prepared by webassets.py, if the browser
+///            has the file already cached only the 304 header is sent.
+///
+/// \param     [in]  const webasset_t* asset
+/// \param     [in]  const uint8_t* request
+/// \param     [in]  uint16_t requestLength
+/// \param     [in]  uint8_t* pageBuffer
+/// \param     [in]  uint16_t pageBufferSize
+/// \param     [in]  uint8_t keepAlive
+/// \param     [in]  Socket_t xConnectedSocket
+///
+/// \return    none
+static void httpserver_sendAsset( const webasset_t* asset, const uint8_t* request, uint16_t requestLength, uint8_t* pageBuffer, uint16_t pageBufferSize, uint8_t keepAlive, Socket_t xConnectedSocket )
+{
+   uint16_t stringLength;
+
+   if( httpserver_ifNoneMatch( request, requestLength, asset->etag ) == 1 )
+   {
+      memcpy( pageBuffer, asset->notModified, asset->notModifiedLength );
+      httpserver_send( pageBuffer, pageBufferSize, asset->notModifiedLength, keepAlive, xConnectedSocket );
+      return;
+   }
+
+   // the header is copied to add the connection field
+   memcpy( pageBuffer, asset->header, asset->headerLength );
+   stringLength = httpserver_completeHeader( pageBuffer, pageBufferSize, asset->headerLength, keepAlive );
+   httpserver_write( xConnectedSocket, pageBuffer, stringLength, 1 );
+   if( keepAlive == 0 )
+   {
+      httpserver_lastPacket( xConnectedSocket );
+   }
+   httpserver_write( xConnectedSocket, asset->data, asset->length, 0 );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Completes the header of the response and sends it. The response
+///            has to fit into the page buffer.
+///
+/// \param     [in]  uint8_t* pageBuffer
+/// \param     [in]  uint16_t pageBufferSize
+/// \param     [in]  uint16_t stringLength, 0 if the handler failed
+/// \param     [in]  uint8_t keepAlive
+/// \param     [in]  Socket_t xConnectedSocket
+///
+/// \return    none
+static void httpserver_send( uint8_t* pageBuffer, uint16_t pageBufferSize, uint16_t stringLength, uint8_t keepAlive, Socket_t xConnectedSocket )
+{
+   if( stringLength > 0 )
+   {
+      stringLength = httpserver_completeHeader( pageBuffer, pageBufferSize, stringLength, keepAlive );
+   }
+
+   // the response did not fit into the buffer
+   if( stringLength == 0 )
+   {
+      keepAlive = 0;
+      stringLength = httpserver_500( pageBuffer, pageBufferSize );
+      stringLength = httpserver_completeHeader( pageBuffer, pageBufferSize, stringLength, keepAlive );
+   }
+
+   if( keepAlive == 0 )
+   {
+      httpserver_lastPacket( xConnectedSocket );
+   }
+   httpserver_write( xConnectedSocket, pageBuffer, stringLength, 1 );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sends a part of a response. The task per connection waits for
+///            the socket up to xSendTimeOut. The select task does not wait,
+///            what does not fit into the socket is held back for the
+///            connection, see httpserver_drain(). The part is copied unless
+///            it is in the flash.
+///
+/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [in]  const void* data
+/// \param     [in]  uint16_t length
+/// \param     [in]  uint8_t copy, 0 if the data stays valid
+///
+/// \return    bytes sent or held back, negative if the part is lost
+static BaseType_t httpserver_write( Socket_t xConnectedSocket, const void* data, uint16_t length, uint8_t copy )
+{
+#if( HTTPSERVER_SELECT == 1u )
+   httpserver_pending_t **tail;
+   httpserver_pending_t *piece;
+   BaseType_t           sent = 0;
+   uint16_t             size;
+
+   if( responding->error == 1 )
+   {
+      return -pdFREERTOS_ERRNO_ENOMEM;
+   }
+
+   // the socket takes what fits, behind the held back output only
+   if( responding->pending == NULL )
+   {
+      sent = FreeRTOS_send( xConnectedSocket, data, length, 0 );
+      if( sent == -pdFREERTOS_ERRNO_ENOSPC )
+      {
+         sent = 0;
+      }
+      if( sent < 0 || sent == length )
+      {
+         return sent;
+      }
+   }
+
+   // the rest is held back, a response which takes too much is aborted
+   size  = ( copy == 1 ) ? length - sent : 0u;
+   piece = ( pendingBytes + size <= PENDINGMAX ) ? pvPortMalloc( sizeof( httpserver_pending_t ) + size ) : NULL;
+   if( piece == NULL )
+   {
+      responding->error = 1;
+      return -pdFREERTOS_ERRNO_ENOMEM;
+   }
+   piece->next    = NULL;
+   piece->length  = length - sent;
+   piece->size    = size;
+   piece->data    = ( const uint8_t* )data + sent;
+   if( copy == 1 )
+   {
+      memcpy( piece + 1, piece->data, size );
+      piece->data = ( const uint8_t* )( piece + 1 );
+   }
+   pendingBytes += size;
+   for( tail = &responding->pending; *tail != NULL; tail = &( *tail )->next );
+   *tail = piece;
+   return length;
+#else
+   return FreeRTOS_send( xConnectedSocket, data, length, 0 );
+#endif
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Adds the Content-Length field to the header of the response,
+///            if it is not there yet, and the Connection field for the last
+///            response of the connection. The body is moved behind the
+///            fields.
+///
+/// \param     [in]  uint8_t* pageBuffer
+/// \param     [in]  uint16_t pageBufferSize
+/// \param     [in]  uint16_t stringLength
+/// \param     [in]  uint8_t keepAlive
+///
+/// \return    stringLength, 0 if the buffer is too small
+static uint16_t httpserver_completeHeader( uint8_t* pageBuffer, uint16_t pageBufferSize, uint16_t stringLength, uint8_t keepAlive )
+{
+   char           fields[48];
+   uint16_t       fieldsLength = 0;
+   uint16_t       headerLength;
+   const uint8_t  *end;
+
+   // the fields are inserted in front of the empty line
+   end = httpserver_search( pageBuffer, stringLength, "\r\n\r\n" );
+   if( end == NULL )
+   {
+      return 0;
+   }
+   headerLength = end + 2u - pageBuffer;
+
+   // 204 and 304 responses have no body and no content length
+   if( httpserver_search( pageBuffer, headerLength, "Content-Length:" ) == NULL &&
+       memcmp( &pageBuffer[9], "204", 3u ) != 0 && memcmp( &pageBuffer[9], "304", 3u ) != 0 )
+   {
+      fieldsLength += snprintf( fields, sizeof( fields ), "Content-Length: %u\r\n", (unsigned int)( stringLength - headerLength - 2u ) );
+   }
+   if( keepAlive == 0 )
+   {
+      fieldsLength += snprintf( fields + fieldsLength, sizeof( fields ) - fieldsLength, "Connection: close\r\n" );
+   }
+
+   if( stringLength + fieldsLength > pageBufferSize )
+   {
+      return 0;
+   }
+   memmove( pageBuffer + headerLength + fieldsLength, pageBuffer + headerLength, stringLength - headerLength );
+   memcpy( pageBuffer + headerLength, fields, fieldsLength );
+
+   return stringLength + fieldsLength;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Prepares the streaming of a response into the socket. The
+///            response is written in pieces of at most one segment into the
+///            page buffer, a response which fits into the first piece is
+///            sent with its content length.
+///
+/// \param     [out] httpserver_stream_t* stream
+/// \param     [in]  uint8_t* pageBuffer
+/// \param     [in]  uint16_t pageBufferSize
+/// \param     [in]  uint8_t keepAlive
+/// \param     [in]  Socket_t xConnectedSocket
+///
+/// \return    none
+static void httpserver_streamBegin( httpserver_stream_t* stream, uint8_t* pageBuffer, uint16_t pageBufferSize, uint8_t keepAlive, Socket_t xConnectedSocket )
+{
+   stream->socket       = xConnectedSocket;
+   stream->buffer       = pageBuffer;
+   stream->bufferSize   = pageBufferSize;
+   stream->size         = pageBufferSize - STREAMRESERVE;
+   if( stream->size > ipconfigTCP_MSS )
+   {
+      stream->size = ipconfigTCP_MSS;
+   }
+   stream->length       = 0;
+   stream->start        = 0;
+   stream->keepAlive    = keepAlive;
+   stream->streaming    = 0;
+   stream->error        = 0;
+   stream->upgrade      = HTTP_OPEN;
+   stream->request      = NULL;
+   stream->requestLength = 0;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Writes data into the stream, a full piece is sent.
+///
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const void* data
+/// \param     [in]  uint16_t length
+///
+/// \return    none
+static void httpserver_streamWrite( httpserver_stream_t* stream, const void* data, uint16_t length )
+{
+   const uint8_t  *bytes = data;
+   uint16_t       n;
+
+   while( length > 0 && stream->error == 0 )
+   {
+      // the piece is sent only if more data follows, the last piece is
+      // sent by httpserver_streamEnd()
+      if( stream->length == stream->size )
+      {
+         httpserver_streamFlush( stream, 0 );
+      }
+
+      n = stream->size - stream->length;
+      if( n > length )
+      {
+         n = length;
+      }
+      memcpy( stream->buffer + stream->length, bytes, n );
+      stream->length += n;
+      bytes          += n;
+      length         -= n;
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Writes the value of a placeholder into the stream.
+///
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  webtemplate_type_t type
+/// \param     [in]  webtemplate_value_t value
+///
+/// \return    none
+static void httpserver_streamValue( httpserver_stream_t* stream, webtemplate_type_t type, webtemplate_value_t value )
+{
+   char     text[VALUETEXT];
+   uint8_t  length;
+
+   // a string is written as it is
+   if( type == WEBTEMPLATE_STR )
+   {
+      httpserver_streamWrite( stream, value.s, strlen( value.s ) );
+      return;
+   }
+
+   length = httpserver_format( text, type, value );
+   httpserver_streamWrite( stream, text, length );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Formats the value of a placeholder as zero terminated text. A
+///            string longer than the text is cut.
+///
+/// \param     [out] char* text, VALUETEXT bytes
+/// \param     [in]  webtemplate_type_t type
+/// \param     [in]  webtemplate_value_t value
+///
+/// \return    length of the text
+static uint8_t httpserver_format( char* text, webtemplate_type_t type, webtemplate_value_t value )
+{
+   static const char hex[] = "0123456789abcdef";
+   char           digits[VALUETEXT];
+   char           *p          = &digits[sizeof( digits )];
+   uint32_t       number;
+   uint8_t        length;
+   uint8_t        decimals    = 0;
+   uint8_t        negative    = 0;
+   float          f;
+
+   switch( type )
+   {
+      case WEBTEMPLATE_STR:
+         for( length = 0; length < VALUETEXT - 1u && value.s[length] != '\0'; length++ )
+         {
+            text[length] = value.s[length];
+         }
+         text[length] = '\0';
+         return length;
+      case WEBTEMPLATE_X2:
+         text[0] = hex[( value.u >> 4u ) & 0x0fu];
+         text[1] = hex[value.u & 0x0fu];
+         text[2] = '\0';
+         return 2u;
+      case WEBTEMPLATE_I32:
+         negative = ( value.i < 0 );
+         number   = negative ? 0u - ( uint32_t )value.i : ( uint32_t )value.i;
+         break;
+      case WEBTEMPLATE_F1:
+      case WEBTEMPLATE_F2:
+         decimals = ( type == WEBTEMPLATE_F1 ) ? 1u : 2u;
+         negative = ( value.f < 0.0f );
+         f        = negative ? -value.f : value.f;
+         number   = ( uint32_t )( f * ( ( decimals == 1u ) ? 10.0f : 100.0f ) + 0.5f );
+         break;
+      default:
+         number   = value.u;
+         break;
+   }
+
+   // the digits from the back, at least one in front of the point
+   for( uint8_t i = 0; number > 0 || i <= decimals; i++ )
+   {
+      if( i == decimals && decimals > 0 )
+      {
+         *--p = '.';
+      }
+      *--p = '0' + number % 10u;
+      number /= 10u;
+   }
+   if( negative == 1 )
+   {
+      *--p = '-';
+   }
+   length = &digits[sizeof( digits )] - p;
+   memcpy( text, p, length );
+   text[length] = '\0';
+   return length;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sends the piece in the page buffer. The length of a streamed
+///            response is not known, it is sent in chunks if the connection
+///            is kept open, otherwise it ends with the connection. The fields
+///            are added to the header with the first piece.
+///
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  uint8_t last, 1 for the last piece of the response
+///
+/// \return    none
+static void httpserver_streamFlush( httpserver_stream_t* stream, uint8_t last )
+{
+   const char     *fields;
+   const uint8_t  *end;
+   uint16_t       fieldsLength;
+   uint16_t       headerLength;
+   uint16_t       gap;
+   char           chunk[8];
+
+   if( stream->streaming == 0 )
+   {
+      // the header has to fit into the first piece
+      end = httpserver_search( stream->buffer, stream->length, "\r\n\r\n" );
+      if( end == NULL )
+      {
+         stream->error = 1;
+         return;
+      }
+      headerLength = end + 2u - stream->buffer;
+
+      // the fields are inserted in front of the empty line, behind it
+      // follows the chunk size line
+      fields         = ( stream->keepAlive == 1 ) ? "Transfer-Encoding: chunked\r\n" : "Connection: close\r\n";
+      fieldsLength   = strlen( fields );
+      gap            = fieldsLength + ( ( stream->keepAlive == 1 ) ? CHUNKLINE : 0u );
+      memmove( stream->buffer + headerLength + 2u + gap, stream->buffer + headerLength + 2u, stream->length - headerLength - 2u );
+      memcpy( stream->buffer + headerLength, fields, fieldsLength );
+      memcpy( stream->buffer + headerLength + fieldsLength, "\r\n", 2u );
+      stream->start     = headerLength + fieldsLength + 2u;
+      stream->length   += gap;
+      stream->streaming = 1;
+   }
+
+   if( stream->keepAlive == 1 )
+   {
+      // frame the data of the piece as chunk
+      if( stream->length > stream->start + CHUNKLINE )
+      {
+         snprintf( chunk, sizeof( chunk ), "%04x\r\n", (unsigned int)( stream->length - stream->start - CHUNKLINE ) );
+         memcpy( stream->buffer + stream->start, chunk, CHUNKLINE );
+         memcpy( stream->buffer + stream->length, "\r\n", 2u );
+         stream->length += 2u;
+      }
+      else
+      {
+         stream->length = stream->start;
+      }
+      if( last == 1 )
+      {
+         memcpy( stream->buffer + stream->length, "0\r\n\r\n", 5u );
+         stream->length += 5u;
+      }
+   }
+   else if( last == 1 )
+   {
+      httpserver_lastPacket( stream->socket );
+   }
+
+   if( stream->length > 0 && httpserver_write( stream->socket, stream->buffer, stream->length, 1 ) < 0 )
+   {
+      stream->error = 1;
+   }
+
+   // the next piece begins with the chunk size line
+   stream->start  = 0;
+   stream->length = ( stream->keepAlive == 1 ) ? CHUNKLINE : 0u;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sends the rest of the response. A response which was not
+///            streamed yet is sent in one piece with its content length.
+///
+/// \param     [in]  httpserver_stream_t* stream
+///
+/// \return    none
+static void httpserver_streamEnd( httpserver_stream_t* stream )
+{
+   if( stream->upgrade != HTTP_OPEN )
+   {
+      // the header of an event stream or the switch to the websocket, the
+      // events and frames follow without length
+      httpserver_write( stream->socket, stream->buffer, stream->length, 1 );
+   }
+   else if( stream->streaming == 0 )
+   {
+      // a failed response is answered with 500
+      httpserver_send( stream->buffer, stream->bufferSize, ( stream->error == 0 ) ? stream->length : 0u, stream->keepAlive, stream->socket );
+   }
+   else if( stream->error == 0 )
+   {
+      httpserver_streamFlush( stream, 1 );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Renders a template into the stream in one pass, the text parts
+///            are copied out of the flash.
+///
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const webtemplate_t* webtemplate
+/// \param     [in]  const webtemplate_value_t* values, valuesCount of the template
+///
+/// \return    none
+static void httpserver_render( httpserver_stream_t* stream, const webtemplate_t* webtemplate, const webtemplate_value_t* values )
+{
+   const webtemplate_part_t *part;
+
+   for( part = webtemplate->parts; part < &webtemplate->parts[webtemplate->partsCount]; part++ )
+   {
+      if( part->type == WEBTEMPLATE_TEXT )
+      {
+         httpserver_streamWrite( stream, part->text, part->length );
+      }
+      else
+      {
+         httpserver_streamValue( stream, part->type, values[part->value] );
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Checks if the If-None-Match header of the request contains the
+///            entity tag.
+///
+/// \param     [in]  const uint8_t* request
+/// \param     [in]  uint16_t requestLength
+/// \param     [in]  const char* etag
+///
+/// \return    1 if the entity tag matches, 0 if not
+static uint8_t httpserver_ifNoneMatch( const uint8_t* request, uint16_t requestLength, const char* etag )
+{
+   const uint8_t  *value;
+   uint16_t       valueLength;
+
+   value = httpserver_findHeader( request, requestLength, "if-none-match:", &valueLength );
+   if( value == NULL || httpserver_search( value, valueLength, etag ) == NULL )
+   {
+      return 0;
+   }
+   return 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Looks up a header field of the request. The name is case
+///            insensitive and has to be given in lower case with the colon.
+///
+/// \param     [in]  const uint8_t* request
+/// \param     [in]  uint16_t requestLength
+/// \param     [in]  const char* name, e.g. "connection:"
+/// \param     [out] uint16_t* valueLength
+///
+/// \return    value of the field, NULL if the request has no such field
+static const uint8_t* httpserver_findHeader( const uint8_t* request, uint16_t requestLength, const char* name, uint16_t* valueLength )
+{
+   const uint16_t nameLength  = strlen( name );
+   const uint8_t  *requestEnd = request + requestLength;
+   const uint8_t  *line;
+   const uint8_t  *end;
+   uint16_t       i;
+
+   // go through the header lines, the request line is skipped
+   for( line = memchr( request, '\n', requestLength ); line != NULL && line + 1 < requestEnd; line = end )
    {
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+      line++;
+      end = memchr( line, '\n', requestEnd - line );
+      if( end == NULL )
+      {
+         end = requestEnd;
+      }
+
+      // an empty line ends the header
+      if( end - line <= 1 )
+      {
+         return NULL;
+      }
+
+      // compare the name
+      if( end - line < nameLength )
+      {
+         continue;
+      }
+      for( i = 0; i < nameLength; i++ )
+      {
+         if( ( line[i] | 0x20u ) != ( uint8_t )name[i] )
+         {
+            break;
+         }
+      }
+      if( i == nameLength )
+      {
+         *valueLength = end - line - nameLength;
+         return line + nameLength;
+      }
    }
-   /////////////////////////////////////////////////////////////////////////////
-   
-   // bottom
-   stringLength = snprintf(0, 0, webpage_bottom_no_btn);
-   snprintf((char*)pageBuffer, stringLength+1, webpage_bottom_no_btn);
-   
-   // send fragment of the webpage//////////////////////////////////////////////
-   if( stringLength < pageBufferSize )
+   return NULL;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Searches a string in the data.
+///
+/// \param     [in]  const uint8_t* data
+/// \param     [in]  uint16_t length
+/// \param     [in]  const char* string
+///
+/// \return    first occurrence, NULL if the string is not in the data
+static const uint8_t* httpserver_search( const uint8_t* data, uint16_t length, const char* string )
+{
+   const uint16_t stringLength = strlen( string );
+
+   for( uint16_t i = 0; i + stringLength <= length; i++ )
    {
-      httpserver_lastPacket( xConnectedSocket );
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+      if( data[i] == string[0] && memcmp( &data[i], string, stringLength ) == 0 )
+      {
+         return &data[i];
+      }
    }
-   vPortFree(task);
-   /////////////////////////////////////////////////////////////////////////////
+   return NULL;
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Main page of the device. With an overview of important data using
-///            the javascript fetch method.
+/// \brief     Searches a token of a header value, case insensitive.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [in]  const uint8_t* value
+/// \param     [in]  uint16_t valueLength
+/// \param     [in]  const char* token, in lower case
 ///
-/// \return    none
-#define TILECOLOR "#34ace0;"
-static void httpserver_homepageFetch( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
-{
-   uint16_t 		   stringLength;
-   uint8_t  		   *ipAddress8b;
-   uint32_t 		   ipAddress;
-   uint32_t 		   netMask;
-   uint32_t 		   dnsAddress;
-   uint32_t 		   gatewayAddress;
-   const uint8_t* 	stackMacAddress;
-   uint8_t           dutyCycle;
-   
-   static const char *webpage_panelcontrollerMonitor = {
-      
-      "<style type='text/css'>"
-
-      // slider
-      ".slidecontainer {width: 100%;}"
-      ".slider {-webkit-appearance: none;width: 200px;height: 15px;border-radius: 5px;background: #d3d3d3;outline: none;opacity: 0.7;-webkit-transition: .2s;transition: opacity .2s;}"
-      ".slider:hover {opacity: 1;}"
-      ".slider::-moz-range-thumb {width: 25px;height: 25px;border-radius: 50%;background: #04AA6D;cursor: pointer;}"
-         
-      // blackpill
-      ".blackpill {"
-         //"position: absolute;"
-         //"top: 585px;"
-         //"left: 550px;"
-         "height: auto;"
-         "width: 250px;"
-         "transform: scale(0.5) rotate(270deg);"
-      "}"
-      ".border {"
-         "width: 900px;"
-         "height: 300px;"
-         "background-image: linear-gradient(grey, black);"
-         "box-shadow: 0 0 1em black;"
-         "position: absolute;"
-         "top: -150px;"
-         "left: -330px;"
-      "}"
-      ".usb {"
-         "width: 150px;"
-         "height: 150px;"
-         "background: #666666;"
-         "position: absolute;"
-         "top: -75px;"
-         "left: -353px;"
-      "}"
-      ".uc1 {"
-         "width: 140px;"
-         "height: 140px;"
-         "background: #666666;"
-         "position: absolute;"
-         "transform: rotate(45deg);"
-         "top: -75px;"
-         "left: 67px;"
-      "}"
-      ".uc2 {"
-         "width: 130px;"
-         "height: 130px;"
-         "background: #000000;"
-         "position: absolute;"
-         "transform: rotate(45deg);"
-         "top: -70px;"
-         "left: 72px;"
-      "}"
-      ".key1 {"
-         "width: 90px;"
-         "height: 60px;"
-         "background: #CCCCCC;"
-         "position: absolute;"
-         "top: 5px;"
-         "left: 367px;"
-      "}"
-      ".key2 {"
-         "width: 55px;"
-         "height: 55px;"
-         "background: #000000;"
-         "position: absolute;"
-         "border-radius: 100% 100% 100% 100%;"
-         "top: 7px;"
-         "left: 384px;"
-      "}"
-      ".led {"
-         "width: 60px;"
-         "height: 60px;"
-         "background-image: linear-gradient(blue, white);"
-         "position: absolute;"
-         "border-radius: 100% 100% 100% 100%;"
-         "top: -75px;"
-         "left: 382px;"
-      "}"
-      ".pins1 {"
-         "width: 850px;"
-         "height: 20px;"
-         "background: #EBDC03;"
-         "position: absolute;"
-         "top: -135px;"
-         "left: -303px;"
-      "}"
-      ".pins2 {"
-         "width: 850px;"
-         "height: 20px;"
-         "background: #EBDC03;"
-         "position: absolute;"
-         "top: 115px;"
-         "left: -303px;"
-      "}"
-      ".infogeneral {"
-         "padding: 10px;"
-         "margin: 20px;"
-         "width: 360px;"
-         "background: "TILECOLOR
-         "color: white;"
-         "border-radius: 10px;"
-         "box-shadow: 0 0 1em #ffb142;"
-         //"animation: fadeIn linear 5s;"
-      "}"
-      ".infortos {"
-         "padding: 10px;"
-         "margin: 20px;"
-         "width: 360px;"
-         "background: "TILECOLOR
-         "color: white;"
-         "border-radius: 10px;"
-         "box-shadow: 0 0 1em #ffb142;"
-      "}"
-      ".infoboard {"
-         "padding: 10px;"
-         "margin: 20px;"
-         "width: 280px;"
-         "background: "TILECOLOR
-         "color: white;"
-         "border-radius: 10px;"
-         "box-shadow: 0 0 1em #ffb142;"
-      "}"
-      ".infotcpip {"
-         "padding: 10px;"
-         "margin: 20px;"
-         "width: 280px;"
-         "height: 298px;"
-         "background: "TILECOLOR
-         "color: white;"
-         "border-radius: 10px;"
-         "box-shadow: 0 0 1em #ffb142;"
-      "}"
-      "table.main {"
-         "margin-left: auto;" 
-         "margin-right: auto;"
-      "}"
-      "</style>"
-      
-      "<table class='main'>"
-         
-        "<td style='vertical-align:top;'>"
-            "<div class='infogeneral'>"
-               "<p><h3>System Info</h3></p>"
-               "<p>IP: %d.%d.%d.%d</p>"
-               "<p>MAC: %02x:%02x:%02x:%02x:%02x:%02x</p>"
-               "<p><div class='timecontainer'></div></p>"
-               "<p>Guest counter: %d</p>" 
-            "</div>"
-            "<div class='infortos'>"
-               "<p><h3>RTOS Info</h3></p>"
-               "<p>FreeRTOS Version: %s</p>"
-               "<p><div class='rtoscontainer'></div></p>"
-            "</div>"
-         "</td>"
-            
-         "<td style='vertical-align:center;'>"
-            "<div class='blackpill'>"
-               "<div class='border'></div>"
-               "<div class='usb'></div>"
-               "<div class='uc1'></div>"
-               "<div class='uc2'><font size='4' face='verdana' color='white'>STM32F411</font></div>"
-               "<div class='key1'></div>"
-               "<div class='key2'></div>"
-               "<div class='led'></div>"
-               "<div class='pins1'></div>"
-               "<div class='pins2'></div>"
-            "</div>"
-         "</td>"
-            
-         "<td style='vertical-align:top;'>"
-            "<div class='infoboard'>"
-               "<p><h3>Peripherals</h3></p>"
-               "<p><div class='slidecontainer'>"
-                  "Led Dimmer<input type='range' min='2' max='40' value=%d class='slider' id='myRange'>"
-               "</div></p>" 
-               "<p><form action='led_pulse' method='post'><button style='width:200px;border-radius:4px;'>Led Pulse</button></form></p>"
-               "<p><div class='sensorcontainer'></div></p>"
-            "</div>" 
-            "<div class='infotcpip'>"
-               "<p><h3>TCP/IP Statistics</h3></p>"
-               "<p><div class='tcpipcontainer'></div></p>"
-            "</div>" 
-         "</td>"
-            
-      "</table>"
-         
-      "<script>"
-      "var xhr=new XMLHttpRequest();"
-      "var slider=document.getElementById('myRange');"
-      "var block=0;"
-         
-      "function unblock(){block=0;};"
-      
-      // block next post request triggert by the slider for 250 ms to avoid "spamming"
-      "slider.oninput=function(){"
-         "if(block==0){"
-            "block=1;"
-            "var urlpost='/led_set_value/'+this.value;"
-            "xhr.open('POST', urlpost, true);"
-            "xhr.setRequestHeader('Content-Type', 'application/x-www-form-urlencoded; charset=UTF-8');"
-            "xhr.send('zero');"
-            "setTimeout(unblock, 150);"
-         "}"
-      "};"
-         
-      // time fetch method
-      "async function getTime(){"
-         "let url = 'time.json';"
-         "try{"
-            "let res = await fetch(url);"
-            "return await res.json();"
-         "}catch(error){"
-            "console.log(error);"
-         "}"
-      "};"
-         
-      "async function renderTime(){"
-         "let time = await getTime();"
-         "let html = '';"
-         "let htmlSegment = `<div class='time'>"
-                                 "Uptime: ${time.d} days, ${time.h} hours, ${time.m} minutes, ${time.s} seconds"
-                              "</div>`;"
-         "html += htmlSegment;"
-      
-         "let timecontainer = document.querySelector('.timecontainer');"
-         "timecontainer.innerHTML = html;"
-      "};"
-         
-      "setInterval(renderTime, 1000);"
-      "renderTime();"
-         
-      // rtos data fetch method
-      "async function getRtos(){"
-         "let url = 'rtos.json';"
-         "try{"
-            "let res = await fetch(url);"
-            "return await res.json();"
-         "}catch(error){"
-            "console.log(error);"
-         "}"
-      "};"
-         
-      "async function renderRtos(){"
-         "let rtos = await getRtos();"
-         "let html = '';"
-         "let htmlSegment = `<div class='rtos'>"
-                                 "<p>Free Heap: ${rtos.heap} bytes</p>"
-                                 "<table style='color:white'>"
-                                    "<tr><td>Running Tasks</td></tr>"
-                                    "<tr><td style='width:150px'>Name</td><td style='width:50px'>Priority</td></tr>"
-                                    "<tr><td>${rtos.t1n}</td><td>${rtos.t1p}</td></tr>"
-                                    "<tr><td>${rtos.t2n}</td><td>${rtos.t2p}</td></tr>"
-                                    "<tr><td>${rtos.t3n}</td><td>${rtos.t3p}</td></tr>"
-                                    "<tr><td>${rtos.t4n}</td><td>${rtos.t4p}</td></tr>"
-                                    "<tr><td>${rtos.t5n}</td><td>${rtos.t5p}</td></tr>"
-                                    "<tr><td>${rtos.t6n}</td><td>${rtos.t6p}</td></tr>"
-                                    "<tr><td>${rtos.t7n}</td><td>${rtos.t7p}</td></tr>"
-                                 "</table>"
-                              "</div>`;"
-         "html += htmlSegment;"
-      
-         "let rtoscontainer = document.querySelector('.rtoscontainer');"
-         "rtoscontainer.innerHTML = html;"
-      "};"
-         
-      //"setInterval(renderRtos, 10000);"
-      "renderRtos();"
-         
-      // rtos data fetch method
-      "async function getSensor(){"
-         "let url = 'sensor.json';"
-         "try{"
-            "let res = await fetch(url);"
-            "return await res.json();"
-         "}catch(error){"
-            "console.log(error);"
-         "}"
-      "};"
-         
-      "async function renderSensor(){"
-         "let sensor = await getSensor();"
-         "let html = '';"
-         "let htmlSegment = `<div class='sensor'>"
-                                 "<p>Button: ${sensor.btn}</p>"
-                                 "<p>Temperature: ${sensor.temp} C</p>"
-                                 "<p>Voltage: ${sensor.volt} V</p>"
-                              "</div>`;"
-         "html += htmlSegment;"
-      
-         "let sensorcontainer = document.querySelector('.sensorcontainer');"
-         "sensorcontainer.innerHTML = html;"
-      "};"
-         
-      "setInterval(renderSensor, 1000);"
-      "renderSensor();"
-         
-      // tcp ip data fetch method
-      "async function getTcpIp(){"
-         "let url = 'tcpip.json';"
-         "try{"
-            "let res = await fetch(url);"
-            "return await res.json();"
-         "}catch(error){"
-            "console.log(error);"
-         "}"
-      "};"
-         
-      "async function renderTcpIp(){"
-         "let tcpip = await getTcpIp();"
-         "let html = '';"
-         "let htmlSegment = `<div class='tcpip'>"
-                                 "<p>Received Ethernet Frames: ${tcpip.rxF}</p>"
-                                 "<p>Received Data: ${tcpip.rxD} Bytes</p>"
-                                 "<p>Transmitted Ethernet Frames: ${tcpip.txF}</p>"
-                                 "<p>Transmitted Data: ${tcpip.txD} Bytes</p>"
-                              "</div>`;"
-         "html += htmlSegment;"
-      
-         "let tcpipcontainer = document.querySelector('.tcpipcontainer');"
-         "tcpipcontainer.innerHTML = html;"
-      "};"
-         
-      "setInterval(renderTcpIp, 1000);"
-      "renderTcpIp();"
+/// \return    1 if the value contains the token, 0 if not
+static uint8_t httpserver_token( const uint8_t* value, uint16_t valueLength, const char* token )
+{
+   const uint16_t tokenLength = strlen( token );
+   uint16_t       i;
 
-      "</script>"
-   };
-   
-   // set the placeholder in every webpage fragment and put all fragments together
-   // top header
-   stringLength = snprintf(0, 0, webpage_top);
-   snprintf((char*)pageBuffer, stringLength+1, webpage_top);
-   
-   // send fragment of the webpage//////////////////////////////////////////////
-   if( stringLength < pageBufferSize )
+   for( ; valueLength >= tokenLength; value++, valueLength-- )
    {
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+      for( i = 0; i < tokenLength && ( value[i] | 0x20u ) == ( uint8_t )token[i]; i++ );
+      if( i == tokenLength )
+      {
+         return 1;
+      }
    }
-   /////////////////////////////////////////////////////////////////////////////
+   return 0;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Send the device info as json fragment of the page. The page
+///            itself is static, it fetches the values at load time.
+///
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, none
+/// \param     [in]  uint16_t parameterLength
+///
+/// \return    none
+static void httpserver_fetchInfoJSON( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
+{
+   webtemplate_value_t  values[INFO_JSON_VALUES];
+   uint8_t  		      *ipAddress8b;
+   uint32_t 		      ipAddress;
+   uint32_t 		      netMask;
+   uint32_t 		      dnsAddress;
+   uint32_t 		      gatewayAddress;
+   const uint8_t* 	   stackMacAddress;
    
-   // panelcontroller monitor
    FreeRTOS_GetAddressConfiguration( &ipAddress, &netMask, &gatewayAddress, &dnsAddress );
    ipAddress8b       = (uint8_t*)(&ipAddress);
    stackMacAddress   = FreeRTOS_GetMACAddress();
-   dutyCycle = led_getDuty();
    guestCounter++;
-   stringLength = snprintf(0, 0, webpage_panelcontrollerMonitor, 
-                           ipAddress8b[0], ipAddress8b[1], ipAddress8b[2], ipAddress8b[3], 
-                           stackMacAddress[0], stackMacAddress[1], stackMacAddress[2], stackMacAddress[3], stackMacAddress[4], stackMacAddress[5], 
-                           guestCounter,
-                           tskKERNEL_VERSION_NUMBER,
-                           dutyCycle);
-   snprintf((char*)pageBuffer, stringLength+1, webpage_panelcontrollerMonitor, 
-                           ipAddress8b[0], ipAddress8b[1], ipAddress8b[2], ipAddress8b[3], 
-                           stackMacAddress[0], stackMacAddress[1], stackMacAddress[2], stackMacAddress[3], stackMacAddress[4], stackMacAddress[5], 
-                           guestCounter,
-                           tskKERNEL_VERSION_NUMBER, 
-                           dutyCycle);
    
-   // send fragment of the webpage//////////////////////////////////////////////
-   if( stringLength < pageBufferSize )
+   for( uint8_t i = 0; i < 4u; i++ )
    {
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+      values[INFO_JSON_IP0 + i].u = ipAddress8b[i];
    }
-   /////////////////////////////////////////////////////////////////////////////
-   
-   // bottom
-   stringLength = snprintf(0, 0, webpage_bottom_no_btn);
-   snprintf((char*)pageBuffer, stringLength+1, webpage_bottom_no_btn);
-   
-   // send fragment of the webpage//////////////////////////////////////////////
-   if( stringLength < pageBufferSize )
+   for( uint8_t i = 0; i < 6u; i++ )
    {
-      httpserver_lastPacket( xConnectedSocket );
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+      values[INFO_JSON_MAC0 + i].u = stackMacAddress[i];
    }
-   /////////////////////////////////////////////////////////////////////////////
+   values[INFO_JSON_GUESTS].u = guestCounter;
+   values[INFO_JSON_RTOS].s   = tskKERNEL_VERSION_NUMBER;
+   values[INFO_JSON_DUTY].u   = led_getDuty();
+   
+   httpserver_render( stream, &webtemplate_info_json, values );
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Send time as html fragment of the page. For the js fetch method.
+/// \brief     Send time as json fragment of the page. For the js fetch method.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, none
+/// \param     [in]  uint16_t parameterLength
 ///
 /// \return    none
-static void httpserver_fetchTime( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
+static void httpserver_fetchTimeJSON( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
 {
-   uint16_t stringLength;
-   uint32_t totalSeconds;
-   uint32_t days;
-   uint32_t hours;
-   uint32_t minutes;
-   uint32_t seconds;
-
-   static const char *webpage_fetchTime = {
-      "HTTP/1.1 200 OK\r\n"
-      "Content-Type: text/html\r\n\r\n" //"Content-Type: text/html; charset=utf-8\r\n"
-
-      //"<html><head></head>"
-      //"<body>"
-      "<p>Uptime: %d days, %d hours, %d minutes, %d seconds</p>"
-      //"</body></html>"
-   };
+   webtemplate_value_t  values[TIME_JSON_VALUES];
    
-   totalSeconds      = xTaskGetTickCount() * portTICK_PERIOD_MS / 1000;
-   days              = (totalSeconds / 86400);       
-   hours             = (totalSeconds / 3600) % 24;   
-   minutes           = (totalSeconds / 60) % 60;     
-   seconds           = totalSeconds % 60;  
-   
-   stringLength = snprintf(0, 0, webpage_fetchTime, 
-                           days, hours, minutes, seconds);
-      
-   snprintf((char*)pageBuffer, stringLength+1, webpage_fetchTime, 
-                           days, hours, minutes, seconds);
-   
-   httpserver_lastPacket( xConnectedSocket );
-   FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+   httpserver_timeValues( values );
+   httpserver_render( stream, &webtemplate_time_json, values );
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Send time as json fragment of the page. For the js fetch method.
+/// \brief     Reads the values of time.json, for the page and the events.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [out] webtemplate_value_t* values, TIME_JSON_VALUES
 ///
 /// \return    none
-static void httpserver_fetchTimeJSON( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
+static void httpserver_timeValues( webtemplate_value_t* values )
 {
-   uint16_t stringLength;
-   uint32_t totalSeconds;
-   uint32_t days;
-   uint32_t hours;
-   uint32_t minutes;
-   uint32_t seconds;
-
-   static const char *webpage_fetchTime = {
-      JSONHEADER
-      "{"
-        "\"d\": \"%d\","
-        "\"h\": \"%d\","
-        "\"m\": \"%d\","
-        "\"s\": \"%d\""
-      "}"
-   };
-   
-   totalSeconds      = xTaskGetTickCount() * portTICK_PERIOD_MS / 1000;
-   days              = (totalSeconds / 86400);       
-   hours             = (totalSeconds / 3600) % 24;   
-   minutes           = (totalSeconds / 60) % 60;     
-   seconds           = totalSeconds % 60;  
-   
-   stringLength = snprintf(0, 0, webpage_fetchTime, 
-                           days, hours, minutes, seconds);
-      
-   snprintf((char*)pageBuffer, stringLength+1, webpage_fetchTime, 
-                           days, hours, minutes, seconds);
+   uint32_t             totalSeconds;
    
-   httpserver_lastPacket( xConnectedSocket );
-   FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+   totalSeconds            = xTaskGetTickCount() * portTICK_PERIOD_MS / 1000;
+   values[TIME_JSON_D].u   = (totalSeconds / 86400);       
+   values[TIME_JSON_H].u   = (totalSeconds / 3600) % 24;   
+   values[TIME_JSON_M].u   = (totalSeconds / 60) % 60;     
+   values[TIME_JSON_S].u   = totalSeconds % 60;
 }
 
 // ----------------------------------------------------------------------------
 /// \brief     Send rtos data as json fragment of the page. For the js fetch method.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, none
+/// \param     [in]  uint16_t parameterLength
 ///
 /// \return    none
-static void httpserver_fetchRtosJSON( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
-{
-   uint16_t          stringLength;
-   size_t 		      freeheap;
-   const uint8_t* 	stackMacAddress;
-   osThreadId_t      tasks[7] = {0};
-   uint32_t          tasksNr = 7;
-   uint8_t           taskCount;
-   TaskStatus_t      *task;
-
-   static const char *webpage_fetchRtos = {
-      JSONHEADER
-      "{"
-         // heap
-        "\"heap\": \"%d\","
-        // tasks
-        "\"t1n\": \"%s\","
-        "\"t2n\": \"%s\","
-        "\"t3n\": \"%s\","
-        "\"t4n\": \"%s\","
-        "\"t5n\": \"%s\","
-        "\"t6n\": \"%s\","    
-        "\"t7n\": \"%s\","   
-        "\"t1p\": \"%d\","
-        "\"t2p\": \"%d\","
-        "\"t3p\": \"%d\","
-        "\"t4p\": \"%d\","
-        "\"t5p\": \"%d\","
-        "\"t6p\": \"%d\","
-        "\"t7p\": \"%d\""   
-      "}"
-   };
+static void httpserver_fetchRtosJSON( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
+{
+   webtemplate_value_t  values[RTOS_JSON_VALUES];
+   
+   httpserver_rtosValues( values );
+   httpserver_render( stream, &webtemplate_rtos_json, values );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Reads the values of rtos.json, for the page and the events.
+///
+/// \param     [out] webtemplate_value_t* values, RTOS_JSON_VALUES
+///
+/// \return    none
+static void httpserver_rtosValues( webtemplate_value_t* values )
+{
+   uint8_t              taskCount;
+   TaskStatus_t         *task;
 
-   freeheap    = xPortGetFreeHeapSize();
    taskCount   = uxTaskGetNumberOfTasks();
    task        = pvPortMalloc(taskCount * sizeof(TaskStatus_t));
    if (task != NULL)
@@ -1240,308 +2128,341 @@ static void httpserver_fetchRtosJSON( uint8_t* pageBuffer, uint16_t pageBufferSi
    }
    else
    {
-      return;
+      taskCount = 0;
    }
    
-   stringLength = snprintf(0, 0, webpage_fetchRtos, 
-                           freeheap, 
-                           task[0].pcTaskName, 
-                           task[1].pcTaskName,  
-                           task[2].pcTaskName,  
-                           task[3].pcTaskName,  
-                           task[4].pcTaskName,  
-                           task[5].pcTaskName, 
-                           task[6].pcTaskName,
-                           task[0].uxCurrentPriority, 
-                           task[1].uxCurrentPriority,                            
-                           task[2].uxCurrentPriority,                            
-                           task[3].uxCurrentPriority,                            
-                           task[4].uxCurrentPriority,                            
-                           task[5].uxCurrentPriority,                            
-                           task[6].uxCurrentPriority);                           
-
-   snprintf((char*)pageBuffer, stringLength+1, webpage_fetchRtos, 
-                           freeheap, 
-                           task[0].pcTaskName, 
-                           task[1].pcTaskName,  
-                           task[2].pcTaskName,  
-                           task[3].pcTaskName,  
-                           task[4].pcTaskName,  
-                           task[5].pcTaskName, 
-                           task[6].pcTaskName,
-                           task[0].uxCurrentPriority, 
-                           task[1].uxCurrentPriority,                            
-                           task[2].uxCurrentPriority,                            
-                           task[3].uxCurrentPriority,                            
-                           task[4].uxCurrentPriority,                            
-                           task[5].uxCurrentPriority,                            
-                           task[6].uxCurrentPriority);  
+   // the page shows the first seven tasks, t1n to t7n and t1p to t7p
+   values[RTOS_JSON_HEAP].u = xPortGetFreeHeapSize();
+   for( uint8_t i = 0; i < 7u; i++ )
+   {
+      values[RTOS_JSON_T1N + i].s = ( i < taskCount ) ? task[i].pcTaskName : "";
+      values[RTOS_JSON_T1P + i].u = ( i < taskCount ) ? task[i].uxCurrentPriority : 0u;
+   }
    
-   httpserver_lastPacket( xConnectedSocket );
-   FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+   // the names are in the task control blocks, they stay valid
    vPortFree(task);
 }
 
 // ----------------------------------------------------------------------------
 /// \brief     Send sensordata as json fragment of the page. For the js fetch method.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, none
+/// \param     [in]  uint16_t parameterLength
 ///
 /// \return    none
-static void httpserver_fetchSensorJSON( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
-{
-   uint16_t          stringLength;
-   float             temperature;
-   float             voltage;
-   const char*       released = {"Released"};
-   const char*       pushed = {"Pushed"};
-   const char*       btnState;
-
-   static const char *webpage_fetchSensor = {
-      JSONHEADER
-      "{"
-        "\"btn\": \"%s\","
-        "\"temp\": \"%.1f\","
-        "\"volt\": \"%.2f\""   
-      "}"
-   };
+static void httpserver_fetchSensorJSON( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
+{
+   webtemplate_value_t  values[SENSOR_JSON_VALUES];
+   
+   httpserver_sensorValues( values );
+   httpserver_render( stream, &webtemplate_sensor_json, values );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Reads the values of sensor.json, for the page and the events.
+///
+/// \param     [out] webtemplate_value_t* values, SENSOR_JSON_VALUES
+///
+/// \return    none
+static void httpserver_sensorValues( webtemplate_value_t* values )
+{
    
    if( HAL_GPIO_ReadPin( GPIOA, GPIO_PIN_0 ) != GPIO_PIN_RESET )
    {
-      btnState = released;
+      values[SENSOR_JSON_BTN].s = "Released";
    }
    else
    {
-      btnState = pushed;
+      values[SENSOR_JSON_BTN].s = "Pushed";
    }
-   temperature = monitor_getTemperature();
-   voltage     = monitor_getVoltage();
-   
-   stringLength = snprintf(0, 0, webpage_fetchSensor, 
-                           btnState,
-                           temperature,
-                           voltage);
-      
-   snprintf((char*)pageBuffer, stringLength+1, webpage_fetchSensor, 
-                           btnState,
-                           temperature,
-                           voltage);
-   
-   httpserver_lastPacket( xConnectedSocket );
-   FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+   values[SENSOR_JSON_TEMP].f = monitor_getTemperature();
+   values[SENSOR_JSON_VOLT].f = monitor_getVoltage();
 }
 
 // ----------------------------------------------------------------------------
 /// \brief     Send tcp/ip data as json fragment of the page. For the js fetch method.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, none
+/// \param     [in]  uint16_t parameterLength
 ///
 /// \return    none
-static void httpserver_fetchTcpIpJSON( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
-{
-   uint16_t          stringLength;
-   uint32_t          rxFrames;
-   uint32_t          txFrames;
-   uint32_t          rxData;
-   uint32_t          txData;
-
-   static const char *webpage_fetchTcpip = {
-      JSONHEADER
-      "{"
-         "\"rxF\": \"%d\","
-         "\"txF\": \"%d\","
-         "\"rxD\": \"%d\","
-         "\"txD\": \"%d\""
-      "}"
-   };
-   
-   txFrames    = usb_getTxFrames();
-   txData      = usb_getTxData();
-   rxFrames    = usb_getRxFrames();
-   rxData      = usb_getRxData();
-   
-   stringLength = snprintf(0, 0, webpage_fetchTcpip, 
-                           rxFrames,
-                           txFrames,
-                           rxData,
-                           txData);
-      
-   snprintf((char*)pageBuffer, stringLength+1, webpage_fetchTcpip, 
-                           rxFrames,
-                           txFrames,
-                           rxData,
-                           txData);
+static void httpserver_fetchTcpIpJSON( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
+{
+   webtemplate_value_t  values[TCPIP_JSON_VALUES];
    
-   httpserver_lastPacket( xConnectedSocket );
-   FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+   httpserver_tcpIpValues( values );
+   httpserver_render( stream, &webtemplate_tcpip_json, values );
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Returns the favicon on http request.
+/// \brief     Reads the values of tcpip.json, for the page and the events.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [out] webtemplate_value_t* values, TCPIP_JSON_VALUES
 ///
-/// \return    stringLength
-static uint16_t httpserver_favicon( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
+/// \return    none
+static void httpserver_tcpIpValues( webtemplate_value_t* values )
 {
-   // general page variables
-   uint16_t stringLength;
-   static const char *httpFavicon = {
-   "HTTP/1.1 200 OK\r\n"
-   "Content-Type: text/html\r\n" //"Content-Type: text/html; charset=utf-8\r\n"
-   "Connection: close\r\n\r\n"
-   "<html><head>"
-   "<link rel=\"shortcut icon\" href=\"data:image/gif;base64,R0lGODlhIAAgAHAAACwAAAAAIAAgAIf////s2+Pqt8j/wNT/v836wsv/xM7/wM7/w9L6ws38uMP4ZHTQCyfgAB7cABnXBhzeBh7bABjiAR/iAB3UAC3wdYfZAwvdAybkAyHqBivjABrgAyblASbiASHjAiLkACXwZ4XkABHsBDTgBCjVASnfASbgBS3eACnhACjiASnXBR7tfpHdAxHpAC3sAifiACXtACXiACbfACXjASfjABnmY3XbBgrYAB7qAB3tAB3tABrgAB3iAB7hAB7ZCCX31+z7vbLjycztw8T0v8fxw8Puysr3vsf1wMj/s6/6v93+m57oo7Xxnaz/nrX3m6rworD9mbH5nLH6nbL1pKPhaXLbBQPfABvhABDrAx3pABDeABDjABbfABXgARbdASXgfY/iABD9AjfcACLTByjoByfgAiffAyfkABvya4ngABDvAzPUAyLfASjjAiTlACndASfeACXkARzleIvZBRHqACvhACLoACjeASDnASjdBCHpaH7gDhfkAyvkBSLqACfeBSDgBybnBSrkBCbjACn67//3x7vz2N354Nz/0+D62t310tj72dr62Nn9zcH4rc7zgobqjKTskJ/6gaDvjqLsiKDwip/viZ7lhYnuanjjDhDjACDhABfmABjdARrnAh/hABniABruAS/ddILTBAzqACjiBiLsCC3hASPkAyPlBCTYAh72b4/iABXwBDXUAyPeACvlACvdACvdACbeACfgAinhBR7vdXLVABnnABvSARflBSDdBB/mAB/vaHnmEz70FULfFzvsFD3lFD7pCzrnEDrVFDMAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAI/wABCBxIsKDBgwgTKlzIsKHDhxAjPvwhABEBAgYIWDTAsWPGhwEcXeR4caQAjCcVPKyRS4uWllrEuJQpE4aWNQ8rxBSjRowYGD6BAv0p5iEILT19xopFtKnPh5a0wOgJYyhPnz3VaFlZZU2WqkFpii3q8IeCIEWKFCoiwMDJIigJAHmYRMkTJk2gPIHCly9evlMeUqniMksWwi4TJybbUJSWMGLWXFUqhinTrQ6PqlkTayhTykEfOhaK9SfVqU8zZ2I6VM1Qq0AhFklEKFGiQwFu07Ztm9FDRxUsWZIECZJw4Y+OW7L1sBfiLC5tztQCHanoUVl9EgUrNJdRpKU/Ky5dyvShLTFZcml/7TPLT8wNexX7JezXfDXFiOknZp9YMYkABijggAQWaOCBAAQEADs=\" />"   
-   "</body><body>"
-   "</head></html>"
-   };
-   
-   // generate message
-   stringLength = snprintf(0, 0, httpFavicon);
-   snprintf((char*)pageBuffer, stringLength+1, httpFavicon);
    
-   // send fragment of the webpage
-   if( stringLength < pageBufferSize )
-   {
-      httpserver_lastPacket( xConnectedSocket );
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
-   }
-   return stringLength;
+   values[TCPIP_JSON_RXF].u            = usb_getRxFrames();
+   values[TCPIP_JSON_TXF].u            = usb_getTxFrames();
+   values[TCPIP_JSON_RXD].u            = usb_getRxData();
+   values[TCPIP_JSON_TXD].u            = usb_getTxData();
+   values[TCPIP_JSON_TXIRQ].u          = usb_getTxInterrupts();
+   values[TCPIP_JSON_TXDROPTAIL].u     = tcpQueue.dropTail;
+   values[TCPIP_JSON_TXDROPHEAD].u     = tcpQueue.dropHead;
+   values[TCPIP_JSON_TXDROPEARLY].u    = tcpQueue.dropEarly;
+   values[TCPIP_JSON_TXWAIT].u         = tcpip_getTxWaits();
+   values[TCPIP_JSON_TXLOST].u         = tcpip_getTxErrors();
+   values[TCPIP_JSON_RXDROPTAIL].u     = usbQueue.dropTail;
+   values[TCPIP_JSON_RXDROPHEAD].u     = usbQueue.dropHead;
+   values[TCPIP_JSON_RXDROPEARLY].u    = usbQueue.dropEarly;
+   values[TCPIP_JSON_RXARMMAX].u       = usb_getRxArmCycles();
+   values[TCPIP_JSON_RXISRMAX].u       = usb_getRxIsrCycles();
+   values[TCPIP_JSON_RXFILTERED].u     = usb_getRxFiltered();
+   values[TCPIP_JSON_RXLENT].u         = tcpip_getRxLent();
+   values[TCPIP_JSON_RXCOPYCYC].u      = tcpip_getRxCopyCycles();
+   values[TCPIP_JSON_TXREF].u          = tcpip_getTxRef();
+   values[TCPIP_JSON_RXNOTETHII].u     = usb_getRxNotEthII();
+   values[TCPIP_JSON_RXETHERTYPE].u    = usb_getRxEtherType();
+   values[TCPIP_JSON_RXEVENTS].u       = tcpip_getRxEvents();
+   values[TCPIP_JSON_IPQUEUEMIN].u     = uxGetMinimumIPQueueSpace();
+   values[TCPIP_JSON_RXCHECKSUMERR].u  = tcpip_getRxChecksumErrors();
 }
 
+#if( QUEUE_SOJOURN == 1u )
 // ----------------------------------------------------------------------------
-/// \brief     Returns the REST API 200 status code ok
+/// \brief     Sends the sojourn time histograms of both queues as json. The
+///            histograms are log2 buckets of cpu cycles, see queuex.h.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, none
+/// \param     [in]  uint16_t parameterLength
 ///
 /// \return    none
-static void httpserver_200( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
+static void httpserver_fetchLatencyJSON( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
 {
-   // general page variables
-   uint16_t stringLength;
-   static const char *httpCode200 = {
-      "HTTP/1.1 200 OK\r\n"
-      "Content-Length: 0\r\n\r\n"
-   };
+   webtemplate_value_t cpuHz = { .u = SystemCoreClock };
    
-   // generate message
-   stringLength = snprintf(0, 0, httpCode200);
-   snprintf((char*)pageBuffer, stringLength+1, httpCode200);
+   httpserver_streamWrite( stream, JSONHEADER "{\"cpuHz\": ", strlen( JSONHEADER "{\"cpuHz\": " ) );
+   httpserver_streamValue( stream, WEBTEMPLATE_U32, cpuHz );
+   httpserver_histogramJSON( stream, "tcpWait", tcpQueue.waitHistogram );
+   httpserver_histogramJSON( stream, "tcpService", tcpQueue.serviceHistogram );
+   httpserver_histogramJSON( stream, "usbWait", usbQueue.waitHistogram );
+   httpserver_histogramJSON( stream, "usbService", usbQueue.serviceHistogram );
+   httpserver_streamWrite( stream, "}", 1u );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Writes a comma followed by a histogram as json array.
+///
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const char* name
+/// \param     [in]  const uint32_t* histogram
+///
+/// \return    none
+static void httpserver_histogramJSON( httpserver_stream_t* stream, const char* name, const uint32_t* histogram )
+{
+   webtemplate_value_t bucket;
    
-   // send fragment of the webpage
-   if( stringLength < pageBufferSize )
+   httpserver_streamWrite( stream, ",\"", 2u );
+   httpserver_streamWrite( stream, name, strlen( name ) );
+   httpserver_streamWrite( stream, "\": [", 4u );
+   for( uint8_t i = 0; i < QUEUEHISTOGRAMBUCKETS; i++ )
    {
-      httpserver_lastPacket( xConnectedSocket );
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+      if( i > 0 )
+      {
+         httpserver_streamWrite( stream, ",", 1u );
+      }
+      bucket.u = histogram[i];
+      httpserver_streamValue( stream, WEBTEMPLATE_U32, bucket );
    }
+   httpserver_streamWrite( stream, "]", 1u );
 }
+#endif
 
 // ----------------------------------------------------------------------------
-/// \brief     Returns the REST API 204 status code no content
+/// \brief     Sends all registered values in the prometheus text format,
+///            GET /metrics. A family is written once with its help and type,
+///            followed by the samples of every group which shares the table,
+///            e.g. of both queues. The values are streamed, nothing is
+///            allocated.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, none
+/// \param     [in]  uint16_t parameterLength
 ///
 /// \return    none
-static void httpserver_204( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
+static void httpserver_fetchMetrics( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
 {
-   // general page variables
-   uint16_t stringLength;
-   static const char *httpCode204 = {
-      "HTTP/1.1 204 No Content\r\n"
-      "Connection: close\r\n\r\n"
-   };
+   const metrics_group_t   *group;
+   const metrics_group_t   *shared;
+   const metrics_t         *family;
+   const metrics_t         *metric;
+   const metrics_t         *end;
    
-   // generate message
-   stringLength = snprintf(0, 0, httpCode204);
-   snprintf((char*)pageBuffer, stringLength+1, httpCode204);
-   
-   // send fragment of the webpage
-   if( stringLength < pageBufferSize )
+   httpserver_streamWrite( stream, METRICSHEADER, strlen( METRICSHEADER ) );
+   for( group = metrics_first(); group != NULL; group = group->next )
    {
-      httpserver_lastPacket( xConnectedSocket );
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+      // a table is written with the first group which uses it
+      for( shared = metrics_first(); shared != group && shared->metrics != group->metrics; shared = shared->next );
+      if( shared != group )
+      {
+         continue;
+      }
+      
+      end = group->metrics + group->count;
+      for( family = group->metrics; family < end; family = metric )
+      {
+         // the entries of a family follow each other
+         for( metric = family + 1; metric < end && strcmp( metric->name, family->name ) == 0; metric++ );
+         
+         if( family->help != NULL )
+         {
+            httpserver_streamWrite( stream, "# HELP ", 7u );
+            httpserver_streamWrite( stream, family->name, strlen( family->name ) );
+            httpserver_streamWrite( stream, " ", 1u );
+            httpserver_streamWrite( stream, family->help, strlen( family->help ) );
+            httpserver_streamWrite( stream, "\n", 1u );
+         }
+         httpserver_streamWrite( stream, "# TYPE ", 7u );
+         httpserver_streamWrite( stream, family->name, strlen( family->name ) );
+         if( family->type == METRICS_COUNTER )
+         {
+            httpserver_streamWrite( stream, " counter\n", 9u );
+         }
+         else
+         {
+            httpserver_streamWrite( stream, " gauge\n", 7u );
+         }
+         
+         for( shared = group; shared != NULL; shared = shared->next )
+         {
+            if( shared->metrics == group->metrics )
+            {
+               for( const metrics_t* sample = family; sample < metric; sample++ )
+               {
+                  httpserver_metricsSample( stream, shared, sample );
+               }
+            }
+         }
+      }
    }
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Returns the REST API 205 status code reset ui
+/// \brief     Writes one sample line, the name with the labels of the group
+///            and of the entry and the value.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const metrics_group_t* group
+/// \param     [in]  const metrics_t* metric, of the group
 ///
 /// \return    none
-static void httpserver_205( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
+static void httpserver_metricsSample( httpserver_stream_t* stream, const metrics_group_t* group, const metrics_t* metric )
 {
-   // general page variables
-   uint16_t stringLength;
-   static const char *httpCode205 = {
-      "HTTP/1.1 205 Reset Content\r\n"
-      "Content-Length: 0\r\n\r\n"
-   };
-   
-   // generate message
-   stringLength = snprintf(0, 0, httpCode205);
-   snprintf((char*)pageBuffer, stringLength+1, httpCode205);
+   webtemplate_value_t value;
    
-   // send fragment of the webpage
-   if( stringLength < pageBufferSize )
+   httpserver_streamWrite( stream, metric->name, strlen( metric->name ) );
+   if( group->labels != NULL || metric->labels != NULL )
    {
-      httpserver_lastPacket( xConnectedSocket );
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+      httpserver_streamWrite( stream, "{", 1u );
+      if( group->labels != NULL )
+      {
+         httpserver_streamWrite( stream, group->labels, strlen( group->labels ) );
+      }
+      if( group->labels != NULL && metric->labels != NULL )
+      {
+         httpserver_streamWrite( stream, ",", 1u );
+      }
+      if( metric->labels != NULL )
+      {
+         httpserver_streamWrite( stream, metric->labels, strlen( metric->labels ) );
+      }
+      httpserver_streamWrite( stream, "}", 1u );
    }
+   httpserver_streamWrite( stream, " ", 1u );
+   value.u = metrics_read( group, metric );
+   httpserver_streamValue( stream, WEBTEMPLATE_U32, value );
+   httpserver_streamWrite( stream, "\n", 1u );
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Returns the REST API 201 status code created
+/// \brief     Toggles the led.
 ///
-/// \param     [in]  uint8_t* pageBuffer
-/// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, none
+/// \param     [in]  uint16_t parameterLength
 ///
 /// \return    none
-static void httpserver_201( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
+static void httpserver_ledToggle( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
 {
-   // general page variables
-   uint16_t stringLength;
-   static const char *httpCode201 = {
-      "HTTP/1.1 201 Created\r\n"
-      //"Refresh: 0\r\n"
-      "Refresh: 0, url= \r\n"
-      "Content-Length: 0\r\n\r\n"
-   };
-   
-   // generate message
-   stringLength = snprintf(0, 0, httpCode201);
-   snprintf((char*)pageBuffer, stringLength+1, httpCode201);
-   
-   // send fragment of the webpage
-   if( stringLength < pageBufferSize )
+   // toggle led
+   led_toggle();
+
+   // send ok rest api
+   httpserver_streamWrite( stream, NOCONTENT, strlen( NOCONTENT ) );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Dims the led to the value of /led_set_value/<value>.
+///
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, duty cycle 0 to 40
+/// \param     [in]  uint16_t parameterLength
+///
+/// \return    none
+static void httpserver_ledSetValue( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
+{
+   uint32_t value = 0;
+   uint16_t i;
+
+   // set led into dim state
+   led_setDim();
+
+   // the parameter is not terminated, it is in the receive buffer
+   for( i = 0; i < parameterLength && i < 3u && parameter[i] >= '0' && parameter[i] <= '9'; i++ )
    {
-      httpserver_lastPacket( xConnectedSocket );
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
+      value = value * 10u + ( parameter[i] - '0' );
+   }
+
+   // check if value is valid
+   if( i > 0 && i == parameterLength && value <= 40 )
+   {
+      // set led pwm
+      led_setDuty(value);
    }
+
+   // send ok rest api
+   httpserver_streamWrite( stream, NOCONTENT, strlen( NOCONTENT ) );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sets the led into the pulse state.
+///
+/// \param     [in]  httpserver_stream_t* stream
+/// \param     [in]  const uint8_t* parameter, none
+/// \param     [in]  uint16_t parameterLength
+///
+/// \return    none
+static void httpserver_ledPulse( httpserver_stream_t* stream, const uint8_t* parameter, uint16_t parameterLength )
+{
+   // set led into pulse state
+   led_setPulse();
+
+   // send ok rest api
+   httpserver_streamWrite( stream, NOCONTENT, strlen( NOCONTENT ) );
 }
 
 // ----------------------------------------------------------------------------
 /// \brief     Returns the REST API 400 status code bad request
 ///
-/// \param     [in]  uint8_t* pageBuffer
+/// \param     [out] uint8_t* pageBuffer
 /// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
 ///
-/// \return    none
-static void httpserver_400( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
+/// \return    stringLength, 0 if the buffer is too small
+static uint16_t httpserver_400( uint8_t* pageBuffer, uint16_t pageBufferSize )
 {
    // general page variables
    uint16_t stringLength;
@@ -1551,45 +2472,31 @@ static void httpserver_400( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket
    };
    
    // generate message
-   stringLength = snprintf(0, 0, httpCode400);
-   snprintf((char*)pageBuffer, stringLength+1, httpCode400);
+   stringLength = snprintf((char*)pageBuffer, pageBufferSize, httpCode400);
    
-   // send fragment of the webpage
-   if( stringLength < pageBufferSize )
-   {
-      httpserver_lastPacket( xConnectedSocket );
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
-   }
+   return ( stringLength < pageBufferSize ) ? stringLength : 0;
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Returns the REST API 301 status code moved permanently
+/// \brief     Returns the REST API 500 status code internal server error
 ///
-/// \param     [in]  uint8_t* pageBuffer
+/// \param     [out] uint8_t* pageBuffer
 /// \param     [in]  uint16_t pageBufferSize
-/// \param     [in]  Socket_t xConnectedSocket
 ///
-/// \return    none
-static void httpserver_301( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket_t xConnectedSocket )
+/// \return    stringLength, 0 if the buffer is too small
+static uint16_t httpserver_500( uint8_t* pageBuffer, uint16_t pageBufferSize )
 {
    // general page variables
    uint16_t stringLength;
-   static const char *httpCode301 = {
-      "HTTP/1.1 301 Moved Permanently\r\n"
-      "Location: /home\r\n" 
+   static const char *httpCode500 = {
+      "HTTP/1.1 500 Internal Server Error\r\n"
       "Content-Length: 0\r\n\r\n"
    };
-
+   
    // generate message
-   stringLength = snprintf(0, 0, httpCode301 );
-   snprintf((char*)pageBuffer, stringLength+1, httpCode301 );
+   stringLength = snprintf((char*)pageBuffer, pageBufferSize, httpCode500);
    
-   // send fragment of the webpage
-   if( stringLength < pageBufferSize )
-   {
-      httpserver_lastPacket( xConnectedSocket );
-      FreeRTOS_send( xConnectedSocket, pageBuffer, stringLength, 0 );
-   }
+   return ( stringLength < pageBufferSize ) ? stringLength : 0;
 }
 
 // ----------------------------------------------------------------------------
@@ -1600,6 +2507,13 @@ static void httpserver_301( uint8_t* pageBuffer, uint16_t pageBufferSize, Socket
 /// \return    none
 static void httpserver_lastPacket( Socket_t xConnectedSocket )
 {
+#if( HTTPSERVER_SELECT == 1u )
+   // held back output goes before the fin, it is sent by the shutdown
+   if( responding->pending != NULL )
+   {
+      return;
+   }
+#endif
    xTrueValue = 1;
    FreeRTOS_setsockopt( xConnectedSocket, 0, FREERTOS_SO_CLOSE_AFTER_SEND, ( void * ) &xTrueValue, sizeof( xTrueValue ) );
 }
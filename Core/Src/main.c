@@ -54,18 +54,54 @@
 #include "led.h"
 #include "monitor.h"
 #include "dhcpserver.h"
+#include "metrics.h"
 
 // Private typedef *************************************************************
 
 // Private define *************************************************************
+#define QUEUEPUMP_PRIORITY    ( osPriorityHigh6 )     // below the mac task, above the servers
+#define QUEUEPUMP_TIMEOUT     ( pdMS_TO_TICKS(10u) )  // fallback poll interval
+
+// Latency benchmark, see Core/Web/latency.py. The cpu hog task keeps the cpu
+// busy at the priority of the servers for CPUHOG_BUSY ms of every
+// CPUHOG_PERIOD ms. With configUSE_IDLE_HOOK 1 in FreeRTOSConfig.h the queue
+// managers run from the idle hook instead of the pump task, as before.
+#define CPUHOG                ( 0u )                  // 1 = start the cpu hog task
+#define CPUHOG_PRIORITY       ( osPriorityNormal )    // of the servers
+#define CPUHOG_BUSY           ( 9u )
+#define CPUHOG_PERIOD         ( 10u )
 
 // Private variables **********************************************************
 queue_handle_t tcpQueue;
 queue_handle_t usbQueue;
+static metrics_group_t tcpQueueMetrics = { queue_metrics, QUEUE_METRICS, &tcpQueue, "queue=\"tcp\"", NULL };
+static metrics_group_t usbQueueMetrics = { queue_metrics, QUEUE_METRICS, &usbQueue, "queue=\"usb\"", NULL };
+static osThreadId_t queuePumpTaskHandle = NULL;
+#if( configUSE_IDLE_HOOK == 0 )
+static const osThreadAttr_t queuePumpTask_attributes = {
+  .name = "Queue-pump",
+  .stack_size = configMINIMAL_STACK_SIZE * 2,
+  .priority = (osPriority_t) QUEUEPUMP_PRIORITY,
+};
+#endif
+#if( CPUHOG == 1u )
+static const osThreadAttr_t cpuHogTask_attributes = {
+  .name = "Cpu-hog",
+  .stack_size = configMINIMAL_STACK_SIZE,
+  .priority = (osPriority_t) CPUHOG_PRIORITY,
+};
+#endif
    
 // Private function prototypes ************************************************
 static void systemClock_Config   ( void );
 static void init_btn             ( void );
+#if( configUSE_IDLE_HOOK == 0 )
+static void queuePump_task       ( void *pvParameters );
+#endif
+static void queuePump_notify     ( void );
+#if( CPUHOG == 1u )
+static void cpuHog_task          ( void *pvParameters );
+#endif
 
 // Private functions **********************************************************
 
@@ -83,23 +119,45 @@ int main( void )
    // Configure the system clock.
    systemClock_Config();
    
-   // Init peripherals
-   monitor_init();
-   led_init();
-   tcpip_init();
-   usb_init();
-   init_btn();
-   
-   // Set the queue on the tcpip stack io
+   // Set the queue on the tcpip stack io. The queues have to be ready before
+   // the usb device is started, because the usb isr is one of their users.
    tcpQueue.messageDirection  = TCP_TO_USB;
    tcpQueue.output            = usb_output;
+   tcpQueue.inFlightMax       = 8u;    // one transfer sending, one staged on the usb in endpoint, up to 4 frames each
+   tcpQueue.notify            = queuePump_notify;
+   tcpQueue.classify          = tcpip_classify;
+   tcpQueue.release           = tcpip_releaseTxBuffer;   // network buffers sent without a copy
+   tcpQueue.dropPolicy        = QUEUE_DROP_TAIL;    // the ip task holds and retries the frame
    queue_init(&tcpQueue);
    
    // Set the queue on the usb io
    usbQueue.messageDirection   = USB_TO_TCP;
    usbQueue.output             = tcpip_output;  
+   usbQueue.inFlightMax        = 6u;   // frames pending on the mac task or lent to the stack, < MACFRAMES
+   usbQueue.notify             = queuePump_notify;
+   usbQueue.classify           = tcpip_classify;
+   usbQueue.dropPolicy         = QUEUE_DROP_HEAD;   // the isr can't wait, keep the newest frames
    queue_init(&usbQueue);
    
+   // Publish the statistics of the queues on /metrics.
+   metrics_register( &tcpQueueMetrics );
+   metrics_register( &usbQueueMetrics );
+   
+   // Start the task running the queue managers.
+#if( configUSE_IDLE_HOOK == 0 )
+   queuePumpTaskHandle = osThreadNew( queuePump_task, NULL, &queuePumpTask_attributes );
+#endif
+#if( CPUHOG == 1u )
+   osThreadNew( cpuHog_task, NULL, &cpuHogTask_attributes );
+#endif
+   
+   // Init peripherals
+   monitor_init();
+   led_init();
+   tcpip_init();
+   usb_init();
+   init_btn();
+   
    // Init scheduler
    osKernelInitialize();
    
@@ -112,9 +170,28 @@ int main( void )
    }
 }
 
+#if( configUSE_IDLE_HOOK == 0 )
+// ----------------------------------------------------------------------------
+/// \brief     Queue pump task. Runs the queue managers of both directions as
+///            soon as a queue signals new messages or completed messages.
+///
+/// \param     [in]  void *pvParameters
+///
+/// \return    none
+static void queuePump_task( void *pvParameters )
+{
+   for( ;; )
+   {
+      ulTaskNotifyTake( pdTRUE, QUEUEPUMP_TIMEOUT );
+      queue_manager( &tcpQueue );
+      queue_manager( &usbQueue );
+   }
+}
+#else
 // ----------------------------------------------------------------------------
 /// \brief     Called by the task.c freertos module. Calling origin is the idle
-///            task.
+///            task. Runs the queue managers instead of the pump task, only to
+///            compare both with the latency benchmark.
 ///
 /// \param     none
 ///
@@ -124,6 +201,56 @@ void vApplicationIdleHook( void )
    queue_manager( &tcpQueue );
    queue_manager( &usbQueue );
 }
+#endif
+
+#if( CPUHOG == 1u )
+// ----------------------------------------------------------------------------
+/// \brief     Cpu hog task of the latency benchmark. Busy for CPUHOG_BUSY ms,
+///            then sleeping until the next period.
+///
+/// \param     [in]  void *pvParameters
+///
+/// \return    none
+static void cpuHog_task( void *pvParameters )
+{
+   TickType_t wake = xTaskGetTickCount();
+   
+   for( ;; )
+   {
+      while( xTaskGetTickCount() - wake < pdMS_TO_TICKS( CPUHOG_BUSY ) )
+      {
+      }
+      vTaskDelayUntil( &wake, pdMS_TO_TICKS( CPUHOG_PERIOD ) );
+   }
+}
+#endif
+
+// ----------------------------------------------------------------------------
+/// \brief     Notify function of the queues, wakes up the queue pump task. 
+///            Called from task and isr context.
+///
+/// \param     none
+///
+/// \return    none
+static void queuePump_notify( void )
+{
+   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+   
+   if( queuePumpTaskHandle == NULL )
+   {
+      return;
+   }
+   
+   if( xPortIsInsideInterrupt() == pdTRUE )
+   {
+      vTaskNotifyGiveFromISR( (TaskHandle_t)queuePumpTaskHandle, &xHigherPriorityTaskWoken );
+      portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+   }
+   else
+   {
+      xTaskNotifyGive( (TaskHandle_t)queuePumpTaskHandle );
+   }
+}
 
 // ----------------------------------------------------------------------------
 /// \brief     Called by the task.c freertos module. Calling origin is the idle
@@ -0,0 +1,145 @@
+// ****************************************************************************
+/// \file      metrics.c
+///
+/// \brief     Metrics C Source File
+///
+/// \details   Registry of the counters and gauges of the modules. A module 
+///            describes its values with a table of offsets into its 
+///            statistic and registers a group of them, a module with several
+///            instances registers one group per instance with the same table
+///            and different labels. Nothing is allocated, the groups are 
+///            linked into a list. The http server renders the registry as 
+///            prometheus text (/metrics).
+///
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+/// 
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person 
+///            obtaining a copy of this software and associated documentation 
+///            files (the "Software"), to deal in the Software without 
+///            restriction, including without limitation the rights to use, 
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the 
+///            Software is furnished to do so, subject to the following 
+///            conditions:
+///            
+///            The above copyright notice and this permission notice shall be 
+///            included in all copies or substantial portions of the Software.
+///            
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES 
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR 
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include <string.h>
+#include "metrics.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Private define *************************************************************
+
+// Private types     **********************************************************
+
+// Private variables **********************************************************
+static metrics_group_t*    groups;        // in the order of the registration
+
+// Global variables ***********************************************************
+const metrics_t metrics_socket[METRICS_SOCKET] =
+{
+   { "socket_receive_errors_total", "error=\"timeout\"",  "Errors of the receive calls of the server tasks", METRICS_COUNTER, METRICS_FIELD( metrics_socket_t, etimeout ), NULL },
+   { "socket_receive_errors_total", "error=\"enomem\"",   NULL,                                              METRICS_COUNTER, METRICS_FIELD( metrics_socket_t, enomem ),   NULL },
+   { "socket_receive_errors_total", "error=\"enotconn\"", NULL,                                              METRICS_COUNTER, METRICS_FIELD( metrics_socket_t, enotconn ), NULL },
+   { "socket_receive_errors_total", "error=\"eintr\"",    NULL,                                              METRICS_COUNTER, METRICS_FIELD( metrics_socket_t, eintr ),    NULL },
+   { "socket_receive_errors_total", "error=\"einval\"",   NULL,                                              METRICS_COUNTER, METRICS_FIELD( metrics_socket_t, einval ),   NULL },
+   { "socket_receive_errors_total", "error=\"other\"",    NULL,                                              METRICS_COUNTER, METRICS_FIELD( metrics_socket_t, eelse ),    NULL },
+};
+
+// Private function prototypes ************************************************
+
+// Private functions **********************************************************
+
+// ----------------------------------------------------------------------------
+/// \brief     Registers the values of a module. The group is appended to the
+///            registry, a group which is already registered is not appended
+///            again. Groups may be registered while the registry is read.
+///
+/// \param     [in]  metrics_group_t* group, statically allocated
+///
+/// \return    none
+void metrics_register( metrics_group_t* group )
+{
+   metrics_group_t **last;
+   
+   taskENTER_CRITICAL();
+   for( last = &groups; *last != NULL && *last != group; last = &(*last)->next );
+   if( *last == NULL )
+   {
+      // the group is complete before it is linked
+      group->next = NULL;
+      *last       = group;
+   }
+   taskEXIT_CRITICAL();
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Returns the first registered group, the others follow with next.
+///
+/// \param     none
+///
+/// \return    const metrics_group_t*, NULL if none is registered
+const metrics_group_t* metrics_first( void )
+{
+   return groups;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Reads a value of a group. The values are read without a lock,
+///            the aligned reads of the cortex-m4 are atomic.
+///
+/// \param     [in]  const metrics_group_t* group
+/// \param     [in]  const metrics_t* metric, of the group
+///
+/// \return    uint32_t value
+uint32_t metrics_read( const metrics_group_t* group, const metrics_t* metric )
+{
+   const volatile uint8_t *value;
+   
+   if( metric->read != NULL )
+   {
+      return metric->read();
+   }
+   
+   value = (const volatile uint8_t*)group->statistic + metric->offset;
+   switch( metric->size )
+   {
+      case 1u:
+         return *value;
+      case 2u:
+         return *(const volatile uint16_t*)value;
+      default:
+         return *(const volatile uint32_t*)value;
+   }
+}
+
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
@@ -57,24 +57,61 @@
 #include <stdio.h>
 
 // Private define *************************************************************
+#define QUEUE_NEXT(index, length)  ( ( (index) + 1u ) < (length) ? ( (index) + 1u ) : 0u )
+#if( QUEUE_SOJOURN == 1u )
+#define QUEUE_TIMESTAMP()           ( DWT->CYCCNT )
+#endif
 
 // Private types     **********************************************************
 
 // Private variables **********************************************************
 
+// Global variables ***********************************************************
+const metrics_t queue_metrics[QUEUE_METRICS] =
+{
+   { "queue_in_messages_total",     NULL,               "Messages enqueued",                            METRICS_COUNTER, METRICS_FIELD( queue_handle_t, dataPacketsIN ),   NULL },
+   { "queue_in_bytes_total",        NULL,               "Bytes enqueued",                               METRICS_COUNTER, METRICS_FIELD( queue_handle_t, bytesIN ),         NULL },
+   { "queue_out_messages_total",    NULL,               "Messages dequeued",                            METRICS_COUNTER, METRICS_FIELD( queue_handle_t, dataPacketsOUT ),  NULL },
+   { "queue_out_bytes_total",       NULL,               "Bytes dequeued",                               METRICS_COUNTER, METRICS_FIELD( queue_handle_t, bytesOUT ),        NULL },
+   { "queue_full_total",            NULL,               "Messages refused by a full lane",              METRICS_COUNTER, METRICS_FIELD( queue_handle_t, queueFull ),       NULL },
+   { "queue_drops_total",           "policy=\"tail\"",  "Messages dropped by the drop policy",          METRICS_COUNTER, METRICS_FIELD( queue_handle_t, dropTail ),        NULL },
+   { "queue_drops_total",           "policy=\"head\"",  NULL,                                           METRICS_COUNTER, METRICS_FIELD( queue_handle_t, dropHead ),        NULL },
+   { "queue_drops_total",           "policy=\"early\"", NULL,                                           METRICS_COUNTER, METRICS_FIELD( queue_handle_t, dropEarly ),       NULL },
+   { "queue_length",                NULL,               "Messages waiting in the lanes",                METRICS_GAUGE,   METRICS_FIELD( queue_handle_t, queueLength ),     NULL },
+   { "queue_length_peak",           NULL,               "Most messages waiting at once",                METRICS_GAUGE,   METRICS_FIELD( queue_handle_t, queueLengthPeak ), NULL },
+   { "queue_dispatches_total",      NULL,               "Messages handed to the output",                METRICS_COUNTER, METRICS_FIELD( queue_handle_t, dispatchCounter ), NULL },
+   { "queue_tail_errors_total",     NULL,               "Dequeues without a message in flight",         METRICS_COUNTER, METRICS_FIELD( queue_handle_t, tailError ),       NULL },
+   { "queue_spurious_errors_total", NULL,               "Releases of messages which are not in flight", METRICS_COUNTER, METRICS_FIELD( queue_handle_t, spuriousError ),   NULL },
+};
+
+// Private function prototypes ************************************************
+static void       queue_initLane     ( queue_lane_t *lane, queue_obj_t *queue, uint32_t length, uint32_t *pool, uint32_t poolSize, uint32_t bufferLength );
+static uint8_t    queue_laneReady    ( queue_lane_t *lane, uint32_t head );
+static uint32_t   queue_inFlight     ( queue_handle_t *queueHandle );
+static uint32_t   queue_poolUsed     ( queue_lane_t *lane, uint32_t head, uint32_t tail );
+static void       queue_releaseSlot  ( queue_lane_t *lane, uint32_t index, queue_handle_t *queueHandle );
+static void       queue_sweep        ( queue_lane_t *lane );
+static void       queue_dropOldest   ( queue_lane_t *lane, uint32_t head, queue_handle_t *queueHandle );
+static uint32_t   queue_random       ( queue_handle_t *queueHandle );
+#if( QUEUE_SOJOURN == 1u )
+static void       queue_histogram    ( uint32_t *histogram, uint32_t cycles );
+#endif
+static uint8_t*   queue_reserve      ( queue_lane_t *lane, uint8_t* end, uint32_t tail );
+static uint8_t*   queue_insert       ( uint8_t* dataStart, uint16_t dataLength, uint8_t* nextBuffer, void* reference, queue_lane_id_t laneId, queue_handle_t *queueHandle );
+
 // Private functions **********************************************************
 
 // ----------------------------------------------------------------------------
-/// \brief     Queue init.
+/// \brief     Queue init. Must be called before the producer and the consumer
+///            of the queue are running, e.g. before the usb device is started.
+///            The in flight window inFlightMax has to be set before, it is
+///            limited to 1..QUEUEINFLIGHTMAX.
 ///
 /// \param     [in/out] queue_handle_t *queueHandle
 ///
 /// \return    none
 void queue_init( queue_handle_t *queueHandle )
 {   
-   // disable irq to avoid racing conditions
-   __disable_irq(); 
-   
    // init statistics to 0
    queueHandle->dataPacketsIN          = 0;
    queueHandle->bytesIN                = 0;
@@ -83,203 +120,974 @@ void queue_init( queue_handle_t *queueHandle )
    queueHandle->queueFull              = 0;
    queueHandle->queueLengthPeak        = 0;
    queueHandle->queueLength            = 0;
-   queueHandle->headIndex              = QUEUELENGTH;
-   queueHandle->tailIndex              = QUEUELENGTH;
+   queueHandle->dispatchCounter        = 0;
+   queueHandle->controlBurst           = 0;
+   queueHandle->flushRequest           = 0;
+   queueHandle->dropTail               = 0;
+   queueHandle->dropHead               = 0;
+   queueHandle->dropEarly              = 0;
+   queueHandle->headDropRequest        = 0;
+   queueHandle->headDropDone           = 0;
+   queueHandle->randomState            = 0x2545F491u;
    
-   // cleanup the queue
-   for( uint8_t i = 0; i < QUEUELENGTH; i++ )
+   // set the drop watermark
+   if( queueHandle->dropWatermark == 0 || queueHandle->dropWatermark >= QUEUEBULKCAPACITY )
    {
-      memset( queueHandle->queue[i].data, 0x00, QUEUEBUFFERLENGTH );
-      queueHandle->queue[i].dataLength       = 0;
-      queueHandle->queue[i].messageStatus    = EMPTY_TX;
-      queueHandle->queue[i].dataStart        = NULL;
+      queueHandle->dropWatermark = ( QUEUEBULKCAPACITY * 3u ) / 4u;
    }
    
+   // limit the in flight window
+   if( queueHandle->inFlightMax == 0 )
+   {
+      queueHandle->inFlightMax = 1;
+   }
+   else if( queueHandle->inFlightMax > QUEUEINFLIGHTMAX )
+   {
+      queueHandle->inFlightMax = QUEUEINFLIGHTMAX;
+   }
+   
+#if( QUEUE_SOJOURN == 1u )
+   // clear the histograms and start the cycle counter
+   memset( queueHandle->waitHistogram, 0x00, sizeof(queueHandle->waitHistogram) );
+   memset( queueHandle->serviceHistogram, 0x00, sizeof(queueHandle->serviceHistogram) );
+   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+   DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+   
+   // cleanup the lanes
+   queue_initLane( &queueHandle->lane[QUEUE_LANE_CONTROL], queueHandle->controlQueue, QUEUECONTROLLENGTH, queueHandle->controlPool, QUEUECONTROLPOOLSIZE, QUEUECONTROLBUFFERLENGTH );
+   queue_initLane( &queueHandle->lane[QUEUE_LANE_BULK], queueHandle->bulkQueue, QUEUEBULKLENGTH, queueHandle->bulkPool, QUEUEBULKPOOLSIZE, QUEUEBUFFERLENGTH );
+   
    // queue status - the tail is used to transmitt messages. As long as the
-   // peripheral is sending the tail thus the queue status remains TAIL_BLOCKED 
+   // in flight window is exhausted the queue status remains TAIL_BLOCKED 
    // because of doing zero opy. After a transmission has been completed the 
    // queue status will be set back to TAIL_UNBLOCKED.
    queueHandle->queueStatus            = TAIL_UNBLOCKED;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Requests to drop all queued and in flight messages, e.g. after
+///            the output peripheral has been reset and will not complete the
+///            in flight messages anymore. The request is executed by the next
+///            call of the queue manager, so it is safe to call from an isr.
+///
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    none
+void queue_flush( queue_handle_t *queueHandle )
+{
+   queueHandle->flushRequest = 1;
    
-   // disable irq
-   __enable_irq(); 
+   if( queueHandle->notify != NULL )
+   {
+      queueHandle->notify();
+   }
 }
 
 // ----------------------------------------------------------------------------
 /// \brief     The queue manager checks for available data to send, and calls
-///            the linked peripheral output interface. NOTE! You have to provide
-///            and link an output interface function before calling this
-///            function.
+///            the linked peripheral output interface until the in flight
+///            window is full. The control lane is served first, but after
+///            QUEUECONTROLBURST control messages in a row a waiting bulk 
+///            message is sent. NOTE! You have to provide and link an output 
+///            interface function before calling this function.
 ///
 /// \param     [in/out] queue_handle_t *queueHandle
 ///
 /// \return    none
 inline void queue_manager( queue_handle_t *queueHandle )
 {      
-   // If the queue status is set to a blocked tail return.
-   if( queueHandle->queueStatus != TAIL_UNBLOCKED )
+   queue_lane_t   *control = &queueHandle->lane[QUEUE_LANE_CONTROL];
+   queue_lane_t   *bulk    = &queueHandle->lane[QUEUE_LANE_BULK];
+   queue_lane_t   *lane;
+   uint32_t       controlHead;
+   uint32_t       bulkHead;
+   uint32_t       head;
+   uint32_t       dispatch;
+   uint8_t        controlReady;
+   uint8_t        bulkReady;
+   
+   // Execute a pending flush request.
+   if( queueHandle->flushRequest != 0 )
    {
+      queueHandle->flushRequest = 0;
+      
+      for( uint32_t l = 0; l < QUEUELANES; l++ )
+      {
+         lane = &queueHandle->lane[l];
+         head = lane->headIndex;
+         __DMB();
+         
+         for( uint32_t i = lane->tailIndex; i != head; i = QUEUE_NEXT(i, lane->length) )
+         {
+            if( lane->queue[i].messageStatus != EMPTY_TX && lane->queue[i].reference != NULL )
+            {
+               queueHandle->release( lane->queue[i].reference );
+            }
+            lane->queue[i].messageStatus = EMPTY_TX;
+         }
+         lane->dispatchIndex = head;
+         
+         // Release the slots to the producer.
+         __DMB();
+         lane->tailIndex = head;
+      }
+      queueHandle->queueStatus = TAIL_UNBLOCKED;
       return;
    }
    
-   // Check if tail and header index are ok and if the message object in the 
-   // queue is ready for transmission.
-   if( queueHandle->tailIndex < queueHandle->headIndex 
-      && queueHandle->queue[queueHandle->tailIndex%QUEUELENGTH].messageStatus == READY_FOR_TX )
+   // Check if there are messages between dispatch and head. The heads are 
+   // read before the message objects, the barrier keeps that order (acquire).
+   controlHead = control->headIndex;
+   bulkHead = bulk->headIndex;
+   __DMB();
+   
+   // Drop the oldest waiting bulk messages requested by the producer.
+   while( queueHandle->headDropDone != queueHandle->headDropRequest )
    {
-      // To avoid racing conditions, immediately block the tail and set the
-      // message status to processing.
-      queueHandle->queue[queueHandle->tailIndex%QUEUELENGTH].messageStatus = PROCESSING_TX;
-      queueHandle->queueStatus = TAIL_BLOCKED;
+      queueHandle->headDropDone++;
+      queue_dropOldest( bulk, bulkHead, queueHandle );
+   }
+   
+   for( ;; )
+   {
+      // Check the in flight window.
+      if( queue_inFlight( queueHandle ) >= queueHandle->inFlightMax )
+      {
+         queueHandle->queueStatus = TAIL_BLOCKED;
+         return;
+      }
+      
+      // Select the lane.
+      controlReady = queue_laneReady( control, controlHead );
+      bulkReady = queue_laneReady( bulk, bulkHead );
+      if( controlReady && ( !bulkReady || queueHandle->controlBurst < QUEUECONTROLBURST ) )
+      {
+         lane = control;
+         if( bulkReady )
+         {
+            queueHandle->controlBurst++;
+         }
+      }
+      else if( bulkReady )
+      {
+         lane = bulk;
+         queueHandle->controlBurst = 0;
+      }
+      else
+      {
+         break;
+      }
+      dispatch = lane->dispatchIndex;
+      
+      // Set the message status to processing and move the dispatch index
+      // forward. This has to be done before the output is called, because the
+      // completion may run before the output function returns.
+      lane->queue[dispatch].messageStatus = PROCESSING_TX;
+      lane->queue[dispatch].dispatchSequence = queueHandle->dispatchCounter++;
+#if( QUEUE_SOJOURN == 1u )
+      lane->queue[dispatch].dispatchTime = QUEUE_TIMESTAMP();
+#endif
+      __DMB();
+      lane->dispatchIndex = QUEUE_NEXT(dispatch, lane->length);
       
       // Send the frame with the linked output function provided by the
       // communication peripheral.
-      if( queueHandle->output( queueHandle->queue[queueHandle->tailIndex%QUEUELENGTH].dataStart, queueHandle->queue[queueHandle->tailIndex%QUEUELENGTH].dataLength ) != 1 )
+      if( queueHandle->output( lane->queue[dispatch].dataStart, lane->queue[dispatch].dataLength ) != 1 )
       {
          // Peripheral is busy, set back states.
-         queueHandle->queue[queueHandle->tailIndex%QUEUELENGTH].messageStatus = READY_FOR_TX;
-         queueHandle->queueStatus = TAIL_UNBLOCKED;
+         lane->queue[dispatch].messageStatus = READY_FOR_TX;
+         lane->dispatchIndex = dispatch;
+         queueHandle->dispatchCounter--;
+         break;
       }
+#if( QUEUE_SOJOURN == 1u )
+      queue_histogram( queueHandle->waitHistogram, lane->queue[dispatch].dispatchTime - lane->queue[dispatch].enqueueTime );
+#endif
    }
+   
+   queueHandle->queueStatus = TAIL_UNBLOCKED;
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     The queue manager checks for available data to send, and calls
-///            the linled output interface.
+/// \brief     Releases the oldest in flight message after the linked output 
+///            interface has finished with it.
 ///
 /// \param     [in/out] queue_handle_t *queueHandle
 ///
 /// \return    none
 inline void queue_dequeue( queue_handle_t *queueHandle )
 {   
-   // Transmission complete unblock the tail.
-   queueHandle->queueStatus = TAIL_UNBLOCKED;
-  
-   if( queueHandle->queue[queueHandle->tailIndex%QUEUELENGTH].messageStatus != PROCESSING_TX )
+   queue_lane_t   *oldest = NULL;
+   queue_lane_t   *lane;
+   uint32_t       tail;
+   
+   // The oldest in flight message is the tail message of one lane, the
+   // dispatch sequence tells which one.
+   for( uint32_t l = 0; l < QUEUELANES; l++ )
+   {
+      lane = &queueHandle->lane[l];
+      queue_sweep( lane );
+      tail = lane->tailIndex;
+      if( tail == lane->dispatchIndex )
+      {
+         continue;
+      }
+      __DMB();
+      if( oldest == NULL || (int32_t)( lane->queue[tail].dispatchSequence - oldest->queue[oldest->tailIndex].dispatchSequence ) < 0 )
+      {
+         oldest = lane;
+      }
+   }
+   
+   // Check if there is a message in flight.
+   if( oldest == NULL )
+   {
+      queueHandle->tailError++;
+      return;
+   }
+   
+   tail = oldest->tailIndex;
+   if( oldest->queue[tail].messageStatus != PROCESSING_TX )
    {
       // Spurious error check for debugging
       queueHandle->spuriousError++;
       return;
    }
    
-   // Check if tail and head index are ok.
-   if( queueHandle->tailIndex < queueHandle->headIndex )
+   queue_releaseSlot( oldest, tail, queueHandle );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Releases an in flight message, selected by its data start 
+///            pointer. The messages may be released in any order, the tail 
+///            moves forward as soon as the oldest message is released.
+///
+/// \param     [in]     uint8_t* dataStart
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    none
+void queue_release( uint8_t* dataStart, queue_handle_t *queueHandle )
+{
+   queue_lane_t   *lane;
+   uint32_t       dispatch;
+   
+   for( uint32_t l = 0; l < QUEUELANES; l++ )
    {
-      // Update queue statistics.
-      queueHandle->dataPacketsOUT++;
-      queueHandle->bytesOUT += queueHandle->queue[queueHandle->tailIndex%QUEUELENGTH].dataLength; // note: this are the frame bytes without preamble and crc value
-      
-      // Set message status.
-      queueHandle->queue[queueHandle->tailIndex%QUEUELENGTH].data[0] = 0x00;
-      queueHandle->queue[queueHandle->tailIndex%QUEUELENGTH].messageStatus = EMPTY_TX;
-      
-      // Set tail number.
-      queueHandle->tailIndex++;
+      lane = &queueHandle->lane[l];
+      dispatch = lane->dispatchIndex;
+      __DMB();
       
-      // set queue length
-      queueHandle->queueLength = queueHandle->headIndex - queueHandle->tailIndex;
+      for( uint32_t i = lane->tailIndex; i != dispatch; i = QUEUE_NEXT(i, lane->length) )
+      {
+         if( lane->queue[i].messageStatus == PROCESSING_TX && lane->queue[i].dataStart == dataStart )
+         {
+            queue_releaseSlot( lane, i, queueHandle );
+            return;
+         }
+      }
    }
-   else
+   
+   // Spurious error check for debugging
+   queueHandle->spuriousError++;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Enqueue a new message into the bulk lane.
+///
+/// \param     [in]     uint8_t* dataStart
+/// \param     [in]     uint16_t dataLength
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    uint8_t* data pointer
+uint8_t* queue_enqueue( uint8_t* dataStart, uint16_t dataLength, queue_handle_t *queueHandle )
+{
+   return queue_enqueueLane( dataStart, dataLength, QUEUE_LANE_BULK, queueHandle );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Enqueue a new message into the ringbuffer of a lane. If the 
+///            ringbuffer is full, the slot will be used again until the head
+///            can move forward. Producer side function. The message has to 
+///            end within the head buffer of the lane returned before. If the
+///            message is dropped the unchanged head buffer is returned.
+///
+/// \param     [in]     uint8_t* dataStart
+/// \param     [in]     uint16_t dataLength
+/// \param     [in]     queue_lane_id_t laneId
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    uint8_t* data pointer
+inline uint8_t* queue_enqueueLane( uint8_t* dataStart, uint16_t dataLength, queue_lane_id_t laneId, queue_handle_t *queueHandle )
+{
+   queue_lane_t *lane = &queueHandle->lane[laneId];
+   uint32_t next = QUEUE_NEXT(lane->headIndex, lane->length);
+   uint32_t tail = lane->tailIndex;
+   uint8_t* nextBuffer = NULL;
+   
+   // Ringbuffer not full? One slot always stays free for receiving.
+   if( next != tail )
    {
-      queueHandle->tailError++;
+      // The slot at next must have been released by the consumer before it
+      // is reused (acquire).
+      __DMB();
+      
+      // Get the buffer for the next message.
+      nextBuffer = queue_reserve( lane, dataStart + dataLength, tail );
    }
+   
+   return queue_enqueueLaneAt( dataStart, dataLength, nextBuffer, laneId, queueHandle );
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Enqueue a new message into the ringbuffer. If the ringbuffer is
-///            full, the slot will be used again until the head can move
-///            forward.
+/// \brief     Enqueue a new message into the ringbuffer of a lane with the
+///            buffer of the next message given by the producer. The next 
+///            buffer is either behind the message within the head buffer, if
+///            the producer has received several messages at once, or a buffer
+///            from queue_reserveLane. Only with the bip buffer, the slot 
+///            buffers are fixed otherwise. The buffers are kept word aligned,
+///            a next buffer behind the message is aligned up, so the next 
+///            message has to start at least 3 bytes behind it. If nextBuffer
+///            is NULL or the ringbuffer is full, the message is dropped and
+///            the unchanged head buffer is returned. Producer side function.
 ///
+/// \param     [in]     uint8_t* dataStart
+/// \param     [in]     uint16_t dataLength
+/// \param     [in]     uint8_t* nextBuffer
+/// \param     [in]     queue_lane_id_t laneId
 /// \param     [in/out] queue_handle_t *queueHandle
 ///
 /// \return    uint8_t* data pointer
-inline uint8_t* queue_enqueue( uint8_t* dataStart, uint16_t dataLength, queue_handle_t *queueHandle )
+uint8_t* queue_enqueueLaneAt( uint8_t* dataStart, uint16_t dataLength, uint8_t* nextBuffer, queue_lane_id_t laneId, queue_handle_t *queueHandle )
+{
+   return queue_insert( dataStart, dataLength, nextBuffer, NULL, laneId, queueHandle );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Enqueue a message by reference into the ringbuffer of a lane.
+///            The message stays in the memory of the producer and takes no 
+///            buffer of the lane pool in bip-buffer mode, in slot mode its 
+///            slot stays unused. The reference is handed to the release 
+///            function of the queue as soon as the message is released or
+///            dropped. Producer side function.
+///
+/// \param     [in]     uint8_t* dataStart
+/// \param     [in]     uint16_t dataLength
+/// \param     [in]     void* reference, not NULL
+/// \param     [in]     queue_lane_id_t laneId
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    0 = ringbuffer full, 1 = message queued
+uint8_t queue_enqueueLaneRef( uint8_t* dataStart, uint16_t dataLength, void* reference, queue_lane_id_t laneId, queue_handle_t *queueHandle )
 {
-   // Integer type wrap arround check and set for head and tail index.
-   if( queueHandle->headIndex < QUEUELENGTH )
+   queue_lane_t *lane = &queueHandle->lane[laneId];
+   uint32_t head = lane->headIndex;
+   uint32_t next = QUEUE_NEXT(head, lane->length);
+   
+   if( next == lane->tailIndex )
    {
-      queueHandle->headIndex += QUEUELENGTH;
-      queueHandle->tailIndex += QUEUELENGTH;
+      queueHandle->queueFull++;
+      queueHandle->dropTail++;
+      lane->queueFull++;
+      return 0;
    }
    
-   // Ringbuffer not full?
-   if( (queueHandle->headIndex - queueHandle->tailIndex) < QUEUELENGTH-1 )
+#if( QUEUE_BIPBUFFER == 1u )
+   // The next message gets the unused head buffer.
+   queue_insert( dataStart, dataLength, lane->queue[head].data, reference, laneId, queueHandle );
+#else
+   queue_insert( dataStart, dataLength, lane->queue[next].data, reference, laneId, queueHandle );
+#endif
+   return 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Enqueues a message with the buffer of the next message, see 
+///            queue_enqueueLaneAt. A message with a reference is released 
+///            through the release function of the queue.
+///
+/// \param     [in]     uint8_t* dataStart
+/// \param     [in]     uint16_t dataLength
+/// \param     [in]     uint8_t* nextBuffer
+/// \param     [in]     void* reference, NULL for messages in the lane pool
+/// \param     [in]     queue_lane_id_t laneId
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    uint8_t* data pointer
+static uint8_t* queue_insert( uint8_t* dataStart, uint16_t dataLength, uint8_t* nextBuffer, void* reference, queue_lane_id_t laneId, queue_handle_t *queueHandle )
+{
+   queue_lane_t *lane = &queueHandle->lane[laneId];
+   uint32_t head = lane->headIndex;
+   uint32_t next = QUEUE_NEXT(head, lane->length);
+   uint32_t tail = lane->tailIndex;
+   
+   if( next != tail && nextBuffer != NULL )
    {
-      // Get actual index in the ringbuffer.
-      uint8_t arrayIndex = queueHandle->headIndex%QUEUELENGTH;
+      // The slot at next must have been released by the consumer before it
+      // is reused (acquire).
+      __DMB();
       
       // Set data length in the message object.
-      queueHandle->queue[arrayIndex].dataLength = dataLength;
+      lane->queue[head].dataLength = dataLength;
       
       // Set data start pointer in the databuffer of the message object.
-      queueHandle->queue[arrayIndex].dataStart = dataStart;
+      lane->queue[head].dataStart = dataStart;
+      lane->queue[head].reference = reference;
+      
+#if( QUEUE_SOJOURN == 1u )
+      lane->queue[head].enqueueTime = QUEUE_TIMESTAMP();
+#endif
       
       // Set message status in the message object.
-      queueHandle->queue[arrayIndex].messageStatus = READY_FOR_TX;
+      lane->queue[head].messageStatus = READY_FOR_TX;
       
       // Update queue statistics.
       queueHandle->frameCounter++;
       queueHandle->dataPacketsIN++;
       queueHandle->bytesIN += dataLength;
+      lane->dataPacketsIN++;
+      
+#if( QUEUE_BIPBUFFER == 1u )
+      // The free space check of queue_reserve relies on aligned buffers.
+      nextBuffer = lane->pool + ( ( (uint32_t)( nextBuffer - lane->pool ) + 3u ) & ~3u );
+#endif
+      
+      // Set the buffer of the next message.
+      lane->queue[next].data = nextBuffer;
+      
+      // Publish the message to the consumer. The message object has to be
+      // written completely before the new head is visible (release).
+      __DMB();
+      lane->headIndex = next;
+      
+      // set queue length
+      lane->queueLength = ( next + lane->length - tail ) % lane->length;
+      if( lane->queueLength > lane->queueLengthPeak )
+      {
+         lane->queueLengthPeak = lane->queueLength;
+      }
+      queueHandle->queueLength = queueHandle->lane[QUEUE_LANE_CONTROL].queueLength + queueHandle->lane[QUEUE_LANE_BULK].queueLength;
       if( queueHandle->queueLength > queueHandle->queueLengthPeak )
       {
          queueHandle->queueLengthPeak = queueHandle->queueLength;
       }
       
-      // Increment absolute head index
-      queueHandle->headIndex++;
-      
-      // set queue length
-      queueHandle->queueLength = queueHandle->headIndex - queueHandle->tailIndex;
-      
       // Set receiving state on the queue object.
-      queueHandle->queue[queueHandle->headIndex%QUEUELENGTH].messageStatus = RECEIVING_RX;
+      lane->queue[next].messageStatus = RECEIVING_RX;
+      
+      // Wake up the queue manager.
+      if( queueHandle->notify != NULL )
+      {
+         queueHandle->notify();
+      }
 
       // Return new pointer.
-      return queueHandle->queue[queueHandle->headIndex%QUEUELENGTH].data;
+      return nextBuffer;
    }
 
    // Queue is full, return old pointer.
    queueHandle->queueFull++;
-   return queueHandle->queue[queueHandle->headIndex%QUEUELENGTH].data;
+   queueHandle->dropTail++;
+   lane->queueFull++;
+   return lane->queue[head].data;
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Returns pointer to the head buffer of the queue.
+/// \brief     Returns pointer to the head buffer of the bulk lane.
 ///
 /// \param     [in/out] queue_handle_t *queueHandle
 ///
 /// \return    uint8_t* data pointer
 uint8_t* queue_getHeadBuffer( queue_handle_t *queueHandle )
 {
-   return queueHandle->queue[queueHandle->headIndex%QUEUELENGTH].data;
+   return queue_getLaneHeadBuffer( QUEUE_LANE_BULK, queueHandle );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Returns pointer to the head buffer of a lane.
+///
+/// \param     [in]     queue_lane_id_t laneId
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    uint8_t* data pointer
+uint8_t* queue_getLaneHeadBuffer( queue_lane_id_t laneId, queue_handle_t *queueHandle )
+{
+   queue_lane_t *lane = &queueHandle->lane[laneId];
+   return lane->queue[lane->headIndex].data;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Reserves the buffer behind end for a producer, which starts to
+///            receive the next message before the messages in the head buffer
+///            are enqueued. The buffer becomes the head buffer with 
+///            queue_enqueueLaneAt or queue_setLaneHeadBuffer. Producer side
+///            function.
+///
+/// \param     [in]     uint8_t* end
+/// \param     [in]     queue_lane_id_t laneId
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    uint8_t* buffer, NULL if there is not enough space
+uint8_t* queue_reserveLane( uint8_t* end, queue_lane_id_t laneId, queue_handle_t *queueHandle )
+{
+   queue_lane_t *lane = &queueHandle->lane[laneId];
+   uint32_t tail = lane->tailIndex;
+   
+   // The space behind tail must have been released before (acquire).
+   __DMB();
+   return queue_reserve( lane, end, tail );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sets the head buffer of a lane to a buffer from 
+///            queue_reserveLane, after the messages received in front of it
+///            have been enqueued or dropped. Producer side function.
+///
+/// \param     [in]     uint8_t* buffer
+/// \param     [in]     queue_lane_id_t laneId
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    none
+void queue_setLaneHeadBuffer( uint8_t* buffer, queue_lane_id_t laneId, queue_handle_t *queueHandle )
+{
+   queue_lane_t *lane = &queueHandle->lane[laneId];
+   lane->queue[lane->headIndex].data = buffer;
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Returns pointer to the tail buffer of the queue.
+/// \brief     Returns pointer to the tail buffer of the bulk lane.
 ///
 /// \param     [in/out] queue_handle_t *queueHandle
 ///
 /// \return    uint8_t* data pointer
 uint8_t* queue_getTailBuffer( queue_handle_t *queueHandle )
 {
-   return queueHandle->queue[queueHandle->tailIndex%QUEUELENGTH].data;
+   queue_lane_t *lane = &queueHandle->lane[QUEUE_LANE_BULK];
+   return lane->queue[lane->tailIndex].data;
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Check if queue is full.
+/// \brief     Check if the bulk lane is full.
 ///
 /// \param     [in/out] queue_handle_t *queueHandle
 ///
 /// \return    0 = full, 1 = not full
 uint8_t queue_isFull( queue_handle_t *queueHandle )
 {
-      // Ringbuffer not full?
-   if( (queueHandle->headIndex - queueHandle->tailIndex) < QUEUELENGTH-1 )
+   return queue_isLaneFull( QUEUE_LANE_BULK, queueHandle );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Check if a lane is full.
+///
+/// \param     [in]     queue_lane_id_t laneId
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    0 = full, 1 = not full
+uint8_t queue_isLaneFull( queue_lane_id_t laneId, queue_handle_t *queueHandle )
+{
+   queue_lane_t *lane = &queueHandle->lane[laneId];
+   
+   // Ringbuffer not full?
+   if( QUEUE_NEXT(lane->headIndex, lane->length) != lane->tailIndex )
+   {
+      return 1;
+   }
+   return 0;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Applies the drop policy to the next message of a lane. Producer
+///            side function, to be called before the message is written into
+///            the head buffer. Tail drop rejects the message if the lane is 
+///            full. Above the watermark of the bulk lane, head drop lets the
+///            queue manager drop the oldest waiting message and early drop 
+///            rejects the message with a probability rising up to the full 
+///            pool. The watermark is compared with the pool bytes used by
+///            the messages, the pool is full long before the descriptors if
+///            the messages are large.
+///
+/// \param     [in]     queue_lane_id_t laneId
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    0 = message dropped, 1 = message admitted
+uint8_t queue_admit( queue_lane_id_t laneId, queue_handle_t *queueHandle )
+{
+   queue_lane_t   *lane    = &queueHandle->lane[laneId];
+   uint32_t       head     = lane->headIndex;
+   uint32_t       tail     = lane->tailIndex;
+   uint32_t       watermark= queueHandle->dropWatermark;
+   uint32_t       used;
+   
+   if( QUEUE_NEXT(head, lane->length) == tail )
+   {
+      queueHandle->queueFull++;
+      queueHandle->dropTail++;
+      lane->queueFull++;
+      return 0;
+   }
+   
+   if( laneId != QUEUE_LANE_BULK )
+   {
+      return 1;
+   }
+   
+   // The buffers from tail to head have to be released before they are
+   // measured (acquire).
+   __DMB();
+   used = queue_poolUsed( lane, head, tail );
+   if( used < watermark )
+   {
+      return 1;
+   }
+   
+   switch( queueHandle->dropPolicy )
+   {
+      case QUEUE_DROP_HEAD:
+         queueHandle->headDropRequest++;
+         break;
+         
+      case QUEUE_DROP_EARLY:
+         if( queue_random( queueHandle ) % ( QUEUEBULKCAPACITY - watermark ) <= used - watermark )
+         {
+            queueHandle->dropEarly++;
+            return 0;
+         }
+         break;
+         
+      default:
+         break;
+   }
+   return 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Returns the lane for a message, selected by the classify 
+///            function of the queue. Messages which do not fit into the 
+///            buffers of the control lane go to the bulk lane.
+///
+/// \param     [in]     uint8_t* data
+/// \param     [in]     uint16_t length
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    queue_lane_id_t lane
+queue_lane_id_t queue_classify( uint8_t* data, uint16_t length, queue_handle_t *queueHandle )
+{
+   if( queueHandle->classify == NULL || length > QUEUECONTROLBUFFERLENGTH )
+   {
+      return QUEUE_LANE_BULK;
+   }
+   return queueHandle->classify( data, length );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Initialises a lane of the queue.
+///
+/// \param     [in/out] queue_lane_t *lane
+/// \param     [in]     queue_obj_t *queue
+/// \param     [in]     uint32_t length
+/// \param     [in]     uint32_t *pool
+/// \param     [in]     uint32_t poolSize
+/// \param     [in]     uint32_t bufferLength
+///
+/// \return    none
+static void queue_initLane( queue_lane_t *lane, queue_obj_t *queue, uint32_t length, uint32_t *pool, uint32_t poolSize, uint32_t bufferLength )
+{
+   lane->queue             = queue;
+   lane->length            = length;
+   lane->pool              = (uint8_t*)pool;
+   lane->poolSize          = poolSize;
+   lane->bufferLength      = bufferLength;
+   lane->headIndex         = 0;
+   lane->tailIndex         = 0;
+   lane->dispatchIndex     = 0;
+   lane->dataPacketsIN     = 0;
+   lane->dataPacketsOUT    = 0;
+   lane->queueFull         = 0;
+   lane->queueLength       = 0;
+   lane->queueLengthPeak   = 0;
+   
+   memset( pool, 0x00, poolSize );
+   for( uint32_t i = 0; i < length; i++ )
+   {
+#if( QUEUE_BIPBUFFER == 1u )
+      queue[i].data              = lane->pool;
+#else
+      queue[i].data              = lane->pool + i * ( ( bufferLength + 3u ) & ~3u );
+#endif
+      queue[i].dataLength        = 0;
+      queue[i].messageStatus     = EMPTY_TX;
+      queue[i].dataStart         = NULL;
+      queue[i].reference         = NULL;
+      queue[i].dispatchSequence  = 0;
+   }
+   
+   // the head slot is the one the producer is writing into
+   queue[0].messageStatus = RECEIVING_RX;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Checks if the next message of a lane is ready to be sent.
+///
+/// \param     [in]     queue_lane_t *lane
+/// \param     [in]     uint32_t head
+///
+/// \return    1 = ready, 0 = nothing to send
+static uint8_t queue_laneReady( queue_lane_t *lane, uint32_t head )
+{
+   uint32_t dispatch = lane->dispatchIndex;
+   
+   if( dispatch != head && lane->queue[dispatch].messageStatus == READY_FOR_TX )
    {
       return 1;
    }
    return 0;
 }
 
+// ----------------------------------------------------------------------------
+/// \brief     Returns the number of in flight messages of all lanes.
+///
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    uint32_t in flight messages
+static uint32_t queue_inFlight( queue_handle_t *queueHandle )
+{
+   queue_lane_t   *lane;
+   uint32_t       inFlight = 0;
+   
+   for( uint32_t l = 0; l < QUEUELANES; l++ )
+   {
+      lane = &queueHandle->lane[l];
+      inFlight += ( lane->dispatchIndex + lane->length - lane->tailIndex ) % lane->length;
+   }
+   return inFlight;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Returns the pool bytes used by the messages from tail to head.
+///            While the used region wraps, the unused end of the pool is 
+///            counted too. Messages enqueued by reference use no pool bytes.
+///
+/// \param     [in]     queue_lane_t *lane
+/// \param     [in]     uint32_t head
+/// \param     [in]     uint32_t tail
+///
+/// \return    uint32_t bytes
+static uint32_t queue_poolUsed( queue_lane_t *lane, uint32_t head, uint32_t tail )
+{
+   uint8_t* oldest   = lane->queue[tail].data;
+   uint8_t* current  = lane->queue[head].data;
+   
+   if( current >= oldest )
+   {
+      return (uint32_t)( current - oldest );
+   }
+   return lane->poolSize - (uint32_t)( oldest - current );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Marks an in flight message as done and moves the tail over all
+///            released messages.
+///
+/// \param     [in/out] queue_lane_t *lane
+/// \param     [in]     uint32_t index
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    none
+static void queue_releaseSlot( queue_lane_t *lane, uint32_t index, queue_handle_t *queueHandle )
+{
+   // Update queue statistics.
+   queueHandle->dataPacketsOUT++;
+   queueHandle->bytesOUT += lane->queue[index].dataLength; // note: this are the frame bytes without preamble and crc value
+   lane->dataPacketsOUT++;
+#if( QUEUE_SOJOURN == 1u )
+   queue_histogram( queueHandle->serviceHistogram, QUEUE_TIMESTAMP() - lane->queue[index].dispatchTime );
+#endif
+   
+   // Set message status. A message enqueued by reference goes back to its
+   // owner, its buffer in the lane pool may already belong to the next one.
+   if( lane->queue[index].reference != NULL )
+   {
+      queueHandle->release( lane->queue[index].reference );
+   }
+   else
+   {
+      lane->queue[index].data[0] = 0x00;
+   }
+   lane->queue[index].messageStatus = EMPTY_TX;
+   
+   // Move the tail over the released messages.
+   queue_sweep( lane );
+   
+   // Wake up the queue manager, the next message may be sent now.
+   if( queueHandle->notify != NULL )
+   {
+      queueHandle->notify();
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Returns the buffer for the message after the head message of a
+///            lane, which ends at end. In slot mode this is the next slot. In
+///            bip-buffer mode it is the next word aligned address behind the
+///            head message or the start of the pool, if there are 
+///            bufferLength contiguous bytes not used by the messages from tail
+///            to head.
+///
+/// \param     [in/out] queue_lane_t *lane
+/// \param     [in]     uint8_t* end
+/// \param     [in]     uint32_t tail
+///
+/// \return    uint8_t* buffer, NULL if there is not enough space
+static uint8_t* queue_reserve( queue_lane_t *lane, uint8_t* end, uint32_t tail )
+{
+#if( QUEUE_BIPBUFFER == 1u )
+   uint8_t* pool     = lane->pool;
+   uint8_t* poolEnd  = pool + lane->poolSize;
+   uint8_t* oldest   = lane->queue[tail].data;
+   uint8_t* current  = lane->queue[lane->headIndex].data;
+   uint8_t* start;
+   
+   // A message not ending within the head buffer takes the whole buffer.
+   if( end <= current || end > current + lane->bufferLength )
+   {
+      end = current + lane->bufferLength;
+   }
+   start = pool + ( ( (uint32_t)( end - pool ) + 3u ) & ~3u );
+   
+   if( start > oldest )
+   {
+      // The used region does not wrap, try behind it or at the pool start.
+      if( start + lane->bufferLength <= poolEnd )
+      {
+         return start;
+      }
+      if( pool + lane->bufferLength <= oldest )
+      {
+         return pool;
+      }
+      return NULL;
+   }
+   
+   // The used region wraps, the free space is between head and tail.
+   if( start + lane->bufferLength <= oldest )
+   {
+      return start;
+   }
+   return NULL;
+#else
+   ( void ) end;
+   ( void ) tail;
+   return lane->queue[QUEUE_NEXT(lane->headIndex, lane->length)].data;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Moves the tail of a lane over the released and dropped messages
+///            and hands their buffers back to the producer. Release side 
+///            function.
+///
+/// \param     [in/out] queue_lane_t *lane
+///
+/// \return    none
+static void queue_sweep( queue_lane_t *lane )
+{
+   uint32_t tail     = lane->tailIndex;
+   uint32_t dispatch = lane->dispatchIndex;
+   
+   if( tail == dispatch || lane->queue[tail].messageStatus != EMPTY_TX )
+   {
+      return;
+   }
+   
+   while( tail != dispatch && lane->queue[tail].messageStatus == EMPTY_TX )
+   {
+      tail = QUEUE_NEXT(tail, lane->length);
+   }
+   
+   // All accesses to the slots have to be finished before the new tail is 
+   // visible (release).
+   __DMB();
+   lane->tailIndex = tail;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Drops the oldest message of a lane which has not been handed to
+///            the output yet. Queue manager side function. The message is 
+///            skipped by the dispatch index and released by the next sweep, 
+///            or right away if no message is in flight.
+///
+/// \param     [in/out] queue_lane_t *lane
+/// \param     [in]     uint32_t head
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    none
+static void queue_dropOldest( queue_lane_t *lane, uint32_t head, queue_handle_t *queueHandle )
+{
+   uint32_t dispatch = lane->dispatchIndex;
+   uint32_t next     = QUEUE_NEXT(dispatch, lane->length);
+   
+   if( dispatch == head || lane->queue[dispatch].messageStatus != READY_FOR_TX )
+   {
+      return;
+   }
+   
+   if( lane->queue[dispatch].reference != NULL )
+   {
+      queueHandle->release( lane->queue[dispatch].reference );
+   }
+   lane->queue[dispatch].messageStatus = EMPTY_TX;
+   queueHandle->dropHead++;
+   __DMB();
+   
+   // Without messages in flight there is no release which could move the 
+   // tail concurrently, so the manager hands the buffer back itself.
+   if( lane->tailIndex == dispatch )
+   {
+      lane->dispatchIndex = next;
+      lane->tailIndex = next;
+   }
+   else
+   {
+      lane->dispatchIndex = next;
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Xorshift pseudo random number generator for the early drop.
+///
+/// \param     [in/out] queue_handle_t *queueHandle
+///
+/// \return    uint32_t random number
+static uint32_t queue_random( queue_handle_t *queueHandle )
+{
+   uint32_t x = queueHandle->randomState;
+   
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   queueHandle->randomState = x;
+   return x;
+}
+
+#if( QUEUE_SOJOURN == 1u )
+// ----------------------------------------------------------------------------
+/// \brief     Counts a time in the log2 bucket of a histogram.
+///
+/// \param     [in/out] uint32_t *histogram
+/// \param     [in]     uint32_t cycles
+///
+/// \return    none
+static void queue_histogram( uint32_t *histogram, uint32_t cycles )
+{
+   uint32_t bucket = 32u - __CLZ( cycles );
+   
+   if( bucket >= QUEUEHISTOGRAMBUCKETS )
+   {
+      bucket = QUEUEHISTOGRAMBUCKETS - 1u;
+   }
+   histogram[bucket]++;
+}
+#endif
+
 /********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
\ No newline at end of file
@@ -53,15 +53,20 @@
 #include "dhcpserver.h"
 #include "dnsserver.h"
 #include "queuex.h"
+#include "checksum.h"
+#include "metrics.h"
 #include "main.h"
 
 #include "cmsis_os.h"
+#include "semphr.h"
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_Sockets.h"
 #include "FreeRTOS_IP_Private.h"
 #include "NetworkBufferManagement.h"
 
 // Private define *************************************************************
+#define MACFRAMES       ( 8u )   // > in flight window of the usbQueue
+#define TXREFERENCES    ( QUEUEBULKLENGTH + QUEUECONTROLLENGTH )   // >= messages the tcpQueue can hold
 
 // Private types     **********************************************************
 typedef struct FRAME_s
@@ -76,6 +81,13 @@ typedef struct MAC_STATISTIC_s
    uint32_t counterTxFrame;
    uint32_t counterRxData;
    uint32_t counterTxData;
+   uint32_t counterTxWait;
+   uint32_t counterRxLent;
+   uint32_t counterRxCopyCycles;
+   uint32_t counterTxRef;
+   uint32_t counterRxEvent;
+   uint32_t counterRxChecksum;
+   uint32_t counterRxMacError;   // frames lost without a network buffer
 }MAC_STATISTIC_t;
 
 // Global variables ***********************************************************
@@ -88,12 +100,23 @@ const uint8_t ucDNSServerAddressFLASH[4]  = {IP1, IP2, IP3, IP4};
 // Private variables **********************************************************
 // Use by the pseudo random number generator.
 static MAC_STATISTIC_t  mac_statistic;
+static uint32_t         malloc_fail_counter;
 static const char       *mainHOST_NAME                   = {HOSTNAME};
 static const char       *mainDEVICE_NICK_NAME            = {DEVICENAME};
 static const char       *mainHOST_NAMEcapLetters         = {HOSTNAMECAP};
 static const char       *mainDEVICE_NICK_NAMEcapLetters  = {DEVICENAMECAP};
-static FlagStatus       processingIdle = SET;
-static FRAME_t          currentFrame;
+static FRAME_t          macFrames[MACFRAMES];        // frames handed over to the mac task, written by tcpip_output
+static volatile uint32_t macFramesHead;               // written by tcpip_output only
+static volatile uint32_t macFramesTail;               // written by the mac task only
+static SemaphoreHandle_t txSpaceSemaphore = NULL;      // given if the tcpQueue released a frame
+#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+static uint8_t*         rxReleased[MACFRAMES];       // lent frames released by the stack, written by tcpip_releaseRxBuffer
+static volatile uint32_t rxReleasedHead;              // written by tcpip_releaseRxBuffer only
+static volatile uint32_t rxReleasedTail;              // written by the mac task only
+#endif
+static NetworkBufferDescriptor_t* txReleased[TXREFERENCES]; // sent network buffers, written by tcpip_releaseTxBuffer
+static volatile uint32_t txReleasedHead;              // written by tcpip_releaseTxBuffer only
+static volatile uint32_t txReleasedTail;              // written by the mac task only
 extern queue_handle_t   tcpQueue;
 extern queue_handle_t   usbQueue;
 static leasetableObj_t  leasetable[DHCPPOOLSIZE] =
@@ -127,6 +150,36 @@ static void       tcpip_rngDeInit           ( void );
 static uint32_t   tcpip_getRandomNumber     ( void );
 static void       tcpip_macTask             ( void *pvParameters );
 static void       tcpip_invokeMacTask       ( void );
+static uint8_t    tcpip_checksumFrame       ( uint8_t* dst, const uint8_t* frame, uint16_t length );
+#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+static uint8_t    tcpip_canLend             ( const uint8_t* frame, uint16_t length );
+#endif
+static uint32_t   tcpip_getMallocFails      ( void );
+static uint32_t   tcpip_getFreeHeap         ( void );
+static uint32_t   tcpip_getMinimumFreeHeap  ( void );
+static uint32_t   tcpip_getMinimumBuffers   ( void );
+static uint32_t   tcpip_getMinimumIPQueue   ( void );
+
+// the values on /metrics, the mac statistic and the resources of the stack
+static const metrics_t tcpip_metrics[] =
+{
+   { "tcpip_output_frames_total",     NULL,                   "Frames of the stack enqueued to the usb",                  METRICS_COUNTER, METRICS_FIELD( MAC_STATISTIC_t, counterRxFrame ),      NULL },
+   { "tcpip_output_references_total", NULL,                   "Frames of the stack enqueued without a copy",              METRICS_COUNTER, METRICS_FIELD( MAC_STATISTIC_t, counterTxRef ),        NULL },
+   { "tcpip_output_waits_total",      NULL,                   "Waits of the stack for space in the usb queue",            METRICS_COUNTER, METRICS_FIELD( MAC_STATISTIC_t, counterTxWait ),       NULL },
+   { "tcpip_output_errors_total",     NULL,                   "Frames of the stack lost by the network interface",        METRICS_COUNTER, METRICS_FIELD( MAC_STATISTIC_t, counterTxError ),      NULL },
+   { "tcpip_input_frames_total",      NULL,                   "Frames of the usb processed by the mac task",              METRICS_COUNTER, METRICS_FIELD( MAC_STATISTIC_t, counterTxFrame ),      NULL },
+   { "tcpip_input_lent_total",        NULL,                   "Frames of the usb lent to the stack without a copy",       METRICS_COUNTER, METRICS_FIELD( MAC_STATISTIC_t, counterRxLent ),       NULL },
+   { "tcpip_input_copy_cycles_total", NULL,                   "Cycles of copying and checksumming the frames of the usb", METRICS_COUNTER, METRICS_FIELD( MAC_STATISTIC_t, counterRxCopyCycles ), NULL },
+   { "tcpip_input_events_total",      NULL,                   "Receive events posted to the ip task",                     METRICS_COUNTER, METRICS_FIELD( MAC_STATISTIC_t, counterRxEvent ),      NULL },
+   { "tcpip_input_rejected_total",    "reason=\"checksum\"",  "Frames of the usb rejected by the mac task",               METRICS_COUNTER, METRICS_FIELD( MAC_STATISTIC_t, counterRxChecksum ),   NULL },
+   { "tcpip_input_rejected_total",    "reason=\"nobuffer\"",  NULL,                                                       METRICS_COUNTER, METRICS_FIELD( MAC_STATISTIC_t, counterRxMacError ),   NULL },
+   { "tcpip_network_buffers_min",     NULL,                   "Fewest free network buffers so far",                       METRICS_GAUGE,   0, 0,                                                  tcpip_getMinimumBuffers },
+   { "tcpip_ip_queue_min",            NULL,                   "Fewest free places in the queue of the ip task so far",    METRICS_GAUGE,   0, 0,                                                  tcpip_getMinimumIPQueue },
+   { "heap_free_bytes",               NULL,                   "Free bytes of the rtos heap",                              METRICS_GAUGE,   0, 0,                                                  tcpip_getFreeHeap },
+   { "heap_free_min_bytes",           NULL,                   "Fewest free bytes of the rtos heap so far",                METRICS_GAUGE,   0, 0,                                                  tcpip_getMinimumFreeHeap },
+   { "heap_malloc_failures_total",    NULL,                   "Failed allocations of the rtos heap",                      METRICS_COUNTER, 0, 0,                                                  tcpip_getMallocFails },
+};
+static metrics_group_t tcpipMetrics = { tcpip_metrics, sizeof( tcpip_metrics ) / sizeof( tcpip_metrics[0] ), &mac_statistic, NULL, NULL };
 
 // Functions ******************************************************************
 // ----------------------------------------------------------------------------
@@ -140,11 +193,17 @@ void tcpip_init( void )
    // init random number generator
    tcpip_rngInit();
    
+   // signal for free space in the tcpQueue
+   txSpaceSemaphore = xSemaphoreCreateBinary();
+   
    // initialise the TCP/IP stack.
    FreeRTOS_IPInit( ucIPAddressFLASH, ucNetMaskFLASH, ucGatewayAddressFLASH, ucDNSServerAddressFLASH, ucMACAddressFLASH );  
    
    // initialise receive complete task
    tcpip_macTaskToNotify = osThreadNew( tcpip_macTask, NULL, &macReceiveTask_attributes );
+   
+   // publish the statistic on /metrics
+   metrics_register( &tcpipMetrics );
 }
 
 // ----------------------------------------------------------------------------
@@ -353,7 +412,9 @@ BaseType_t xApplicationDNSQueryHook( const char *pcName )
 #endif
 
 //------------------------------------------------------------------------------
-/// \brief     Tcp start output/transmit function.          
+/// \brief     Tcp start output/transmit function. The frame is handed over to
+///            the mac task, which releases it from the usbQueue after it has
+///            been processed. Several frames can be pending on the mac task.
 ///
 /// \param     [in] uint8_t* buffer
 /// \param     [in] uint16_t length
@@ -361,28 +422,41 @@ BaseType_t xApplicationDNSQueryHook( const char *pcName )
 /// \return    0 = not send, 1 = send
 uint8_t tcpip_output( uint8_t* buffer, uint16_t length )
 {
-   if( buffer == NULL || length == 0 )
+   uint32_t head = macFramesHead;
+   uint32_t next = ( head + 1u ) % MACFRAMES;
+   
+   if( next == macFramesTail )
    {
-      queue_dequeue( &usbQueue );
       return 0;
    }
-
-   if( processingIdle != RESET )
-   {
-      // set states to processing new frame from the mac layer
-      currentFrame.data = buffer;
-      currentFrame.length = length;
-      processingIdle = RESET;
-      tcpip_invokeMacTask();
-      return 1;
-   }
    
-   return 0;
+   // empty frames are passed too, the mac task releases them in order
+   macFrames[head].data = buffer;
+   macFrames[head].length = ( buffer == NULL ) ? 0 : length;
+   
+   // publish the frame to the mac task
+   __DMB();
+   macFramesHead = next;
+   tcpip_invokeMacTask();
+   
+   return 1;
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Mac main task. The task gets a frame from the fifo and hands it
-///            over to the TCP/IP stack.
+/// \brief     Mac main task. The task gets all pending frames from the fifo
+///            and hands them over to the TCP/IP stack. With 
+///            ipconfigZERO_COPY_RX_DRIVER the frames tcpip_canLend accepts 
+///            are lent to the stack in their usbQueue slot, all others are
+///            copied into a network buffer and released right away. Frames
+///            the stack would not process have been skipped by the rndis 
+///            driver already (USBD_RNDIS_filterType). The checksums
+///            are verified by tcpip_checksumFrame, for the copied frames in
+///            the same pass as the copy (ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM).
+///            The task also
+///            releases the network buffers sent by the usb without a copy.
+///            The descriptors of all frames pending at a wake up are chained
+///            through pxNextBuffer and posted to the ip task as one event
+///            (ipconfigUSE_LINKED_RX_MESSAGES).
 ///
 /// \param     [in]  void *pvParameters
 ///
@@ -391,90 +465,173 @@ static void tcpip_macTask( void *pvParameters )
 {
    // current step get pointer and length of frame!
    NetworkBufferDescriptor_t  *pxBufferDescriptor;
+   NetworkBufferDescriptor_t  *pxBatchHead;
+   NetworkBufferDescriptor_t  *pxBatchTail;
    size_t                     xBytesReceived;
    uint8_t*                   xFramePointer;
+   uint32_t                   tail;
+   uint32_t                   start;
+   uint8_t                    lent;
+   uint8_t                    valid;
    // Used to indicate that xSendEventStructToIPTask() is being called because of an Ethernet receive event.
    IPStackEvent_t             xRxEvent;
-   static uint32_t            rxMacCallCounter, rxMacErrCounter;
+   static uint32_t            rxMacCallCounter;
 
    for( ;; )
    {
       /* Wait for the Ethernet MAC interrupt to indicate that another packet
-      has been received.  The task notification is used in a similar way to a
-      counting semaphore to count Rx events, but is a lot more efficient than
-      a semaphore. */
-      ulTaskNotifyTake( pdFALSE, portMAX_DELAY );
+      has been received.  The task notification is used as a binary event,
+      all frames pending at the time of the wake up are processed. */
+      ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
         
       rxMacCallCounter++;
-
-      // set the bytes received variable
-      xBytesReceived = currentFrame.length;
-      xFramePointer = currentFrame.data;
       
-      /* Allocate a network buffer descriptor that points to a buffer
-      large enough to hold the received frame.  As this is the simple
-      rather than efficient example the received data will just be copied
-      into this buffer. */
-      pxBufferDescriptor = (NetworkBufferDescriptor_t*)pxGetNetworkBufferWithDescriptor( xBytesReceived, 0 );
-      
-      if( pxBufferDescriptor != NULL )
+#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+      // hand the frames released by the stack back to the usbQueue, this
+      // task is the only one releasing its frames
+      while( ( tail = rxReleasedTail ) != rxReleasedHead )
+      {
+         __DMB();
+         queue_release( rxReleased[tail], &usbQueue );
+         rxReleasedTail = ( tail + 1u ) % MACFRAMES;
+      }
+#endif
+
+      // release the network buffers sent by the usb, the buffer management 
+      // of the stack can't be called from the usb isr
+      while( ( tail = txReleasedTail ) != txReleasedHead )
+      {
+         __DMB();
+         vReleaseNetworkBufferAndDescriptor( txReleased[tail] );
+         txReleasedTail = ( tail + 1u ) % TXREFERENCES;
+      }
+
+      pxBatchHead = NULL;
+      pxBatchTail = NULL;
+      while( ( tail = macFramesTail ) != macFramesHead )
       {
-         // copy data onto the heap release frame from fifo
-         memcpy(pxBufferDescriptor->pucEthernetBuffer, (uint8_t*)xFramePointer, xBytesReceived);
+         __DMB();
          
-         // set the pointer back
-         pxBufferDescriptor->xDataLength = xBytesReceived;
+         // set the bytes received variable
+         xBytesReceived = macFrames[tail].length;
+         xFramePointer = macFrames[tail].data;
+         lent = 0;
+         valid = 1;
          
-         /* See if the data contained in the received Ethernet frame needs
-         to be processed.  NOTE! It is preferable to do this in
-         the interrupt service routine itself, which would remove the need
-         to unblock this task for packets that don't need processing. */
-         if( eConsiderFrameForProcessing( pxBufferDescriptor->pucEthernetBuffer ) == eProcessBuffer )
+         // empty frames are released without processing
+         if( xBytesReceived != 0 )
          {
-            /* The event about to be sent to the TCP/IP is an Rx event. */
-            xRxEvent.eEventType = eNetworkRxEvent;
+#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+            if( tcpip_canLend( xFramePointer, (uint16_t)xBytesReceived ) )
+            {
+               // A descriptor without buffer gets the frame in the queue slot.
+               // The back pointer is written into the consumed rndis header 
+               // in front of the frame, like the stack does in its buffers.
+               pxBufferDescriptor = NULL;
+               valid = tcpip_checksumFrame( NULL, xFramePointer, (uint16_t)xBytesReceived );
+               if( valid == 1 )
+               {
+                  pxBufferDescriptor = pxGetNetworkBufferWithDescriptor( 0, 0 );
+               }
+               if( pxBufferDescriptor != NULL )
+               {
+                  pxBufferDescriptor->pucEthernetBuffer = xFramePointer;
+                  *( ( NetworkBufferDescriptor_t ** ) ( xFramePointer - ipBUFFER_PADDING ) ) = pxBufferDescriptor;
+                  mac_statistic.counterRxLent++;
+                  lent = 1;
+               }
+            }
+            else
+#endif
+            {
+               /* Allocate a network buffer descriptor that points to a buffer
+               large enough to hold the received frame and copy the frame 
+               into it, the checksums are verified while copying. */
+               pxBufferDescriptor = (NetworkBufferDescriptor_t*)pxGetNetworkBufferWithDescriptor( xBytesReceived, 0 );
+               if( pxBufferDescriptor != NULL )
+               {
+                  start = DWT->CYCCNT;
+                  valid = tcpip_checksumFrame( pxBufferDescriptor->pucEthernetBuffer, xFramePointer, (uint16_t)xBytesReceived );
+                  mac_statistic.counterRxCopyCycles += DWT->CYCCNT - start;
+                  if( valid != 1 )
+                  {
+                     vReleaseNetworkBufferAndDescriptor( pxBufferDescriptor );
+                     pxBufferDescriptor = NULL;
+                  }
+               }
+            }
             
-            /* pvData is used to point to the network buffer descriptor that
-            now references the received data. */
-            xRxEvent.pvData = ( void * ) pxBufferDescriptor;
+            if( pxBufferDescriptor != NULL )
+            {
+               // set the pointer back
+               pxBufferDescriptor->xDataLength = xBytesReceived;
+               
+               // append the descriptor to the batch for the ip task
+               pxBufferDescriptor->pxNextBuffer = NULL;
+               if( pxBatchHead == NULL )
+               {
+                  pxBatchHead = pxBufferDescriptor;
+               }
+               else
+               {
+                  pxBatchTail->pxNextBuffer = pxBufferDescriptor;
+               }
+               pxBatchTail = pxBufferDescriptor;
+            }
+            else if( valid == 1 )
+            {
+               /* The event was lost because a network buffer was not available.
+               Call the standard trace macro to log the occurrence. */
+               iptraceETHERNET_RX_EVENT_LOST();
+               mac_statistic.counterRxMacError++;
+            }
             
-            /* Send the data to the TCP/IP stack. */
-            if( xSendEventStructToIPTask( &xRxEvent, 0 ) == pdFALSE )
+            mac_statistic.counterTxFrame++;  // this is likely to send a frame from rndis view
+         }
+         
+         // release the frame from the mac fifo and the queue, the frames 
+         // may be released out of order because of the lent ones
+         macFramesTail = ( tail + 1u ) % MACFRAMES;
+         if( lent == 0 )
+         {
+            queue_release( xFramePointer, &usbQueue );
+         }
+      }
+      
+      if( pxBatchHead != NULL )
+      {
+         /* The event about to be sent to the TCP/IP is an Rx event. */
+         xRxEvent.eEventType = eNetworkRxEvent;
+         
+         /* pvData is used to point to the first network buffer descriptor of
+         the chain that references the received data. */
+         xRxEvent.pvData = ( void * ) pxBatchHead;
+         
+         /* Send the data to the TCP/IP stack. */
+         if( xSendEventStructToIPTask( &xRxEvent, 0 ) == pdFALSE )
+         {
+            /* The chain could not be sent to the IP task so the buffers must
+            be released, a lent frame comes back through 
+            tcpip_releaseRxBuffer. */
+            while( pxBatchHead != NULL )
             {
-               /* The buffer could not be sent to the IP task so the buffer
-               must be released. */
+               pxBufferDescriptor = pxBatchHead;
+               pxBatchHead = pxBatchHead->pxNextBuffer;
                vReleaseNetworkBufferAndDescriptor( pxBufferDescriptor );
                
                /* Make a call to the standard trace macro to log the
                occurrence. */
                iptraceETHERNET_RX_EVENT_LOST();
             }
-            else
-            {
-               /* The message was successfully sent to the TCP/IP stack.
-               Call the standard trace macro to log the occurrence. */
-               iptraceNETWORK_INTERFACE_RECEIVE();
-            }
          }
          else
          {
-            /* The Ethernet frame can be dropped, but the Ethernet buffer
-            must be released. */
-            vReleaseNetworkBufferAndDescriptor( pxBufferDescriptor );
+            /* The message was successfully sent to the TCP/IP stack.
+            Call the standard trace macro to log the occurrence. */
+            iptraceNETWORK_INTERFACE_RECEIVE();
+            mac_statistic.counterRxEvent++;
          }
       }
-      else
-      {
-         /* The event was lost because a network buffer was not available.
-         Call the standard trace macro to log the occurrence. */
-         iptraceETHERNET_RX_EVENT_LOST();
-         rxMacErrCounter++;
-      }
-
-      // reset the processing frame flag
-      processingIdle = SET;
-      mac_statistic.counterTxFrame++;  // this is likely to send a frame from rndis view
-      queue_dequeue( &usbQueue );
    }
 }
 
@@ -493,6 +650,239 @@ static void tcpip_invokeMacTask( void )
    }
 }
 
+// ----------------------------------------------------------------------------
+/// \brief     Verifies the ip header and the tcp, udp or icmp checksum of a
+///            received frame, which the stack does not do itself with 
+///            ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM. If a destination is 
+///            given, the frame is copied in the same pass. The ip datagram is
+///            summed once, the sum of the ip header is subtracted from it to 
+///            get the sum of the payload. Frames which are not ipv4, are 
+///            fragmented or have inconsistent lengths are passed unchecked,
+///            the length checks of the stack drop the broken ones. Like the
+///            stack, the ip header checksum of icmp packets is not checked
+///            and udp packets without checksum are passed.
+///
+/// \param     [out] uint8_t* dst, NULL to verify the frame in place
+/// \param     [in]  const uint8_t* frame
+/// \param     [in]  uint16_t length
+///
+/// \return    0 = checksum error, 1 = valid
+static uint8_t tcpip_checksumFrame( uint8_t* dst, const uint8_t* frame, uint16_t length )
+{
+   const uint8_t  *ip = &frame[ipSIZE_OF_ETH_HEADER];
+   uint32_t       headerLength;
+   uint32_t       totalLength;
+   uint32_t       sum;
+   uint32_t       headerSum;
+   uint8_t        protocol;
+   uint16_t       usFrameType;
+   
+   // the fields are read bytewise, the frame may be unaligned
+   memcpy( &usFrameType, &frame[12], sizeof( usFrameType ) );
+   if( length < ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER || usFrameType != ipIPv4_FRAME_TYPE )
+   {
+      headerLength = 0;
+      totalLength = 0;
+   }
+   else
+   {
+      headerLength = ( ip[0] & 0x0Fu ) << 2;
+      totalLength = ( (uint32_t)ip[2] << 8 ) | ip[3];
+   }
+   
+   if(   headerLength < ipSIZE_OF_IPv4_HEADER
+      || totalLength < headerLength
+      || ipSIZE_OF_ETH_HEADER + totalLength > length
+      || ( ( ( (uint32_t)ip[6] << 8 ) | ip[7] ) & 0x3FFFu ) != 0 )
+   {
+      if( dst != NULL )
+      {
+         memcpy( dst, frame, length );
+      }
+      return 1;
+   }
+   
+   // sum the ip datagram, copy the ethernet header and padding behind it
+   if( dst != NULL )
+   {
+      memcpy( dst, frame, ipSIZE_OF_ETH_HEADER );
+      sum = checksum_copy( &dst[ipSIZE_OF_ETH_HEADER], ip, totalLength, 0 );
+      memcpy( &dst[ipSIZE_OF_ETH_HEADER + totalLength], &ip[totalLength], length - ipSIZE_OF_ETH_HEADER - totalLength );
+   }
+   else
+   {
+      sum = checksum_add( ip, totalLength, 0 );
+   }
+   headerSum = checksum_fold( checksum_add( ip, headerLength, 0 ) );
+   protocol = ip[9];
+   
+   if( protocol != ipPROTOCOL_ICMP && headerSum != CHECKSUM_CORRECT )
+   {
+      mac_statistic.counterRxChecksum++;
+      return 0;
+   }
+   
+   // payload sum = datagram sum - header sum
+   sum = checksum_combine( sum, (uint16_t)~headerSum );
+   
+   switch( protocol )
+   {
+      case ipPROTOCOL_UDP:
+         // udp packets without checksum are passed
+         if(   totalLength - headerLength < ipSIZE_OF_UDP_HEADER
+            || ( ip[headerLength + 6u] == 0 && ip[headerLength + 7u] == 0 ) )
+         {
+            return 1;
+         }
+         break;
+      case ipPROTOCOL_TCP:
+      case ipPROTOCOL_ICMP:
+         break;
+      default:
+         // passed unchecked, the stack drops protocols it does not handle
+         return 1;
+   }
+   
+   // pseudo header of tcp and udp: addresses, protocol and payload length in
+   // network byte order
+   if( protocol != ipPROTOCOL_ICMP )
+   {
+      sum = checksum_combine( sum, checksum_add( &ip[12], 8u, 0 ) );
+      sum = checksum_combine( sum, FreeRTOS_htons( (uint16_t)protocol ) );
+      sum = checksum_combine( sum, FreeRTOS_htons( (uint16_t)( totalLength - headerLength ) ) );
+   }
+   
+   if( checksum_fold( sum ) != CHECKSUM_CORRECT )
+   {
+      mac_statistic.counterRxChecksum++;
+      return 0;
+   }
+   return 1;
+}
+
+#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+// ----------------------------------------------------------------------------
+/// \brief     Checks if a received frame can be lent to the stack. Only tcp
+///            frames of the bulk lane are lent, the stack releases them from
+///            the ip task shortly after. Udp frames may wait in a socket 
+///            until the application reads them and would block the lane. The
+///            frame has to be aligned like the network buffers of the stack,
+///            which is the case for the first frame of an out transfer.
+///
+/// \param     [in]  const uint8_t* frame
+/// \param     [in]  uint16_t length
+///
+/// \return    0 = copy, 1 = lend
+static uint8_t tcpip_canLend( const uint8_t* frame, uint16_t length )
+{
+   const EthernetHeader_t  *pxEthernetHeader = ( const EthernetHeader_t * ) frame;
+   const IPHeader_t        *pxIPHeader;
+   
+   if(   frame < (uint8_t*)usbQueue.bulkPool
+      || frame >= (uint8_t*)usbQueue.bulkPool + QUEUEBULKPOOLSIZE
+      || ( (uint32_t)frame & 3u ) != ipconfigPACKET_FILLER_SIZE
+      || length < ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER
+      || pxEthernetHeader->usFrameType != ipIPv4_FRAME_TYPE )
+   {
+      return 0;
+   }
+   
+   pxIPHeader = ( const IPHeader_t * ) &frame[ipSIZE_OF_ETH_HEADER];
+   return ( pxIPHeader->ucProtocol == ipPROTOCOL_TCP ) ? 1 : 0;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Takes back a frame lent to the stack, called by the buffer 
+///            management of the stack for every released buffer. The frame
+///            is released from the usbQueue by the mac task. May be called
+///            from any task.
+///
+/// \param     [in]  uint8_t* buffer
+///
+/// \return    0 = not a lent frame, 1 = taken back
+uint8_t tcpip_releaseRxBuffer( uint8_t* buffer )
+{
+   uint32_t head;
+   
+   if(   buffer < (uint8_t*)usbQueue.bulkPool
+      || buffer >= (uint8_t*)usbQueue.bulkPool + QUEUEBULKPOOLSIZE )
+   {
+      return 0;
+   }
+   
+   // the fifo can't overflow, there are less lent frames than entries
+   taskENTER_CRITICAL();
+   head = rxReleasedHead;
+   rxReleased[head] = buffer;
+   __DMB();
+   rxReleasedHead = ( head + 1u ) % MACFRAMES;
+   taskEXIT_CRITICAL();
+   
+   tcpip_invokeMacTask();
+   return 1;
+}
+#endif
+
+//------------------------------------------------------------------------------
+/// \brief     Queue classify function. Selects the control lane for frames
+///            which are small and latency sensitive: arp, icmp, udp (dhcp,
+///            dns) and tcp segments without payload (pure acks, syn, fin). 
+///            Everything else goes to the bulk lane.
+///
+/// \param     [in]  uint8_t* frame
+/// \param     [in]  uint16_t length
+///
+/// \return    queue_lane_id_t lane
+queue_lane_id_t tcpip_classify( uint8_t* frame, uint16_t length )
+{
+   const EthernetHeader_t  *pxEthernetHeader = ( const EthernetHeader_t * ) frame;
+   const IPHeader_t        *pxIPHeader;
+   const TCPHeader_t       *pxTCPHeader;
+   uint16_t                ipHeaderLength;
+   uint16_t                tcpHeaderLength;
+   
+   // the frame and the rndis header have to fit into a control lane buffer
+   if( length < ipSIZE_OF_ETH_HEADER || length > ( QUEUECONTROLBUFFERLENGTH - RXBUFFEROFFSET ) )
+   {
+      return QUEUE_LANE_BULK;
+   }
+   
+   if( pxEthernetHeader->usFrameType == ipARP_FRAME_TYPE )
+   {
+      return QUEUE_LANE_CONTROL;
+   }
+   
+   if( pxEthernetHeader->usFrameType != ipIPv4_FRAME_TYPE || length < ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER )
+   {
+      return QUEUE_LANE_BULK;
+   }
+   
+   pxIPHeader = ( const IPHeader_t * ) &frame[ipSIZE_OF_ETH_HEADER];
+   switch( pxIPHeader->ucProtocol )
+   {
+      case ipPROTOCOL_ICMP:
+      case ipPROTOCOL_UDP:
+         return QUEUE_LANE_CONTROL;
+         
+      case ipPROTOCOL_TCP:
+         ipHeaderLength = ( uint16_t )( ( pxIPHeader->ucVersionHeaderLength & 0x0Fu ) << 2 );
+         if( length < ipSIZE_OF_ETH_HEADER + ipHeaderLength + ipSIZE_OF_TCP_HEADER )
+         {
+            return QUEUE_LANE_BULK;
+         }
+         pxTCPHeader = ( const TCPHeader_t * ) &frame[ipSIZE_OF_ETH_HEADER + ipHeaderLength];
+         tcpHeaderLength = ( uint16_t )( ( pxTCPHeader->ucTCPOffset >> 4 ) << 2 );
+         if( FreeRTOS_ntohs( pxIPHeader->usLength ) <= ipHeaderLength + tcpHeaderLength )
+         {
+            return QUEUE_LANE_CONTROL;
+         }
+         return QUEUE_LANE_BULK;
+         
+      default:
+         return QUEUE_LANE_BULK;
+   }
+}
+
 //------------------------------------------------------------------------------
 /// \brief     Called if a call to pvPortMalloc() fails because there is 
 ///            insufficient free memory available in the FreeRTOS heap.  
@@ -506,7 +896,6 @@ static void tcpip_invokeMacTask( void )
 /// \return    none
 void vApplicationMallocFailedHook( void )
 {
-   static uint32_t malloc_fail_counter = 0;
    malloc_fail_counter++;
 }
 
@@ -583,7 +972,15 @@ static uint32_t tcpip_getRandomNumber( void )
 /// \return    0 = queue is full, 1 = frame queued
 uint8_t tcpip_enqueue( uint8_t* data, uint16_t length )
 {
-   if( queue_isFull( &tcpQueue ) != 1 )
+   // select the lane, use the bulk lane if the control lane is full
+   queue_lane_id_t lane = queue_classify( data, length, &tcpQueue );
+   if( lane != QUEUE_LANE_BULK && queue_isLaneFull( lane, &tcpQueue ) != 1 )
+   {
+      lane = QUEUE_LANE_BULK;
+   }
+   
+   // apply the drop policy of the queue
+   if( queue_admit( lane, &tcpQueue ) != 1 )
    {
       return 0;
    }
@@ -593,7 +990,7 @@ uint8_t tcpip_enqueue( uint8_t* data, uint16_t length )
    //uint8_t*   crcFragment;
 
    // copy message into queue header, as this is being interpreted as received message on secondary output
-   uint8_t *rxBuffer = queue_getHeadBuffer( &tcpQueue ) + RXBUFFEROFFSET;
+   uint8_t *rxBuffer = queue_getLaneHeadBuffer( lane, &tcpQueue ) + RXBUFFEROFFSET;
    
    // copy data into buffer
    memcpy( rxBuffer, data, length );
@@ -609,11 +1006,270 @@ uint8_t tcpip_enqueue( uint8_t* data, uint16_t length )
    //   *(rxBuffer+length+i) = *(crcFragment+j);
    //}
    
+   // enqueue to the ringbuffer, the head buffer stays the same if the frame
+   // has been dropped
+   if( queue_enqueueLane( rxBuffer, (uint16_t)(length), lane, &tcpQueue ) == rxBuffer - RXBUFFEROFFSET )
+   {
+      return 0;
+   }
+   
    // this is likely to receive a frame on the rndis part
    mac_statistic.counterRxFrame++;
    
-   // enqueue to the ringbuffer
-   queue_enqueue( rxBuffer, (uint16_t)(length), &tcpQueue );
+   return 1;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Function to handover a network buffer of the tcp ip stack to the
+///            queue without copying it. The usb sends the frame out of the
+///            network buffer, the headroom and padding in front of it take 
+///            the rndis header. The buffer is released by tcpip_releaseTxBuffer after 
+///            the transfer.
+///
+/// \param     [in]  uint8_t* data
+/// \param     [in]  uint16_t length
+/// \param     [in]  void* reference, network buffer descriptor of the frame
+///
+/// \return    0 = queue is full, 1 = frame queued
+uint8_t tcpip_enqueueRef( uint8_t* data, uint16_t length, void* reference )
+{
+   // select the lane, use the bulk lane if the control lane is full
+   queue_lane_id_t lane = queue_classify( data, length, &tcpQueue );
+   if( lane != QUEUE_LANE_BULK && queue_isLaneFull( lane, &tcpQueue ) != 1 )
+   {
+      lane = QUEUE_LANE_BULK;
+   }
+   
+   // apply the drop policy of the queue
+   if( queue_admit( lane, &tcpQueue ) != 1 )
+   {
+      return 0;
+   }
+   
+   if( queue_enqueueLaneRef( data, length, reference, lane, &tcpQueue ) != 1 )
+   {
+      return 0;
+   }
+   
+   // this is likely to receive a frame on the rndis part
+   mac_statistic.counterRxFrame++;
+   mac_statistic.counterTxRef++;
    
    return 1;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Release function of the tcpQueue. Takes back a network buffer
+///            queued by tcpip_enqueueRef, which is released by the mac task.
+///            Called from the usb isr after the transfer or from the queue 
+///            pump if the message has been dropped.
+///
+/// \param     [in]  void* reference
+///
+/// \return    none
+void tcpip_releaseTxBuffer( void* reference )
+{
+   BaseType_t  xHigherPriorityTaskWoken = pdFALSE;
+   UBaseType_t uxSavedInterruptStatus;
+   uint32_t    head;
+   
+   // the fifo can't overflow, it has an entry for every message of the queue
+   uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+   head = txReleasedHead;
+   txReleased[head] = ( NetworkBufferDescriptor_t * ) reference;
+   __DMB();
+   txReleasedHead = ( head + 1u ) % TXREFERENCES;
+   portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+   
+   if( xPortIsInsideInterrupt() == pdFALSE )
+   {
+      tcpip_invokeMacTask();
+   }
+   else if( tcpip_macTaskToNotify != NULL )
+   {
+      vTaskNotifyGiveFromISR( tcpip_macTaskToNotify, &xHigherPriorityTaskWoken );
+      portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+   }
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Waits until the tcpQueue has released a frame or the timeout
+///            has elapsed. Used by the network interface to hold a frame 
+///            instead of dropping it, if the queue is full.
+///
+/// \param     [in]  uint32_t timeout in ticks
+///
+/// \return    none
+void tcpip_waitTxSpace( uint32_t timeout )
+{
+   mac_statistic.counterTxWait++;
+   if( txSpaceSemaphore != NULL )
+   {
+      xSemaphoreTake( txSpaceSemaphore, timeout );
+   }
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Signals a released frame of the tcpQueue. Called from the usb 
+///            isr.
+///
+/// \param     none
+///
+/// \return    none
+void tcpip_notifyTxSpace( void )
+{
+   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+   
+   if( txSpaceSemaphore != NULL )
+   {
+      xSemaphoreGiveFromISR( txSpaceSemaphore, &xHigherPriorityTaskWoken );
+      portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+   }
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Counts a frame the network interface could not queue.
+///
+/// \param     none
+///
+/// \return    none
+void tcpip_countTxError( void )
+{
+   mac_statistic.counterTxError++;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the number of waits for free space in the tcpQueue.
+///
+/// \param     none
+///
+/// \return    uint32_t waits
+uint32_t tcpip_getTxWaits( void )
+{
+   return mac_statistic.counterTxWait;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the number of received frames lent to the stack.
+///
+/// \param     none
+///
+/// \return    uint32_t frames
+uint32_t tcpip_getRxLent( void )
+{
+   return mac_statistic.counterRxLent;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the number of network buffers sent without a copy.
+///
+/// \param     none
+///
+/// \return    uint32_t frames
+uint32_t tcpip_getTxRef( void )
+{
+   return mac_statistic.counterTxRef;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the number of rx events posted to the ip task, each of
+///            them carries a chain of received frames.
+///
+/// \param     none
+///
+/// \return    uint32_t events
+uint32_t tcpip_getRxEvents( void )
+{
+   return mac_statistic.counterRxEvent;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the number of received frames dropped because of a 
+///            checksum error.
+///
+/// \param     none
+///
+/// \return    uint32_t frames
+uint32_t tcpip_getRxChecksumErrors( void )
+{
+   return mac_statistic.counterRxChecksum;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the cycles spent copying and checksumming the received
+///            frames into network buffers.
+///
+/// \param     none
+///
+/// \return    uint32_t cycles
+uint32_t tcpip_getRxCopyCycles( void )
+{
+   return mac_statistic.counterRxCopyCycles;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the number of frames lost by the network interface.
+///
+/// \param     none
+///
+/// \return    uint32_t lost frames
+uint32_t tcpip_getTxErrors( void )
+{
+   return mac_statistic.counterTxError;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the number of failed allocations of the rtos heap.
+///
+/// \param     none
+///
+/// \return    uint32_t failures
+static uint32_t tcpip_getMallocFails( void )
+{
+   return malloc_fail_counter;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the free bytes of the rtos heap.
+///
+/// \param     none
+///
+/// \return    uint32_t bytes
+static uint32_t tcpip_getFreeHeap( void )
+{
+   return xPortGetFreeHeapSize();
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the fewest free bytes of the rtos heap since the start.
+///
+/// \param     none
+///
+/// \return    uint32_t bytes
+static uint32_t tcpip_getMinimumFreeHeap( void )
+{
+   return xPortGetMinimumEverFreeHeapSize();
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the fewest free network buffers since the start.
+///
+/// \param     none
+///
+/// \return    uint32_t network buffers
+static uint32_t tcpip_getMinimumBuffers( void )
+{
+   return uxGetMinimumFreeNetworkBuffers();
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the fewest free places in the queue of the ip task 
+///            since the start.
+///
+/// \param     none
+///
+/// \return    uint32_t places
+static uint32_t tcpip_getMinimumIPQueue( void )
+{
+   return uxGetMinimumIPQueueSpace();
 }
\ No newline at end of file
@@ -0,0 +1,627 @@
+// ****************************************************************************
+/// \file      webassets.c
+///
+/// \brief     Web Assets C Source File
+///
+/// \details   Generated by Core/Web/webassets.py, do not edit.
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include "webassets.h"
+#include "webtemplates.h"
+
+// index.html, 2282 bytes, 797 bytes compressed
+static const uint8_t webasset_index_html[797] = {
+   0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x9d, 0x56, 0x5b, 0x6f, 0xda, 0x30,
+   0x14, 0x7e, 0xdf, 0xaf, 0xf0, 0x3a, 0x69, 0x7e, 0x82, 0x00, 0x6d, 0xa7, 0x8d, 0x26, 0x48, 0x13,
+   0x6d, 0x37, 0xb4, 0xb5, 0x45, 0x05, 0x4d, 0xda, 0xd3, 0xe4, 0x24, 0x07, 0xe2, 0xd5, 0xb1, 0x2d,
+   0xdb, 0xa1, 0xb0, 0x5f, 0xbf, 0xe3, 0x24, 0xac, 0x69, 0x0b, 0x0d, 0x2b, 0x0f, 0xf8, 0xf6, 0x1d,
+   0xfb, 0x3b, 0xf7, 0x84, 0x6f, 0xcf, 0x6f, 0xc6, 0xf3, 0x9f, 0xd3, 0x0b, 0x92, 0xb9, 0x5c, 0x8c,
+   0xde, 0x84, 0x7e, 0x20, 0x82, 0xc9, 0x65, 0x44, 0x41, 0x52, 0xbf, 0x01, 0x2c, 0xc5, 0x21, 0x07,
+   0xc7, 0x48, 0x92, 0x31, 0x63, 0xc1, 0x45, 0xb4, 0x70, 0x8b, 0xce, 0x47, 0x7f, 0x2a, 0xb8, 0xbc,
+   0x23, 0x99, 0x81, 0x45, 0x44, 0x83, 0x05, 0x5b, 0xf1, 0x44, 0xc9, 0x2e, 0xfe, 0x51, 0x62, 0x40,
+   0x44, 0xd4, 0x2f, 0x29, 0x71, 0x1b, 0x0d, 0x38, 0xcf, 0xd9, 0x12, 0x82, 0x75, 0xa7, 0xda, 0x0b,
+   0x9e, 0xc8, 0x5a, 0xb7, 0x11, 0xd0, 0x4d, 0xac, 0xad, 0x25, 0xcb, 0xb5, 0xcd, 0x00, 0xdc, 0x56,
+   0xde, 0xc1, 0xda, 0x05, 0x25, 0xc0, 0xcb, 0x3a, 0xee, 0x04, 0x8c, 0x6e, 0xaf, 0xcf, 0x27, 0x33,
+   0xf2, 0x75, 0x3e, 0x9f, 0x92, 0x19, 0x98, 0x15, 0x18, 0x72, 0xb1, 0x66, 0xb9, 0x16, 0x10, 0x06,
+   0x15, 0xe0, 0x4d, 0x18, 0xd4, 0xfc, 0x63, 0x95, 0x6e, 0x70, 0x48, 0xf9, 0x8a, 0x24, 0x82, 0x59,
+   0x1b, 0xd1, 0x9c, 0x71, 0xaf, 0x20, 0x21, 0x24, 0xd4, 0xa3, 0xf2, 0x80, 0xa7, 0x11, 0x8d, 0xd5,
+   0xba, 0x4f, 0x49, 0xf9, 0x7c, 0x44, 0x33, 0xe0, 0xcb, 0xcc, 0x0d, 0x4f, 0x4f, 0xcf, 0x2a, 0xa0,
+   0xc7, 0x2e, 0x94, 0x74, 0xc4, 0xf2, 0x3f, 0x78, 0x3c, 0xe8, 0x51, 0x52, 0x2e, 0x13, 0x25, 0x94,
+   0x89, 0xe8, 0x7d, 0xc6, 0x1d, 0xd0, 0x51, 0x18, 0xef, 0x27, 0x46, 0x3a, 0x64, 0xd5, 0xeb, 0x1e,
+   0x77, 0x7b, 0xdd, 0x41, 0x18, 0xc4, 0xa3, 0x30, 0xf0, 0xf2, 0x15, 0x89, 0x00, 0x29, 0xe0, 0x86,
+   0xae, 0x56, 0xb1, 0xf1, 0x7a, 0xfa, 0x99, 0x63, 0x31, 0xca, 0x3d, 0x23, 0x5d, 0x1e, 0xa5, 0x5b,
+   0xa6, 0xf8, 0x84, 0xe3, 0x09, 0x13, 0x1d, 0x26, 0xf8, 0x52, 0x0e, 0x9d, 0xd2, 0x0f, 0x94, 0x3d,
+   0xb2, 0xa1, 0x37, 0x97, 0x0b, 0xb5, 0x04, 0x09, 0x86, 0x89, 0x26, 0xa4, 0xb6, 0x43, 0x76, 0x3c,
+   0x9a, 0x6d, 0xac, 0x83, 0x9c, 0x4c, 0x10, 0x87, 0xe6, 0x3b, 0xfe, 0xc7, 0xa9, 0x89, 0x9b, 0x4c,
+   0x87, 0x24, 0xb4, 0x9a, 0xc9, 0xd2, 0x68, 0x5c, 0xa3, 0xd6, 0x81, 0x5f, 0xee, 0x04, 0x5f, 0x7d,
+   0x1e, 0x37, 0xd1, 0x39, 0x4b, 0x5e, 0x84, 0x37, 0xc9, 0x3a, 0x9e, 0x03, 0x06, 0x8c, 0x43, 0xb5,
+   0xc1, 0x78, 0xa9, 0xa6, 0x91, 0x9a, 0x42, 0x5f, 0x0a, 0xb0, 0xde, 0x11, 0x85, 0x74, 0x60, 0x9a,
+   0xaf, 0x2d, 0xfd, 0x81, 0xdd, 0xf3, 0x60, 0x75, 0xdf, 0x7e, 0x3b, 0x19, 0xa7, 0xec, 0x6e, 0x23,
+   0xdd, 0xce, 0x6f, 0x66, 0x2f, 0x9b, 0xe8, 0xd2, 0x00, 0x94, 0xa8, 0x1f, 0x60, 0x2c, 0x57, 0xb2,
+   0x49, 0xca, 0xdf, 0xbb, 0xaa, 0xb6, 0x0f, 0x36, 0x85, 0x97, 0x69, 0x31, 0xc5, 0x23, 0x75, 0x30,
+   0x07, 0xd2, 0xf6, 0x48, 0x49, 0xc0, 0x1b, 0x6c, 0x6f, 0xb0, 0xc4, 0x82, 0x25, 0x77, 0x9a, 0x8b,
+   0x67, 0xa1, 0xd2, 0xc4, 0x28, 0x93, 0x3e, 0x30, 0xda, 0x0b, 0x2b, 0x6c, 0xdc, 0x8e, 0x49, 0xfa,
+   0x07, 0x60, 0x06, 0x88, 0x69, 0xa4, 0xe1, 0x09, 0x66, 0x21, 0x4b, 0x2a, 0xd5, 0x52, 0x26, 0x19,
+   0x7d, 0x92, 0x8f, 0xb3, 0xf9, 0xd5, 0xf1, 0xe0, 0xf2, 0xa4, 0xdf, 0xaf, 0xb3, 0xad, 0xe5, 0xfe,
+   0x3b, 0xd8, 0xb4, 0x93, 0x40, 0xd0, 0xa0, 0x15, 0x24, 0x20, 0x6d, 0xc5, 0x68, 0x2e, 0x6d, 0xff,
+   0x20, 0xd4, 0x8e, 0xf7, 0x5e, 0xe1, 0xef, 0xb6, 0xca, 0x10, 0x2b, 0x66, 0xd2, 0xdd, 0x21, 0x3f,
+   0x05, 0xc3, 0x75, 0xe6, 0xeb, 0x86, 0xdd, 0x1b, 0xf4, 0xcd, 0xeb, 0xac, 0xe0, 0x69, 0x33, 0x79,
+   0x1f, 0x61, 0xf1, 0xf7, 0x1d, 0x52, 0x72, 0xce, 0xf3, 0x1c, 0x4c, 0xc8, 0xa5, 0x2e, 0x5c, 0x5d,
+   0xe8, 0x0d, 0x36, 0x1f, 0xa0, 0x24, 0xe7, 0x12, 0x2b, 0x2c, 0x8e, 0x6c, 0x8d, 0x2e, 0xc6, 0x4a,
+   0xbb, 0x62, 0xa2, 0xa8, 0x8b, 0x6e, 0xf3, 0x01, 0x43, 0xab, 0xa2, 0xb2, 0xb9, 0x2d, 0xe5, 0x9e,
+   0x30, 0xda, 0x5b, 0x2f, 0x30, 0x80, 0x4c, 0x4e, 0x58, 0xe2, 0x30, 0x05, 0x4b, 0x4f, 0xfd, 0xd2,
+   0x85, 0xb0, 0xfe, 0x5d, 0x70, 0x99, 0xc2, 0x0b, 0xb5, 0xb2, 0xce, 0xd7, 0xf2, 0xc2, 0x39, 0x25,
+   0xb7, 0xc6, 0xbc, 0xe7, 0xa9, 0xcb, 0x86, 0x83, 0x5e, 0x4f, 0xaf, 0xcf, 0xaa, 0xb0, 0xef, 0x18,
+   0x96, 0xf2, 0xc2, 0x0e, 0x4f, 0x70, 0x87, 0x8e, 0xbc, 0x4a, 0x53, 0x7f, 0x0f, 0x16, 0xf7, 0x52,
+   0xb0, 0xac, 0xf0, 0x26, 0x6f, 0xb7, 0x15, 0x48, 0xab, 0xcc, 0xff, 0xa4, 0xf7, 0x0e, 0xdf, 0xb9,
+   0x44, 0xfb, 0x4a, 0xbc, 0xcb, 0x77, 0xf3, 0xf1, 0x34, 0x98, 0x60, 0x33, 0x72, 0xcc, 0x71, 0x8b,
+   0xf1, 0x70, 0x98, 0x07, 0xcb, 0x0b, 0x5f, 0x55, 0x73, 0x70, 0xe2, 0xdb, 0x56, 0x35, 0xb7, 0x09,
+   0x06, 0x0e, 0x66, 0xab, 0x49, 0xb0, 0xd3, 0x33, 0xad, 0xbb, 0xbf, 0xab, 0x7a, 0x5c, 0x6e, 0x6f,
+   0xdb, 0x5d, 0xdd, 0x89, 0x6b, 0x4b, 0x1f, 0xf9, 0x76, 0xff, 0xb8, 0x44, 0x1d, 0x8d, 0xde, 0xbf,
+   0xeb, 0x7f, 0xf8, 0x44, 0xc6, 0x4a, 0x6f, 0x8c, 0xef, 0xcb, 0x64, 0xd0, 0x1b, 0xf4, 0x49, 0xbc,
+   0x21, 0xd7, 0xf8, 0x4d, 0x41, 0xbe, 0x29, 0x23, 0x4b, 0x66, 0x35, 0x21, 0xf4, 0x40, 0xd5, 0xf2,
+   0x83, 0xea, 0xcb, 0xe6, 0x2f, 0x1b, 0xaa, 0xa0, 0x8c, 0xea, 0x08, 0x00, 0x00,
+};
+
+// style.css, 2399 bytes, 764 bytes compressed
+static const uint8_t webasset_style_css[764] = {
+   0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb5, 0x96, 0xdb, 0x6e, 0xa3, 0x30,
+   0x10, 0x86, 0xef, 0xf3, 0x14, 0x96, 0xa2, 0x95, 0x9a, 0x2a, 0x50, 0xc0, 0x90, 0xa4, 0x70, 0xd5,
+   0x6d, 0xf7, 0x41, 0x0c, 0x18, 0xb0, 0x6a, 0x30, 0x32, 0xa6, 0x49, 0xb6, 0xea, 0xbb, 0xaf, 0x6d,
+   0x0c, 0x01, 0x42, 0xd4, 0xee, 0x09, 0x94, 0x08, 0x8f, 0x0f, 0xf3, 0xcd, 0x3f, 0x63, 0xcc, 0xc3,
+   0x3d, 0x28, 0x30, 0x4a, 0x31, 0x07, 0x02, 0x9f, 0x04, 0xb8, 0x7f, 0x58, 0xad, 0x63, 0x76, 0x72,
+   0xc1, 0xfb, 0x0a, 0x00, 0x10, 0xa3, 0xe4, 0x35, 0xe7, 0xac, 0xad, 0x52, 0x8b, 0x94, 0x28, 0xc7,
+   0x21, 0xa0, 0xa4, 0xc2, 0x88, 0x5b, 0x39, 0x47, 0x29, 0xc1, 0x95, 0xb8, 0x5b, 0x43, 0x1f, 0x25,
+   0xd8, 0xd9, 0x82, 0xb5, 0xe7, 0xed, 0x9d, 0x47, 0xb8, 0x89, 0xd4, 0xbc, 0x1a, 0xa5, 0x29, 0xa9,
+   0xf2, 0x10, 0xb8, 0x4e, 0x7d, 0xd2, 0x96, 0x12, 0xf1, 0x9c, 0x54, 0xbd, 0xe1, 0x63, 0x95, 0x92,
+   0x37, 0xbb, 0x44, 0xa4, 0xea, 0xfc, 0x64, 0xac, 0x12, 0x56, 0x86, 0x4a, 0x42, 0xcf, 0x21, 0x78,
+   0xe2, 0x04, 0xd1, 0xe9, 0x32, 0x8e, 0xed, 0xb8, 0xb8, 0x04, 0xb0, 0x5f, 0x4d, 0x12, 0x5a, 0x4d,
+   0x81, 0x52, 0x76, 0x0c, 0x81, 0x57, 0x9f, 0xf4, 0xcf, 0x35, 0xbf, 0x75, 0xea, 0xa9, 0x3b, 0x9a,
+   0xf1, 0x27, 0x8c, 0x32, 0x1e, 0x82, 0x75, 0xe6, 0xaa, 0x5b, 0x21, 0xac, 0x1e, 0xee, 0x41, 0x43,
+   0x89, 0x0a, 0x5d, 0x46, 0x6d, 0xeb, 0xc7, 0x44, 0x82, 0x48, 0x2a, 0x69, 0x7a, 0x3f, 0x92, 0x54,
+   0x14, 0x0a, 0xd8, 0xf9, 0x16, 0x7d, 0x98, 0x6e, 0x69, 0xb6, 0x8e, 0x38, 0x7e, 0x25, 0xc2, 0x42,
+   0x75, 0x2d, 0x85, 0x40, 0x55, 0x22, 0x45, 0xa9, 0x58, 0x85, 0x23, 0x33, 0xde, 0x73, 0x14, 0x64,
+   0x81, 0x49, 0x5e, 0x08, 0x39, 0x3b, 0x90, 0x8d, 0x98, 0x71, 0x39, 0xd5, 0x52, 0x92, 0xb5, 0x4d,
+   0x08, 0xb4, 0x69, 0x00, 0x93, 0x48, 0x29, 0x54, 0x77, 0xc4, 0x5a, 0xa1, 0xd4, 0x35, 0xcb, 0xb1,
+   0x1a, 0x25, 0x44, 0x9c, 0x55, 0xec, 0xfb, 0xa8, 0x77, 0x2a, 0xa4, 0xc3, 0x86, 0x08, 0xc2, 0xa4,
+   0x92, 0xb6, 0xd7, 0x44, 0xe3, 0xb6, 0x99, 0xa0, 0xed, 0x03, 0x6f, 0x58, 0xb0, 0x37, 0x45, 0x3d,
+   0xac, 0xe6, 0x8e, 0xfa, 0x42, 0xab, 0x64, 0x3f, 0x25, 0x56, 0x95, 0x63, 0x4b, 0x14, 0x6d, 0x19,
+   0x0f, 0x41, 0x7b, 0xc1, 0x28, 0x06, 0x6f, 0x29, 0x06, 0x29, 0xca, 0x24, 0x06, 0xc7, 0x7f, 0x7a,
+   0xda, 0xbd, 0x44, 0x49, 0xcb, 0x1b, 0x25, 0x73, 0xcd, 0x48, 0x25, 0x30, 0x8f, 0x3a, 0x95, 0x63,
+   0x2a, 0x87, 0xd6, 0x84, 0x52, 0x2d, 0xf4, 0xa5, 0xa5, 0x73, 0xdf, 0xbb, 0x41, 0xad, 0x60, 0x3a,
+   0x69, 0x03, 0x43, 0x9f, 0x6d, 0x1d, 0x65, 0xc6, 0x78, 0x19, 0x82, 0x26, 0x41, 0x14, 0xdf, 0x39,
+   0x76, 0xb0, 0x01, 0x9c, 0x09, 0x24, 0xf0, 0x9d, 0xac, 0xba, 0x14, 0xe7, 0x1b, 0x95, 0x50, 0xbb,
+   0x83, 0xec, 0x96, 0x35, 0xab, 0x3c, 0x3a, 0xfd, 0x2a, 0xbd, 0x1f, 0x38, 0x58, 0x3e, 0xaf, 0xee,
+   0x9c, 0xe3, 0xf3, 0xb6, 0xc3, 0xdf, 0x5c, 0x15, 0x9e, 0x23, 0x6f, 0x55, 0x95, 0xba, 0xbb, 0xab,
+   0x57, 0xd6, 0x27, 0x03, 0xc5, 0x0d, 0xa3, 0xad, 0xc0, 0x1d, 0x3f, 0xab, 0x43, 0x60, 0xb9, 0x43,
+   0x3c, 0x14, 0x67, 0x92, 0xc3, 0x82, 0xd0, 0xec, 0x05, 0xbb, 0x6d, 0xe2, 0x09, 0xf4, 0x65, 0xe8,
+   0xa5, 0x8e, 0xae, 0xa1, 0xa5, 0xea, 0x3b, 0x7d, 0x7d, 0xee, 0x7b, 0x1f, 0xcc, 0x5c, 0x07, 0xb0,
+   0x77, 0x9d, 0xb8, 0x53, 0xd7, 0xfe, 0x95, 0x6b, 0xff, 0x4f, 0x5d, 0x5f, 0xd2, 0x66, 0x72, 0xe5,
+   0x07, 0x5d, 0xaa, 0x6e, 0x71, 0xed, 0xf6, 0x03, 0x95, 0x37, 0xa5, 0x82, 0x57, 0x54, 0x70, 0x91,
+   0xca, 0xd1, 0xd7, 0xdf, 0x52, 0x4d, 0x13, 0xb5, 0xf7, 0x0c, 0xd5, 0x2b, 0x3e, 0xbb, 0xb3, 0xe2,
+   0x9a, 0x51, 0xed, 0x16, 0xa1, 0x9e, 0xf5, 0xf5, 0x69, 0x96, 0xa6, 0x5a, 0xc0, 0x41, 0x0c, 0xe9,
+   0x76, 0xaa, 0x46, 0x10, 0xcc, 0xdc, 0x0e, 0x86, 0xdf, 0xd4, 0x62, 0xb6, 0xa9, 0xd5, 0xab, 0x6e,
+   0xf6, 0x77, 0xa1, 0xdb, 0x4f, 0xe9, 0x0e, 0xbe, 0xa1, 0xa3, 0x38, 0x9d, 0xc0, 0xed, 0xbe, 0xa0,
+   0xc9, 0xad, 0xed, 0x16, 0xd3, 0x16, 0x6f, 0xc1, 0xb1, 0x20, 0x02, 0x6f, 0xfe, 0x15, 0xf7, 0xbc,
+   0xc6, 0xe0, 0xa1, 0x4f, 0x67, 0x4d, 0xaa, 0x66, 0x9a, 0xcf, 0xc3, 0xd5, 0xbe, 0xf3, 0x16, 0x13,
+   0xfa, 0xe3, 0xfb, 0xcb, 0xb3, 0x03, 0xbf, 0xb0, 0xe5, 0xe1, 0x7c, 0xdf, 0x39, 0x70, 0xe4, 0xdc,
+   0xfb, 0x9f, 0xce, 0x5d, 0xf7, 0x96, 0x6f, 0xf5, 0x46, 0x16, 0x84, 0xe2, 0x46, 0xbf, 0x8d, 0x49,
+   0x95, 0xb1, 0x1c, 0xcb, 0x13, 0x0f, 0xd1, 0x2d, 0xd0, 0x2d, 0x2e, 0x58, 0x63, 0x1e, 0x63, 0x86,
+   0x78, 0x6a, 0x9e, 0x45, 0x52, 0x93, 0xba, 0x23, 0xbe, 0x7d, 0xbc, 0x2f, 0x23, 0x77, 0xdf, 0x08,
+   0xda, 0x6e, 0x8e, 0x61, 0x9d, 0xe3, 0xe5, 0x5c, 0x2e, 0x1c, 0xf1, 0xfd, 0x9b, 0x76, 0x9d, 0x65,
+   0xb1, 0xeb, 0x7b, 0x5a, 0xc0, 0x65, 0xee, 0xe1, 0x04, 0x83, 0xba, 0xec, 0xcc, 0x38, 0x1d, 0xc6,
+   0xe5, 0x70, 0x3b, 0x8c, 0xba, 0x4c, 0x54, 0x93, 0xae, 0x41, 0xff, 0xc7, 0x83, 0x1e, 0x28, 0x50,
+   0x4c, 0xf1, 0xe8, 0x6b, 0xa5, 0x0b, 0xd6, 0xea, 0x74, 0x1d, 0x8e, 0x2d, 0x63, 0xe5, 0xe3, 0xd3,
+   0xec, 0x63, 0xf5, 0x0b, 0x07, 0x06, 0xf3, 0x0d, 0x5f, 0x09, 0x00, 0x00,
+};
+
+// app.js, 4859 bytes, 1731 bytes compressed
+static const uint8_t webasset_app_js[1731] = {
+   0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x9d, 0x58, 0x6d, 0x6f, 0xdb, 0x38,
+   0x0c, 0xfe, 0xde, 0x5f, 0xa1, 0x1b, 0x0e, 0xb3, 0x83, 0xa5, 0x4e, 0xba, 0x77, 0x34, 0x75, 0x80,
+   0x6d, 0x6d, 0xb1, 0x1e, 0xb6, 0xb6, 0x68, 0xb2, 0xdd, 0x01, 0xc3, 0xb0, 0x3a, 0x36, 0x13, 0x6b,
+   0xb5, 0x25, 0x9f, 0x24, 0xc7, 0xf5, 0x75, 0xfe, 0xef, 0x47, 0x49, 0x76, 0xe2, 0x64, 0x69, 0xfa,
+   0xd2, 0x0f, 0x49, 0x44, 0x91, 0x14, 0xf9, 0x50, 0xa4, 0xc8, 0xce, 0x03, 0x41, 0xae, 0x63, 0xe1,
+   0x33, 0x28, 0xc8, 0x3f, 0x9f, 0x3f, 0x7d, 0x54, 0x2a, 0xbb, 0x80, 0x7f, 0x73, 0x90, 0xca, 0xed,
+   0x0c, 0x76, 0xe6, 0xb8, 0x2b, 0x13, 0x1a, 0x81, 0xf0, 0x23, 0x1e, 0xe6, 0x29, 0x30, 0xe5, 0xcd,
+   0x40, 0x1d, 0x25, 0xa0, 0x7f, 0xbe, 0x2f, 0x4f, 0x22, 0xd7, 0x49, 0xcb, 0x8b, 0x80, 0xcd, 0xc0,
+   0xa9, 0xd9, 0x27, 0x09, 0x0f, 0xaf, 0xfc, 0xfe, 0x60, 0x67, 0x67, 0x9a, 0xb3, 0x50, 0x51, 0xce,
+   0x48, 0xce, 0x0c, 0xd1, 0xed, 0xdc, 0x34, 0x9b, 0x15, 0x6e, 0xf7, 0x7a, 0x44, 0xc5, 0x50, 0xab,
+   0x27, 0x12, 0x58, 0x24, 0x0d, 0x21, 0xca, 0x55, 0x49, 0xc2, 0x32, 0x4c, 0x80, 0xf0, 0x39, 0xee,
+   0x68, 0x5a, 0x01, 0x13, 0x89, 0x92, 0xa0, 0xba, 0x24, 0x20, 0xf3, 0x20, 0xc9, 0x81, 0x50, 0xa9,
+   0x65, 0x14, 0x29, 0x62, 0x60, 0x8d, 0xae, 0x4c, 0xc0, 0x9c, 0xf2, 0x5c, 0x12, 0xce, 0x0c, 0x43,
+   0xc0, 0x64, 0x01, 0x02, 0x22, 0xfc, 0x11, 0x19, 0x06, 0x23, 0x2a, 0x09, 0x65, 0x64, 0x02, 0xaa,
+   0x00, 0x60, 0x24, 0x10, 0x68, 0xc2, 0x15, 0xcd, 0x32, 0x88, 0x8c, 0xf9, 0x85, 0xf4, 0x59, 0x9e,
+   0x24, 0x83, 0x7a, 0xf1, 0x3e, 0x97, 0xa5, 0x76, 0xc6, 0xae, 0xce, 0xd1, 0x48, 0xca, 0x66, 0xfe,
+   0xee, 0x5e, 0xdb, 0x3d, 0x6d, 0xfa, 0x21, 0x1a, 0xed, 0x1a, 0xed, 0x9d, 0x9b, 0x1d, 0x42, 0x08,
+   0x9d, 0xba, 0xb5, 0xb0, 0xbf, 0x67, 0x29, 0xf8, 0xb7, 0x54, 0x60, 0x38, 0x07, 0x35, 0x59, 0x80,
+   0xca, 0x05, 0x33, 0xab, 0x6a, 0xc7, 0xb0, 0x19, 0xc1, 0xbd, 0x81, 0x5d, 0x78, 0x5a, 0xbf, 0xab,
+   0xe3, 0xf3, 0x85, 0x32, 0xf5, 0xf6, 0x9d, 0x10, 0x41, 0xe9, 0x7e, 0xeb, 0x5f, 0xf7, 0xf7, 0xba,
+   0xd6, 0x9f, 0xef, 0x1d, 0x84, 0x5e, 0x23, 0xaa, 0x0f, 0xa5, 0x2c, 0xe2, 0x85, 0xf7, 0x37, 0x4c,
+   0x46, 0x06, 0x2f, 0x7b, 0xb6, 0x76, 0x0a, 0xe5, 0x17, 0x54, 0xd7, 0x29, 0xe4, 0x7e, 0xaf, 0xe7,
+   0x3c, 0xc3, 0x70, 0x04, 0xda, 0x07, 0x2f, 0xe6, 0x52, 0x3d, 0x73, 0x7a, 0x85, 0xd4, 0x61, 0xb4,
+   0xc7, 0x4e, 0x28, 0x0b, 0x44, 0x39, 0x2e, 0x33, 0xf0, 0x9d, 0x40, 0x1f, 0x3a, 0xc9, 0xa7, 0x53,
+   0x10, 0x4e, 0xb3, 0xcf, 0x59, 0x0a, 0x52, 0x06, 0x33, 0xf0, 0x1b, 0x24, 0x5c, 0x58, 0xb8, 0x5a,
+   0x07, 0x44, 0x40, 0x96, 0x94, 0x84, 0x4f, 0x31, 0x6a, 0x36, 0xac, 0x3c, 0x4d, 0x31, 0x16, 0x5d,
+   0xc2, 0x85, 0xa1, 0x32, 0x0c, 0x05, 0xfa, 0x40, 0x23, 0x1d, 0xb1, 0x5a, 0x34, 0x01, 0x45, 0x68,
+   0xe4, 0xaf, 0x39, 0x0c, 0x5e, 0x14, 0xa8, 0xa0, 0xf3, 0xad, 0xff, 0xbd, 0x81, 0x0d, 0xbd, 0x45,
+   0x36, 0xbf, 0x7f, 0xfd, 0x76, 0x8f, 0xfc, 0xfa, 0x45, 0xec, 0xef, 0xe3, 0xe3, 0x85, 0x09, 0x4b,
+   0x24, 0xfb, 0x83, 0x25, 0xc9, 0x04, 0xa6, 0x0e, 0xc3, 0xd0, 0xef, 0xb7, 0xb9, 0xeb, 0xb3, 0x0d,
+   0xa6, 0xfe, 0x82, 0x69, 0xb0, 0xc2, 0xb0, 0x7a, 0x07, 0xda, 0x3b, 0x6b, 0xb7, 0xa0, 0xb5, 0x59,
+   0xed, 0xb4, 0xbe, 0xab, 0x25, 0x7c, 0x61, 0xc2, 0x65, 0x0b, 0xbc, 0xce, 0x4d, 0x73, 0xf7, 0x90,
+   0xa7, 0x32, 0xf9, 0x61, 0xd2, 0x85, 0x30, 0xb8, 0x56, 0x24, 0xc3, 0x00, 0x21, 0x9c, 0x26, 0x33,
+   0x89, 0x12, 0x74, 0x36, 0x03, 0xa1, 0xc8, 0xa4, 0x6c, 0xe7, 0xd0, 0x14, 0x51, 0xdd, 0x7b, 0xd5,
+   0x27, 0x29, 0x26, 0x12, 0x27, 0xc1, 0x9c, 0x23, 0xae, 0x4f, 0x64, 0x16, 0xa4, 0x29, 0x1a, 0xfc,
+   0x64, 0xc7, 0x72, 0xe1, 0xc1, 0x94, 0x65, 0xb9, 0x6a, 0x1f, 0xbc, 0xb8, 0xb1, 0x7f, 0x18, 0x03,
+   0xc8, 0xd3, 0xa7, 0xda, 0x42, 0x01, 0x41, 0x54, 0x8e, 0x54, 0xa0, 0xc0, 0xf7, 0x17, 0x57, 0xc7,
+   0x3b, 0x3b, 0x3f, 0x3a, 0x5d, 0xa0, 0xb6, 0x70, 0xfa, 0x34, 0x4f, 0x27, 0x20, 0x5c, 0x15, 0x53,
+   0xe9, 0x59, 0x00, 0x2c, 0x02, 0x15, 0x24, 0x12, 0xb4, 0x6e, 0x9b, 0xf9, 0x2d, 0xc0, 0x2d, 0x61,
+   0x01, 0xa2, 0x4e, 0xb0, 0x5c, 0x24, 0xda, 0x4d, 0xdf, 0xe9, 0x25, 0x10, 0xfd, 0x90, 0xa0, 0x7e,
+   0x18, 0x55, 0x78, 0x4f, 0x97, 0x7a, 0x1b, 0x7e, 0xac, 0x59, 0x1e, 0xcf, 0x80, 0xb9, 0xce, 0xf9,
+   0xd9, 0x68, 0xec, 0x74, 0x1b, 0xe1, 0x2e, 0x82, 0xd3, 0x82, 0x5f, 0xb3, 0xa1, 0xa2, 0xba, 0xa4,
+   0x7d, 0x44, 0x8f, 0xd0, 0x4a, 0xe7, 0x03, 0x67, 0x0a, 0x6b, 0xc7, 0xae, 0xbe, 0xdc, 0x28, 0xea,
+   0x04, 0x59, 0x96, 0x50, 0x9b, 0x09, 0xbd, 0xeb, 0xdd, 0xa2, 0x28, 0x76, 0x11, 0xca, 0x74, 0x17,
+   0x55, 0x02, 0x0b, 0x79, 0x04, 0xd1, 0x80, 0x84, 0x71, 0x20, 0x50, 0x91, 0xff, 0x65, 0x7c, 0xbc,
+   0xfb, 0xd6, 0x59, 0xd3, 0x8f, 0xf9, 0xe9, 0xfc, 0x07, 0x82, 0x2f, 0xe9, 0xc8, 0x3a, 0xa6, 0x29,
+   0xf0, 0x5c, 0xb9, 0x75, 0xf5, 0xeb, 0xea, 0xd0, 0xd4, 0xa0, 0x98, 0x6c, 0x0d, 0x64, 0xc9, 0x42,
+   0xb2, 0xa8, 0x22, 0x58, 0x56, 0xff, 0x1a, 0x9d, 0x9d, 0xba, 0x78, 0xa8, 0xc5, 0x48, 0x89, 0xf2,
+   0xa6, 0x95, 0x12, 0x02, 0xeb, 0x96, 0x4f, 0x82, 0x22, 0xa0, 0x8a, 0x4c, 0x41, 0x85, 0xb1, 0xe1,
+   0x5c, 0xad, 0x21, 0xf5, 0x36, 0xb2, 0x7a, 0x3f, 0xa5, 0x8e, 0xac, 0x3d, 0x0e, 0x3d, 0x43, 0x76,
+   0x10, 0x82, 0x8b, 0x05, 0xfc, 0x21, 0x67, 0x92, 0x27, 0xe0, 0x25, 0x7c, 0x56, 0xef, 0xb4, 0x4c,
+   0xc3, 0xab, 0x17, 0x61, 0x25, 0x0d, 0x31, 0x72, 0x6c, 0xca, 0xbb, 0xb6, 0xb6, 0x62, 0xa6, 0x13,
+   0xaa, 0x24, 0x24, 0x53, 0x53, 0x7b, 0xf1, 0x5e, 0xd0, 0xd0, 0x14, 0xd6, 0x30, 0x08, 0x63, 0xac,
+   0xb1, 0xf5, 0x5d, 0x9c, 0x08, 0x5e, 0x48, 0x10, 0xeb, 0xee, 0x09, 0x04, 0x09, 0xc4, 0x09, 0xaa,
+   0xab, 0xef, 0x9b, 0x49, 0x73, 0x5c, 0x2e, 0x9c, 0x6a, 0x00, 0x70, 0x34, 0xd5, 0xd8, 0x5f, 0xc3,
+   0x79, 0xeb, 0xcb, 0x43, 0x33, 0xa7, 0xe3, 0x29, 0xcc, 0x8e, 0x3a, 0x9e, 0xa8, 0xca, 0xc8, 0xd2,
+   0x6c, 0xbb, 0x5c, 0x1a, 0x84, 0x9b, 0x05, 0x71, 0x63, 0xbb, 0xe4, 0x4c, 0xdf, 0x22, 0xb9, 0x59,
+   0xd8, 0xee, 0x6d, 0x97, 0x17, 0x8a, 0x4b, 0x7c, 0xd3, 0x24, 0xd5, 0xce, 0x6d, 0x52, 0xa2, 0x19,
+   0x8c, 0x8a, 0x3a, 0x59, 0xed, 0x5b, 0x57, 0x6f, 0xea, 0x12, 0x6a, 0x2b, 0x7d, 0x1b, 0xcd, 0xe5,
+   0x53, 0x5a, 0xbf, 0x6e, 0x58, 0x58, 0x9b, 0x80, 0x75, 0x49, 0x0a, 0x62, 0x86, 0xc1, 0x99, 0x0a,
+   0x9e, 0x1a, 0x2a, 0xcc, 0xf1, 0x34, 0xa9, 0xeb, 0xaf, 0x5e, 0x69, 0x94, 0xc9, 0x94, 0x26, 0x20,
+   0xed, 0x53, 0x6f, 0x92, 0xfd, 0xa6, 0x6a, 0xbf, 0x6e, 0xf6, 0x28, 0x7d, 0x99, 0x5d, 0x85, 0x1f,
+   0xcb, 0xe0, 0xc5, 0x2a, 0x4d, 0xd0, 0xb2, 0xcb, 0x83, 0x88, 0xce, 0x49, 0x98, 0x04, 0x52, 0xfa,
+   0x8e, 0xe6, 0x70, 0x86, 0x5f, 0x32, 0xfd, 0xbd, 0x4f, 0xfe, 0xbc, 0xd1, 0xdf, 0x5e, 0x54, 0x91,
+   0x28, 0x28, 0x65, 0xb7, 0x59, 0xc7, 0x15, 0x89, 0x79, 0x2e, 0x96, 0x84, 0xb4, 0x22, 0x58, 0xa1,
+   0x72, 0x05, 0x4b, 0x92, 0xac, 0x30, 0x85, 0xf0, 0x8e, 0x46, 0xf2, 0xa0, 0x87, 0xfa, 0x87, 0x97,
+   0xab, 0xb8, 0x62, 0x36, 0x8b, 0x72, 0x04, 0x09, 0x84, 0x8a, 0x63, 0x3e, 0x7b, 0x5a, 0x06, 0xb9,
+   0x55, 0x40, 0x19, 0xbe, 0x50, 0x1d, 0x8f, 0x32, 0xfc, 0xfe, 0x38, 0xfe, 0xfc, 0x09, 0x0d, 0xd4,
+   0x76, 0x5a, 0xd4, 0xd6, 0x7c, 0xba, 0x40, 0xac, 0x5d, 0x0d, 0xf8, 0x76, 0x9f, 0x34, 0x87, 0x33,
+   0xbc, 0x7c, 0xb6, 0x52, 0xed, 0xcd, 0xdf, 0xe5, 0x41, 0x36, 0x3c, 0x16, 0x00, 0x04, 0xeb, 0x4a,
+   0xa6, 0xdd, 0xd5, 0xac, 0x5e, 0x8c, 0x8b, 0x0a, 0xb3, 0x01, 0xdd, 0x39, 0xe8, 0x65, 0xb7, 0x08,
+   0xaa, 0x60, 0x82, 0xfd, 0x8d, 0x54, 0x65, 0x82, 0xaf, 0x6b, 0xc8, 0x13, 0x2e, 0xf6, 0x8b, 0x98,
+   0x2a, 0xd8, 0x7c, 0x90, 0x15, 0x11, 0xc3, 0x03, 0x15, 0x0d, 0x2f, 0x72, 0x86, 0x05, 0x7c, 0x46,
+   0xc6, 0x81, 0xbc, 0xc2, 0x03, 0x90, 0x82, 0x1f, 0xe2, 0x2e, 0xb1, 0xe6, 0xa8, 0x82, 0x46, 0x2a,
+   0xde, 0xc7, 0x4a, 0x94, 0x5d, 0x3b, 0xc3, 0xd3, 0x20, 0x05, 0xab, 0x61, 0x9d, 0xc1, 0xee, 0x9f,
+   0x0b, 0xca, 0x05, 0x55, 0xe5, 0xbd, 0x4f, 0x19, 0xd6, 0x10, 0xa8, 0x3d, 0x56, 0x35, 0x8a, 0x97,
+   0xb4, 0xac, 0x7a, 0xb8, 0xa2, 0xe7, 0x1b, 0x14, 0x3d, 0x7f, 0x8c, 0xa2, 0x17, 0x1b, 0x14, 0xbd,
+   0x78, 0x8c, 0xa2, 0x97, 0x1b, 0x14, 0xbd, 0x7c, 0x8c, 0xa2, 0x57, 0x1b, 0x14, 0xbd, 0x7a, 0x8c,
+   0xa2, 0xd7, 0x1b, 0x14, 0xbd, 0x7e, 0x8c, 0xa2, 0x37, 0x1b, 0x14, 0xbd, 0xb9, 0x4b, 0xd1, 0x25,
+   0xee, 0xe8, 0xcb, 0xfc, 0xfb, 0xe6, 0xe5, 0xbd, 0x52, 0x57, 0x1f, 0xf3, 0xe0, 0xd4, 0x1d, 0x01,
+   0xbe, 0x5e, 0xc2, 0x95, 0xe6, 0x6b, 0x7b, 0xfa, 0x5a, 0x9e, 0xdb, 0x13, 0xf8, 0x7d, 0xae, 0x14,
+   0x67, 0x3a, 0x7b, 0x2d, 0xa7, 0x37, 0x51, 0x1a, 0x86, 0xec, 0x56, 0x81, 0x31, 0xa4, 0x19, 0x88,
+   0x00, 0xdf, 0x5b, 0x68, 0x49, 0x29, 0xa4, 0x56, 0xe4, 0xc3, 0x36, 0xc1, 0xaf, 0x3c, 0x51, 0x58,
+   0x93, 0x5b, 0x42, 0x73, 0xa4, 0x54, 0xe4, 0xeb, 0x46, 0xa1, 0xfb, 0xa1, 0x67, 0x15, 0x3d, 0x18,
+   0xbf, 0x71, 0x98, 0x9d, 0x64, 0xae, 0x0a, 0x33, 0x9a, 0xdd, 0x51, 0xd0, 0x35, 0xcb, 0xed, 0xe0,
+   0x5d, 0x40, 0x08, 0x74, 0x8e, 0xef, 0xcb, 0x11, 0xbe, 0x26, 0x82, 0xa1, 0x92, 0x63, 0x81, 0x45,
+   0x45, 0x9a, 0xda, 0xaf, 0x45, 0x3d, 0x71, 0x7d, 0xbc, 0x15, 0xcd, 0x85, 0x86, 0x43, 0x6c, 0xef,
+   0xdb, 0x62, 0x87, 0x15, 0x79, 0xbf, 0xbd, 0x86, 0x62, 0x28, 0x04, 0x4e, 0x78, 0x29, 0x55, 0x6a,
+   0x9b, 0x05, 0xea, 0x0e, 0x0b, 0xda, 0x4a, 0x56, 0x8d, 0x50, 0xdb, 0x8d, 0xb8, 0x5f, 0x84, 0x8c,
+   0xaa, 0x07, 0x07, 0xe8, 0x5d, 0x92, 0xd4, 0x7d, 0x52, 0xeb, 0xfd, 0x35, 0xcf, 0xb3, 0xed, 0x89,
+   0x5a, 0x2f, 0xd8, 0x6f, 0xd4, 0x26, 0x39, 0xd6, 0xe9, 0x36, 0xe8, 0x0d, 0xb9, 0xee, 0xf3, 0x32,
+   0x9e, 0x24, 0x72, 0xad, 0x17, 0xe8, 0x62, 0xc3, 0x6e, 0xe7, 0x0a, 0x10, 0x7a, 0x02, 0x8f, 0x03,
+   0x49, 0x18, 0xb7, 0xad, 0x03, 0xbe, 0x13, 0x38, 0x17, 0xa4, 0xeb, 0xed, 0x9d, 0x56, 0xb3, 0x6c,
+   0x5d, 0xcf, 0x26, 0x3f, 0xd1, 0x7d, 0x0f, 0x6f, 0x10, 0x9d, 0x31, 0x7b, 0x62, 0x77, 0xad, 0xcb,
+   0xd3, 0xbc, 0x6d, 0xe3, 0x8c, 0xc3, 0x6b, 0x50, 0xa0, 0xa0, 0x50, 0xe7, 0xa8, 0x19, 0xdf, 0xbb,
+   0x1a, 0x0d, 0x73, 0x8e, 0x79, 0x92, 0xdb, 0x1d, 0x22, 0x76, 0xeb, 0xae, 0x6e, 0x68, 0x95, 0x9e,
+   0x02, 0x74, 0xff, 0xf3, 0xcd, 0x74, 0x22, 0x96, 0x05, 0xfb, 0xfb, 0x3a, 0xdd, 0x9a, 0xa5, 0x8d,
+   0xae, 0x59, 0x7d, 0x5f, 0x34, 0xc4, 0x0b, 0x0f, 0x5a, 0x2d, 0xfc, 0x09, 0xf6, 0x66, 0x02, 0xbb,
+   0x2a, 0x57, 0x6f, 0x62, 0x03, 0xdf, 0xef, 0xf7, 0xcd, 0xa0, 0xb1, 0xd6, 0x2b, 0xb7, 0xa0, 0xca,
+   0x72, 0x19, 0x83, 0xc5, 0x13, 0x27, 0x06, 0xa6, 0x5b, 0xaf, 0xa6, 0x2b, 0x63, 0xe6, 0xbf, 0x12,
+   0x68, 0x26, 0x03, 0xe3, 0x5e, 0x6b, 0x5c, 0x3f, 0xd2, 0xc8, 0x8e, 0xb0, 0x27, 0x0a, 0xeb, 0xfe,
+   0x4a, 0x37, 0x63, 0xb6, 0x53, 0x33, 0x73, 0x70, 0x6b, 0xdf, 0x75, 0x2c, 0xbd, 0xf6, 0xdc, 0x2e,
+   0xb6, 0xcf, 0xe2, 0x1b, 0xa3, 0xa1, 0x83, 0xe0, 0x65, 0x7a, 0xa6, 0x69, 0x46, 0xeb, 0xd6, 0x2c,
+   0xd1, 0x0a, 0xc8, 0x62, 0x64, 0x6d, 0xfc, 0x34, 0xe1, 0xd7, 0x13, 0x80, 0x19, 0x5f, 0x23, 0x33,
+   0x74, 0xce, 0x38, 0x8f, 0xd6, 0xee, 0x4c, 0xc4, 0x41, 0x5f, 0x1a, 0x45, 0xae, 0x18, 0x2f, 0x70,
+   0x6e, 0x58, 0x31, 0xd6, 0x0c, 0x1c, 0xeb, 0x03, 0xa8, 0x9d, 0x41, 0x6b, 0x9e, 0xf6, 0xec, 0xd9,
+   0xf2, 0xde, 0xfb, 0xf0, 0xe9, 0x6c, 0x74, 0x74, 0xd8, 0x9e, 0xda, 0x57, 0x2f, 0xc9, 0x60, 0x6d,
+   0xd6, 0x36, 0xf3, 0xa7, 0xe1, 0x5e, 0xe7, 0xab, 0x76, 0xfe, 0x07, 0x83, 0x50, 0xd1, 0xaf, 0xfb,
+   0x12, 0x00, 0x00,
+};
+
+// favicon.ico, 318 bytes, 212 bytes compressed
+static const uint8_t webasset_favicon_ico[212] = {
+   0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x85, 0x8b, 0x31, 0x6e, 0xc2, 0x40,
+   0x14, 0x44, 0x07, 0x41, 0xe4, 0xc6, 0x12, 0xfb, 0x43, 0x62, 0x44, 0x15, 0xd8, 0x26, 0x6e, 0x28,
+   0xac, 0x2f, 0x91, 0x2e, 0x11, 0x92, 0x0f, 0x00, 0x05, 0x07, 0x40, 0x2b, 0xb9, 0x8f, 0x29, 0xb6,
+   0x4d, 0xaa, 0x94, 0x39, 0x4c, 0x2e, 0xc0, 0x51, 0xf0, 0x0d, 0x48, 0x67, 0xd1, 0x90, 0xf9, 0x41,
+   0x56, 0x94, 0x8a, 0xd9, 0x9d, 0xff, 0x46, 0x7f, 0x76, 0x81, 0x1e, 0x8f, 0x73, 0x8e, 0x73, 0x80,
+   0xbc, 0x07, 0x64, 0x00, 0x72, 0xda, 0xd1, 0x53, 0xda, 0xf6, 0xa6, 0x37, 0xfc, 0xc9, 0x75, 0xa1,
+   0x39, 0xff, 0xe2, 0xf4, 0x3c, 0xc1, 0xfb, 0x97, 0xe5, 0x33, 0xb2, 0xf9, 0x0a, 0x37, 0x92, 0x23,
+   0x4d, 0x4f, 0xb8, 0x26, 0xb9, 0xdf, 0xac, 0x79, 0x45, 0xc4, 0x48, 0x48, 0x7c, 0x1d, 0x47, 0x42,
+   0x23, 0xa5, 0xe4, 0x53, 0x92, 0xec, 0x8c, 0x3e, 0x46, 0x4f, 0x7a, 0x5f, 0x3f, 0x7a, 0x2f, 0x72,
+   0x6b, 0x9c, 0xf1, 0xa1, 0xaf, 0xbd, 0x7d, 0x93, 0x91, 0x2a, 0x6b, 0xc9, 0x82, 0x2e, 0xaa, 0x2d,
+   0xb9, 0x08, 0x1a, 0xd4, 0xa8, 0x85, 0x16, 0x2c, 0xaa, 0x50, 0x18, 0xa4, 0xa4, 0x96, 0xe4, 0x5d,
+   0x59, 0x72, 0x36, 0x1f, 0xc0, 0xf7, 0xe7, 0xc5, 0xfb, 0xfe, 0x7f, 0x1f, 0x12, 0xe0, 0xf8, 0x02,
+   0xb4, 0xc3, 0x4b, 0x3e, 0x74, 0xbb, 0x07, 0x9a, 0x6c, 0xd9, 0xfd, 0x00, 0x6f, 0x0d, 0xc4, 0x5d,
+   0x3e, 0x01, 0x00, 0x00,
+};
+
+// 9858 bytes, 3504 bytes compressed
+const webasset_t webassets[] = {
+   {
+      .uri                 = "/",
+      .etag                = "\"f3267d71b39745d0\"",
+      .header              = "HTTP/1.1 200 OK\r\nContent-Type: text/html; charset=utf-8\r\nContent-Encoding: gzip\r\nContent-Length: 797\r\nCache-Control: no-cache\r\nETag: \"f3267d71b39745d0\"\r\n\r\n",
+      .headerLength        = 155,
+      .notModified         = "HTTP/1.1 304 Not Modified\r\nCache-Control: no-cache\r\nETag: \"f3267d71b39745d0\"\r\n\r\n",
+      .notModifiedLength   = 80,
+      .data                = webasset_index_html,
+      .length              = 797,
+   },
+   {
+      .uri                 = "/style.css",
+      .etag                = "\"720850e649b3f407\"",
+      .header              = "HTTP/1.1 200 OK\r\nContent-Type: text/css; charset=utf-8\r\nContent-Encoding: gzip\r\nContent-Length: 764\r\nCache-Control: max-age=86400\r\nETag: \"720850e649b3f407\"\r\n\r\n",
+      .headerLength        = 159,
+      .notModified         = "HTTP/1.1 304 Not Modified\r\nCache-Control: max-age=86400\r\nETag: \"720850e649b3f407\"\r\n\r\n",
+      .notModifiedLength   = 85,
+      .data                = webasset_style_css,
+      .length              = 764,
+   },
+   {
+      .uri                 = "/app.js",
+      .etag                = "\"c473e085ad3841ea\"",
+      .header              = "HTTP/1.1 200 OK\r\nContent-Type: text/javascript; charset=utf-8\r\nContent-Encoding: gzip\r\nContent-Length: 1731\r\nCache-Control: max-age=86400\r\nETag: \"c473e085ad3841ea\"\r\n\r\n",
+      .headerLength        = 167,
+      .notModified         = "HTTP/1.1 304 Not Modified\r\nCache-Control: max-age=86400\r\nETag: \"c473e085ad3841ea\"\r\n\r\n",
+      .notModifiedLength   = 85,
+      .data                = webasset_app_js,
+      .length              = 1731,
+   },
+   {
+      .uri                 = "/favicon.ico",
+      .etag                = "\"c204636ef1b34018\"",
+      .header              = "HTTP/1.1 200 OK\r\nContent-Type: image/x-icon\r\nContent-Encoding: gzip\r\nContent-Length: 212\r\nCache-Control: max-age=604800\r\nETag: \"c204636ef1b34018\"\r\n\r\n",
+      .headerLength        = 149,
+      .notModified         = "HTTP/1.1 304 Not Modified\r\nCache-Control: max-age=604800\r\nETag: \"c204636ef1b34018\"\r\n\r\n",
+      .notModifiedLength   = 86,
+      .data                = webasset_favicon_ico,
+      .length              = 212,
+   },
+};
+
+const uint16_t webassetsCount = sizeof( webassets ) / sizeof( webassets[0] );
+
+// info.json, 13 values
+static const webtemplate_part_t webtemplate_info_json_parts[] = {
+   { WEBTEMPLATE_TEXT, 0, 132, "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nX-Content-Type-Options: nosniff\r\nCache-Control: no-cache\r\n\r\n{\"ip\": \"" },
+   { WEBTEMPLATE_U32, INFO_JSON_IP0, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 1, "." },
+   { WEBTEMPLATE_U32, INFO_JSON_IP1, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 1, "." },
+   { WEBTEMPLATE_U32, INFO_JSON_IP2, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 1, "." },
+   { WEBTEMPLATE_U32, INFO_JSON_IP3, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"mac\": \"" },
+   { WEBTEMPLATE_X2, INFO_JSON_MAC0, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 1, ":" },
+   { WEBTEMPLATE_X2, INFO_JSON_MAC1, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 1, ":" },
+   { WEBTEMPLATE_X2, INFO_JSON_MAC2, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 1, ":" },
+   { WEBTEMPLATE_X2, INFO_JSON_MAC3, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 1, ":" },
+   { WEBTEMPLATE_X2, INFO_JSON_MAC4, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 1, ":" },
+   { WEBTEMPLATE_X2, INFO_JSON_MAC5, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 13, "\",\"guests\": \"" },
+   { WEBTEMPLATE_U32, INFO_JSON_GUESTS, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 11, "\",\"rtos\": \"" },
+   { WEBTEMPLATE_STR, INFO_JSON_RTOS, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 11, "\",\"duty\": \"" },
+   { WEBTEMPLATE_U32, INFO_JSON_DUTY, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 2, "\"}" },
+};
+
+static const char* const webtemplate_info_json_names[] = {
+   "ip0",
+   "ip1",
+   "ip2",
+   "ip3",
+   "mac0",
+   "mac1",
+   "mac2",
+   "mac3",
+   "mac4",
+   "mac5",
+   "guests",
+   "rtos",
+   "duty",
+};
+
+static const webtemplate_type_t webtemplate_info_json_types[] = {
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_X2,
+   WEBTEMPLATE_X2,
+   WEBTEMPLATE_X2,
+   WEBTEMPLATE_X2,
+   WEBTEMPLATE_X2,
+   WEBTEMPLATE_X2,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_STR,
+   WEBTEMPLATE_U32,
+};
+
+const webtemplate_t webtemplate_info_json = {
+   .parts               = webtemplate_info_json_parts,
+   .partsCount          = sizeof( webtemplate_info_json_parts ) / sizeof( webtemplate_info_json_parts[0] ),
+   .names               = webtemplate_info_json_names,
+   .types               = webtemplate_info_json_types,
+   .valuesCount         = 13,
+};
+
+// time.json, 4 values
+static const webtemplate_part_t webtemplate_time_json_parts[] = {
+   { WEBTEMPLATE_TEXT, 0, 131, "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nX-Content-Type-Options: nosniff\r\nCache-Control: no-cache\r\n\r\n{\"d\": \"" },
+   { WEBTEMPLATE_U32, TIME_JSON_D, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 8, "\",\"h\": \"" },
+   { WEBTEMPLATE_U32, TIME_JSON_H, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 8, "\",\"m\": \"" },
+   { WEBTEMPLATE_U32, TIME_JSON_M, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 8, "\",\"s\": \"" },
+   { WEBTEMPLATE_U32, TIME_JSON_S, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 2, "\"}" },
+};
+
+static const char* const webtemplate_time_json_names[] = {
+   "d",
+   "h",
+   "m",
+   "s",
+};
+
+static const webtemplate_type_t webtemplate_time_json_types[] = {
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+};
+
+const webtemplate_t webtemplate_time_json = {
+   .parts               = webtemplate_time_json_parts,
+   .partsCount          = sizeof( webtemplate_time_json_parts ) / sizeof( webtemplate_time_json_parts[0] ),
+   .names               = webtemplate_time_json_names,
+   .types               = webtemplate_time_json_types,
+   .valuesCount         = 4,
+};
+
+// rtos.json, 15 values
+static const webtemplate_part_t webtemplate_rtos_json_parts[] = {
+   { WEBTEMPLATE_TEXT, 0, 134, "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nX-Content-Type-Options: nosniff\r\nCache-Control: no-cache\r\n\r\n{\"heap\": \"" },
+   { WEBTEMPLATE_U32, RTOS_JSON_HEAP, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t1n\": \"" },
+   { WEBTEMPLATE_STR, RTOS_JSON_T1N, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t2n\": \"" },
+   { WEBTEMPLATE_STR, RTOS_JSON_T2N, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t3n\": \"" },
+   { WEBTEMPLATE_STR, RTOS_JSON_T3N, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t4n\": \"" },
+   { WEBTEMPLATE_STR, RTOS_JSON_T4N, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t5n\": \"" },
+   { WEBTEMPLATE_STR, RTOS_JSON_T5N, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t6n\": \"" },
+   { WEBTEMPLATE_STR, RTOS_JSON_T6N, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t7n\": \"" },
+   { WEBTEMPLATE_STR, RTOS_JSON_T7N, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t1p\": \"" },
+   { WEBTEMPLATE_U32, RTOS_JSON_T1P, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t2p\": \"" },
+   { WEBTEMPLATE_U32, RTOS_JSON_T2P, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t3p\": \"" },
+   { WEBTEMPLATE_U32, RTOS_JSON_T3P, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t4p\": \"" },
+   { WEBTEMPLATE_U32, RTOS_JSON_T4P, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t5p\": \"" },
+   { WEBTEMPLATE_U32, RTOS_JSON_T5P, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t6p\": \"" },
+   { WEBTEMPLATE_U32, RTOS_JSON_T6P, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"t7p\": \"" },
+   { WEBTEMPLATE_U32, RTOS_JSON_T7P, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 2, "\"}" },
+};
+
+static const char* const webtemplate_rtos_json_names[] = {
+   "heap",
+   "t1n",
+   "t2n",
+   "t3n",
+   "t4n",
+   "t5n",
+   "t6n",
+   "t7n",
+   "t1p",
+   "t2p",
+   "t3p",
+   "t4p",
+   "t5p",
+   "t6p",
+   "t7p",
+};
+
+static const webtemplate_type_t webtemplate_rtos_json_types[] = {
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_STR,
+   WEBTEMPLATE_STR,
+   WEBTEMPLATE_STR,
+   WEBTEMPLATE_STR,
+   WEBTEMPLATE_STR,
+   WEBTEMPLATE_STR,
+   WEBTEMPLATE_STR,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+};
+
+const webtemplate_t webtemplate_rtos_json = {
+   .parts               = webtemplate_rtos_json_parts,
+   .partsCount          = sizeof( webtemplate_rtos_json_parts ) / sizeof( webtemplate_rtos_json_parts[0] ),
+   .names               = webtemplate_rtos_json_names,
+   .types               = webtemplate_rtos_json_types,
+   .valuesCount         = 15,
+};
+
+// sensor.json, 3 values
+static const webtemplate_part_t webtemplate_sensor_json_parts[] = {
+   { WEBTEMPLATE_TEXT, 0, 133, "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nX-Content-Type-Options: nosniff\r\nCache-Control: no-cache\r\n\r\n{\"btn\": \"" },
+   { WEBTEMPLATE_STR, SENSOR_JSON_BTN, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 11, "\",\"temp\": \"" },
+   { WEBTEMPLATE_F1, SENSOR_JSON_TEMP, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 11, "\",\"volt\": \"" },
+   { WEBTEMPLATE_F2, SENSOR_JSON_VOLT, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 2, "\"}" },
+};
+
+static const char* const webtemplate_sensor_json_names[] = {
+   "btn",
+   "temp",
+   "volt",
+};
+
+static const webtemplate_type_t webtemplate_sensor_json_types[] = {
+   WEBTEMPLATE_STR,
+   WEBTEMPLATE_F1,
+   WEBTEMPLATE_F2,
+};
+
+const webtemplate_t webtemplate_sensor_json = {
+   .parts               = webtemplate_sensor_json_parts,
+   .partsCount          = sizeof( webtemplate_sensor_json_parts ) / sizeof( webtemplate_sensor_json_parts[0] ),
+   .names               = webtemplate_sensor_json_names,
+   .types               = webtemplate_sensor_json_types,
+   .valuesCount         = 3,
+};
+
+// tcpip.json, 24 values
+static const webtemplate_part_t webtemplate_tcpip_json_parts[] = {
+   { WEBTEMPLATE_TEXT, 0, 133, "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nX-Content-Type-Options: nosniff\r\nCache-Control: no-cache\r\n\r\n{\"rxF\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXF, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"txF\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_TXF, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"rxD\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXD, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 10, "\",\"txD\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_TXD, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 12, "\",\"txIrq\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_TXIRQ, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 17, "\",\"txDropTail\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_TXDROPTAIL, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 17, "\",\"txDropHead\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_TXDROPHEAD, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 18, "\",\"txDropEarly\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_TXDROPEARLY, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 13, "\",\"txWait\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_TXWAIT, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 13, "\",\"txLost\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_TXLOST, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 17, "\",\"rxDropTail\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXDROPTAIL, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 17, "\",\"rxDropHead\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXDROPHEAD, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 18, "\",\"rxDropEarly\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXDROPEARLY, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 15, "\",\"rxArmMax\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXARMMAX, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 15, "\",\"rxIsrMax\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXISRMAX, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 17, "\",\"rxFiltered\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXFILTERED, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 13, "\",\"rxLent\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXLENT, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 16, "\",\"rxCopyCyc\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXCOPYCYC, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 12, "\",\"txRef\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_TXREF, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 17, "\",\"rxNotEthII\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXNOTETHII, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 18, "\",\"rxEtherType\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXETHERTYPE, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 15, "\",\"rxEvents\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXEVENTS, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 17, "\",\"ipQueueMin\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_IPQUEUEMIN, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 20, "\",\"rxChecksumErr\": \"" },
+   { WEBTEMPLATE_U32, TCPIP_JSON_RXCHECKSUMERR, 0, NULL },
+   { WEBTEMPLATE_TEXT, 0, 2, "\"}" },
+};
+
+static const char* const webtemplate_tcpip_json_names[] = {
+   "rxF",
+   "txF",
+   "rxD",
+   "txD",
+   "txIrq",
+   "txDropTail",
+   "txDropHead",
+   "txDropEarly",
+   "txWait",
+   "txLost",
+   "rxDropTail",
+   "rxDropHead",
+   "rxDropEarly",
+   "rxArmMax",
+   "rxIsrMax",
+   "rxFiltered",
+   "rxLent",
+   "rxCopyCyc",
+   "txRef",
+   "rxNotEthII",
+   "rxEtherType",
+   "rxEvents",
+   "ipQueueMin",
+   "rxChecksumErr",
+};
+
+static const webtemplate_type_t webtemplate_tcpip_json_types[] = {
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+   WEBTEMPLATE_U32,
+};
+
+const webtemplate_t webtemplate_tcpip_json = {
+   .parts               = webtemplate_tcpip_json_parts,
+   .partsCount          = sizeof( webtemplate_tcpip_json_parts ) / sizeof( webtemplate_tcpip_json_parts[0] ),
+   .names               = webtemplate_tcpip_json_names,
+   .types               = webtemplate_tcpip_json_types,
+   .valuesCount         = 24,
+};
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
@@ -0,0 +1,329 @@
+// ****************************************************************************
+/// \file      websocket.c
+///
+/// \brief     WebSocket C Source File
+///
+/// \details   Module for the websocket protocol (rfc 6455). The accept key 
+///            of the opening handshake is calculated with a small sha-1, 
+///            the f411 has no hash peripheral and the key is only needed 
+///            once per connection. The frames of the clients are parsed and
+///            unmasked in the receive buffer of the connection, the frames
+///            of the server are not fragmented.
+///
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+/// 
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person 
+///            obtaining a copy of this software and associated documentation 
+///            files (the "Software"), to deal in the Software without 
+///            restriction, including without limitation the rights to use, 
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the 
+///            Software is furnished to do so, subject to the following 
+///            conditions:
+///            
+///            The above copyright notice and this permission notice shall be 
+///            included in all copies or substantial portions of the Software.
+///            
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES 
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR 
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include <string.h>
+#include "websocket.h"
+
+// Private define *************************************************************
+#define WEBSOCKET_KEY         ( 24u )     // length of the key of the client, base64 of 16 bytes
+#define WEBSOCKET_GUID        "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+#define SHA1_BLOCK            ( 64u )     // bytes per block
+#define SHA1_DIGEST           ( 20u )
+#define SHA1_ROTL( x, n )     ( ( ( x ) << ( n ) ) | ( ( x ) >> ( 32u - ( n ) ) ) )
+
+// Private types     **********************************************************
+
+// Private variables **********************************************************
+static const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Private function prototypes ************************************************
+static void websocket_sha1       ( const uint8_t* data, uint8_t length, uint8_t* digest );
+static void websocket_sha1Block  ( uint32_t* h, const uint8_t* block );
+static void websocket_base64     ( const uint8_t* data, uint8_t length, char* text );
+
+// Private functions **********************************************************
+
+// ----------------------------------------------------------------------------
+/// \brief     Calculates the accept key of the opening handshake, the base64
+///            of the sha-1 digest of the key of the client and the guid of 
+///            the protocol.
+///
+/// \param     [in]  const uint8_t* key, value of the Sec-WebSocket-Key field
+/// \param     [in]  uint16_t keyLength
+/// \param     [out] char* accept, WEBSOCKET_ACCEPT characters and the 
+///                  terminating zero
+///
+/// \return    1 if the key is valid, 0 if not
+uint8_t websocket_accept( const uint8_t* key, uint16_t keyLength, char* accept )
+{
+   uint8_t  text[WEBSOCKET_KEY + sizeof( WEBSOCKET_GUID ) - 1u];
+   uint8_t  digest[SHA1_DIGEST];
+   
+   // the field value is not trimmed, it is in the receive buffer
+   while( keyLength > 0 && ( *key == ' ' || *key == '\t' ) )
+   {
+      key++;
+      keyLength--;
+   }
+   while( keyLength > 0 && ( key[keyLength - 1u] == ' ' || key[keyLength - 1u] == '\t' || key[keyLength - 1u] == '\r' ) )
+   {
+      keyLength--;
+   }
+   if( keyLength != WEBSOCKET_KEY )
+   {
+      return 0;
+   }
+   
+   memcpy( text, key, WEBSOCKET_KEY );
+   memcpy( text + WEBSOCKET_KEY, WEBSOCKET_GUID, sizeof( WEBSOCKET_GUID ) - 1u );
+   websocket_sha1( text, sizeof( text ), digest );
+   websocket_base64( digest, SHA1_DIGEST, accept );
+   
+   return 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Parses the first frame in the receive buffer and unmasks its
+///            payload in place. The frames of a client are masked, the 
+///            payload of a control frame has at most 125 bytes and a frame
+///            with a 64 bit length never fits into the buffer.
+///
+/// \param     [in]  uint8_t* data
+/// \param     [in]  uint16_t length, of the received data
+/// \param     [out] websocket_frame_t* frame
+///
+/// \return    websocket_status_t
+websocket_status_t websocket_parse( uint8_t* data, uint16_t length, websocket_frame_t* frame )
+{
+   const uint8_t  *mask;
+   uint16_t       headerLength   = 2u;
+   
+   if( length < 2u )
+   {
+      return WEBSOCKET_INCOMPLETE;
+   }
+   
+   frame->fin           = data[0] >> 7;
+   frame->opcode        = data[0] & 0x0Fu;
+   frame->payloadLength = data[1] & 0x7Fu;
+   if( ( data[0] & 0x70u ) != 0 || ( data[1] & 0x80u ) == 0 || frame->payloadLength == 127u )
+   {
+      // extensions, an unmasked frame or a 64 bit length
+      return WEBSOCKET_INVALID;
+   }
+   if( ( frame->opcode & 0x08u ) != 0 && ( frame->fin == 0 || frame->payloadLength > 125u ) )
+   {
+      // a fragmented or a long control frame
+      return WEBSOCKET_INVALID;
+   }
+   
+   // the extended 16 bit length in network byte order
+   if( frame->payloadLength == 126u )
+   {
+      if( length < 4u )
+      {
+         return WEBSOCKET_INCOMPLETE;
+      }
+      frame->payloadLength = ( (uint16_t)data[2] << 8 ) | data[3];
+      headerLength = 4u;
+   }
+   
+   // the masking key follows the length
+   mask           = data + headerLength;
+   headerLength  += 4u;
+   if( (uint32_t)headerLength + frame->payloadLength > length )
+   {
+      return WEBSOCKET_INCOMPLETE;
+   }
+   
+   frame->payload = data + headerLength;
+   frame->length  = headerLength + frame->payloadLength;
+   for( uint16_t i = 0; i < frame->payloadLength; i++ )
+   {
+      frame->payload[i] ^= mask[i & 3u];
+   }
+   
+   return WEBSOCKET_COMPLETE;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Writes the header of an unfragmented frame of the server, the 
+///            frames of the server are not masked. The payload follows the
+///            header.
+///
+/// \param     [out] uint8_t* buffer, at least WEBSOCKET_HEADERMAX bytes
+/// \param     [in]  uint8_t opcode
+/// \param     [in]  uint16_t payloadLength
+///
+/// \return    length of the header
+uint16_t websocket_header( uint8_t* buffer, uint8_t opcode, uint16_t payloadLength )
+{
+   buffer[0] = 0x80u | opcode;
+   if( payloadLength < 126u )
+   {
+      buffer[1] = payloadLength;
+      return 2u;
+   }
+   buffer[1] = 126u;
+   buffer[2] = payloadLength >> 8;
+   buffer[3] = payloadLength & 0xFFu;
+   return 4u;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Calculates the sha-1 digest (rfc 3174) of a short message, the
+///            message and its padding fit into two blocks.
+///
+/// \param     [in]  const uint8_t* data
+/// \param     [in]  uint8_t length, at most 2 * SHA1_BLOCK - 9 bytes
+/// \param     [out] uint8_t* digest, SHA1_DIGEST bytes
+///
+/// \return    none
+static void websocket_sha1( const uint8_t* data, uint8_t length, uint8_t* digest )
+{
+   uint8_t  blocks[2u * SHA1_BLOCK];
+   uint32_t h[5]        = { 0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u, 0xC3D2E1F0u };
+   uint32_t bits        = (uint32_t)length * 8u;
+   uint16_t size        = ( length + 9u > SHA1_BLOCK ) ? 2u * SHA1_BLOCK : SHA1_BLOCK;
+   
+   // the message, a one bit, the zeros and the length in bits
+   memset( blocks, 0, sizeof( blocks ) );
+   memcpy( blocks, data, length );
+   blocks[length]       = 0x80u;
+   blocks[size - 4u]    = bits >> 24;
+   blocks[size - 3u]    = bits >> 16;
+   blocks[size - 2u]    = bits >> 8;
+   blocks[size - 1u]    = bits;
+   
+   for( uint16_t i = 0; i < size; i += SHA1_BLOCK )
+   {
+      websocket_sha1Block( h, &blocks[i] );
+   }
+   
+   // the digest in network byte order
+   for( uint8_t i = 0; i < SHA1_DIGEST; i++ )
+   {
+      digest[i] = h[i / 4u] >> ( 24u - 8u * ( i % 4u ) );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Processes one block of the sha-1 digest. The message schedule
+///            is kept in a ring of 16 words.
+///
+/// \param     [in]  uint32_t* h, the state of the digest
+/// \param     [in]  const uint8_t* block, SHA1_BLOCK bytes
+///
+/// \return    none
+static void websocket_sha1Block( uint32_t* h, const uint8_t* block )
+{
+   uint32_t w[16];
+   uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+   uint32_t f, k, temp;
+   
+   for( uint8_t i = 0; i < 16u; i++ )
+   {
+      w[i] = ( (uint32_t)block[4u * i] << 24 ) | ( (uint32_t)block[4u * i + 1u] << 16 ) | ( (uint32_t)block[4u * i + 2u] << 8 ) | block[4u * i + 3u];
+   }
+   
+   for( uint8_t i = 0; i < 80u; i++ )
+   {
+      if( i >= 16u )
+      {
+         temp = w[( i + 13u ) & 15u] ^ w[( i + 8u ) & 15u] ^ w[( i + 2u ) & 15u] ^ w[i & 15u];
+         w[i & 15u] = SHA1_ROTL( temp, 1u );
+      }
+      
+      if( i < 20u )
+      {
+         f = ( b & c ) | ( ~b & d );
+         k = 0x5A827999u;
+      }
+      else if( i < 40u )
+      {
+         f = b ^ c ^ d;
+         k = 0x6ED9EBA1u;
+      }
+      else if( i < 60u )
+      {
+         f = ( b & c ) | ( b & d ) | ( c & d );
+         k = 0x8F1BBCDCu;
+      }
+      else
+      {
+         f = b ^ c ^ d;
+         k = 0xCA62C1D6u;
+      }
+      
+      temp  = SHA1_ROTL( a, 5u ) + f + e + k + w[i & 15u];
+      e     = d;
+      d     = c;
+      c     = SHA1_ROTL( b, 30u );
+      b     = a;
+      a     = temp;
+   }
+   
+   h[0] += a;
+   h[1] += b;
+   h[2] += c;
+   h[3] += d;
+   h[4] += e;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Encodes data as base64 text (rfc 4648) with padding.
+///
+/// \param     [in]  const uint8_t* data
+/// \param     [in]  uint8_t length
+/// \param     [out] char* text, 4 characters per 3 bytes and the 
+///                  terminating zero
+///
+/// \return    none
+static void websocket_base64( const uint8_t* data, uint8_t length, char* text )
+{
+   uint32_t triple;
+   
+   for( uint8_t i = 0; i < length; i += 3u )
+   {
+      triple   = (uint32_t)data[i] << 16;
+      triple  |= ( i + 1u < length ) ? (uint32_t)data[i + 1u] << 8 : 0u;
+      triple  |= ( i + 2u < length ) ? data[i + 2u] : 0u;
+      *text++  = base64[( triple >> 18 ) & 0x3Fu];
+      *text++  = base64[( triple >> 12 ) & 0x3Fu];
+      *text++  = ( i + 1u < length ) ? base64[( triple >> 6 ) & 0x3Fu] : '=';
+      *text++  = ( i + 2u < length ) ? base64[triple & 0x3Fu] : '=';
+   }
+   *text = '\0';
+}
+
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
@@ -0,0 +1,523 @@
+// ****************************************************************************
+/// \file      checksum_test.c
+///
+/// \brief     Host test and benchmark of the checksum module
+///
+/// \details   Checks usGenerateChecksum() of the checksum module against
+///            the generic usGenerateChecksum() of FreeRTOS+TCP, which is
+///            copied in as the reference, on CONFORMANCEBUFFERS random
+///            buffers of 0 to 1514 bytes at the offsets 0 to 3 with random
+///            start sums, and compares their throughput for all offsets and
+///            lengths from 20 to 1514 bytes.
+///            Checks the portable checksum_copy() against memcpy() and
+///            checksum_add(), and measures it on frame sized buffers against
+///            a copy followed by a separate checksum pass, like the mac task
+///            did before. The times are of the host cpu and only compare the
+///            kernels, the cycles on the target are counted by the mac task
+///            (rxCopyCyc on /tcpip.json). Each time is the fastest of
+///            REPEATS runs.
+///            Usage: checksum_test [rounds [seed]], 20000 rounds per length
+///            and a seed of the clock by default. The seed is printed, a
+///            failing run is repeated with it.
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+///
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person
+///            obtaining a copy of this software and associated documentation
+///            files (the "Software"), to deal in the Software without
+///            restriction, including without limitation the rights to use,
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the
+///            Software is furnished to do so, subject to the following
+///            conditions:
+///
+///            The above copyright notice and this permission notice shall be
+///            included in all copies or substantial portions of the Software.
+///
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre
+///
+/// \bug
+///
+/// \warning
+///
+/// \todo
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "checksum.h"
+
+// Private define *************************************************************
+#define ROUNDS_DEFAULT     ( 20000u )
+#define BUFFERLENGTH       ( 1514u + 8u )
+#define REPEATS            ( 5u )         // the fastest of the repeats is taken
+#define CONFORMANCEBUFFERS ( 200000u )
+#define FRAMELENGTHMAX     ( 1514u )
+#define SWEEPLENGTHMIN     ( 20u )
+#define SWEEPROUNDS        ( 50u )        // per length and offset, the sweep covers every length
+
+// The reference is copied from FreeRTOS_IP.c and needs these on the host,
+// which is little endian like the target.
+#define FreeRTOS_htons( x )                 ( ( uint16_t ) __builtin_bswap16( ( uint16_t ) ( x ) ) )
+#define FreeRTOS_ntohs( x )                 FreeRTOS_htons( x )
+#define ipPOINTER_CAST( TYPE, pointer )     ( ( TYPE ) ( pointer ) )
+
+// Private types     **********************************************************
+typedef union _xUnion32
+{
+   uint32_t u32;
+   uint16_t u16[ 2 ];
+   uint8_t  u8[ 4 ];
+} xUnion32;
+
+typedef union _xUnionPtr
+{
+   uint32_t *u32ptr;
+   uint16_t *u16ptr;
+   uint8_t  *u8ptr;
+} xUnionPtr;
+
+// Private variables **********************************************************
+static uint8_t             src[BUFFERLENGTH] __attribute__((aligned(4)));
+static uint8_t             dst[BUFFERLENGTH] __attribute__((aligned(4)));
+static volatile uint32_t   sink;
+static uint32_t            errors;
+
+// Global variables ***********************************************************
+
+// Private function prototypes ************************************************
+static void       checksum_test_conformance ( uint32_t seed );
+static void       checksum_test_sweep       ( void );
+static void       checksum_test_copy        ( uint32_t rounds );
+static uint16_t   checksum_test_module      ( uint16_t usSum, const uint8_t * pucNextData, size_t uxByteCount );
+static uint16_t   checksum_test_reference   ( uint16_t usSum, const uint8_t * pucNextData, size_t uxByteCount );
+static double     checksum_test_now         ( void );
+static uint32_t   checksum_test_random      ( uint32_t *state );
+
+// Private functions **********************************************************
+
+// ----------------------------------------------------------------------------
+/// \brief     Runs the tests and the benchmark.
+///
+/// \param     [in]  int argc
+/// \param     [in]  char **argv
+///
+/// \return    0 if all sums matched, 1 if not
+int main( int argc, char **argv )
+{
+   uint32_t rounds = ( argc > 1 ) ? strtoul( argv[1], NULL, 10 ) : ROUNDS_DEFAULT;
+   uint32_t seed   = ( argc > 2 ) ? strtoul( argv[2], NULL, 10 ) : (uint32_t)time( NULL );
+   uint32_t state  = 0x9E3779B9u;
+   
+   checksum_test_conformance( seed != 0 ? seed : 1u );
+   
+   for( uint32_t i = 0; i < BUFFERLENGTH; i++ )
+   {
+      src[i] = (uint8_t)checksum_test_random( &state );
+   }
+   
+   checksum_test_sweep();
+   checksum_test_copy( rounds );
+   
+   printf( "checksum: %u errors\n", (unsigned)errors );
+   return errors == 0 ? 0 : 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Compares the checksum module with the reference on random
+///            buffers, lengths, offsets and start sums. Every 16th buffer is
+///            filled with 0xff to get the most carries. checksum_copy() is
+///            checked on the same buffers.
+///
+/// \param     [in]  uint32_t seed
+///
+/// \return    none
+static void checksum_test_conformance( uint32_t seed )
+{
+   uint32_t state = seed;
+   uint32_t length, offset, sum, mismatches = 0;
+   uint16_t start, reference, module;
+   
+   printf( "checksum: %u random buffers against the reference, seed %u\n", (unsigned)CONFORMANCEBUFFERS, (unsigned)seed );
+   for( uint32_t n = 0; n < CONFORMANCEBUFFERS; n++ )
+   {
+      length = checksum_test_random( &state ) % ( FRAMELENGTHMAX + 1u );
+      offset = checksum_test_random( &state ) % 4u;
+      start  = (uint16_t)checksum_test_random( &state );
+      for( uint32_t i = 0; i < length; i++ )
+      {
+         src[offset + i] = ( n % 16u == 0u ) ? 0xffu : (uint8_t)checksum_test_random( &state );
+      }
+      
+      reference = checksum_test_reference( start, &src[offset], length );
+      module    = checksum_test_module( start, &src[offset], length );
+      sum       = checksum_copy( &dst[offset], &src[offset], length, FreeRTOS_htons( start ) );
+      if(   module != reference
+         || FreeRTOS_ntohs( checksum_fold( sum ) ) != reference
+         || memcmp( &dst[offset], &src[offset], length ) != 0 )
+      {
+         if( mismatches++ < 10u )
+         {
+            printf( "checksum: buffer %u, %u bytes at offset %u, start 0x%04x: reference 0x%04x, module 0x%04x\n",
+                    (unsigned)n, (unsigned)length, (unsigned)offset, start, reference, module );
+         }
+      }
+   }
+   errors += mismatches;
+   printf( "checksum: %u mismatches\n", (unsigned)mismatches );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Measures the reference and the checksum module for every
+///            length from SWEEPLENGTHMIN to FRAMELENGTHMAX at the offsets 0 to
+///            3. Lists some lengths and the mean over all lengths.
+///
+/// \param     none
+///
+/// \return    none
+static void checksum_test_sweep( void )
+{
+   static const uint32_t lengths[] = { 20u, 40u, 64u, 128u, 256u, 576u, 1024u, 1460u, 1514u };
+   double   start, time, reference, module, referenceTotal, moduleTotal;
+   uint32_t bytes, l;
+   
+   printf( "checksum: reference against module, ns per buffer\n" );
+   for( uint32_t offset = 0; offset < 4u; offset++ )
+   {
+      referenceTotal = 0;
+      moduleTotal    = 0;
+      bytes          = 0;
+      l              = 0;
+      for( uint32_t length = SWEEPLENGTHMIN; length <= FRAMELENGTHMAX; length++ )
+      {
+         reference = 1e9;
+         module    = 1e9;
+         for( uint8_t k = 0; k < REPEATS; k++ )
+         {
+            start = checksum_test_now();
+            for( uint32_t r = 0; r < SWEEPROUNDS; r++ )
+            {
+               sink = checksum_test_reference( (uint16_t)r, &src[offset], length );
+            }
+            time = checksum_test_now() - start;
+            reference = ( time < reference ) ? time : reference;
+            
+            start = checksum_test_now();
+            for( uint32_t r = 0; r < SWEEPROUNDS; r++ )
+            {
+               sink = checksum_test_module( (uint16_t)r, &src[offset], length );
+            }
+            time = checksum_test_now() - start;
+            module = ( time < module ) ? time : module;
+         }
+         referenceTotal += reference;
+         moduleTotal    += module;
+         bytes          += length;
+         
+         if( l < sizeof(lengths) / sizeof(lengths[0]) && length == lengths[l] )
+         {
+            printf( "  %4u byte, offset %u: reference %7.1f, module %7.1f, %.2fx\n",
+                    (unsigned)length, (unsigned)offset, reference * 1e9 / SWEEPROUNDS,
+                    module * 1e9 / SWEEPROUNDS, reference / module );
+            l++;
+         }
+      }
+      printf( "  %u to %u byte, offset %u: reference %.2f GB/s, module %.2f GB/s, %.2fx\n",
+              (unsigned)SWEEPLENGTHMIN, (unsigned)FRAMELENGTHMAX, (unsigned)offset,
+              bytes * (double)SWEEPROUNDS / referenceTotal / 1e9, bytes * (double)SWEEPROUNDS / moduleTotal / 1e9,
+              referenceTotal / moduleTotal );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Checks and measures checksum_copy() for frame lengths, with the
+///            source and destination aligned and 2 bytes off, which is the
+///            offset of the ip header in a frame.
+///
+/// \param     [in]  uint32_t rounds
+///
+/// \return    none
+static void checksum_test_copy( uint32_t rounds )
+{
+   static const uint32_t lengths[] = { 60u, 128u, 576u, 1024u, 1500u };
+   static const uint32_t offsets[] = { 0u, 2u };
+   double   start, time, fused, separate, copy;
+   uint32_t length, offset, sum;
+   
+   printf( "checksum: checksum_copy() against memcpy() and checksum_add(), ns per buffer\n" );
+   for( uint8_t o = 0; o < sizeof(offsets) / sizeof(offsets[0]); o++ )
+   {
+      for( uint8_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++ )
+      {
+         length = lengths[l];
+         offset = offsets[o];
+         
+         memset( dst, 0, sizeof(dst) );
+         sum = checksum_copy( &dst[offset], &src[offset], length, 0 );
+         if(   checksum_fold( sum ) != checksum_fold( checksum_add( &src[offset], length, 0 ) )
+            || memcmp( &dst[offset], &src[offset], length ) != 0 )
+         {
+            errors++;
+            printf( "checksum: checksum_copy() wrong for %u bytes at offset %u\n", (unsigned)length, (unsigned)offset );
+         }
+         
+         fused    = 1e9;
+         separate = 1e9;
+         copy     = 1e9;
+         for( uint8_t k = 0; k < REPEATS; k++ )
+         {
+            start = checksum_test_now();
+            for( uint32_t r = 0; r < rounds; r++ )
+            {
+               sink = checksum_copy( &dst[offset], &src[offset], length, r );
+            }
+            time = checksum_test_now() - start;
+            fused = ( time < fused ) ? time : fused;
+            
+            start = checksum_test_now();
+            for( uint32_t r = 0; r < rounds; r++ )
+            {
+               memcpy( &dst[offset], &src[offset], length );
+               sink = checksum_add( &dst[offset], length, r );
+            }
+            time = checksum_test_now() - start;
+            separate = ( time < separate ) ? time : separate;
+            
+            start = checksum_test_now();
+            for( uint32_t r = 0; r < rounds; r++ )
+            {
+               memcpy( &dst[offset], &src[offset], length );
+               sink = dst[offset + ( r % length )];
+            }
+            time = checksum_test_now() - start;
+            copy = ( time < copy ) ? time : copy;
+         }
+         
+         printf( "  %4u byte, offset %u: fused %7.1f, copy then sum %7.1f, copy only %7.1f, %.2f GB/s fused\n",
+                 (unsigned)length, (unsigned)offset, fused * 1e9 / rounds, separate * 1e9 / rounds, 
+                 copy * 1e9 / rounds, length * (double)rounds / fused / 1e9 );
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     usGenerateChecksum() of FreeRTOS_IP.c with the checksum module
+///            (ipconfigUSE_CHECKSUM_MODULE 1).
+///
+/// \param     [in]  uint16_t usSum
+/// \param     [in]  const uint8_t * pucNextData
+/// \param     [in]  size_t uxByteCount
+///
+/// \return    uint16_t sum
+static uint16_t checksum_test_module( uint16_t usSum, const uint8_t * pucNextData, size_t uxByteCount )
+{
+   uint32_t ulSum = ( uint32_t ) FreeRTOS_htons( usSum );
+   
+   ulSum = checksum_add( pucNextData, ( uint32_t ) uxByteCount, ulSum );
+   return FreeRTOS_ntohs( checksum_fold( ulSum ) );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     The generic usGenerateChecksum() of FreeRTOS_IP.c
+///            (ipconfigUSE_CHECKSUM_MODULE 0), copied unchanged.
+///
+/// \param     [in]  uint16_t usSum
+/// \param     [in]  const uint8_t * pucNextData
+/// \param     [in]  size_t uxByteCount
+///
+/// \return    uint16_t sum
+static uint16_t checksum_test_reference( uint16_t usSum,
+                                         const uint8_t * pucNextData,
+                                         size_t uxByteCount )
+{
+/* MISRA/PC-lint doesn't like the use of unions. Here, they are a great
+ * aid though to optimise the calculations. */
+    xUnion32 xSum2, xSum, xTerm;
+    xUnionPtr xSource;
+    xUnionPtr xLastSource;
+    uintptr_t uxAlignBits;
+    uint32_t ulCarry = 0UL;
+    uint16_t usTemp;
+    size_t uxDataLengthBytes = uxByteCount;
+
+    /* Small MCUs often spend up to 30% of the time doing checksum calculations
+    * This function is optimised for 32-bit CPUs; Each time it will try to fetch
+    * 32-bits, sums it with an accumulator and counts the number of carries. */
+
+    /* Swap the input (little endian platform only). */
+    usTemp = FreeRTOS_ntohs( usSum );
+    xSum.u32 = ( uint32_t ) usTemp;
+    xTerm.u32 = 0UL;
+
+    xSource.u8ptr = ipPOINTER_CAST( uint8_t *, pucNextData );
+    uxAlignBits = ( ( ( uintptr_t ) pucNextData ) & 0x03U );
+
+    /*
+     * If pucNextData is non-aligned then the checksum is starting at an
+     * odd position and we need to make sure the usSum value now in xSum is
+     * as if it had been "aligned" in the same way.
+     */
+    if( ( uxAlignBits & 1UL ) != 0U )
+    {
+        xSum.u32 = ( ( xSum.u32 & 0xffU ) << 8 ) | ( ( xSum.u32 & 0xff00U ) >> 8 );
+    }
+
+    /* If byte (8-bit) aligned... */
+    if( ( ( uxAlignBits & 1UL ) != 0UL ) && ( uxDataLengthBytes >= ( size_t ) 1 ) )
+    {
+        xTerm.u8[ 1 ] = *( xSource.u8ptr );
+        xSource.u8ptr++;
+        uxDataLengthBytes--;
+        /* Now xSource is word (16-bit) aligned. */
+    }
+
+    /* If half-word (16-bit) aligned... */
+    if( ( ( uxAlignBits == 1U ) || ( uxAlignBits == 2U ) ) && ( uxDataLengthBytes >= 2U ) )
+    {
+        xSum.u32 += *( xSource.u16ptr );
+        xSource.u16ptr++;
+        uxDataLengthBytes -= 2U;
+        /* Now xSource is word (32-bit) aligned. */
+    }
+
+    /* Word (32-bit) aligned, do the most part. */
+    xLastSource.u32ptr = ( xSource.u32ptr + ( uxDataLengthBytes / 4U ) ) - 3U;
+
+    /* In this loop, four 32-bit additions will be done, in total 16 bytes.
+     * Indexing with constants (0,1,2,3) gives faster code than using
+     * post-increments. */
+    while( xSource.u32ptr < xLastSource.u32ptr )
+    {
+        /* Use a secondary Sum2, just to see if the addition produced an
+         * overflow. */
+        xSum2.u32 = xSum.u32 + xSource.u32ptr[ 0 ];
+
+        if( xSum2.u32 < xSum.u32 )
+        {
+            ulCarry++;
+        }
+
+        /* Now add the secondary sum to the major sum, and remember if there was
+         * a carry. */
+        xSum.u32 = xSum2.u32 + xSource.u32ptr[ 1 ];
+
+        if( xSum2.u32 > xSum.u32 )
+        {
+            ulCarry++;
+        }
+
+        /* And do the same trick once again for indexes 2 and 3 */
+        xSum2.u32 = xSum.u32 + xSource.u32ptr[ 2 ];
+
+        if( xSum2.u32 < xSum.u32 )
+        {
+            ulCarry++;
+        }
+
+        xSum.u32 = xSum2.u32 + xSource.u32ptr[ 3 ];
+
+        if( xSum2.u32 > xSum.u32 )
+        {
+            ulCarry++;
+        }
+
+        /* And finally advance the pointer 4 * 4 = 16 bytes. */
+        xSource.u32ptr = &( xSource.u32ptr[ 4 ] );
+    }
+
+    /* Now add all carries. */
+    xSum.u32 = ( uint32_t ) xSum.u16[ 0 ] + xSum.u16[ 1 ] + ulCarry;
+
+    uxDataLengthBytes %= 16U;
+    xLastSource.u8ptr = ( uint8_t * ) ( xSource.u8ptr + ( uxDataLengthBytes & ~( ( size_t ) 1 ) ) );
+
+    /* Half-word aligned. */
+
+    /* Coverity does not like Unions. Warning issued here: "The operator "<"
+     * is being applied to the pointers "xSource.u16ptr" and "xLastSource.u16ptr",
+     * which do not point into the same object." */
+    while( xSource.u16ptr < xLastSource.u16ptr )
+    {
+        /* At least one more short. */
+        xSum.u32 += xSource.u16ptr[ 0 ];
+        xSource.u16ptr++;
+    }
+
+    if( ( uxDataLengthBytes & ( size_t ) 1 ) != 0U ) /* Maybe one more ? */
+    {
+        xTerm.u8[ 0 ] = xSource.u8ptr[ 0 ];
+    }
+
+    xSum.u32 += xTerm.u32;
+
+    /* Now add all carries again. */
+
+    /* Assigning value from "xTerm.u32" to "xSum.u32" here, but that stored value is overwritten before it can be used.
+     * Coverity doesn't understand about union variables. */
+    xSum.u32 = ( uint32_t ) xSum.u16[ 0 ] + xSum.u16[ 1 ];
+
+    /* coverity[value_overwrite] */
+    xSum.u32 = ( uint32_t ) xSum.u16[ 0 ] + xSum.u16[ 1 ];
+
+    if( ( uxAlignBits & 1U ) != 0U )
+    {
+        /* Quite unlikely, but pucNextData might be non-aligned, which would
+        * mean that a checksum is calculated starting at an odd position. */
+        xSum.u32 = ( ( xSum.u32 & 0xffU ) << 8 ) | ( ( xSum.u32 & 0xff00U ) >> 8 );
+    }
+
+    /* swap the output (little endian platform only). */
+    return FreeRTOS_htons( ( ( uint16_t ) xSum.u32 ) );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Returns the time of the monotonic clock.
+///
+/// \param     none
+///
+/// \return    double seconds
+static double checksum_test_now( void )
+{
+   struct timespec ts;
+   
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Xorshift pseudo random number generator.
+///
+/// \param     [in/out] uint32_t *state
+///
+/// \return    uint32_t random number
+static uint32_t checksum_test_random( uint32_t *state )
+{
+   uint32_t x = *state;
+   
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   *state = x;
+   return x;
+}
+
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
@@ -0,0 +1,687 @@
+// ****************************************************************************
+/// \file      queuex_test.c
+///
+/// \brief     Host stress test of the queue
+///
+/// \details   Runs the three contexts of a queue in three threads, like on
+///            the target: the producer (usb isr or ip task) enqueues numbered
+///            messages of random length into both lanes, every 8th one by
+///            reference. The manager (pump task) runs queue_manager and
+///            checks in the output that every message of a lane arrives in
+///            order and with its payload. The releaser (usb isr or mac task)
+///            checks the payload again and releases the dispatched messages,
+///            in dispatch order with queue_dequeue or in random order with
+///            queue_release. The cases retry the refused messages or drop
+///            them by a drop policy, and one flushes the queue while the
+///            messages are in flight, as a usb reset does.
+///            Usage: queuex_test [messages], 5000000 per case by default,
+///            "make long" runs 100000000 per case.
+///            queuex_test throughput [messages [service]] times the lossless
+///            cases with one message in flight, as before the in flight
+///            window, and with the windows of main.c. The releaser then
+///            takes service ns per message, one after the other, like the
+///            usb transfer or the mac task, 0 by default.
+///            "make throughput" runs 1000000 messages with 0 ns and 100000
+///            with 20000 ns.
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+/// 
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person 
+///            obtaining a copy of this software and associated documentation 
+///            files (the "Software"), to deal in the Software without 
+///            restriction, including without limitation the rights to use, 
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the 
+///            Software is furnished to do so, subject to the following 
+///            conditions:
+///            
+///            The above copyright notice and this permission notice shall be 
+///            included in all copies or substantial portions of the Software.
+///            
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES 
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR 
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "queuex.h"
+
+// Private define *************************************************************
+#define MESSAGES_DEFAULT   ( 5000000u )
+#define THROUGHPUT_DEFAULT ( 1000000u )
+#define HEADER             ( 5u )      // lane and sequence number in front of the payload
+#define REFERENCES         ( 64u )     // buffers of the producer for the messages by reference
+#define RING               ( 64u )     // dispatched messages on the way to the releaser, > QUEUEINFLIGHTMAX
+#define WATCHDOG           ( 5000u )   // ms without progress until a case fails
+
+// Private types     **********************************************************
+typedef struct
+{
+   const char*          name;
+   uint32_t             inFlightMax;
+   queue_drop_policy_t  dropPolicy;
+   uint8_t              retry;            // 1 = refused messages are enqueued again, 0 = dropped by the drop policy
+   uint8_t              anyOrder;         // 1 = released with queue_release in random order, 0 = with queue_dequeue
+   uint32_t             flushEvery;       // releases between two flushes, 0 = no flush
+} queuex_test_case_t;
+
+typedef struct
+{
+   uint8_t*             data;
+   uint16_t             length;
+} queuex_test_message_t;
+
+typedef struct
+{
+   uint8_t              data[QUEUEBUFFERLENGTH];
+   volatile uint8_t     queued;           // 1 from the enqueue to the release
+} queuex_test_reference_t;
+
+// Private variables **********************************************************
+// the windows of the queues in main.c, the ip task retries and the usb isr drops
+static const queuex_test_case_t cases[] =
+{
+   { "dequeue",   8u, QUEUE_DROP_TAIL,  1u, 0u,   0u },   // tcpQueue, released by the usb isr
+   { "release",   6u, QUEUE_DROP_TAIL,  1u, 1u,   0u },   // usbQueue, released by the mac task
+   { "tail",      6u, QUEUE_DROP_TAIL,  0u, 1u,   0u },
+   { "head",      6u, QUEUE_DROP_HEAD,  0u, 1u,   0u },   // usbQueue, written by the usb isr
+   { "early",     6u, QUEUE_DROP_EARLY, 0u, 1u,   0u },
+   { "flush",     8u, QUEUE_DROP_TAIL,  1u, 0u, 997u },   // tcpQueue, usb reset
+};
+
+// the lossless cases with one message in flight and with the windows
+static const queuex_test_case_t throughput[] =
+{
+   { "tcp",       1u, QUEUE_DROP_TAIL,  1u, 0u,   0u },
+   { "tcp",       8u, QUEUE_DROP_TAIL,  1u, 0u,   0u },
+   { "usb",       1u, QUEUE_DROP_TAIL,  1u, 1u,   0u },
+   { "usb",       6u, QUEUE_DROP_TAIL,  1u, 1u,   0u },
+};
+
+static queue_handle_t            queue;
+static const queuex_test_case_t* test;
+static uint32_t                  messages;
+static uint64_t                  service;                // ns per released message, 0 = none
+static uint64_t                  bytes;
+static double                    seconds;                // from the start to the last release
+static queuex_test_reference_t   references[REFERENCES];
+static uint32_t                  expected[QUEUELANES];   // next sequence number of a lane
+static uint32_t                  received;
+static uint32_t                  errors;
+static uint32_t                  retries;
+static uint32_t                  byReference;
+static volatile uint32_t         referencesReleased;
+static uint32_t                  flushes;
+static uint32_t                  flushed;
+static queuex_test_message_t     ring[RING];
+static volatile uint32_t         ringHead;               // written by the manager
+static volatile uint32_t         ringTail;               // written by the releaser
+static volatile uint32_t         held;                   // dispatched messages the releaser holds
+static volatile uint8_t          resetting;              // the output refuses all messages
+static volatile uint32_t         produced;               // messages handled by the producer
+static volatile uint8_t          stop;
+
+// Global variables ***********************************************************
+
+// Private function prototypes ************************************************
+static uint32_t   queuex_test_run      ( void );
+static void*      queuex_test_producer ( void *arg );
+static void*      queuex_test_manager  ( void *arg );
+static void*      queuex_test_releaser ( void *arg );
+static uint8_t    queuex_test_output   ( uint8_t* data, uint16_t length );
+static void       queuex_test_release  ( void* reference );
+static void       queuex_test_write    ( uint8_t* buffer, uint16_t length, queue_lane_id_t laneId, uint32_t sequence );
+static uint8_t    queuex_test_check    ( const uint8_t* data, uint16_t length, uint32_t* sequence );
+static uint8_t    queuex_test_drained  ( void );
+static void       queuex_test_error    ( const char* message, uint32_t value );
+static uint32_t   queuex_test_random   ( uint32_t *state );
+static uint64_t   queuex_test_now      ( void );
+
+// Private functions **********************************************************
+
+// ----------------------------------------------------------------------------
+/// \brief     Runs all cases and prints the results.
+///
+/// \param     [in]  int argc
+/// \param     [in]  char **argv
+///
+/// \return    0 if all cases passed, 1 if not
+int main( int argc, char **argv )
+{
+   uint32_t failed = 0;
+   
+   setvbuf( stdout, NULL, _IOLBF, 0 );
+   
+   if( argc > 1 && strcmp( argv[1], "throughput" ) == 0 )
+   {
+      messages = ( argc > 2 ) ? strtoul( argv[2], NULL, 10 ) : THROUGHPUT_DEFAULT;
+      service  = ( argc > 3 ) ? strtoull( argv[3], NULL, 10 ) : 0;
+      for( uint32_t c = 0; c < sizeof( throughput ) / sizeof( throughput[0] ); c++ )
+      {
+         test = &throughput[c];
+         failed += queuex_test_run();
+         printf( "queuex: %-7s window %u, service %u ns, %.0f frames/s, %.1f MB/s\n",
+                 test->name, (unsigned)test->inFlightMax, (unsigned)service, received / seconds, bytes / seconds / 1e6 );
+      }
+      return failed == 0 ? 0 : 1;
+   }
+   
+   messages = ( argc > 1 ) ? strtoul( argv[1], NULL, 10 ) : MESSAGES_DEFAULT;
+   for( uint32_t c = 0; c < sizeof( cases ) / sizeof( cases[0] ); c++ )
+   {
+      test = &cases[c];
+      failed += queuex_test_run();
+   }
+   
+   return failed == 0 ? 0 : 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Runs one case with the three threads and checks the queue 
+///            after the producer is done and all messages are released.
+///
+/// \param     none
+///
+/// \return    0 if the case passed, 1 if not
+static uint32_t queuex_test_run( void )
+{
+   pthread_t   producer, manager, releaser;
+   uint32_t    dropped;
+   uint32_t    queued = 0;
+   uint32_t    progress;
+   uint32_t    idle = 0;
+   uint64_t    start;
+   
+   memset( &queue, 0x00, sizeof( queue ) );
+   memset( references, 0x00, sizeof( references ) );
+   memset( expected, 0x00, sizeof( expected ) );
+   received             = 0;
+   bytes                = 0;
+   errors               = 0;
+   retries              = 0;
+   byReference          = 0;
+   referencesReleased   = 0;
+   flushes              = 0;
+   flushed              = 0;
+   ringHead             = 0;
+   ringTail             = 0;
+   held                 = 0;
+   resetting            = 0;
+   produced             = 0;
+   stop                 = 0;
+   
+   queue.output         = queuex_test_output;
+   queue.release        = queuex_test_release;
+   queue.inFlightMax    = test->inFlightMax;
+   queue.dropPolicy     = test->dropPolicy;
+   queue_init( &queue );
+   
+   start = queuex_test_now();
+   pthread_create( &manager, NULL, queuex_test_manager, NULL );
+   pthread_create( &releaser, NULL, queuex_test_releaser, NULL );
+   pthread_create( &producer, NULL, queuex_test_producer, NULL );
+   
+   // wait until the producer is done and all messages are released, a
+   // queue which does not move anymore fails the case
+   progress = 0;
+   while( produced != messages || queuex_test_drained() == 0 )
+   {
+      usleep( 1000u );
+      if( progress != produced + received + queue.dataPacketsOUT + flushes )
+      {
+         progress = produced + received + queue.dataPacketsOUT + flushes;
+         idle = 0;
+      }
+      else if( ++idle == WATCHDOG )
+      {
+         queuex_test_error( "no progress, produced", produced );
+         break;
+      }
+   }
+   seconds = ( queuex_test_now() - start ) / 1e9;
+   stop = 1;
+   pthread_join( producer, NULL );
+   pthread_join( manager, NULL );
+   pthread_join( releaser, NULL );
+   
+   // a flush requested by the last release
+   queue_manager( &queue );
+   if( queuex_test_drained() == 0 )
+   {
+      queuex_test_error( "queue not empty, in flight", queue.dispatchCounter - queue.dataPacketsOUT - flushed );
+   }
+   for( uint32_t i = 0; i < REFERENCES; i++ )
+   {
+      queued += references[i].queued;
+   }
+   if( queued != 0 || referencesReleased != byReference )
+   {
+      queuex_test_error( "references not released", byReference - referencesReleased );
+   }
+   if( queue.tailError != 0 || queue.spuriousError != 0 )
+   {
+      queuex_test_error( "tail and spurious errors", queue.tailError + queue.spuriousError );
+   }
+   
+   // every message is received or dropped, only a flush loses messages
+   dropped = ( test->retry == 1u ) ? 0 : queue.dropTail + queue.dropHead + queue.dropEarly;
+   if(   ( test->flushEvery == 0 && received + dropped != messages )
+      || ( test->retry == 1u && queue.dropHead + queue.dropEarly != 0 ) )
+   {
+      queuex_test_error( "messages lost", messages - received - dropped );
+   }
+   
+   printf( "queuex: %-7s %u messages, %u errors, %u received, %u by reference, %u retries, %u dropped (refused tail %u, head %u, early %u), %u flushes, peak length %u\n",
+           test->name, (unsigned)messages, (unsigned)errors, (unsigned)received, (unsigned)byReference, (unsigned)retries,
+           (unsigned)dropped, (unsigned)queue.dropTail, (unsigned)queue.dropHead, (unsigned)queue.dropEarly, (unsigned)flushes,
+           (unsigned)queue.queueLengthPeak );
+   
+   return errors == 0 ? 0 : 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Producer thread, writes the messages into the head buffer of a
+///            lane or into a buffer of its own and enqueues them. A refused 
+///            message is enqueued again, or dropped after the drop policy.
+///
+/// \param     [in]  void *arg
+///
+/// \return    NULL
+static void* queuex_test_producer( void *arg )
+{
+   uint32_t                state    = 0x12345678u;
+   uint32_t                sequence[QUEUELANES] = { 0 };
+   uint32_t                random;
+   uint32_t                dropTail;
+   uint32_t                next     = 0;
+   uint16_t                length;
+   queue_lane_id_t         laneId;
+   uint8_t*                buffer;
+   queuex_test_reference_t *reference;
+   
+   for( uint32_t i = 0; i < messages && stop == 0; i++, produced = i )
+   {
+      random = queuex_test_random( &state );
+      laneId = ( random & 3u ) == 0 ? QUEUE_LANE_CONTROL : QUEUE_LANE_BULK;
+      length = HEADER + ( random >> 8 ) % ( ( laneId == QUEUE_LANE_CONTROL ? QUEUECONTROLBUFFERLENGTH : QUEUEBUFFERLENGTH ) - HEADER + 1u );
+      
+      // the usb isr can't wait, the drop policy decides, the next frame
+      // comes a bit later
+      if( test->retry == 0 && queue_admit( laneId, &queue ) == 0 )
+      {
+         sequence[laneId]++;
+         sched_yield();
+         continue;
+      }
+      
+      if( ( random >> 28 ) < 2u )
+      {
+         // by reference, wait for a buffer released by the queue
+         while( references[next].queued != 0 && stop == 0 )
+         {
+            sched_yield();
+         }
+         if( stop != 0 )
+         {
+            break;
+         }
+         reference = &references[next];
+         next = ( next + 1u ) % REFERENCES;
+         queuex_test_write( reference->data, length, laneId, sequence[laneId] );
+         reference->queued = 1;
+         while( queue_enqueueLaneRef( reference->data, length, reference, laneId, &queue ) != 1 )
+         {
+            if( test->retry == 0 || stop != 0 )
+            {
+               reference->queued = 0;
+               sched_yield();
+               break;
+            }
+            retries++;
+            sched_yield();
+         }
+         byReference += reference->queued;
+      }
+      else
+      {
+         buffer = queue_getLaneHeadBuffer( laneId, &queue );
+         queuex_test_write( buffer, length, laneId, sequence[laneId] );
+         for( ;; )
+         {
+            dropTail = queue.dropTail;
+            queue_enqueueLane( buffer, length, laneId, &queue );
+            if( queue.dropTail == dropTail )
+            {
+               break;
+            }
+            if( test->retry == 0 || stop != 0 )
+            {
+               sched_yield();
+               break;
+            }
+            retries++;
+            sched_yield();
+         }
+      }
+      sequence[laneId]++;
+   }
+   return NULL;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Manager thread, like the pump task.
+///
+/// \param     [in]  void *arg
+///
+/// \return    NULL
+static void* queuex_test_manager( void *arg )
+{
+   uint32_t dispatched;
+   
+   while( stop == 0 )
+   {
+      dispatched = ringHead;
+      queue_manager( &queue );
+      if( ringHead == dispatched )
+      {
+         sched_yield();
+      }
+   }
+   return NULL;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Releaser thread, like the usb isr or the mac task. Takes the 
+///            dispatched messages and releases one after the other, the 
+///            oldest one or a random one. A flush drops the held messages,
+///            the output refuses the messages until the manager has run it.
+///
+/// \param     [in]  void *arg
+///
+/// \return    NULL
+static void* queuex_test_releaser( void *arg )
+{
+   queuex_test_message_t inFlight[RING];
+   uint32_t    state    = 0x87654321u;
+   uint32_t    released = 0;
+   uint32_t    count    = 0;
+   uint32_t    index;
+   uint32_t    sequence;
+   uint64_t    due      = 0;
+   
+   while( stop == 0 )
+   {
+      while( ringTail != ringHead )
+      {
+         __DMB();
+         inFlight[count++] = ring[ringTail % RING];
+         __DMB();
+         ringTail++;
+      }
+      held = count;
+      if( count == 0 )
+      {
+         sched_yield();
+         continue;
+      }
+      
+      // the messages take service ns each, one after the other, the next
+      // one starts when the last one is done or when it arrives
+      if( service != 0 )
+      {
+         if( due == 0 )
+         {
+            due = queuex_test_now() + service;
+         }
+         if( queuex_test_now() < due )
+         {
+            sched_yield();
+            continue;
+         }
+      }
+      
+      // the message has to be unchanged until it is released
+      index = ( test->anyOrder == 1u ) ? queuex_test_random( &state ) % count : 0;
+      if( queuex_test_check( inFlight[index].data, inFlight[index].length, &sequence ) == 0 )
+      {
+         queuex_test_error( "message changed in flight", sequence );
+      }
+      if( test->anyOrder == 1u )
+      {
+         queue_release( inFlight[index].data, &queue );
+         inFlight[index] = inFlight[--count];
+      }
+      else
+      {
+         queue_dequeue( &queue );
+         memmove( &inFlight[0], &inFlight[1], --count * sizeof( inFlight[0] ) );
+      }
+      held = count;
+      due = ( count != 0 && due != 0 ) ? due + service : 0;
+      
+      if( test->flushEvery != 0 && ++released % test->flushEvery == 0 )
+      {
+         resetting = 1;
+         __DMB();
+         queue_flush( &queue );
+         while( queue.flushRequest != 0 && stop == 0 )
+         {
+            sched_yield();
+         }
+         __DMB();
+         flushed += count + ( ringHead - ringTail );
+         ringTail = ringHead;
+         count = 0;
+         held = 0;
+         due = 0;
+         flushes++;
+         __DMB();
+         resetting = 0;
+      }
+   }
+   return NULL;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Output of the queue, checks the message and hands it to the 
+///            releaser.
+///
+/// \param     [in]  uint8_t* data
+/// \param     [in]  uint16_t length
+///
+/// \return    1, the message is taken, 0 while a flush is pending
+static uint8_t queuex_test_output( uint8_t* data, uint16_t length )
+{
+   uint32_t sequence;
+   uint8_t  laneId = data[0];
+   
+   if( resetting != 0 )
+   {
+      return 0;
+   }
+   
+   if( queuex_test_check( data, length, &sequence ) == 0 )
+   {
+      queuex_test_error( "message corrupt", sequence );
+   }
+   else if(    ( test->retry == 1u && test->flushEvery == 0 && sequence != expected[laneId] )
+            || sequence < expected[laneId] )
+   {
+      queuex_test_error( "message out of order", sequence );
+   }
+   else
+   {
+      expected[laneId] = sequence + 1u;
+   }
+   
+   ring[ringHead % RING].data    = data;
+   ring[ringHead % RING].length  = length;
+   __DMB();
+   ringHead++;
+   received++;
+   bytes += length;
+   return 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Release function of the queue, gives a buffer back to the 
+///            producer. Called by the releaser and by the manager.
+///
+/// \param     [in]  void* reference
+///
+/// \return    none
+static void queuex_test_release( void* reference )
+{
+   queuex_test_reference_t *buffer = reference;
+   
+   if( buffer->queued != 1u )
+   {
+      queuex_test_error( "reference released twice", (uint32_t)( buffer - references ) );
+   }
+   __DMB();
+   buffer->queued = 0;
+   __sync_fetch_and_add( &referencesReleased, 1u );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Writes a message, the lane, the sequence number and the low 
+///            byte of the sequence number as payload.
+///
+/// \param     [out] uint8_t* buffer
+/// \param     [in]  uint16_t length
+/// \param     [in]  queue_lane_id_t laneId
+/// \param     [in]  uint32_t sequence
+///
+/// \return    none
+static void queuex_test_write( uint8_t* buffer, uint16_t length, queue_lane_id_t laneId, uint32_t sequence )
+{
+   buffer[0] = (uint8_t)laneId;
+   memcpy( &buffer[1], &sequence, 4u );
+   memset( &buffer[HEADER], (uint8_t)sequence, length - HEADER );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Checks the lane and the payload of a message.
+///
+/// \param     [in]  const uint8_t* data
+/// \param     [in]  uint16_t length
+/// \param     [out] uint32_t* sequence
+///
+/// \return    1 if the message is valid, 0 if not
+static uint8_t queuex_test_check( const uint8_t* data, uint16_t length, uint32_t* sequence )
+{
+   memcpy( sequence, &data[1], 4u );
+   if( length < HEADER || data[0] >= QUEUELANES )
+   {
+      return 0;
+   }
+   for( uint16_t i = HEADER; i < length; i++ )
+   {
+      if( data[i] != (uint8_t)*sequence )
+      {
+         return 0;
+      }
+   }
+   return 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Checks if all messages are dispatched and released.
+///
+/// \param     none
+///
+/// \return    1 if the queue is empty, 0 if not
+static uint8_t queuex_test_drained( void )
+{
+   queue_lane_t *lane;
+   
+   if(   ringHead != ringTail || held != 0 || queue.flushRequest != 0 
+      || queue.headDropDone != queue.headDropRequest )
+   {
+      return 0;
+   }
+   for( uint32_t l = 0; l < QUEUELANES; l++ )
+   {
+      lane = &queue.lane[l];
+      if( lane->tailIndex != lane->headIndex || lane->dispatchIndex != lane->headIndex )
+      {
+         return 0;
+      }
+   }
+   return 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Counts an error and prints the first ones.
+///
+/// \param     [in]  const char* message
+/// \param     [in]  uint32_t value
+///
+/// \return    none
+static void queuex_test_error( const char* message, uint32_t value )
+{
+   if( __sync_fetch_and_add( &errors, 1u ) < 10u )
+   {
+      printf( "queuex: %s: %s %u\n", test->name, message, (unsigned)value );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Xorshift pseudo random number generator.
+///
+/// \param     [in/out] uint32_t *state
+///
+/// \return    uint32_t random number
+static uint32_t queuex_test_random( uint32_t *state )
+{
+   uint32_t x = *state;
+   
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   *state = x;
+   return x;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Monotonic time.
+///
+/// \param     none
+///
+/// \return    uint64_t time in ns
+static uint64_t queuex_test_now( void )
+{
+   struct timespec now;
+   
+   clock_gettime( CLOCK_MONOTONIC, &now );
+   return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
@@ -0,0 +1,689 @@
+// ****************************************************************************
+/// \file      rndis_test.c
+///
+/// \brief     Host test and benchmark of the rndis data path
+///
+/// \details   Runs the rndis class unchanged against a stubbed usb device
+///            library. The transfers of the in endpoint are completed right
+///            away, the out transfers are written by the test like the host
+///            would. Every frame carries a sequence number, which is checked
+///            on the other side.
+///            Counts the usb transfers, bulk packets and completion
+///            interrupts per frame with and without packing several packet
+///            messages into one transfer. The frames per second are a model
+///            of the bus only: 19 bulk packets of 64 bytes per 1 ms frame of
+///            the full speed bus, the host and the cpu are assumed to keep up.
+///            rndis_test_pad is built with RNDIS_TX_ZLP 0, to compare the
+///            termination of full packet transfers by a padding byte.
+///            The broadcast heavy workload mixes the frames the stack wants
+///            with frames of a chatty host, which the driver has to skip
+///            before they take a slot of the usbQueue. The pump and the mac
+///            task take only 6 frames per out transfer there.
+///            Usage: rndis_test [frames], 100000 per workload by default.
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+///
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person
+///            obtaining a copy of this software and associated documentation
+///            files (the "Software"), to deal in the Software without
+///            restriction, including without limitation the rights to use,
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the
+///            Software is furnished to do so, subject to the following
+///            conditions:
+///
+///            The above copyright notice and this permission notice shall be
+///            included in all copies or substantial portions of the Software.
+///
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre
+///
+/// \bug
+///
+/// \warning
+///
+/// \todo
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "usbd_rndis.h"
+#include "usb_device.h"
+#include "queuex.h"
+#include "ndis.h"
+#include "rndis_protocol.h"
+
+// Private define *************************************************************
+#define FRAMES_DEFAULT     ( 100000u )
+#define HEADER             ( sizeof(rndis_data_packet_t) )
+#define TXSLOTS            ( 64u )        // frames of the tx buffer, used round robin
+#define TXSTRIDE           ( 2048u )
+#define SEQUENCE           ( 14u )        // offset of the sequence number, behind the ethernet header
+#define BUSPACKETS         ( 19u )        // bulk packets of 64 bytes per 1 ms usb frame
+#define MIXLENGTH          ( 60u )        // frame length of the broadcast heavy workload
+#define MIXCONSUMER        ( 6u )         // frames taken from the usbQueue per out transfer
+#define ALL                ( 0xFFFFFFFFu )
+
+// Private types     **********************************************************
+typedef struct
+{
+   const uint8_t*       destination;
+   uint16_t             type;
+   uint8_t              wanted;
+   uint8_t              percent;
+   const char*          name;
+} rndis_test_mix_t;
+
+typedef struct
+{
+   uint32_t             frames;
+   uint32_t             transfers;
+   uint32_t             packets;
+   uint32_t             terminations;   // zlps or padding bytes
+   uint32_t             interrupts;
+} rndis_test_count_t;
+
+// Private variables **********************************************************
+static PCD_HandleTypeDef   hpcd;
+static uint8_t*            ctlBuffer;
+static uint8_t*            rxBuffer;
+static uint32_t            txPending;
+static uint32_t            txExpected;
+static uint32_t            rxExpected;
+static uint32_t            rxReceived;
+static uint32_t            rxInFlight;
+static uint32_t            errors;
+static rndis_test_count_t  txCount;
+static uint8_t             txBuffer[TXSLOTS * TXSTRIDE];
+static const uint8_t       deviceMac[6]   = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static const uint8_t       hostMac[6]     = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+static const uint8_t       otherMac[6]    = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x03 };
+static const uint8_t       broadcast[6]   = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+static const uint8_t       mdns[6]        = { 0x33, 0x33, 0x00, 0x00, 0x00, 0xFB };
+static const rndis_test_mix_t mix[] =
+{
+   { deviceMac,   0x0800u, 1u, 30u, "ipv4 to us" },
+   { broadcast,   0x0806u, 1u, 10u, "arp broadcast" },
+   { broadcast,   0x0800u, 1u, 15u, "ipv4 broadcast" },
+   { broadcast,   0x0842u, 0u, 10u, "wake on lan broadcast" },
+   { broadcast,   0x86DDu, 0u, 10u, "ipv6 broadcast" },
+   { broadcast,   0x0026u, 0u, 10u, "ieee 802.3 llc broadcast" },
+   { mdns,        0x86DDu, 0u, 10u, "mdns multicast" },
+   { otherMac,    0x0800u, 0u,  5u, "ipv4 to another host" },
+};
+
+// Global variables ***********************************************************
+USBD_HandleTypeDef         hUsbDeviceFS;
+queue_handle_t             usbQueue;
+queue_handle_t             tcpQueue;
+
+// Private function prototypes ************************************************
+static void       rndis_test_control   ( const void *msg, uint16_t length );
+static void       rndis_test_frame     ( uint8_t *frame, const uint8_t *destination, uint16_t type, uint16_t length, uint32_t sequence );
+static void       rndis_test_tx        ( uint16_t length, uint8_t packed, uint32_t frames );
+static void       rndis_test_rx        ( uint16_t length, uint8_t packed, uint32_t frames );
+static void       rndis_test_mix       ( uint32_t frames );
+static uint32_t   rndis_test_random    ( uint32_t *state );
+static void       rndis_test_print     ( const char *name, uint16_t length, const rndis_test_count_t *count );
+static void       rndis_test_complete  ( void );
+static void       rndis_test_drain     ( uint32_t limit );
+static uint8_t    rndis_test_output    ( uint8_t* data, uint16_t length );
+static void       rndis_test_error     ( const char *text, uint32_t value );
+
+// Private functions **********************************************************
+
+// ----------------------------------------------------------------------------
+/// \brief     Initialises the class like the host does and runs the small
+///            frame workloads in both directions.
+///
+/// \param     [in]  int argc
+/// \param     [in]  char **argv
+///
+/// \return    0 if all frames arrived, 1 if not
+int main( int argc, char **argv )
+{
+   static const uint16_t lengths[] = { 60u, 128u, 256u, 590u };
+   static const uint16_t fullPackets[] = { 84u, 1492u };   // with the header a multiple of the packet size
+   uint32_t frames = ( argc > 1 ) ? strtoul( argv[1], NULL, 10 ) : FRAMES_DEFAULT;
+   rndis_initialize_msg_t init;
+   struct
+   {
+      rndis_set_msg_t   msg;
+      uint32_t          filter;
+   } set;
+
+   hUsbDeviceFS.pData   = &hpcd;
+   usbQueue.output      = rndis_test_output;
+   usbQueue.inFlightMax = 6;
+   usbQueue.dropPolicy  = QUEUE_DROP_HEAD;
+   queue_init( &usbQueue );
+   tcpQueue.output      = rndis_test_output;
+   tcpQueue.inFlightMax = 8;
+   queue_init( &tcpQueue );
+
+   USBD_RNDIS_setDeviceAddress( deviceMac );
+   USBD_RNDIS_getClass()->Init( &hUsbDeviceFS, 0 );
+
+   memset( &init, 0, sizeof(init) );
+   init.MessageType        = REMOTE_NDIS_INITIALIZE_MSG;
+   init.MessageLength      = sizeof(init);
+   init.MajorVersion       = 1;
+   init.MaxTransferSize    = 16384u;
+   rndis_test_control( &init, sizeof(init) );
+
+   memset( &set, 0, sizeof(set) );
+   set.msg.MessageType              = REMOTE_NDIS_SET_MSG;
+   set.msg.MessageLength            = sizeof(set);
+   set.msg.Oid                      = OID_GEN_CURRENT_PACKET_FILTER;
+   set.msg.InformationBufferLength  = sizeof(set.filter);
+   set.msg.InformationBufferOffset  = sizeof(rndis_set_msg_t) - offsetof(rndis_set_msg_t, RequestId);
+   set.filter                       = NDIS_PACKET_TYPE_DIRECTED | NDIS_PACKET_TYPE_BROADCAST;
+   rndis_test_control( &set, sizeof(set) );
+
+   printf( "rndis: in transfers, modelled with %u bulk packets per ms\n", BUSPACKETS );
+   for( uint8_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++ )
+   {
+      rndis_test_tx( lengths[i], 0u, frames );
+      rndis_test_tx( lengths[i], 1u, frames );
+   }
+   printf( "rndis: in transfers of full packets, terminated with a %s\n", RNDIS_TX_ZLP == 1u ? "zlp" : "padding byte" );
+   for( uint8_t i = 0; i < sizeof(fullPackets) / sizeof(fullPackets[0]); i++ )
+   {
+      rndis_test_tx( fullPackets[i], 0u, frames );
+      rndis_test_tx( fullPackets[i], 1u, frames );
+   }
+   printf( "rndis: out transfers, modelled with %u bulk packets per ms\n", BUSPACKETS );
+   for( uint8_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++ )
+   {
+      rndis_test_rx( lengths[i], 0u, frames );
+      rndis_test_rx( lengths[i], 1u, frames );
+   }
+
+   rndis_test_mix( frames );
+
+   printf( "rndis: %u errors\n", (unsigned)errors );
+   return errors == 0 ? 0 : 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sends an encapsulated message over the control endpoint.
+///
+/// \param     [in]  const void *msg
+/// \param     [in]  uint16_t length
+///
+/// \return    none
+static void rndis_test_control( const void *msg, uint16_t length )
+{
+   USBD_SetupReqTypedef req;
+
+   memset( &req, 0, sizeof(req) );
+   req.bmRequest  = USB_REQ_TYPE_CLASS | 0x01u;
+   req.wLength    = length;
+   USBD_RNDIS_getClass()->Setup( &hUsbDeviceFS, &req );
+   memcpy( ctlBuffer, msg, length );
+   USBD_RNDIS_getClass()->EP0_RxReady( &hUsbDeviceFS );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Writes an ethernet frame with its sequence number.
+///
+/// \param     [out] uint8_t *frame
+/// \param     [in]  const uint8_t *destination
+/// \param     [in]  uint16_t type
+/// \param     [in]  uint16_t length
+/// \param     [in]  uint32_t sequence
+///
+/// \return    none
+static void rndis_test_frame( uint8_t *frame, const uint8_t *destination, uint16_t type, uint16_t length, uint32_t sequence )
+{
+   memcpy( &frame[0], destination, 6u );
+   memcpy( &frame[6], hostMac, 6u );
+   frame[12] = (uint8_t)( type >> 8 );
+   frame[13] = (uint8_t)type;
+   memset( &frame[SEQUENCE], 0, length - SEQUENCE );
+   memcpy( &frame[SEQUENCE], &sequence, 4u );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Sends frames of one length to the host. Packed frames follow
+///            each other word aligned with the header space in front, like
+///            in the bulk lane of the tcpQueue. Otherwise each frame is
+///            apart and takes its own transfer. A refused frame is sent
+///            again after the running transfer has completed.
+///
+/// \param     [in]  uint16_t length
+/// \param     [in]  uint8_t packed
+/// \param     [in]  uint32_t frames
+///
+/// \return    none
+static void rndis_test_tx( uint16_t length, uint8_t packed, uint32_t frames )
+{
+   uint32_t stride = packed ? ( ( HEADER + length + 3u ) & ~3u ) : TXSTRIDE;
+   uint8_t  *frame;
+
+   memset( &txCount, 0, sizeof(txCount) );
+   txExpected  = 0;
+   rndis_test_complete();
+
+   for( uint32_t i = 0; i < frames; i++ )
+   {
+      frame = &txBuffer[( i % TXSLOTS ) * stride + HEADER];
+      rndis_test_frame( frame, deviceMac, 0x0800u, length, i );
+      while( !USBD_RNDIS_send( frame, length ) )
+      {
+         if( txPending == 0 )
+         {
+            rndis_test_error( "frame refused without a transfer", i );
+            return;
+         }
+         rndis_test_complete();
+      }
+   }
+   while( txPending > 0 )
+   {
+      rndis_test_complete();
+   }
+
+   txCount.frames = txExpected;
+   if( txExpected != frames )
+   {
+      rndis_test_error( "frames sent to the host", txExpected );
+   }
+   rndis_test_print( packed ? "packed" : "single", length, &txCount );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Receives frames of one length from the host. Packed frames
+///            are sent as many packet messages in one transfer as the
+///            device accepts, otherwise one per transfer.
+///
+/// \param     [in]  uint16_t length
+/// \param     [in]  uint8_t packed
+/// \param     [in]  uint32_t frames
+///
+/// \return    none
+static void rndis_test_rx( uint16_t length, uint8_t packed, uint32_t frames )
+{
+   rndis_test_count_t   count;
+   rndis_data_packet_t  *p;
+   uint32_t             perTransfer = 1u;
+   uint32_t             size;
+   uint32_t             sent = 0;
+
+   if( packed )
+   {
+      perTransfer = ( QUEUEBUFFERLENGTH - 2u ) / ( HEADER + length );
+      if( perTransfer > RNDIS_RX_MAX_PACKETS )
+      {
+         perTransfer = RNDIS_RX_MAX_PACKETS;
+      }
+   }
+
+   memset( &count, 0, sizeof(count) );
+   rxExpected = 0;
+   rxReceived = 0;
+   while( sent < frames )
+   {
+      for( size = 0; size < perTransfer * ( HEADER + length ) && sent < frames; size += HEADER + length )
+      {
+         p = (rndis_data_packet_t *)&rxBuffer[size];
+         memset( p, 0, HEADER );
+         p->MessageType    = REMOTE_NDIS_PACKET_MSG;
+         p->MessageLength  = HEADER + length;
+         p->DataOffset     = HEADER - offsetof(rndis_data_packet_t, DataOffset);
+         p->DataLength     = length;
+         rndis_test_frame( &rxBuffer[size + HEADER], deviceMac, 0x0800u, length, sent++ );
+      }
+      hpcd.OUT_ep[RNDIS_DATA_OUT_EP & 0x0Fu].xfer_count = size;
+      USBD_RNDIS_getClass()->DataOut( &hUsbDeviceFS, RNDIS_DATA_OUT_EP & 0x0Fu );
+      rndis_test_drain( ALL );
+
+      count.transfers++;
+      count.interrupts++;
+      count.packets += size / RNDIS_DATA_IN_SZ + 1u;   // the last one is short or a zlp
+   }
+
+   count.frames = rxReceived;
+   if( rxReceived != frames )
+   {
+      rndis_test_error( "frames received from the host", rxReceived );
+   }
+   rndis_test_print( packed ? "packed" : "single", length, &count );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Receives the broadcast heavy workload. Transfers of 8 frames
+///            of the mix are sent, the pump and the mac task take only
+///            MIXCONSUMER frames per transfer. Every frame the driver has to
+///            skip would take a slot of the usbQueue otherwise and push the
+///            wanted frames out.
+///
+/// \param     [in]  uint32_t frames
+///
+/// \return    none
+static void rndis_test_mix( uint32_t frames )
+{
+   rndis_data_packet_t  *p;
+   uint32_t             state = 0x2545F491u;
+   uint32_t             sent[sizeof(mix) / sizeof(mix[0])] = { 0 };
+   uint32_t             wanted = 0;
+   uint32_t             size;
+   uint32_t             i;
+   uint32_t             n;
+   uint32_t             roll;
+   uint32_t             filtered    = USBD_RNDIS_getRxFiltered();
+   uint32_t             notEthII    = USBD_RNDIS_getRxNotEthII();
+   uint32_t             etherType   = USBD_RNDIS_getRxEtherType();
+   uint32_t             enqueued    = usbQueue.dataPacketsIN;
+   uint32_t             dropped     = usb_getRxDropped();
+
+   rxExpected = 0;
+   rxReceived = 0;
+   for( n = 0; n < frames; )
+   {
+      for( size = 0; size < RNDIS_RX_MAX_PACKETS * ( HEADER + MIXLENGTH ) && n < frames; size += HEADER + MIXLENGTH, n++ )
+      {
+         roll = rndis_test_random( &state ) % 100u;
+         for( i = 0; roll >= mix[i].percent; i++ )
+         {
+            roll -= mix[i].percent;
+         }
+         sent[i]++;
+         wanted += mix[i].wanted;
+         p = (rndis_data_packet_t *)&rxBuffer[size];
+         memset( p, 0, HEADER );
+         p->MessageType    = REMOTE_NDIS_PACKET_MSG;
+         p->MessageLength  = HEADER + MIXLENGTH;
+         p->DataOffset     = HEADER - offsetof(rndis_data_packet_t, DataOffset);
+         p->DataLength     = MIXLENGTH;
+         rndis_test_frame( &rxBuffer[size + HEADER], mix[i].destination, mix[i].type, MIXLENGTH, n );
+      }
+      hpcd.OUT_ep[RNDIS_DATA_OUT_EP & 0x0Fu].xfer_count = size;
+      USBD_RNDIS_getClass()->DataOut( &hUsbDeviceFS, RNDIS_DATA_OUT_EP & 0x0Fu );
+      rndis_test_drain( MIXCONSUMER );
+   }
+   rndis_test_drain( ALL );
+
+   filtered    = USBD_RNDIS_getRxFiltered() - filtered;
+   notEthII    = USBD_RNDIS_getRxNotEthII() - notEthII;
+   etherType   = USBD_RNDIS_getRxEtherType() - etherType;
+   enqueued    = usbQueue.dataPacketsIN - enqueued;
+   dropped     = usb_getRxDropped() - dropped;
+
+   printf( "rndis: broadcast heavy host, %u frames of %u byte, %u taken per transfer of %u\n",
+           (unsigned)frames, MIXLENGTH, MIXCONSUMER, RNDIS_RX_MAX_PACKETS );
+   for( i = 0; i < sizeof(mix) / sizeof(mix[0]); i++ )
+   {
+      printf( "  %-26s %3u%% %s\n", mix[i].name, mix[i].percent, mix[i].wanted ? "wanted" : "skipped" );
+   }
+   printf( "  skipped by address %u, not ethernet II %u, frame type %u\n",
+           (unsigned)filtered, (unsigned)notEthII, (unsigned)etherType );
+   printf( "  wanted %u, enqueued %u, delivered %u, dropped by the queue %u\n",
+           (unsigned)wanted, (unsigned)enqueued, (unsigned)rxReceived, (unsigned)dropped );
+
+   if(   filtered + notEthII + etherType + wanted != frames
+      || filtered != sent[6] + sent[7]
+      || notEthII != sent[5]
+      || etherType != sent[3] + sent[4]
+      || enqueued != wanted
+      || rxReceived + dropped != wanted )
+   {
+      rndis_test_error( "broadcast heavy frames not accounted for", frames );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Xorshift pseudo random number generator.
+///
+/// \param     [in/out] uint32_t *state
+///
+/// \return    uint32_t random number
+static uint32_t rndis_test_random( uint32_t *state )
+{
+   uint32_t x = *state;
+   
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   *state = x;
+   return x;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Prints the counts of a workload per frame.
+///
+/// \param     [in]  const char *name
+/// \param     [in]  uint16_t length
+/// \param     [in]  const rndis_test_count_t *count
+///
+/// \return    none
+static void rndis_test_print( const char *name, uint16_t length, const rndis_test_count_t *count )
+{
+   double frames = count->frames ? (double)count->frames : 1.0;
+
+   printf( "  %-6s %4u byte: %.3f transfers, %.3f packets, %.4f terminations, %.3f interrupts per frame, %6.0f frames/s\n",
+           name, length, count->transfers / frames, count->packets / frames, count->terminations / frames,
+           count->interrupts / frames, BUSPACKETS * 1000.0 * frames / ( count->packets ? count->packets : 1u ) );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Completes the running in transfer, the class gets the data in
+///            interrupt.
+///
+/// \param     none
+///
+/// \return    none
+static void rndis_test_complete( void )
+{
+   if( txPending == 0 )
+   {
+      return;
+   }
+   txPending--;
+   txCount.interrupts++;
+   USBD_RNDIS_getClass()->DataIn( &hUsbDeviceFS, RNDIS_DATA_IN_EP );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Dispatches and releases the frames of the usbQueue, like the
+///            pump and the mac task.
+///
+/// \param     [in]  uint32_t limit, frames to take at most
+///
+/// \return    none
+static void rndis_test_drain( uint32_t limit )
+{
+   uint32_t taken = 0;
+   
+   do
+   {
+      rxInFlight = 0;
+      queue_manager( &usbQueue );
+      for( uint32_t i = 0; i < rxInFlight; i++ )
+      {
+         queue_dequeue( &usbQueue );
+      }
+      taken += rxInFlight;
+   } while( rxInFlight > 0 && taken < limit );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Output of the usbQueue, checks that the frame is one the
+///            stack wants and that the frames stay in sequence. Frames may
+///            be missing, if the queue has dropped them.
+///
+/// \param     [in]  uint8_t* data
+/// \param     [in]  uint16_t length
+///
+/// \return    1, the frame is taken
+static uint8_t rndis_test_output( uint8_t* data, uint16_t length )
+{
+   uint32_t sequence;
+   uint16_t type = (uint16_t)( ( data[12] << 8 ) | data[13] );
+
+   memcpy( &sequence, &data[SEQUENCE], 4u );
+   if(   sequence < rxExpected
+      || ( memcmp( data, deviceMac, 6u ) != 0 && memcmp( data, broadcast, 6u ) != 0 )
+      || ( type != 0x0800u && type != 0x0806u ) )
+   {
+      rndis_test_error( "received frame out of sequence or unwanted", sequence );
+   }
+   rxExpected = sequence + 1u;
+   rxReceived++;
+   rxInFlight++;
+   return 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Counts and prints an error, only the first ones are printed.
+///
+/// \param     [in]  const char *text
+/// \param     [in]  uint32_t value
+///
+/// \return    none
+static void rndis_test_error( const char *text, uint32_t value )
+{
+   if( errors++ < 10u )
+   {
+      printf( "rndis: %s %u\n", text, (unsigned)value );
+   }
+}
+
+// Usb device library stubs ***************************************************
+
+// ----------------------------------------------------------------------------
+/// \brief     Starts an in transfer. The packet messages of a data transfer
+///            are checked against the sent frames.
+///
+/// \return    USBD_OK
+USBD_StatusTypeDef USBD_LL_Transmit( USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint32_t size )
+{
+   rndis_data_packet_t  *p;
+   uint32_t             offset;
+   uint32_t             sequence;
+
+   if( ep_addr != RNDIS_DATA_IN_EP )
+   {
+      return USBD_OK;
+   }
+
+   txPending++;
+   txCount.transfers++;
+   txCount.packets += size ? ( size + RNDIS_DATA_IN_SZ - 1u ) / RNDIS_DATA_IN_SZ : 1u;
+   if( size == 0 )
+   {
+      txCount.terminations++;
+      return USBD_OK;
+   }
+   if( size == 1u && pbuf[0] == 0u )
+   {
+      txCount.terminations++;   // padding byte
+      return USBD_OK;
+   }
+
+   for( offset = 0; offset < size; offset += p->MessageLength )
+   {
+      p = (rndis_data_packet_t *)&pbuf[offset];
+      if( p->MessageType != REMOTE_NDIS_PACKET_MSG || p->MessageLength < HEADER )
+      {
+         rndis_test_error( "bad packet message in transfer at", offset );
+         return USBD_OK;
+      }
+      memcpy( &sequence, &pbuf[offset + offsetof(rndis_data_packet_t, DataOffset) + p->DataOffset + SEQUENCE], 4u );
+      if( sequence != txExpected )
+      {
+         rndis_test_error( "sent frame out of sequence", sequence );
+      }
+      txExpected = sequence + 1u;
+   }
+   if( offset != size && offset != size + 1u )
+   {
+      rndis_test_error( "transfer length does not match the messages", size );
+   }
+   return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_PrepareReceive( USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t *pbuf, uint32_t size )
+{
+   rxBuffer = pbuf;
+   return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_OpenEP( USBD_HandleTypeDef *pdev, uint8_t ep_addr, uint8_t ep_type, uint16_t ep_mps )
+{
+   return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_LL_CloseEP( USBD_HandleTypeDef *pdev, uint8_t ep_addr )
+{
+   return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_CtlPrepareRx( USBD_HandleTypeDef *pdev, uint8_t *pbuf, uint32_t len )
+{
+   ctlBuffer = pbuf;
+   return USBD_OK;
+}
+
+USBD_StatusTypeDef USBD_CtlSendData( USBD_HandleTypeDef *pdev, uint8_t *pbuf, uint32_t len )
+{
+   return USBD_OK;
+}
+
+void metrics_register( metrics_group_t* group )
+{
+}
+
+// Usb device callbacks, as in usb_device.c ***********************************
+
+void on_usbOutRxPacket( const char *data, int size, uint8_t *next )
+{
+   if( queue_admit( QUEUE_LANE_BULK, &usbQueue ) == 1 )
+   {
+      if( next != NULL )
+      {
+         queue_enqueueLaneAt( (uint8_t*)data, (uint16_t)size, next, QUEUE_LANE_BULK, &usbQueue );
+         return;
+      }
+      queue_enqueue( (uint8_t*)data, size, &usbQueue );
+      USBD_RNDIS_setBuffer( queue_getHeadBuffer( &usbQueue ) );
+   }
+}
+
+uint8_t* on_usbOutRxReserve( const char *end )
+{
+   return queue_reserveLane( (uint8_t*)end, QUEUE_LANE_BULK, &usbQueue );
+}
+
+void on_usbOutRxCplt( uint8_t *buffer )
+{
+   queue_setLaneHeadBuffer( buffer, QUEUE_LANE_BULK, &usbQueue );
+}
+
+void on_usbInTxCplt( void )
+{
+}
+
+uint32_t usb_getRxDropped( void )
+{
+   return usbQueue.dropTail + usbQueue.dropHead + usbQueue.dropEarly;
+}
+
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
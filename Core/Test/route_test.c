@@ -0,0 +1,285 @@
+// ****************************************************************************
+/// \file      route_test.c
+///
+/// \brief     Host test and benchmark of the route lookup of the http server
+///
+/// \details   Looks up requests with httpserver_route() of httproute.h in a
+///            table of ROUTES routes, generated by webassets.py --bench out
+///            of the routes of the server and made up ones. Checks every
+///            route, the parameter of the routes with a parameter, queries
+///            and unknown paths, and measures the lookup against a linear
+///            search of the keys in the order of ROUTES in webassets.py, as
+///            the chain of compares did before. The times are of the host
+///            cpu and only compare the two searches.
+///            Usage: route_test [rounds], 1000000 lookups by default.
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+///
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person
+///            obtaining a copy of this software and associated documentation
+///            files (the "Software"), to deal in the Software without
+///            restriction, including without limitation the rights to use,
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the
+///            Software is furnished to do so, subject to the following
+///            conditions:
+///
+///            The above copyright notice and this permission notice shall be
+///            included in all copies or substantial portions of the Software.
+///
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre
+///
+/// \bug
+///
+/// \warning
+///
+/// \todo
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Private define *************************************************************
+#define ROUNDS_DEFAULT     ( 1000000u )
+#define REQUESTLENGTH      ( 128u )
+#define REPEATS            ( 5u )         // the fastest of the repeats is taken
+
+// Private types     **********************************************************
+// the fields of the route which the lookup uses, as in httpserver.c
+typedef struct
+{
+   const char*          key;
+   uint16_t             keyLength;
+   uint8_t              prefix;
+   const void*          handler;
+   const void*          asset;
+} httpserver_route_t;
+
+typedef struct
+{
+   const httpserver_route_t* route;
+   uint8_t              request[REQUESTLENGTH];
+   uint16_t             requestLength;
+} route_test_request_t;
+
+// the generated table and the lookup of the server
+#include "webroutes_bench.h"
+#include "httproute.h"
+
+// Private variables **********************************************************
+static route_test_request_t   requests[WEBROUTES_SIZE + 2u];
+static uint32_t               requestsCount;
+static const httpserver_route_t* linear[WEBROUTES_SIZE];
+static uint32_t               linearCount;
+static volatile uintptr_t     sink;
+static uint32_t               errors;
+
+// Global variables ***********************************************************
+
+// Private function prototypes ************************************************
+static void       route_test_prepare   ( void );
+static void       route_test_check     ( void );
+static void       route_test_measure   ( uint32_t rounds );
+static const httpserver_route_t* route_test_linear( const uint8_t* request, uint16_t requestLength );
+static double     route_test_now       ( void );
+
+// Private functions **********************************************************
+
+// ----------------------------------------------------------------------------
+/// \brief     Runs the test and the benchmark.
+///
+/// \param     [in]  int argc
+/// \param     [in]  char **argv
+///
+/// \return    0 if all lookups matched, 1 if not
+int main( int argc, char **argv )
+{
+   uint32_t rounds = ( argc > 1 ) ? strtoul( argv[1], NULL, 10 ) : ROUNDS_DEFAULT;
+
+   route_test_prepare();
+   route_test_check();
+   route_test_measure( rounds );
+
+   printf( "route: %u errors\n", (unsigned)errors );
+   return errors == 0 ? 0 : 1;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Puts the routes into the order of the linear search and writes
+///            a request for every route, a parameter route gets a value. The
+///            generated table is sorted by slot, the order of webassets.py
+///            is restored from the made up names, the server routes first.
+///
+/// \param     none
+///
+/// \return    none
+static void route_test_prepare( void )
+{
+   const httpserver_route_t   *route;
+   route_test_request_t       *request;
+
+   for( uint8_t pass = 0; pass < 2; pass++ )
+   {
+      for( route = webroutes; route < &webroutes[WEBROUTES_SIZE]; route++ )
+      {
+         if( route->key != NULL && ( strstr( route->key, "/api/" ) != NULL ) == pass )
+         {
+            linear[linearCount++] = route;
+         }
+      }
+   }
+
+   for( uint32_t i = 0; i < linearCount; i++ )
+   {
+      request                 = &requests[requestsCount++];
+      request->route          = linear[i];
+      request->requestLength  = snprintf( (char*)request->request, REQUESTLENGTH, "%s%s HTTP/1.1\r\nHost: 192.168.2.1\r\n\r\n",
+                                          linear[i]->key, ( linear[i]->prefix == 1 ) ? "12" : "" );
+   }
+
+   // a query and an unknown path
+   request                 = &requests[requestsCount++];
+   request->route          = linear[0];
+   request->requestLength  = snprintf( (char*)request->request, REQUESTLENGTH, "%s?id=1 HTTP/1.1\r\n\r\n", linear[0]->key );
+   request                 = &requests[requestsCount++];
+   request->route          = NULL;
+   request->requestLength  = snprintf( (char*)request->request, REQUESTLENGTH, "GET /api/unknown.json HTTP/1.1\r\n\r\n" );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Checks the lookup and the linear search for every request.
+///
+/// \param     none
+///
+/// \return    none
+static void route_test_check( void )
+{
+   const httpserver_route_t   *route;
+   const uint8_t              *parameter;
+   uint16_t                   parameterLength;
+
+   for( uint32_t i = 0; i < requestsCount; i++ )
+   {
+      route = httpserver_route( requests[i].request, requests[i].requestLength, &parameter, &parameterLength );
+      if(   route != requests[i].route
+         || route_test_linear( requests[i].request, requests[i].requestLength ) != requests[i].route
+         || ( route != NULL && route->prefix == 1 && ( parameterLength != 2u || memcmp( parameter, "12", 2u ) != 0 ) ) )
+      {
+         errors++;
+         printf( "route: wrong route for %.*s\n", (int)( strchr( (char*)requests[i].request, '\r' ) - (char*)requests[i].request ), requests[i].request );
+      }
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Measures the lookup and the linear search over all requests,
+///            and for the first and the last route of the linear search.
+///
+/// \param     [in]  uint32_t rounds
+///
+/// \return    none
+static void route_test_measure( uint32_t rounds )
+{
+   static const char          *names[] = { "all", "first", "last", "unknown" };
+   const route_test_request_t *request;
+   const uint8_t              *parameter;
+   uint16_t                   parameterLength;
+   double                     start, time, hash, search;
+   uint32_t                   first, count;
+
+   printf( "route: %u routes in %u slots, ns per lookup\n", (unsigned)linearCount, (unsigned)WEBROUTES_SIZE );
+   for( uint8_t n = 0; n < sizeof( names ) / sizeof( names[0] ); n++ )
+   {
+      first = ( n == 0 || n == 1 ) ? 0u : ( n == 2 ) ? linearCount - 1u : requestsCount - 1u;
+      count = ( n == 0 ) ? requestsCount : 1u;
+
+      hash     = 1e9;
+      search   = 1e9;
+      for( uint8_t k = 0; k < REPEATS; k++ )
+      {
+         start = route_test_now();
+         for( uint32_t r = 0; r < rounds; r++ )
+         {
+            request = &requests[first + r % count];
+            sink = (uintptr_t)httpserver_route( request->request, request->requestLength, &parameter, &parameterLength );
+         }
+         time = route_test_now() - start;
+         hash = ( time < hash ) ? time : hash;
+
+         start = route_test_now();
+         for( uint32_t r = 0; r < rounds; r++ )
+         {
+            request = &requests[first + r % count];
+            sink = (uintptr_t)route_test_linear( request->request, request->requestLength );
+         }
+         time = route_test_now() - start;
+         search = ( time < search ) ? time : search;
+      }
+
+      printf( "  %-7s: hash %6.1f, linear %6.1f\n", names[n], hash * 1e9 / rounds, search * 1e9 / rounds );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Linear search of the route, one compare per route in the order
+///            of the routes, a parameter route matches its prefix.
+///
+/// \param     [in]  const uint8_t* request
+/// \param     [in]  uint16_t requestLength
+///
+/// \return    route, NULL if there is no route for the request
+static const httpserver_route_t* route_test_linear( const uint8_t* request, uint16_t requestLength )
+{
+   const uint8_t *end;
+
+   // the key ends at the second space or at the query
+   end = memchr( request, ' ', requestLength );
+   for( end = ( end != NULL ) ? end + 1 : request + requestLength; end < request + requestLength && *end != ' ' && *end != '?'; end++ );
+
+   for( uint32_t i = 0; i < linearCount; i++ )
+   {
+      if(   ( linear[i]->prefix == 1 || linear[i]->keyLength == end - request )
+         && linear[i]->keyLength <= end - request
+         && memcmp( linear[i]->key, request, linear[i]->keyLength ) == 0 )
+      {
+         return linear[i];
+      }
+   }
+   return NULL;
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Returns the time of the monotonic clock.
+///
+/// \param     none
+///
+/// \return    double seconds
+static double route_test_now( void )
+{
+   struct timespec ts;
+
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
@@ -0,0 +1,84 @@
+// ****************************************************************************
+/// \file      stm32f4xx.h
+///
+/// \brief     Host stub of the device header for the tests
+///
+/// \details   Gives the modules under test the few core definitions they use,
+///            the barrier, the count leading zeros instruction and the cycle
+///            counter, so they compile unchanged on the host.
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+/// 
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person 
+///            obtaining a copy of this software and associated documentation 
+///            files (the "Software"), to deal in the Software without 
+///            restriction, including without limitation the rights to use, 
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the 
+///            Software is furnished to do so, subject to the following 
+///            conditions:
+///            
+///            The above copyright notice and this permission notice shall be 
+///            included in all copies or substantial portions of the Software.
+///            
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES 
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR 
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __STM32F4XX_H
+#define __STM32F4XX_H
+
+// Include ********************************************************************
+#include <stdint.h>
+#include <stddef.h>
+
+// Exported defines ***********************************************************
+#define __DMB()                        __sync_synchronize()
+#define __CLZ( x )                     ( ( x ) == 0u ? 32u : (uint32_t)__builtin_clz( x ) )
+#define DWT                            ( &host_dwt )
+#define CoreDebug                      ( &host_coreDebug )
+#define DWT_CTRL_CYCCNTENA_Msk         ( 1u )
+#define CoreDebug_DEMCR_TRCENA_Msk     ( 1u << 24 )
+
+// Exported types *************************************************************
+typedef struct
+{
+   volatile uint32_t CTRL;
+   volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+   volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+// Exported variables *********************************************************
+// the cycle counter stays 0 on the host
+static DWT_Type         host_dwt          __attribute__(( unused ));
+static CoreDebug_Type   host_coreDebug    __attribute__(( unused ));
+
+#endif // __STM32F4XX_H
+
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
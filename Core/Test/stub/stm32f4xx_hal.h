@@ -0,0 +1,84 @@
+// ****************************************************************************
+/// \file      stm32f4xx_hal.h
+///
+/// \brief     Host stub of the hal header for the tests
+///
+/// \details   Gives the usb class and the usb device library the few hal types
+///            and macros they use, so they compile unchanged on the host.
+///
+/// \author    Nico Korn
+///
+/// \version   0.3.0.2
+///
+/// \date      17102026
+/// 
+/// \copyright Copyright (C) 2021 by "Nico Korn". nico13@hispeed.ch
+///
+///            Permission is hereby granted, free of charge, to any person 
+///            obtaining a copy of this software and associated documentation 
+///            files (the "Software"), to deal in the Software without 
+///            restriction, including without limitation the rights to use, 
+///            copy, modify, merge, publish, distribute, sublicense, and/or sell
+///            copies of the Software, and to permit persons to whom the 
+///            Software is furnished to do so, subject to the following 
+///            conditions:
+///            
+///            The above copyright notice and this permission notice shall be 
+///            included in all copies or substantial portions of the Software.
+///            
+///            THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+///            EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES 
+///            OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+///            NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT 
+///            HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+///            WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+///            FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR 
+///            OTHER DEALINGS IN THE SOFTWARE.
+///
+/// \pre       
+///
+/// \bug       
+///
+/// \warning   
+///
+/// \todo      
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __STM32F4XX_HAL_H
+#define __STM32F4XX_HAL_H
+
+// Include ********************************************************************
+#include "stm32f4xx.h"
+
+// Exported defines ***********************************************************
+#define __IO                           volatile
+#define __STATIC_INLINE                static inline
+#define UNUSED( X )                    (void)( X )
+#define HAL_NVIC_DisableIRQ( irq )
+#define HAL_NVIC_EnableIRQ( irq )
+
+// Exported types *************************************************************
+typedef enum
+{
+   OTG_FS_IRQn = 67
+} IRQn_Type;
+
+typedef struct
+{
+   uint32_t                xfer_count;    // bytes of the completed out transfer
+} PCD_EPTypeDef;
+
+typedef struct
+{
+   PCD_EPTypeDef           IN_ep[16];
+   PCD_EPTypeDef           OUT_ep[16];
+} PCD_HandleTypeDef;
+
+// Exported functions *********************************************************
+void HAL_Delay( uint32_t Delay );
+
+#endif // __STM32F4XX_HAL_H
+
+/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
@@ -0,0 +1,156 @@
+var xhr=new XMLHttpRequest();
+var slider=document.getElementById('myRange');
+var block=0;
+
+function unblock(){block=0;};
+
+// the slider sends the duty cycle over the websocket, a value is sent when
+// the previous one is answered and the values in between are skipped
+var ws=null;
+var wsBusy=0;
+var wsPending=-1;
+
+function sendDuty(value){
+   if(wsBusy==1){
+      wsPending=value;
+      return;
+   }
+   wsBusy=1;
+   ws.send(new Uint8Array([0x01, value]));
+};
+
+if(window.WebSocket){
+   ws=new WebSocket('ws://'+location.host+'/ws');
+   ws.binaryType='arraybuffer';
+   ws.onmessage=function(e){
+      // the reply of a duty command, or of an invalid one
+      let id=new Uint8Array(e.data)[0];
+      if(id==0x81 || id==0xFF){
+         wsBusy=0;
+         if(wsPending>=0){
+            let value=wsPending;
+            wsPending=-1;
+            sendDuty(value);
+         }
+      }
+   };
+   ws.onclose=function(){ws=null;};
+}
+
+// block next post request triggert by the slider for 150 ms to avoid "spamming"
+slider.oninput=function(){
+   if(ws!=null && ws.readyState==WebSocket.OPEN){
+      sendDuty(Number(this.value));
+   }else if(block==0){
+      block=1;
+      var urlpost='/led_set_value/'+this.value;
+      xhr.open('POST', urlpost, true);
+      xhr.setRequestHeader('Content-Type', 'application/x-www-form-urlencoded; charset=UTF-8');
+      xhr.send('zero');
+      setTimeout(unblock, 150);
+   }
+};
+
+async function getJSON(url){
+   try{
+      let res = await fetch(url);
+      return await res.json();
+   }catch(error){
+      console.log(error);
+   }
+};
+
+// device info, the page itself is static and cached by the browser
+async function renderInfo(){
+   let info = await getJSON('info.json');
+   document.getElementById('ip').textContent = info.ip;
+   document.getElementById('mac').textContent = info.mac;
+   document.getElementById('guests').textContent = info.guests;
+   document.getElementById('rtosversion').textContent = info.rtos;
+   slider.value = info.duty;
+};
+
+renderInfo();
+
+// the values of the page, merged from the events or the json files
+var state={};
+
+function renderTime(time){
+   let html = `<div class='time'>Uptime: ${time.d} days, ${time.h} hours, ${time.m} minutes, ${time.s} seconds</div>`;
+   document.querySelector('.timecontainer').innerHTML = html;
+};
+
+function renderRtos(rtos){
+   let html = `<div class='rtos'>`+
+                 `<p>Free Heap: ${rtos.heap} bytes</p>`+
+                 `<table style='color:white'>`+
+                    `<tr><td>Running Tasks</td></tr>`+
+                    `<tr><td style='width:150px'>Name</td><td style='width:50px'>Priority</td></tr>`+
+                    `<tr><td>${rtos.t1n}</td><td>${rtos.t1p}</td></tr>`+
+                    `<tr><td>${rtos.t2n}</td><td>${rtos.t2p}</td></tr>`+
+                    `<tr><td>${rtos.t3n}</td><td>${rtos.t3p}</td></tr>`+
+                    `<tr><td>${rtos.t4n}</td><td>${rtos.t4p}</td></tr>`+
+                    `<tr><td>${rtos.t5n}</td><td>${rtos.t5p}</td></tr>`+
+                    `<tr><td>${rtos.t6n}</td><td>${rtos.t6p}</td></tr>`+
+                    `<tr><td>${rtos.t7n}</td><td>${rtos.t7p}</td></tr>`+
+                 `</table>`+
+              `</div>`;
+   document.querySelector('.rtoscontainer').innerHTML = html;
+};
+
+function renderSensor(sensor){
+   let html = `<div class='sensor'>`+
+                 `<p>Button: ${sensor.btn}</p>`+
+                 `<p>Temperature: ${sensor.temp} C</p>`+
+                 `<p>Voltage: ${sensor.volt} V</p>`+
+              `</div>`;
+   document.querySelector('.sensorcontainer').innerHTML = html;
+};
+
+function renderTcpIp(tcpip){
+   let html = `<div class='tcpip'>`+
+                 `<p>Received Ethernet Frames: ${tcpip.rxF}</p>`+
+                 `<p>Received Data: ${tcpip.rxD} Bytes</p>`+
+                 `<p>Transmitted Ethernet Frames: ${tcpip.txF}</p>`+
+                 `<p>Transmitted Data: ${tcpip.txD} Bytes</p>`+
+              `</div>`;
+   document.querySelector('.tcpipcontainer').innerHTML = html;
+};
+
+function renderAll(){
+   renderTime(state);
+   renderRtos(state);
+   renderSensor(state);
+   renderTcpIp(state);
+};
+
+// polls the json files, if the server has no event stream
+async function poll(url){
+   Object.assign(state, await getJSON(url));
+   renderAll();
+};
+
+function startPolling(){
+   poll('rtos.json');
+   for(const url of ['time.json', 'sensor.json', 'tcpip.json']){
+      poll(url);
+      setInterval(poll, 1000, url);
+   }
+};
+
+// the server pushes the changed values on one connection
+if(window.EventSource){
+   var events=new EventSource('events');
+   events.onmessage=function(e){
+      Object.assign(state, JSON.parse(e.data));
+      renderAll();
+   };
+   // the stream is closed for good if the server does not know it
+   events.onerror=function(){
+      if(events.readyState==EventSource.CLOSED){
+         startPolling();
+      }
+   };
+}else{
+   startPolling();
+}
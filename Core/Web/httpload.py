@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+# *****************************************************************************
+# \file      httpload.py
+#
+# \brief     Measures the connection capacity and the request latency of the
+#            http server of the board.
+#
+# \details   Opens a number of keep-alive connections at once, every one asks
+#            for a small response in a loop. Stalled clients can be added,
+#            they ask for a large response and never read it, so their
+#            receive window is full and the server cannot send to them.
+#            Prints how many connections were served, refused or dropped, the
+#            requests per second and the latency percentiles of the served
+#            requests. Build the firmware with HTTPSERVER_SELECT 1 and 0 and
+#            run the same command against both to compare them:
+#
+#               python Core/Web/httpload.py --connections 6 --stalled 1
+#
+# \author    Nico Korn
+#
+# \version   0.3.0.2
+#
+# \date      17102026
+# *****************************************************************************
+
+import argparse
+import socket
+import threading
+import time
+
+HOST = '192.168.2.1'   # IP1.IP2.IP3.IP4 of tcpip.h
+
+
+def read_response(sock, buffer):
+    """Reads one response, returns the rest of the buffer or None if the
+    connection was closed before the response was complete."""
+    while b'\r\n\r\n' not in buffer:
+        data = sock.recv(4096)
+        if not data:
+            return None
+        buffer += data
+    header, _, buffer = buffer.partition(b'\r\n\r\n')
+    fields = header.lower()
+
+    if b'content-length:' in fields:
+        length = int(fields.split(b'content-length:')[1].split(b'\r\n')[0])
+        while len(buffer) < length:
+            data = sock.recv(4096)
+            if not data:
+                return None
+            buffer += data
+        return buffer[length:]
+
+    if b'transfer-encoding: chunked' in fields:
+        while True:
+            while b'\r\n' not in buffer:
+                data = sock.recv(4096)
+                if not data:
+                    return None
+                buffer += data
+            line, _, buffer = buffer.partition(b'\r\n')
+            size = int(line, 16)
+            while len(buffer) < size + 2:
+                data = sock.recv(4096)
+                if not data:
+                    return None
+                buffer += data
+            buffer = buffer[size + 2:]
+            if size == 0:
+                return buffer
+
+    # the response ends with the connection
+    while sock.recv(4096):
+        pass
+    return None
+
+
+def client(args, result, stop):
+    """Asks for args.path on one keep-alive connection until stop is set."""
+    request = ('GET %s HTTP/1.1\r\nHost: %s\r\n\r\n' % (args.path, args.host)).encode()
+    try:
+        sock = socket.create_connection((args.host, args.port), timeout=args.timeout)
+    except OSError:
+        result['refused'] += 1
+        return
+    buffer = b''
+    try:
+        while not stop.is_set():
+            start = time.perf_counter()
+            sock.sendall(request)
+            buffer = read_response(sock, buffer)
+            if buffer is None:
+                result['dropped'] += 1
+                break
+            result['latency'].append(time.perf_counter() - start)
+    except OSError:
+        result['dropped'] += 1
+    finally:
+        sock.close()
+
+
+def stalled(args, sockets):
+    """Asks for args.stall_path and never reads the response."""
+    request = ('GET %s HTTP/1.1\r\nHost: %s\r\n\r\n' % (args.stall_path, args.host)).encode()
+    try:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 256)
+        sock.settimeout(args.timeout)
+        sock.connect((args.host, args.port))
+        for _ in range(args.stall_requests):
+            sock.sendall(request)
+        sockets.append(sock)
+    except OSError:
+        pass
+
+
+def percentile(values, p):
+    if not values:
+        return float('nan')
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Connection capacity and request latency of the http server')
+    parser.add_argument('--host', default=HOST)
+    parser.add_argument('--port', type=int, default=80)
+    parser.add_argument('--path', default='/time.json', help='small response of the clients')
+    parser.add_argument('--connections', type=int, default=6, help='clients at once')
+    parser.add_argument('--stalled', type=int, default=0, help='clients which never read')
+    parser.add_argument('--stall-path', default='/metrics', help='large response of the stalled clients')
+    parser.add_argument('--stall-requests', type=int, default=4, help='requests sent by a stalled client')
+    parser.add_argument('--duration', type=float, default=10.0, help='seconds')
+    parser.add_argument('--timeout', type=float, default=10.0, help='seconds per socket operation')
+    args = parser.parse_args()
+
+    # the stalled clients take their slots first
+    held = []
+    for _ in range(args.stalled):
+        stalled(args, held)
+    time.sleep(0.5)
+
+    result = {'refused': 0, 'dropped': 0, 'latency': []}
+    stop = threading.Event()
+    threads = [threading.Thread(target=client, args=(args, result, stop)) for _ in range(args.connections)]
+    start = time.perf_counter()
+    for thread in threads:
+        thread.start()
+    time.sleep(args.duration)
+    stop.set()
+    for thread in threads:
+        thread.join()
+    elapsed = time.perf_counter() - start
+    for sock in held:
+        sock.close()
+
+    latency = [t * 1000.0 for t in result['latency']]
+    print('connections %d, stalled %d: %d refused, %d dropped, %d of %d stalled held'
+          % (args.connections, args.stalled, result['refused'], result['dropped'], len(held), args.stalled))
+    print('%d requests, %.1f per second' % (len(latency), len(latency) / elapsed))
+    print('latency ms: p50 %.1f, p95 %.1f, p99 %.1f, max %.1f'
+          % (percentile(latency, 50), percentile(latency, 95), percentile(latency, 99),
+             max(latency) if latency else float('nan')))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+# *****************************************************************************
+# \file      latency.py
+#
+# \brief     Measures the ping round trip and the tcp throughput of the board,
+#            idle and while a tcp transfer is running.
+#
+# \details   Pings the board with the ping command of the system, then
+#            downloads a file on a keep-alive connection for a while, and
+#            pings again during a second download. Prints the round trip
+#            percentiles, the lost pings and the download rate.
+#            The benchmark compares the queue managers in the pump task with
+#            the managers in the idle hook, with and without a busy cpu.
+#            Build the firmware four times and run the same command against
+#            every build:
+#
+#               configUSE_IDLE_HOOK 1 in FreeRTOSConfig.h, CPUHOG 0 in main.c
+#               configUSE_IDLE_HOOK 1 in FreeRTOSConfig.h, CPUHOG 1 in main.c
+#               configUSE_IDLE_HOOK 0 in FreeRTOSConfig.h, CPUHOG 0 in main.c
+#               configUSE_IDLE_HOOK 0 in FreeRTOSConfig.h, CPUHOG 1 in main.c
+#
+#               python Core/Web/latency.py --pings 100 --duration 10
+#
+# \author    Nico Korn
+#
+# \version   0.3.0.2
+#
+# \date      17102026
+# *****************************************************************************
+
+import argparse
+import platform
+import re
+import socket
+import subprocess
+import threading
+import time
+
+from httpload import read_response, percentile
+
+HOST = '192.168.2.1'   # IP1.IP2.IP3.IP4 of tcpip.h
+TIME = re.compile(r'time[=<]\s*([\d.]+)\s*ms')
+
+
+class CountingSocket:
+    """Counts the bytes received by read_response."""
+
+    def __init__(self, sock):
+        self.sock = sock
+        self.received = 0
+
+    def recv(self, size):
+        data = self.sock.recv(size)
+        self.received += len(data)
+        return data
+
+
+def ping(args):
+    """Pings the board args.pings times, returns the round trips in ms, a
+    lost ping has none."""
+    if platform.system() == 'Windows':
+        command = ['ping', '-n', str(args.pings), '-w', '1000', args.host]
+    else:
+        command = ['ping', '-c', str(args.pings), '-i', str(args.interval), '-W', '1', args.host]
+    output = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True).stdout
+    # the summary lines have no time=
+    return [float(t) for t in TIME.findall(output)]
+
+
+def download(args, result, stop):
+    """Asks for args.path on one keep-alive connection until stop is set."""
+    request = ('GET %s HTTP/1.1\r\nHost: %s\r\n\r\n' % (args.path, args.host)).encode()
+    try:
+        sock = socket.create_connection((args.host, args.port), timeout=args.timeout)
+    except OSError:
+        result['errors'] += 1
+        return
+    counting = CountingSocket(sock)
+    buffer = b''
+    try:
+        while not stop.is_set():
+            sock.sendall(request)
+            buffer = read_response(counting, buffer)
+            if buffer is None:
+                result['errors'] += 1
+                break
+            result['responses'] += 1
+    except OSError:
+        result['errors'] += 1
+    finally:
+        result['bytes'] += counting.received
+        sock.close()
+
+
+def transfer(args, during=None):
+    """Downloads for args.duration seconds, runs during() meanwhile if given,
+    returns the download result and the result of during()."""
+    result = {'bytes': 0, 'responses': 0, 'errors': 0}
+    stop = threading.Event()
+    thread = threading.Thread(target=download, args=(args, result, stop))
+    start = time.perf_counter()
+    thread.start()
+    other = during() if during is not None else None
+    remaining = args.duration - (time.perf_counter() - start)
+    if remaining > 0:
+        time.sleep(remaining)
+    stop.set()
+    thread.join()
+    result['rate'] = result['bytes'] / 1024.0 / (time.perf_counter() - start)
+    return result, other
+
+
+def report_ping(name, args, times):
+    print('%-22s %d of %d answered, rtt ms: min %.2f, p50 %.2f, p95 %.2f, max %.2f'
+          % (name, len(times), args.pings, min(times) if times else float('nan'), percentile(times, 50),
+             percentile(times, 95), max(times) if times else float('nan')))
+
+
+def report_transfer(name, result):
+    print('%-22s %.1f KiB/s, %d responses, %d errors'
+          % (name, result['rate'], result['responses'], result['errors']))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Ping round trip and tcp throughput, idle and under load')
+    parser.add_argument('--host', default=HOST)
+    parser.add_argument('--port', type=int, default=80)
+    parser.add_argument('--path', default='/app.js', help='file of the download')
+    parser.add_argument('--pings', type=int, default=100)
+    parser.add_argument('--interval', type=float, default=0.2, help='seconds between pings, not on windows')
+    parser.add_argument('--duration', type=float, default=10.0, help='seconds of a download')
+    parser.add_argument('--timeout', type=float, default=10.0, help='seconds per socket operation')
+    args = parser.parse_args()
+
+    report_ping('ping idle:', args, ping(args))
+    result, _ = transfer(args)
+    report_transfer('download:', result)
+    result, times = transfer(args, lambda: ping(args))
+    report_ping('ping during download:', args, times)
+    report_transfer('download with ping:', result)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,370 @@
+#!/usr/bin/env python3
+# *****************************************************************************
+# \file      webassets.py
+#
+# \brief     Generates Core/Src/webassets.c, Core/Inc/webtemplates.h and
+#            Core/Inc/webroutes.h from the files in Core/Web.
+#
+# \details   Every file is gzip compressed and stored in the flash together
+#            with its complete 200 and 304 response headers, so the http
+#            server sends it without any formatting. The entity tag is a hash
+#            of the file content, it changes with every edit of the file.
+#            The templates in Core/Web/templates are split into flash text
+#            and typed placeholders {{name:type}}, the http server renders
+#            them in one pass. Every placeholder gets an index into the
+#            values of the template in webtemplates.h.
+#            The routes of the http server and the static files are put
+#            into a perfect hash table, the server looks up a request with
+#            one hash over the method and the path and one compare.
+#            Run it after changing a file in this directory:
+#
+#               python Core/Web/webassets.py
+#
+# \author    Nico Korn
+#
+# \version   0.3.0.2
+#
+# \date      17102026
+# *****************************************************************************
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+WEBDIR = os.path.dirname(os.path.abspath(__file__))
+OUTPUT = os.path.join(WEBDIR, '..', 'Src', 'webassets.c')
+OUTPUTH = os.path.join(WEBDIR, '..', 'Inc', 'webtemplates.h')
+OUTPUTR = os.path.join(WEBDIR, '..', 'Inc', 'webroutes.h')
+
+# file, uri, content type, cache control
+# The page is revalidated on every load, the files it references are cached.
+ASSETS = [
+    ('index.html',  '/',            'text/html; charset=utf-8',  'no-cache'),
+    ('style.css',   '/style.css',   'text/css; charset=utf-8',   'max-age=86400'),
+    ('app.js',      '/app.js',      'text/javascript; charset=utf-8', 'max-age=86400'),
+    ('favicon.ico', '/favicon.ico', 'image/x-icon',              'max-age=604800'),
+]
+
+# file in templates, content type
+# The responses are rendered at every request, they are never cached.
+TEMPLATES = [
+    ('info.json',   'application/json; charset=utf-8'),
+    ('time.json',   'application/json; charset=utf-8'),
+    ('rtos.json',   'application/json; charset=utf-8'),
+    ('sensor.json', 'application/json; charset=utf-8'),
+    ('tcpip.json',  'application/json; charset=utf-8'),
+]
+
+# method, path, handler in httpserver.c, condition
+# A path ending with * passes its last segment to the handler. The static
+# files are routed too, a GET of any other path gets the homepage.
+ROUTES = [
+    ('GET',  '/info.json',        'httpserver_fetchInfoJSON',    None),
+    ('GET',  '/time.json',        'httpserver_fetchTimeJSON',    None),
+    ('GET',  '/rtos.json',        'httpserver_fetchRtosJSON',    None),
+    ('GET',  '/sensor.json',      'httpserver_fetchSensorJSON',  None),
+    ('GET',  '/tcpip.json',       'httpserver_fetchTcpIpJSON',   None),
+    ('GET',  '/metrics',          'httpserver_fetchMetrics',     None),
+    ('GET',  '/latency.json',     'httpserver_fetchLatencyJSON', 'QUEUE_SOJOURN == 1u'),
+    ('GET',  '/events',           'httpserver_fetchEvents',      'HTTPSERVER_SELECT == 1u'),
+    ('GET',  '/ws',               'httpserver_fetchWebSocket',   'HTTPSERVER_SELECT == 1u'),
+    ('POST', '/led_toggle',       'httpserver_ledToggle',        None),
+    ('POST', '/led_set_value/*',  'httpserver_ledSetValue',      None),
+    ('POST', '/led_pulse',        'httpserver_ledPulse',         None),
+]
+
+# FNV-1a, the same as httpserver_route()
+FNV_BASIS = 0x811c9dc5
+FNV_PRIME = 16777619
+
+# placeholder type, webtemplate_type_t
+TYPES = {
+    'u32': 'WEBTEMPLATE_U32',
+    'i32': 'WEBTEMPLATE_I32',
+    'x2':  'WEBTEMPLATE_X2',
+    'f1':  'WEBTEMPLATE_F1',
+    'f2':  'WEBTEMPLATE_F2',
+    'str': 'WEBTEMPLATE_STR',
+}
+
+PLACEHOLDER = re.compile(r'\{\{(\w+):(\w+)\}\}')
+
+HEADER = '''// ****************************************************************************
+/// \\file      webassets.c
+///
+/// \\brief     Web Assets C Source File
+///
+/// \\details   Generated by Core/Web/webassets.py, do not edit.
+///
+// ****************************************************************************
+
+// Include ********************************************************************
+#include "webassets.h"
+#include "webtemplates.h"
+
+'''
+
+HEADERH = '''// ****************************************************************************
+/// \\file      webtemplates.h
+///
+/// \\brief     Web Templates C Header File
+///
+/// \\details   Generated by Core/Web/webassets.py, do not edit.
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __WEBTEMPLATES_H
+#define __WEBTEMPLATES_H
+
+// Include ********************************************************************
+#include "webassets.h"
+
+'''
+
+HEADERR = '''// ****************************************************************************
+/// \\file      webroutes.h
+///
+/// \\brief     Web Routes C Header File
+///
+/// \\details   Generated by Core/Web/webassets.py, do not edit. Included by
+///            httpserver.c only, the handlers are static there.
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __WEBROUTES_H
+#define __WEBROUTES_H
+
+'''
+
+HEADERB = '''// ****************************************************************************
+/// \\file      webroutes_bench.h
+///
+/// \\brief     Web Routes C Header File of the route benchmark
+///
+/// \\details   Generated by Core/Web/webassets.py --bench, do not edit.
+///            Included by Core/Test/route_test.c only.
+///
+// ****************************************************************************
+
+// Define to prevent recursive inclusion **************************************
+#ifndef __WEBROUTES_H
+#define __WEBROUTES_H
+
+'''
+
+FOOTER = '/********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/\n'
+
+
+def c_name(filename):
+   return 'webasset_' + filename.replace('.', '_').replace('-', '_')
+
+
+def c_string(text):
+   return '"' + text.replace('\\', '\\\\').replace('"', '\\"').replace('\r', '\\r').replace('\n', '\\n') + '"'
+
+
+def c_enum(filename, name):
+   return (filename.replace('.', '_').replace('-', '_') + '_' + name).upper()
+
+
+def route_hash(key, seed):
+   h = seed
+   for b in key.encode('ascii'):
+      h = ((h ^ b) * FNV_PRIME) & 0xffffffff
+   return h
+
+
+def route_table(keys):
+   # the smallest power of two with a seed that puts every key into its own
+   # slot, at least twice the number of keys to keep the search short
+   size = 1
+   while size < 2 * len(keys):
+      size *= 2
+   while True:
+      for seed in range(FNV_BASIS, FNV_BASIS + 10000):
+         slots = set(route_hash(key, seed) & (size - 1) for key in keys)
+         if len(slots) == len(keys):
+            return size, seed
+      size *= 2
+
+
+def c_bytes(data):
+   lines = []
+   for i in range(0, len(data), 16):
+      lines.append('   ' + ' '.join('0x%02x,' % b for b in data[i:i + 16]))
+   return '\n'.join(lines)
+
+
+def routes():
+   # key, prefix, handler, asset, condition
+   result = []
+   for method, path, handler, condition in ROUTES:
+      prefix = path.endswith('*')
+      result.append((method + ' ' + path.rstrip('*'), prefix, handler, 'NULL', condition))
+   for index, (filename, uri, contentType, cacheControl) in enumerate(ASSETS):
+      result.append(('GET ' + uri, False, 'NULL', '&webassets[%d]' % index, None))
+   return result
+
+
+def route_header(header, routes):
+   size, seed = route_table([route[0] for route in routes])
+   slots = sorted((route_hash(route[0], seed) & (size - 1), route) for route in routes)
+
+   outr = [header]
+   outr.append('// Exported defines ***********************************************************\n')
+   outr.append('#define WEBROUTES_SEED          ( 0x%08xu )\n' % seed)
+   outr.append('#define WEBROUTES_SIZE          ( %du )\n' % size)
+   outr.append('#define WEBROUTES_HOME          ( %du )        // GET /\n\n' %
+               [slot for slot, route in slots if route[0] == 'GET /'][0])
+   outr.append('// Exported variables *********************************************************\n')
+   outr.append('// %d routes, the slot is the hash of the key\n' % len(routes))
+   outr.append('static const httpserver_route_t webroutes[WEBROUTES_SIZE] = {\n')
+   for slot, (key, prefix, handler, asset, condition) in slots:
+      if condition:
+         outr.append('#if( %s )\n' % condition)
+      outr.append('   [%d] = {\n'
+                  '      .key                 = %s,\n'
+                  '      .keyLength           = %d,\n'
+                  '      .prefix              = %d,\n'
+                  '      .handler             = %s,\n'
+                  '      .asset               = %s,\n'
+                  '   },\n' % (slot, c_string(key), len(key), prefix, handler, asset))
+      if condition:
+         outr.append('#endif\n')
+   outr.append('};\n\n')
+   outr.append('#endif // __WEBROUTES_H\n')
+   outr.append(FOOTER)
+   return outr
+
+
+def bench(count, path):
+   # the routes of the server without handlers and files, and made up json
+   # and parameter routes up to count, for Core/Test/route_test.c
+   result = [(key, prefix, 'NULL', 'NULL', None) for key, prefix, handler, asset, condition in routes()]
+   for i in range(count - len(result)):
+      if i % 4 == 3:
+         result.append(('POST /api/set_%02d/' % i, True, 'NULL', 'NULL', None))
+      else:
+         result.append(('GET /api/value_%02d.json' % i, False, 'NULL', 'NULL', None))
+   with open(path, 'w', newline='\n') as f:
+      f.write(''.join(route_header(HEADERB, result)))
+
+
+def main():
+   out = [HEADER]
+   table = []
+   total = 0
+   totalGzip = 0
+
+   for filename, uri, contentType, cacheControl in ASSETS:
+      with open(os.path.join(WEBDIR, filename), 'rb') as f:
+         raw = f.read()
+      # mtime 0 keeps the output identical for identical input
+      data = gzip.compress(raw, compresslevel=9, mtime=0)
+      etag = '"%s"' % hashlib.sha1(raw).hexdigest()[:16]
+      header = ('HTTP/1.1 200 OK\r\n'
+                'Content-Type: %s\r\n'
+                'Content-Encoding: gzip\r\n'
+                'Content-Length: %d\r\n'
+                'Cache-Control: %s\r\n'
+                'ETag: %s\r\n\r\n') % (contentType, len(data), cacheControl, etag)
+      notModified = ('HTTP/1.1 304 Not Modified\r\n'
+                     'Cache-Control: %s\r\n'
+                     'ETag: %s\r\n\r\n') % (cacheControl, etag)
+      name = c_name(filename)
+
+      out.append('// %s, %d bytes, %d bytes compressed\n' % (filename, len(raw), len(data)))
+      out.append('static const uint8_t %s[%d] = {\n%s\n};\n\n' % (name, len(data), c_bytes(data)))
+      table.append('   {\n'
+                   '      .uri                 = %s,\n'
+                   '      .etag                = %s,\n'
+                   '      .header              = %s,\n'
+                   '      .headerLength        = %d,\n'
+                   '      .notModified         = %s,\n'
+                   '      .notModifiedLength   = %d,\n'
+                   '      .data                = %s,\n'
+                   '      .length              = %d,\n'
+                   '   },\n' % (c_string(uri), c_string(etag), c_string(header), len(header),
+                                c_string(notModified), len(notModified), name, len(data)))
+      total += len(raw)
+      totalGzip += len(data)
+
+   out.append('// %d bytes, %d bytes compressed\n' % (total, totalGzip))
+   out.append('const webasset_t webassets[] = {\n')
+   out.extend(table)
+   out.append('};\n\n')
+   out.append('const uint16_t webassetsCount = sizeof( webassets ) / sizeof( webassets[0] );\n')
+
+   outh = [HEADERH]
+   for filename, contentType in TEMPLATES:
+      with open(os.path.join(WEBDIR, 'templates', filename), 'r') as f:
+         # the indentation and the line breaks are not sent
+         text = ''.join(line.strip() for line in f.read().splitlines())
+      text = ('HTTP/1.1 200 OK\r\n'
+              'Content-Type: %s\r\n'
+              'X-Content-Type-Options: nosniff\r\n'
+              'Cache-Control: no-cache\r\n\r\n') % contentType + text
+      name = 'webtemplate_' + filename.replace('.', '_').replace('-', '_')
+      values = {}
+      parts = []
+      position = 0
+      for match in PLACEHOLDER.finditer(text):
+         value, valueType = match.group(1), match.group(2)
+         if valueType not in TYPES:
+            raise SystemExit('%s: unknown type of {{%s:%s}}' % (filename, value, valueType))
+         if values.setdefault(value, (len(values), valueType))[1] != valueType:
+            raise SystemExit('%s: {{%s}} has two types' % (filename, value))
+         if match.start() > position:
+            literal = text[position:match.start()]
+            parts.append('   { WEBTEMPLATE_TEXT, 0, %d, %s },\n' % (len(literal), c_string(literal)))
+         parts.append('   { %s, %s, 0, NULL },\n' % (TYPES[valueType], c_enum(filename, value)))
+         position = match.end()
+      if position < len(text):
+         literal = text[position:]
+         parts.append('   { WEBTEMPLATE_TEXT, 0, %d, %s },\n' % (len(literal), c_string(literal)))
+
+      names = [(value, valueType) for value, (index, valueType) in sorted(values.items(), key=lambda item: item[1][0])]
+
+      out.append('\n// %s, %d values\n' % (filename, len(values)))
+      out.append('static const webtemplate_part_t %s_parts[] = {\n%s};\n\n' % (name, ''.join(parts)))
+      out.append('static const char* const %s_names[] = {\n%s};\n\n' % (name, ''.join('   %s,\n' % c_string(value) for value, valueType in names)))
+      out.append('static const webtemplate_type_t %s_types[] = {\n%s};\n\n' % (name, ''.join('   %s,\n' % TYPES[valueType] for value, valueType in names)))
+      out.append('const webtemplate_t %s = {\n'
+                 '   .parts               = %s_parts,\n'
+                 '   .partsCount          = sizeof( %s_parts ) / sizeof( %s_parts[0] ),\n'
+                 '   .names               = %s_names,\n'
+                 '   .types               = %s_types,\n'
+                 '   .valuesCount         = %d,\n'
+                 '};\n' % (name, name, name, name, name, name, len(values)))
+
+      outh.append('// %s\n' % filename)
+      outh.append('enum\n{\n')
+      for value, (index, valueType) in sorted(values.items(), key=lambda item: item[1][0]):
+         outh.append('   %s,%s// %s\n' % (c_enum(filename, value), ' ' * max(1, 30 - len(c_enum(filename, value))), valueType))
+      outh.append('   %s\n};\n' % c_enum(filename, 'values'))
+      outh.append('extern const webtemplate_t %s;\n\n' % name)
+
+   out.append(FOOTER)
+
+   outr = route_header(HEADERR, routes())
+
+   outh.append('#endif // __WEBTEMPLATES_H\n')
+   outh.append(FOOTER)
+
+   with open(OUTPUT, 'w', newline='\n') as f:
+      f.write(''.join(out))
+   with open(OUTPUTH, 'w', newline='\n') as f:
+      f.write(''.join(outh))
+   with open(OUTPUTR, 'w', newline='\n') as f:
+      f.write(''.join(outr))
+
+
+if __name__ == '__main__':
+   if len(sys.argv) == 4 and sys.argv[1] == '--bench':
+      bench(int(sys.argv[2]), sys.argv[3])
+   else:
+      main()
@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+# *****************************************************************************
+# \file      wsround.py
+#
+# \brief     Measures the round trip of a led command of the http server of
+#            the board, over the websocket and over a POST request.
+#
+# \details   Sends the same duty cycles to the led, once as binary commands
+#            HTTPSERVER_WS_DUTY on the websocket /ws and once as requests
+#            POST /led_set_value/<duty> on a keep-alive connection, one
+#            command at a time. A websocket command is done with its reply,
+#            a request with its 204 response. With --new-connection every
+#            request opens its own connection, as a browser does after the
+#            server closed the last one. Prints the commands per second and
+#            the latency percentiles of both. Needs the firmware with
+#            HTTPSERVER_SELECT 1, the websocket is not served without it:
+#
+#               python Core/Web/wsround.py --count 1000
+#
+# \author    Nico Korn
+#
+# \version   0.3.0.2
+#
+# \date      17102026
+# *****************************************************************************
+
+import argparse
+import base64
+import hashlib
+import os
+import socket
+import struct
+import time
+
+HOST = '192.168.2.1'   # IP1.IP2.IP3.IP4 of tcpip.h
+GUID = b'258EAFA5-E914-47DA-95CA-C5AB0DC85B11'
+
+WS_DUTY = 0x01         # HTTPSERVER_WS_DUTY of httpserver.h
+WS_REPLY = 0x80        # HTTPSERVER_WS_REPLY
+WS_INVALID = 0xFF      # HTTPSERVER_WS_INVALID
+DUTY_MAX = 40
+
+
+def receive(sock, buffer, length):
+    """Reads until the buffer has length bytes, None if the connection was
+    closed before."""
+    while len(buffer) < length:
+        data = sock.recv(4096)
+        if not data:
+            return None
+        buffer += data
+    return buffer
+
+
+def read_header(sock, buffer):
+    """Reads one response header, returns the status and the rest of the
+    buffer, or None if the connection was closed before."""
+    while b'\r\n\r\n' not in buffer:
+        data = sock.recv(4096)
+        if not data:
+            return None
+        buffer += data
+    header, _, buffer = buffer.partition(b'\r\n\r\n')
+    return int(header.split(b' ')[1]), header.lower(), buffer
+
+
+def ws_open(args):
+    """Opens the websocket, returns the socket and the rest of the buffer."""
+    key = base64.b64encode(os.urandom(16))
+    request = ('GET /ws HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+               'Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n\r\n' % (args.host, key.decode())).encode()
+    sock = socket.create_connection((args.host, args.port), timeout=args.timeout)
+    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    sock.sendall(request)
+    response = read_header(sock, b'')
+    if response is None or response[0] != 101:
+        raise OSError('websocket refused')
+    accept = base64.b64encode(hashlib.sha1(key + GUID).digest())
+    if b'sec-websocket-accept: ' + accept.lower() not in response[1]:
+        raise OSError('wrong websocket accept')
+    return sock, response[2]
+
+
+def ws_frame(payload):
+    """Binary frame of a client, a client has to mask its frames."""
+    mask = os.urandom(4)
+    masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+    return struct.pack('!BB', 0x82, 0x80 | len(payload)) + mask + masked
+
+
+def ws_read(sock, buffer):
+    """Reads one frame of the server, returns the opcode, the payload and the
+    rest of the buffer, or None if the connection was closed before."""
+    buffer = receive(sock, buffer, 2)
+    if buffer is None:
+        return None
+    opcode, length = buffer[0] & 0x0f, buffer[1] & 0x7f
+    start = 2
+    if length == 126:
+        buffer = receive(sock, buffer, 4)
+        if buffer is None:
+            return None
+        length, start = struct.unpack('!H', buffer[2:4])[0], 4
+    buffer = receive(sock, buffer, start + length)
+    if buffer is None:
+        return None
+    return opcode, buffer[start:start + length], buffer[start + length:]
+
+
+def ws_round(args, duties):
+    """Sends the duties as commands on the websocket, returns the latencies."""
+    latency = []
+    sock, buffer = ws_open(args)
+    try:
+        for duty in duties:
+            start = time.perf_counter()
+            sock.sendall(ws_frame(bytes([WS_DUTY, duty])))
+            while True:
+                frame = ws_read(sock, buffer)
+                if frame is None:
+                    raise OSError('websocket closed')
+                opcode, payload, buffer = frame
+                # the telemetry is off, but a push or a pong may come between
+                if opcode == 0x2 and payload[0] in (WS_DUTY | WS_REPLY, WS_INVALID):
+                    break
+                if opcode == 0x8:
+                    raise OSError('websocket closed by the server')
+            latency.append(time.perf_counter() - start)
+            if payload[0] != WS_DUTY | WS_REPLY or payload[1] != duty:
+                raise OSError('wrong reply %s to duty %d' % (payload.hex(), duty))
+        sock.sendall(struct.pack('!BB', 0x88, 0x80) + os.urandom(4))
+    finally:
+        sock.close()
+    return latency
+
+
+def post_round(args, duties):
+    """Sends the duties as POST requests, returns the latencies and how often
+    the server closed the connection before a response."""
+    latency = []
+    reconnects = 0
+    sock = None
+    buffer = b''
+    try:
+        for duty in duties:
+            request = ('POST /led_set_value/%d HTTP/1.1\r\nHost: %s\r\nContent-Length: 0\r\n\r\n'
+                       % (duty, args.host)).encode()
+            start = time.perf_counter()
+            while True:
+                if sock is None:
+                    sock = socket.create_connection((args.host, args.port), timeout=args.timeout)
+                    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+                    buffer = b''
+                sock.sendall(request)
+                response = read_header(sock, buffer)
+                if response is not None:
+                    break
+                # closed by the server before the response, once more on a new one
+                sock.close()
+                sock = None
+                reconnects += 1
+                if reconnects > len(duties):
+                    raise OSError('connection closed by the server')
+            status, header, buffer = response
+            latency.append(time.perf_counter() - start)
+            if status != 204:
+                raise OSError('status %d to duty %d' % (status, duty))
+            if args.new_connection or b'connection: close' in header:
+                sock.close()
+                sock = None
+    finally:
+        if sock is not None:
+            sock.close()
+    return latency, reconnects
+
+
+def percentile(values, p):
+    if not values:
+        return float('nan')
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+def report(name, latency, elapsed):
+    latency = [t * 1000.0 for t in latency]
+    print('%-9s %d commands, %.1f per second, latency ms: p50 %.2f, p95 %.2f, p99 %.2f, max %.2f'
+          % (name, len(latency), len(latency) / elapsed, percentile(latency, 50), percentile(latency, 95),
+             percentile(latency, 99), max(latency) if latency else float('nan')))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Round trip of a led command, websocket against POST')
+    parser.add_argument('--host', default=HOST)
+    parser.add_argument('--port', type=int, default=80)
+    parser.add_argument('--count', type=int, default=500, help='commands of each kind')
+    parser.add_argument('--new-connection', action='store_true', help='one connection per POST request')
+    parser.add_argument('--timeout', type=float, default=5.0, help='seconds per socket operation')
+    args = parser.parse_args()
+
+    # a slider sweep, up and down
+    duties = [abs(i % (2 * DUTY_MAX) - DUTY_MAX) for i in range(args.count)]
+
+    start = time.perf_counter()
+    latency = ws_round(args, duties)
+    report('websocket', latency, time.perf_counter() - start)
+
+    start = time.perf_counter()
+    latency, reconnects = post_round(args, duties)
+    report('post', latency, time.perf_counter() - start)
+    if reconnects:
+        print('post: %d connections closed by the server' % reconnects)
+
+
+if __name__ == '__main__':
+    main()
@@ -49,6 +49,9 @@
 #include "NetworkInterface.h"
 #include "NetworkBufferManagement.h"
 #include "FreeRTOS_DNS.h"
+#if ( ipconfigUSE_CHECKSUM_MODULE == 1 )
+    #include "checksum.h"
+#endif
 
 
 /* Used to ensure the structure packing is having the desired effect.  The
@@ -2791,6 +2794,24 @@ uint16_t usGenerateProtocolChecksum( const uint8_t * const pucEthernetBuffer,
  * @return The 16-bit one's complement of the one's complement sum of all 16-bit
  *         words in the header
  */
+#if ( ipconfigUSE_CHECKSUM_MODULE == 1 )
+
+/* The sum is calculated by checksum_add() of the project's checksum module.
+ * Its partial sums are in memory byte order, and they always start at an
+ * even offset of the data, so an odd address needs no swapping. */
+uint16_t usGenerateChecksum( uint16_t usSum,
+                             const uint8_t * pucNextData,
+                             size_t uxByteCount )
+{
+    uint32_t ulSum = ( uint32_t ) FreeRTOS_htons( usSum );
+
+    ulSum = checksum_add( pucNextData, ( uint32_t ) uxByteCount, ulSum );
+
+    return FreeRTOS_ntohs( checksum_fold( ulSum ) );
+}
+
+#else /* ipconfigUSE_CHECKSUM_MODULE */
+
 uint16_t usGenerateChecksum( uint16_t usSum,
                              const uint8_t * pucNextData,
                              size_t uxByteCount )
@@ -2934,6 +2955,8 @@ uint16_t usGenerateChecksum( uint16_t usSum,
     /* swap the output (little endian platform only). */
     return FreeRTOS_htons( ( ( uint16_t ) xSum.u32 ) );
 }
+
+#endif /* ipconfigUSE_CHECKSUM_MODULE */
 /*-----------------------------------------------------------*/
 
 /* This function is used in other files, has external linkage e.g. in
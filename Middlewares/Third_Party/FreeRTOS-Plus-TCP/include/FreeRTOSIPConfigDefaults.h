@@ -470,6 +470,12 @@
     #define ipconfigCHECK_IP_QUEUE_SPACE    0
 #endif
 
+/* Set to 1 to have usGenerateChecksum() use checksum_add() of the project's
+ * checksum module instead of the generic implementation. */
+#ifndef ipconfigUSE_CHECKSUM_MODULE
+    #define ipconfigUSE_CHECKSUM_MODULE    0
+#endif
+
 #ifndef ipconfigUSE_LLMNR
     /* Include support for LLMNR: Link-local Multicast Name Resolution (non-Microsoft) */
     #define ipconfigUSE_LLMNR    ( 0 )
@@ -41,6 +41,11 @@
 /* The following function is defined only when BufferAllocation_1.c is linked in the project. */
     BaseType_t xGetPhyLinkStatus( void );
 
+/* The following function is defined only when ipconfigZERO_COPY_RX_DRIVER is set
+ * and BufferAllocation_2.c is linked in the project. It returns pdTRUE if the
+ * buffer belongs to the driver, which takes it back instead of freeing it. */
+    BaseType_t xNetworkInterfaceReleaseRxBuffer( uint8_t * pucEthernetBuffer );
+
     #ifdef __cplusplus
         } /* extern "C" */
     #endif
@@ -61,6 +61,12 @@
     #define baMINIMAL_BUFFER_SIZE    sizeof( ARPPacket_t )
 #endif /* ipconfigUSE_TCP == 1 */
 
+/* Space in front of the ipBUFFER_PADDING bytes of every buffer, which a zero
+ * copy driver can use for its own header.  Has to be a multiple of 4 bytes. */
+#ifndef ipconfigBUFFER_HEADROOM
+    #define ipconfigBUFFER_HEADROOM    0U
+#endif
+
 /*_RB_ This is too complex not to have an explanation. */
 #if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
     #define ASSERT_CONCAT_( a, b )    a ## b
@@ -179,7 +185,7 @@ uint8_t * pucGetNetworkBuffer( size_t * pxRequestedSizeBytes )
     /* Allocate a buffer large enough to store the requested Ethernet frame size
      * and a pointer to a network buffer structure (hence the addition of
      * ipBUFFER_PADDING bytes). */
-    pucEthernetBuffer = ( uint8_t * ) pvPortMalloc( xSize + ipBUFFER_PADDING );
+    pucEthernetBuffer = ( uint8_t * ) pvPortMalloc( xSize + ipconfigBUFFER_HEADROOM + ipBUFFER_PADDING );
     configASSERT( pucEthernetBuffer != NULL );
 
     if( pucEthernetBuffer != NULL )
@@ -187,7 +193,7 @@ uint8_t * pucGetNetworkBuffer( size_t * pxRequestedSizeBytes )
         /* Enough space is left at the start of the buffer to place a pointer to
          * the network buffer structure that references this Ethernet buffer.
          * Return a pointer to the start of the Ethernet buffer itself. */
-        pucEthernetBuffer += ipBUFFER_PADDING;
+        pucEthernetBuffer += ipconfigBUFFER_HEADROOM + ipBUFFER_PADDING;
     }
 
     return pucEthernetBuffer;
@@ -201,7 +207,15 @@ void vReleaseNetworkBuffer( uint8_t * pucEthernetBuffer )
      * space before freeing the buffer. */
     if( pucEthernetBuffer != NULL )
     {
-        pucEthernetBuffer -= ipBUFFER_PADDING;
+        #if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
+            /* Buffers lent by the driver are not on the heap. */
+            if( xNetworkInterfaceReleaseRxBuffer( pucEthernetBuffer ) != pdFALSE )
+            {
+                return;
+            }
+        #endif
+
+        pucEthernetBuffer -= ipconfigBUFFER_HEADROOM + ipBUFFER_PADDING;
         vPortFree( ( void * ) pucEthernetBuffer );
     }
 }
@@ -257,7 +271,7 @@ NetworkBufferDescriptor_t * pxGetNetworkBufferWithDescriptor( size_t xRequestedS
             {
                 /* Extra space is obtained so a pointer to the network buffer can
                  * be stored at the beginning of the buffer. */
-                pxReturn->pucEthernetBuffer = ( uint8_t * ) pvPortMalloc( xRequestedSizeBytes + ipBUFFER_PADDING );
+                pxReturn->pucEthernetBuffer = ( uint8_t * ) pvPortMalloc( xRequestedSizeBytes + ipconfigBUFFER_HEADROOM + ipBUFFER_PADDING );
 
                 if( pxReturn->pucEthernetBuffer == NULL )
                 {
@@ -269,6 +283,9 @@ NetworkBufferDescriptor_t * pxGetNetworkBufferWithDescriptor( size_t xRequestedS
                 }
                 else
                 {
+                    /* The headroom stays in front of the pointer. */
+                    pxReturn->pucEthernetBuffer += ipconfigBUFFER_HEADROOM;
+
                     /* Store a pointer to the network buffer structure in the
                      * buffer storage area, then move the buffer pointer on past the
                      * stored pointer so the pointer value is not overwritten by the
@@ -56,6 +56,13 @@
 #include "tcpip.h"
 
 // Private define *************************************************************
+#define TX_RETRIES      ( 3u )                  // waits for free space in the queue
+#define TX_WAIT         ( pdMS_TO_TICKS(2u) )   // max. time per wait
+
+// the rndis packet header takes the 44 bytes in front of a frame sent by reference
+#if( ipconfigZERO_COPY_TX_DRIVER != 0 ) && ( ipconfigBUFFER_HEADROOM + ipBUFFER_PADDING < 44 )
+   #error "ipconfigBUFFER_HEADROOM is too small for the rndis packet header"
+#endif
 
 // Private types     **********************************************************
 
@@ -70,31 +77,60 @@ BaseType_t xNetworkInterfaceInitialise( void )
     return pdPASS;
 }
 
-/* Simple network interfaces (as opposed to more efficient zero copy network
-interfaces) just use Ethernet peripheral driver library functions to copy
-data from the FreeRTOS+TCP buffer into the peripheral driver's own buffer.
-This example assumes SendData() is a peripheral driver library function that
-takes a pointer to the start of the data to be sent and the length of the
-data to be sent as two separate parameters.  The start of the data is located
-by pxDescriptor->pucEthernetBuffer.  The length of the data is located
-by pxDescriptor->xDataLength. */
+/* With ipconfigZERO_COPY_TX_DRIVER the network buffer is handed to the 
+tcpQueue by reference and sent by the usb straight out of the buffer. The 
+headroom and the ipBUFFER_PADDING in front of pucEthernetBuffer take the rndis
+packet header, see ipconfigBUFFER_HEADROOM. The buffer is released by the mac task after the usb 
+transfer, see tcpip_releaseTxBuffer(). A buffer the stack still needs 
+(xReleaseAfterSend == pdFALSE) is copied into the tcpQueue like before. */
 BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxDescriptor, BaseType_t xReleaseAfterSend )
 {
-   // fix pointer length from the rtos buffer
-   tcpip_enqueue( pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength );
+   BaseType_t xReturn = pdTRUE;
+   uint8_t    byReference = 0;
+   
+#if( ipconfigZERO_COPY_TX_DRIVER != 0 )
+   byReference = ( xReleaseAfterSend != pdFALSE ) ? 1 : 0;
+#endif
+   
+   // fix pointer length from the rtos buffer. If the queue does not take the
+   // frame, hold it and retry after the usb has sent a frame.
+   for( uint8_t retries = 0; 
+        ( byReference != 0 ) ? tcpip_enqueueRef( pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength, pxDescriptor ) != 1
+                             : tcpip_enqueue( pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength ) != 1; 
+        retries++ )
+   {
+      if( retries >= TX_RETRIES )
+      {
+         tcpip_countTxError();
+         xReturn = pdFALSE;
+         break;
+      }
+      tcpip_waitTxSpace( TX_WAIT );
+   }
    
    // finish the transmission
-   // release the allocated buffer
-   if( xReleaseAfterSend != pdFALSE )
+   // release the allocated buffer, a queued reference is released after the
+   // usb transfer
+   if( xReleaseAfterSend != pdFALSE && ( byReference == 0 || xReturn == pdFALSE ) )
    {
-      // It is assumed SendData() copies the data out of the FreeRTOS+TCP Ethernet
-      // buffer.  The Ethernet buffer is therefore no longer needed, and must be
-      // freed for re-use.
+      // The frame has been copied out of the FreeRTOS+TCP Ethernet buffer or
+      // has been lost. The Ethernet buffer is therefore no longer needed, and
+      // must be freed for re-use.
       vReleaseNetworkBufferAndDescriptor( pxDescriptor );
    }  
    
    // Call the standard trace macro to log the send event.
    iptraceNETWORK_INTERFACE_TRANSMIT();
    
-   return pdTRUE;
-}
\ No newline at end of file
+   return xReturn;
+}
+
+#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+/* The received frames are lent to the stack in their usbQueue slot, see 
+tcpip_macTask(). BufferAllocation_2.c calls this function for every released 
+buffer, a lent frame is returned to the queue instead of being freed. */
+BaseType_t xNetworkInterfaceReleaseRxBuffer( uint8_t * pucEthernetBuffer )
+{
+   return ( tcpip_releaseRxBuffer( pucEthernetBuffer ) == 1 ) ? pdTRUE : pdFALSE;
+}
+#endif
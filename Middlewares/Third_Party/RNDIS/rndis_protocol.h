@@ -300,6 +300,12 @@ typedef struct {
 	uint32_t		rxok;
 	uint32_t		txbad;
 	uint32_t		rxbad;
+	uint32_t		rxfiltered;
+	uint32_t		rxdirected;
+	uint32_t		rxmulticast;
+	uint32_t		rxbroadcast;
+	uint32_t		rxnotethii;
+	uint32_t		rxethertype;
 } usb_eth_stat_t;
 
 #endif /* _RNDIS_H */
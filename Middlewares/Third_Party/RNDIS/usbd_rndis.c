@@ -58,17 +58,21 @@
 #include "ndis.h"
 #include "rndis_protocol.h"
 #include "usb_device.h"
+#include "metrics.h"
 
 // Private defines ************************************************************
 #define ETH_HEADER_SIZE                   14
 #define ETH_MAX_PACKET_SIZE               ETH_HEADER_SIZE + RNDIS_MTU
 #define RNDIS_RX_BUFFER_SIZE              (ETH_MAX_PACKET_SIZE + sizeof(rndis_data_packet_t))
+#define RNDIS_RX_PINGPONG                 QUEUE_BIPBUFFER /* start the next out transfer before parsing, the slot buffers are fixed without bip buffer */
+#define RNDIS_RX_OFFSET                   2u /* the out transfers start 2 bytes into the queue buffer, so the ip header of the first frame is word aligned */
+#define RNDIS_RX_LENGTH                   ( QUEUEBUFFERLENGTH - RNDIS_RX_OFFSET ) /* >= RNDIS_RX_BUFFER_SIZE */
 
 #define TX_STATE_READY                    0 /* initial transmitter state */
 #define TX_STATE_NEED_SENDING             1 /* has user data to send */
 #define TX_STATE_SENDING_HDR              2 /* sending first packet with header */
 #define TX_STATE_SENDING_DATA             3 /* sending message data */
-#define TX_STATE_SENDING_PADDING          4 /* sending one byte padding */
+#define TX_STATE_SENDING_PADDING          4 /* sending one byte padding or the zlp */
 #define TX_STATE_RESET                    5 /* reset state */
 
 #define USB_CONFIGURATION_DESCRIPTOR_TYPE 0x02
@@ -77,6 +81,15 @@
 
 #define INFBUF ((uint32_t *)((uint8_t *)&(m->RequestId) + m->InformationBufferOffset))
 
+#define ETH_ADDR_SIZE                     6
+#define ETH_IS_MULTICAST(addr)            ( ( (addr)[0] & 0x01u ) != 0u )
+#define ETH_IS_BROADCAST(addr)            ( ( (addr)[0] & (addr)[1] & (addr)[2] & (addr)[3] & (addr)[4] & (addr)[5] ) == 0xFFu )
+#define MCAST_HASH(addr)                  ( ( (addr)[2] ^ (addr)[3] ^ (addr)[4] ^ (addr)[5] ) & 0x3Fu ) /* bit in the 64 bit multicast hash */
+#define ETH_TYPE(frame)                   ( (uint16_t)( ( (frame)[12] << 8 ) | (frame)[13] ) )
+#define ETH_TYPE_MIN                      0x0600u /* up to this value the type field is the length of an ieee 802.3 frame */
+#define ETH_TYPE_IPV4                     0x0800u
+#define ETH_TYPE_ARP                      0x0806u
+
 #define MAC_OPT NDIS_MAC_OPTION_COPY_LOOKAHEAD_DATA | \
 			NDIS_MAC_OPTION_RECEIVE_SERIALIZED  | \
 			NDIS_MAC_OPTION_TRANSFERS_NOT_PEND  | \
@@ -91,6 +104,14 @@ static __ALIGN_BEGIN char*    rndis_rx_buffer __ALIGN_END;
 static rndis_state_t          rndis_state;
 static const uint8_t          station_hwaddr[6] = { RNDIS_HWADDR };
 static const uint8_t          permanent_hwaddr[6] = { RNDIS_HWADDR };
+static uint32_t               rndis_tx_max_transfer = RNDIS_RX_BUFFER_SIZE;
+static uint32_t               rndis_tx_interrupts;
+static uint32_t               rndis_rx_arm_cycles;    // max. cycles until the out endpoint is receiving again
+static uint32_t               rndis_rx_isr_cycles;    // max. cycles of the data out callback
+static uint8_t                device_hwaddr[ETH_ADDR_SIZE];   // destination address of the directed frames
+static uint8_t                mcast_list[RNDIS_MULTICAST_LIST_SIZE][ETH_ADDR_SIZE];
+static uint8_t                mcast_count;
+static uint32_t               mcast_hash[2];          // one bit per MCAST_HASH, rejects most multicasts without a list lookup
 
 // struct for the rndis transmission information and status
 static struct
@@ -98,15 +119,34 @@ static struct
 	uint8_t  *ptr;
 	uint16_t size;
 	uint16_t state;
+	uint8_t  frames;
 	bool need_padding;
 } tx =
 {
 	NULL,
 	0,
 	TX_STATE_RESET,
+	0,
 	false
 };
 
+// struct for the staged frames, which are started by the data in callback as
+// soon as the current transmission has been completed. Frames following each
+// other in memory are packed into the staged transfer.
+static struct
+{
+	uint8_t  *ptr;
+	uint8_t  *last;
+	uint16_t size;
+	uint8_t  frames;
+} tx_staged =
+{
+	NULL,
+	NULL,
+	0,
+	0
+};
+
 // USB standard device descriptor
 __ALIGN_BEGIN static uint8_t USBD_RNDIS_DeviceQualifierDesc[USB_LEN_DEV_QUALIFIER_DESC] __ALIGN_END =
 {
@@ -250,10 +290,14 @@ const uint32_t OIDSupportedList[] =
     OID_802_3_CURRENT_ADDRESS,
     OID_802_3_MULTICAST_LIST,
     OID_802_3_MAXIMUM_LIST_SIZE,
-    OID_802_3_MAC_OPTIONS
+    OID_802_3_MAC_OPTIONS,
+    OID_GEN_RCV_NO_BUFFER,
+    OID_GEN_DIRECTED_FRAMES_RCV,
+    OID_GEN_MULTICAST_FRAMES_RCV,
+    OID_GEN_BROADCAST_FRAMES_RCV
 };
 #define OID_LIST_LENGTH (sizeof(OIDSupportedList) / sizeof(*OIDSupportedList))
-#define ENC_BUF_SIZE    (OID_LIST_LENGTH * 4 + 32)
+#define ENC_BUF_SIZE    (OID_LIST_LENGTH * 4 + 32 + RNDIS_MULTICAST_LIST_SIZE * ETH_ADDR_SIZE)
 static uint8_t encapsulated_buffer[ENC_BUF_SIZE];
 
 // Global variables ***********************************************************
@@ -275,10 +319,31 @@ static uint8_t    *USBD_RNDIS_GetOtherSpeedCfgDesc          ( uint16_t *length )
 static uint8_t    *USBD_RNDIS_GetDeviceQualifierDescriptor  ( uint16_t *length );
 static void       USBD_RNDIS_query                          ( void *pdev );
 static void       USBD_RNDIS_handleSetMsg                   ( void *pdev );
+static void       USBD_RNDIS_buildHeader                    ( uint8_t *ptr, uint16_t size );
+static void       USBD_RNDIS_startTransfer                  ( uint8_t *ptr, uint16_t size, uint8_t frames, uint8_t *last );
+static void       USBD_RNDIS_sendStaged                     ( void );
 static void       USBD_RNDIS_handleConfigParm               ( const char *data, uint16_t keyoffset, uint16_t valoffset, uint16_t keylen, uint16_t vallen );
 static void       USBD_RNDIS_packetFilter                   ( uint32_t newfilter );
+static uint32_t   USBD_RNDIS_setMulticastList               ( const uint8_t *list, uint32_t length );
+static bool       USBD_RNDIS_filterFrame                    ( const uint8_t *frame, uint32_t length );
+static bool       USBD_RNDIS_filterType                     ( const uint8_t *frame );
 static void       USBD_RNDIS_query_cmplt                    ( uint32_t status, const void *data, uint16_t size );
 
+// the values on /metrics, the ethernet statistic of the rndis device
+static const metrics_t rndis_metrics[] =
+{
+   { "rndis_tx_frames_total",     NULL,                   "Frames sent to the host",                                     METRICS_COUNTER, METRICS_FIELD( usb_eth_stat_t, txok ),        NULL },
+   { "rndis_rx_frames_total",     NULL,                   "Frames received from the host",                               METRICS_COUNTER, METRICS_FIELD( usb_eth_stat_t, rxok ),        NULL },
+   { "rndis_rx_bad_total",        NULL,                   "Malformed data messages of the host",                         METRICS_COUNTER, METRICS_FIELD( usb_eth_stat_t, rxbad ),       NULL },
+   { "rndis_rx_filtered_total",   NULL,                   "Frames of the host skipped by the packet filter",             METRICS_COUNTER, METRICS_FIELD( usb_eth_stat_t, rxfiltered ),  NULL },
+   { "rndis_rx_rejected_total",   "reason=\"notethii\"",  "Frames of the host the stack does not handle",                METRICS_COUNTER, METRICS_FIELD( usb_eth_stat_t, rxnotethii ),  NULL },
+   { "rndis_rx_rejected_total",   "reason=\"ethertype\"", NULL,                                                          METRICS_COUNTER, METRICS_FIELD( usb_eth_stat_t, rxethertype ), NULL },
+   { "rndis_tx_interrupts_total", NULL,                   "Completed transfers on the data in endpoint",                 METRICS_COUNTER, 0, 0,                                         USBD_RNDIS_getTxInterrupts },
+   { "rndis_rx_arm_cycles_max",   NULL,                   "Most cycles until the data out endpoint was receiving again", METRICS_GAUGE,   0, 0,                                         USBD_RNDIS_getRxArmCycles },
+   { "rndis_rx_isr_cycles_max",   NULL,                   "Most cycles of the data out callback",                        METRICS_GAUGE,   0, 0,                                         USBD_RNDIS_getRxIsrCycles },
+};
+static metrics_group_t rndisMetrics = { rndis_metrics, sizeof( rndis_metrics ) / sizeof( rndis_metrics[0] ), &usb_eth_stat, NULL, NULL };
+
 // RNDIS interface class callbacks structure
 USBD_ClassTypeDef USBD_RDNIS =
 {
@@ -332,16 +397,17 @@ static uint8_t USBD_RNDIS_Init( USBD_HandleTypeDef *pdev, uint8_t cfgidx )
    USBD_LL_OpenEP( pdev, RNDIS_DATA_OUT_EP, USBD_EP_TYPE_BULK, RNDIS_DATA_OUT_SZ );
    
    // Set the data receive pointer.
-   rndis_rx_buffer = (char*)queue_getHeadBuffer( &usbQueue );
+   rndis_rx_buffer = (char*)queue_getHeadBuffer( &usbQueue ) + RNDIS_RX_OFFSET;
    
    // Prepare Out endpoint to receive next packet
-   USBD_LL_PrepareReceive( pdev, RNDIS_DATA_OUT_EP, (uint8_t*)rndis_rx_buffer, QUEUEBUFFERLENGTH );
+   USBD_LL_PrepareReceive( pdev, RNDIS_DATA_OUT_EP, (uint8_t*)rndis_rx_buffer, RNDIS_RX_LENGTH );
    
    // set rndis state to ready
+   tx_staged.ptr = NULL;
    tx.state = TX_STATE_READY;
    
-   // init the queue
-   queue_init(&tcpQueue);
+   // drop the frames queued for the previous usb session
+   queue_flush(&tcpQueue);
 
    return USBD_OK;
 }
@@ -365,6 +431,7 @@ static uint8_t USBD_RNDIS_DeInit( USBD_HandleTypeDef *pdev, uint8_t cfgidx )
    USBD_LL_CloseEP( pdev, RNDIS_DATA_OUT_EP );
    
    // set transmission state to reset
+   tx_staged.ptr = NULL;
    tx.state = TX_STATE_RESET;
    
    return USBD_OK;
@@ -391,7 +458,8 @@ static uint8_t USBD_RNDIS_Setup( USBD_HandleTypeDef  *pdev, USBD_SetupReqTypedef
             }
             else // Host-to-Device requeset
             {
-               USBD_CtlPrepareRx( pdev, encapsulated_buffer, req->wLength );          
+               // a longer message is cut and rejected by its handler
+               USBD_CtlPrepareRx( pdev, encapsulated_buffer, req->wLength < sizeof(encapsulated_buffer) ? req->wLength : sizeof(encapsulated_buffer) );          
             }
          }  
          return USBD_OK;
@@ -414,6 +482,15 @@ static uint8_t USBD_RNDIS_EP0_RxReady( USBD_HandleTypeDef *pdev )
       case REMOTE_NDIS_INITIALIZE_MSG:
          {
             rndis_initialize_cmplt_t *m;
+            
+            // the host limits the size of the in transfers, take it before
+            // the message is overwritten by the response
+            rndis_tx_max_transfer = ((rndis_initialize_msg_t *)encapsulated_buffer)->MaxTransferSize;
+            if( rndis_tx_max_transfer > RNDIS_TX_MAX_TRANSFER )
+            {
+               rndis_tx_max_transfer = RNDIS_TX_MAX_TRANSFER;
+            }
+            
             m = ((rndis_initialize_cmplt_t *)encapsulated_buffer);
             // m->MessageID is same as before
             m->MessageType = REMOTE_NDIS_INITIALIZE_CMPLT;
@@ -423,7 +500,7 @@ static uint8_t USBD_RNDIS_EP0_RxReady( USBD_HandleTypeDef *pdev )
             m->Status = RNDIS_STATUS_SUCCESS;
             m->DeviceFlags = RNDIS_DF_CONNECTIONLESS;
             m->Medium = RNDIS_MEDIUM_802_3;
-            m->MaxPacketsPerTransfer = 1;
+            m->MaxPacketsPerTransfer = RNDIS_RX_MAX_PACKETS;
             m->MaxTransferSize = RNDIS_RX_BUFFER_SIZE;
             m->PacketAlignmentFactor = 0;
             m->AfListOffset = 0;
@@ -487,23 +564,39 @@ static uint8_t USBD_RNDIS_DataIn( USBD_HandleTypeDef *pdev, uint8_t epnum )
 	epnum &= 0x0F;
 	if( epnum == (RNDIS_DATA_IN_EP & 0x0F) )
 	{
+      rndis_tx_interrupts++;
+      
 		if( tx.state == TX_STATE_SENDING_DATA )
 		{
+         // the frames have left the buffers, the termination does not touch
+         // them anymore
+         usb_eth_stat.txok += tx.frames;
+         for( ; tx.frames > 0; tx.frames-- )
+         {
+            on_usbInTxCplt();
+         }
+         
+			// the hal ends a transfer after its last full packet, the short
+			// packet costs one more transfer and data in interrupt
 			if( tx.need_padding )
 			{
+#if( RNDIS_TX_ZLP == 1u )
+				USBD_LL_Transmit(&hUsbDeviceFS, RNDIS_DATA_IN_EP, NULL, 0);
+#else
 				USBD_LL_Transmit(&hUsbDeviceFS, RNDIS_DATA_IN_EP, (uint8_t *)"\0", 1);
+#endif
 				tx.state = TX_STATE_SENDING_PADDING;
 				return USBD_OK;
 			}
 			tx.state = TX_STATE_READY;
-         on_usbInTxCplt();
+         USBD_RNDIS_sendStaged();
 			return USBD_OK;
 		}
 		
 		if( tx.state == TX_STATE_SENDING_PADDING )
 		{
 			tx.state = TX_STATE_READY;
-         on_usbInTxCplt();
+         USBD_RNDIS_sendStaged();
 			return USBD_OK;
 		}
 	}
@@ -511,37 +604,83 @@ static uint8_t USBD_RNDIS_DataIn( USBD_HandleTypeDef *pdev, uint8_t epnum )
 }
 
 //------------------------------------------------------------------------------
-/// \brief     Handled packet function.
+/// \brief     Handled packet function. The host may concatenate up to
+///            RNDIS_RX_MAX_PACKETS packet messages in one transfer, each of
+///            them is handed over as its own frame. The frames are enqueued in
+///            place. If the next transfer is already received into next, each
+///            frame is enqueued with the following message or next as the 
+///            next buffer. Otherwise the messages behind an enqueued frame are
+///            moved into the new receive buffer if they are not already 
+///            inside of it.
 ///
 /// \param     [in]  const char *data
 /// \param     [in]  uint16_t size
+/// \param     [in]  uint8_t *next
 ///
 /// \return    none
-static void USBD_RNDIS_handlePacket(const char *data, uint16_t size)
+static void USBD_RNDIS_handlePacket(const char *data, uint16_t size, uint8_t *next)
 {
 	rndis_data_packet_t *p;
-	p = (rndis_data_packet_t *)data;
-	if (size < sizeof(rndis_data_packet_t) || size > QUEUEBUFFERLENGTH)
+   char                 *buffer;
+   uint8_t              *following;
+   uint32_t             dataStart;
+   uint8_t              packets;
+   
+	if (size < sizeof(rndis_data_packet_t) || size > RNDIS_RX_LENGTH)
    {
 		usb_eth_stat.rxbad++;
 		return;
    }
-	if (p->MessageType != REMOTE_NDIS_PACKET_MSG)
+   
+   for( packets = 0; packets < RNDIS_RX_MAX_PACKETS && size >= sizeof(rndis_data_packet_t); packets++ )
    {
-		usb_eth_stat.rxbad++;
-		return;
-   }
-	if (p->DataOffset + offsetof(rndis_data_packet_t, DataOffset) + p->DataLength != size)
-	{
-      // padding?
-      if( p->MessageLength != size-1u )
+      p = (rndis_data_packet_t *)data;
+      dataStart = p->DataOffset + offsetof(rndis_data_packet_t, DataOffset);
+      if(   p->MessageType != REMOTE_NDIS_PACKET_MSG
+         || p->MessageLength > size
+         || p->MessageLength < sizeof(rndis_data_packet_t)
+         || dataStart < sizeof(rndis_data_packet_t)
+         || dataStart + p->DataLength > p->MessageLength )
       {
          usb_eth_stat.rxbad++;
          return;
       }
-	}
-	usb_eth_stat.rxok++;
-   on_usbOutRxPacket( &rndis_rx_buffer[p->DataOffset + offsetof(rndis_data_packet_t, DataOffset)], p->DataLength );
+      
+      // the buffer behind the frame
+      following = next;
+      if( next != NULL && size - p->MessageLength >= sizeof(rndis_data_packet_t) )
+      {
+         following = (uint8_t *)&data[p->MessageLength];
+      }
+      
+      // the frame handler may change the receive buffer, frames the host 
+      // has not asked for and frames the stack does not handle are skipped
+      // before they take a queue slot
+      buffer = rndis_rx_buffer;
+      if( !USBD_RNDIS_filterFrame( (const uint8_t*)&data[dataStart], p->DataLength ) )
+      {
+         usb_eth_stat.rxfiltered++;
+      }
+      else if( USBD_RNDIS_filterType( (const uint8_t*)&data[dataStart] ) )
+      {
+         usb_eth_stat.rxok++;
+         on_usbOutRxPacket( &data[dataStart], p->DataLength, following );
+      }
+      
+      // the rest of the transfer, a single padding byte is no message
+      data += p->MessageLength;
+      size -= (uint16_t)p->MessageLength;
+      if( size < sizeof(rndis_data_packet_t) )
+      {
+         return;
+      }
+      if(   rndis_rx_buffer != buffer
+         && ( data < rndis_rx_buffer || data + size > rndis_rx_buffer + RNDIS_RX_LENGTH ) )
+      {
+         memmove( rndis_rx_buffer, data, size );
+         data = rndis_rx_buffer;
+      }
+   }
 }
 
 //------------------------------------------------------------------------------
@@ -554,13 +693,54 @@ static void USBD_RNDIS_handlePacket(const char *data, uint16_t size)
 /// \return    status
 static uint8_t USBD_RNDIS_DataOut( USBD_HandleTypeDef *pdev, uint8_t epnum )
 {
-   UNUSED(pdev);
+   uint32_t start = DWT->CYCCNT;
+   uint32_t cycles;
+   char     *received;
+   uint8_t  *next = NULL;
    
 	if( epnum == RNDIS_DATA_OUT_EP )
 	{  
       PCD_EPTypeDef *ep = &((PCD_HandleTypeDef*)pdev->pData)->OUT_ep[epnum]; 
-      USBD_RNDIS_handlePacket(rndis_rx_buffer, ep->xfer_count);
-		USBD_LL_PrepareReceive(&hUsbDeviceFS, RNDIS_DATA_OUT_EP, (uint8_t*)(rndis_rx_buffer), QUEUEBUFFERLENGTH);
+      received = rndis_rx_buffer;
+      
+#if( RNDIS_RX_PINGPONG == 1u )
+      // Receive the next transfer behind this one while its frames are parsed,
+      // so the host is not nacked meanwhile. Without space the transfer is
+      // parsed first and the endpoint is started with the remaining buffer.
+      next = on_usbOutRxReserve( &received[ep->xfer_count] );
+      if( next != NULL )
+      {
+         rndis_rx_buffer = (char*)next + RNDIS_RX_OFFSET;
+         USBD_LL_PrepareReceive(&hUsbDeviceFS, RNDIS_DATA_OUT_EP, (uint8_t*)rndis_rx_buffer, RNDIS_RX_LENGTH);
+         cycles = DWT->CYCCNT - start;
+         if( cycles > rndis_rx_arm_cycles )
+         {
+            rndis_rx_arm_cycles = cycles;
+         }
+      }
+#endif
+      
+      USBD_RNDIS_handlePacket(received, ep->xfer_count, next);
+      
+      if( next != NULL )
+      {
+         on_usbOutRxCplt( next );
+      }
+      else
+      {
+         USBD_LL_PrepareReceive(&hUsbDeviceFS, RNDIS_DATA_OUT_EP, (uint8_t*)(rndis_rx_buffer), RNDIS_RX_LENGTH);
+         cycles = DWT->CYCCNT - start;
+         if( cycles > rndis_rx_arm_cycles )
+         {
+            rndis_rx_arm_cycles = cycles;
+         }
+      }
+      
+      cycles = DWT->CYCCNT - start;
+      if( cycles > rndis_rx_isr_cycles )
+      {
+         rndis_rx_isr_cycles = cycles;
+      }
 	}
    return USBD_OK;
 }
@@ -577,7 +757,11 @@ bool USBD_RNDIS_canSend(void)
 }
 
 //------------------------------------------------------------------------------
-/// \brief     Requests to send next packet over rndis usb.
+/// \brief     Requests to send next packet over rndis usb. If a transmission is
+///            ongoing, the packet is staged and started by the data in 
+///            callback. A packet directly behind the staged ones in memory is
+///            packed into the staged transfer, as long as the transfer stays
+///            within RNDIS_TX_MAX_PACKETS and the host's max. transfer size.
 ///
 /// \param     [in]  const void *data
 /// \param     [in]  uint16_t size
@@ -585,7 +769,11 @@ bool USBD_RNDIS_canSend(void)
 /// \return    bool
 bool USBD_RNDIS_send( const void *data, uint16_t size )
 {
-	if( tx.state != TX_STATE_READY )
+   uint8_t  *ptr;
+   uint8_t  *stagedEnd;
+   bool     accepted = true;
+   
+	if( tx.state == TX_STATE_RESET )
    {
       return false;
    }
@@ -594,43 +782,231 @@ bool USBD_RNDIS_send( const void *data, uint16_t size )
       return false;
    }
 
-	__disable_irq();
-   
-   tx.ptr = (uint8_t *)data-44u;    // there is allocated memory in front of data for the usb header
-	tx.size = size+44u;              // add 44 byte of header for the complete length
-	tx.state = TX_STATE_NEED_SENDING;
-
-   rndis_data_packet_t *hdr;
-   hdr = (rndis_data_packet_t *)tx.ptr;
-   memset(hdr, 0, sizeof(rndis_data_packet_t));
-   hdr->MessageType     = REMOTE_NDIS_PACKET_MSG;
-   hdr->MessageLength   = sizeof(rndis_data_packet_t) + tx.size-44u; // substract header size
-   hdr->DataOffset      = sizeof(rndis_data_packet_t) - offsetof(rndis_data_packet_t, DataOffset);
-   hdr->DataLength      = tx.size-44u; // substract header size
+   ptr = (uint8_t *)data-44u;    // there is allocated memory in front of data for the usb header
+   USBD_RNDIS_buildHeader( ptr, size );
    
-   tx.need_padding = (hdr->MessageLength & (RNDIS_DATA_IN_SZ - 1)) == 0;
-   if (tx.need_padding)
+   // The tx states are shared with the data in callback, so the usb interrupt
+   // is masked while they are updated and the transfer is started. The state 
+   // has to be set before the transfer is started.
+   HAL_NVIC_DisableIRQ(OTG_FS_IRQn);
+   stagedEnd = ( tx_staged.ptr != NULL ) ? tx_staged.ptr + tx_staged.size : NULL;
+   if( tx.state == TX_STATE_READY && tx_staged.ptr == NULL )
    {
-      hdr->MessageLength++;
+      USBD_RNDIS_startTransfer( ptr, size+44u, 1u, ptr );    // add 44 byte of header for the complete length
+   }
+   else if( tx.state == TX_STATE_RESET )
+   {
+      accepted = false;
+   }
+   else if( tx_staged.ptr == NULL )
+   {
+      tx_staged.size    = size+44u;
+      tx_staged.frames  = 1u;
+      tx_staged.last    = ptr;
+      tx_staged.ptr     = ptr;
+   }
+   else if(    ptr >= stagedEnd
+            && (uint32_t)( ptr - stagedEnd ) < sizeof(uint32_t)
+            && tx_staged.frames < RNDIS_TX_MAX_PACKETS
+            && (uint32_t)(ptr - tx_staged.ptr) + size + 44u + 1u <= rndis_tx_max_transfer )
+   {
+      // the alignment gap in front of the packet is part of the previous 
+      // message, one byte is kept free for the padding
+      ((rndis_data_packet_t *)tx_staged.last)->MessageLength += (uint32_t)(ptr - stagedEnd);
+      tx_staged.size    = (uint16_t)(ptr - tx_staged.ptr) + size + 44u;
+      tx_staged.last    = ptr;
+      tx_staged.frames++;
+   }
+   else
+   {
+      accepted = false;
+   }
+   HAL_NVIC_EnableIRQ(OTG_FS_IRQn);
+
+	return accepted;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Writes the rndis packet header into the 44 bytes in front of the
+///            frame. The header is built on the stack and copied, a frame
+///            sent out of a network buffer is not word aligned.
+///
+/// \param     [in]  uint8_t *ptr
+/// \param     [in]  uint16_t size
+///
+/// \return    none
+static void USBD_RNDIS_buildHeader( uint8_t *ptr, uint16_t size )
+{
+   rndis_data_packet_t hdr;
+   memset(&hdr, 0, sizeof(rndis_data_packet_t));
+   hdr.MessageType      = REMOTE_NDIS_PACKET_MSG;
+   hdr.MessageLength    = sizeof(rndis_data_packet_t) + size;
+   hdr.DataOffset       = sizeof(rndis_data_packet_t) - offsetof(rndis_data_packet_t, DataOffset);
+   hdr.DataLength       = size;
+   memcpy(ptr, &hdr, sizeof(rndis_data_packet_t));
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Starts an in transfer of one or more packets. If the transfer
+///            length is a multiple of the endpoint size, the host needs a
+///            short packet to see the end of the transfer. Depending on
+///            RNDIS_TX_ZLP this is a zero length packet or a padding byte, for
+///            which the last message is extended. It is sent as a transfer of
+///            its own after the data in interrupt. Has to be called with the
+///            usb interrupt masked or from the usb interrupt.
+///
+/// \param     [in]  uint8_t *ptr
+/// \param     [in]  uint16_t size
+/// \param     [in]  uint8_t frames
+/// \param     [in]  uint8_t *last
+///
+/// \return    none
+static void USBD_RNDIS_startTransfer( uint8_t *ptr, uint16_t size, uint8_t frames, uint8_t *last )
+{
+   tx.need_padding = false;
+   if( (size & (RNDIS_DATA_IN_SZ - 1)) == 0 )
+   {
+#if( RNDIS_TX_ZLP == 0u )
+      ((rndis_data_packet_t *)last)->MessageLength++;
+#else
+      UNUSED(last);
+#endif
+      tx.need_padding = true;
    }
    
+   tx.ptr      = ptr;
+   tx.size     = size;
+   tx.frames   = frames;
+   tx.state    = TX_STATE_SENDING_DATA;
    USBD_LL_Transmit(&hUsbDeviceFS, RNDIS_DATA_IN_EP, tx.ptr, (uint32_t)tx.size);
-   tx.state = TX_STATE_SENDING_DATA;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Starts the staged packets. Called from the data in callback
+///            after the previous transmission has been completed.
+///
+/// \param     none
+///
+/// \return    none
+static void USBD_RNDIS_sendStaged( void )
+{
+   uint8_t *ptr;
+   
+   if( tx.state != TX_STATE_READY || tx_staged.ptr == NULL )
+   {
+      return;
+   }
+   
+   ptr            = tx_staged.ptr;
+   tx_staged.ptr  = NULL;
+   USBD_RNDIS_startTransfer( ptr, tx_staged.size, tx_staged.frames, tx_staged.last );
+}
 
-	__enable_irq();
+//------------------------------------------------------------------------------
+/// \brief     Returns the number of data in completion interrupts. Related to
+///            the sent frames, it shows the interrupt load per frame.
+///
+/// \param     none
+///
+/// \return    uint32_t interrupts
+uint32_t USBD_RNDIS_getTxInterrupts( void )
+{
+   return rndis_tx_interrupts;
+}
 
-	return true;
+//------------------------------------------------------------------------------
+/// \brief     Returns the max. cycles from the data out callback entry until
+///            the out endpoint receives again.
+///
+/// \param     none
+///
+/// \return    uint32_t cycles
+uint32_t USBD_RNDIS_getRxArmCycles( void )
+{
+   return rndis_rx_arm_cycles;
 }
 
 //------------------------------------------------------------------------------
-/// \brief     Setting buffer for receiving next frame.
+/// \brief     Returns the max. cycles of the data out callback.
+///
+/// \param     none
+///
+/// \return    uint32_t cycles
+uint32_t USBD_RNDIS_getRxIsrCycles( void )
+{
+   return rndis_rx_isr_cycles;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the received frames dropped by the packet filter.
+///
+/// \param     none
+///
+/// \return    uint32_t frames
+uint32_t USBD_RNDIS_getRxFiltered( void )
+{
+   return usb_eth_stat.rxfiltered;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the received frames skipped because they are not in
+///            Ethernet II format.
+///
+/// \param     none
+///
+/// \return    uint32_t frames
+uint32_t USBD_RNDIS_getRxNotEthII( void )
+{
+   return usb_eth_stat.rxnotethii;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Returns the received frames skipped because the stack does not
+///            handle their frame type.
+///
+/// \param     none
+///
+/// \return    uint32_t frames
+uint32_t USBD_RNDIS_getRxEtherType( void )
+{
+   return usb_eth_stat.rxethertype;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Sets the address of the directed frames passed by the packet 
+///            filter, the address of the network interface on the device.
+///
+/// \param     [in]  const uint8_t *hwaddr
+///
+/// \return    none
+void USBD_RNDIS_setDeviceAddress( const uint8_t *hwaddr )
+{
+   memcpy( device_hwaddr, hwaddr, ETH_ADDR_SIZE );
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Publishes the ethernet statistic of the rndis device on 
+///            /metrics. Not called by the init of the class, it runs in the
+///            usb interrupt on every enumeration.
+///
+/// \param     none
+///
+/// \return    none
+void USBD_RNDIS_registerMetrics( void )
+{
+   metrics_register( &rndisMetrics );
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Setting buffer for receiving next frame. The out transfer 
+///            starts RNDIS_RX_OFFSET bytes into the buffer.
 ///
 /// \param     [in]  uint8_t* buffer
 ///
 /// \return    none
 void USBD_RNDIS_setBuffer( uint8_t* buffer )
 {
-   rndis_rx_buffer = (char*)buffer;
+   rndis_rx_buffer = (char*)buffer + RNDIS_RX_OFFSET;
 }
 
 //------------------------------------------------------------------------------
@@ -770,8 +1146,8 @@ static void USBD_RNDIS_query( void *pdev )
 		case OID_GEN_RECEIVE_BLOCK_SIZE:     USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, ETH_MAX_PACKET_SIZE); return;
 		case OID_GEN_MEDIA_CONNECT_STATUS:   USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, NDIS_MEDIA_STATE_CONNECTED); return;
 		case OID_GEN_RNDIS_CONFIG_PARAMETER: USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, 0); return;
-		case OID_802_3_MAXIMUM_LIST_SIZE:    USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, 1); return;
-		case OID_802_3_MULTICAST_LIST:       USBD_RNDIS_query_cmplt32(RNDIS_STATUS_NOT_SUPPORTED, 0); return;
+		case OID_802_3_MAXIMUM_LIST_SIZE:    USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, RNDIS_MULTICAST_LIST_SIZE); return;
+		case OID_802_3_MULTICAST_LIST:       USBD_RNDIS_query_cmplt(RNDIS_STATUS_SUCCESS, mcast_list, mcast_count * ETH_ADDR_SIZE); return;
 		case OID_802_3_MAC_OPTIONS:          USBD_RNDIS_query_cmplt32(RNDIS_STATUS_NOT_SUPPORTED, 0); return;
 		case OID_GEN_MAC_OPTIONS:            USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, /*MAC_OPT*/ 0); return;
 		case OID_802_3_RCV_ERROR_ALIGNMENT:  USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, 0); return;
@@ -781,7 +1157,10 @@ static void USBD_RNDIS_query( void *pdev )
 		case OID_GEN_RCV_OK:                 USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, usb_eth_stat.rxok); return;
 		case OID_GEN_RCV_ERROR:              USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, usb_eth_stat.rxbad); return;
 		case OID_GEN_XMIT_ERROR:             USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, usb_eth_stat.txbad); return;
-		case OID_GEN_RCV_NO_BUFFER:          USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, 0); return;
+		case OID_GEN_RCV_NO_BUFFER:          USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, usb_getRxDropped()); return;
+		case OID_GEN_DIRECTED_FRAMES_RCV:    USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, usb_eth_stat.rxdirected); return;
+		case OID_GEN_MULTICAST_FRAMES_RCV:   USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, usb_eth_stat.rxmulticast); return;
+		case OID_GEN_BROADCAST_FRAMES_RCV:   USBD_RNDIS_query_cmplt32(RNDIS_STATUS_SUCCESS, usb_eth_stat.rxbroadcast); return;
 		default:                             USBD_RNDIS_query_cmplt(RNDIS_STATUS_FAILURE, NULL, 0); return;
 	}
 }
@@ -806,14 +1185,146 @@ static void USBD_RNDIS_handleConfigParm( const char *data, uint16_t keyoffset, u
 }
 
 //------------------------------------------------------------------------------
-/// \brief     Packetfilter function.
+/// \brief     Packetfilter function. The frames are filtered by 
+///            USBD_RNDIS_filterFrame with oid_packet_filter, without a filter
+///            no frame is passed on.
 ///
 /// \param     [in]  uint32_t newfilter
 ///
 /// \return    none
 static void USBD_RNDIS_packetFilter( uint32_t newfilter )
 {
-    (void)newfilter;
+   oid_packet_filter = newfilter;
+   if( oid_packet_filter )
+   {
+      rndis_state = rndis_data_initialized;
+   } 
+   else 
+   {
+      rndis_state = rndis_initialized;
+   }
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Replaces the multicast list with the list set by the host. An
+///            empty list removes all addresses.
+///
+/// \param     [in]  const uint8_t *list
+/// \param     [in]  uint32_t length in bytes
+///
+/// \return    rndis status
+static uint32_t USBD_RNDIS_setMulticastList( const uint8_t *list, uint32_t length )
+{
+   if( length % ETH_ADDR_SIZE != 0u )
+   {
+      return RNDIS_STATUS_INVALID_DATA;
+   }
+   if( length > sizeof(mcast_list) )
+   {
+      return NDIS_STATUS_MULTICAST_FULL;
+   }
+   
+   memcpy( mcast_list, list, length );
+   mcast_count = (uint8_t)( length / ETH_ADDR_SIZE );
+   mcast_hash[0] = 0u;
+   mcast_hash[1] = 0u;
+   for( uint8_t i = 0; i < mcast_count; i++ )
+   {
+      mcast_hash[MCAST_HASH(mcast_list[i]) >> 5u] |= 1uL << ( MCAST_HASH(mcast_list[i]) & 0x1Fu );
+   }
+   return RNDIS_STATUS_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Destination address filter of the received frames, driven by
+///            the packet filter and the multicast list of the host. Counts 
+///            the passed frames per address type.
+///
+/// \param     [in]  const uint8_t *frame
+/// \param     [in]  uint32_t length
+///
+/// \return    true if the frame is passed on
+static bool USBD_RNDIS_filterFrame( const uint8_t *frame, uint32_t length )
+{
+   uint8_t hash;
+   uint8_t i;
+   
+   if( length < ETH_HEADER_SIZE )
+   {
+      return false;
+   }
+   
+   // unicast
+   if( !ETH_IS_MULTICAST(frame) )
+   {
+      if(   ( oid_packet_filter & NDIS_PACKET_TYPE_PROMISCUOUS ) != 0u
+         || (   ( oid_packet_filter & NDIS_PACKET_TYPE_DIRECTED ) != 0u
+             && memcmp( frame, device_hwaddr, ETH_ADDR_SIZE ) == 0 ) )
+      {
+         usb_eth_stat.rxdirected++;
+         return true;
+      }
+      return false;
+   }
+   
+   // broadcast
+   if( ETH_IS_BROADCAST(frame) )
+   {
+      if( ( oid_packet_filter & ( NDIS_PACKET_TYPE_BROADCAST | NDIS_PACKET_TYPE_PROMISCUOUS ) ) != 0u )
+      {
+         usb_eth_stat.rxbroadcast++;
+         return true;
+      }
+      return false;
+   }
+   
+   // multicast, the hash rejects most addresses not in the list
+   if( ( oid_packet_filter & ( NDIS_PACKET_TYPE_ALL_MULTICAST | NDIS_PACKET_TYPE_PROMISCUOUS ) ) != 0u )
+   {
+      usb_eth_stat.rxmulticast++;
+      return true;
+   }
+   hash = MCAST_HASH(frame);
+   if(   ( oid_packet_filter & NDIS_PACKET_TYPE_MULTICAST ) != 0u
+      && ( mcast_hash[hash >> 5u] & ( 1uL << ( hash & 0x1Fu ) ) ) != 0u )
+   {
+      for( i = 0; i < mcast_count; i++ )
+      {
+         if( memcmp( frame, mcast_list[i], ETH_ADDR_SIZE ) == 0 )
+         {
+            usb_eth_stat.rxmulticast++;
+            return true;
+         }
+      }
+   }
+   return false;
+}
+
+//------------------------------------------------------------------------------
+/// \brief     Frame type filter of the received frames, behind the address
+///            filter. The stack only takes Ethernet II frames of ipv4 and arp
+///            (ipconfigFILTER_OUT_NON_ETHERNET_II_FRAMES and 
+///            ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES), the others are 
+///            counted by their reason. The frame has the ethernet header.
+///
+/// \param     [in]  const uint8_t *frame
+///
+/// \return    true if the frame is passed on
+static bool USBD_RNDIS_filterType( const uint8_t *frame )
+{
+   uint16_t type = ETH_TYPE(frame);
+   
+   if( type <= ETH_TYPE_MIN )
+   {
+      usb_eth_stat.rxnotethii++;
+      return false;
+   }
+   if( type != ETH_TYPE_IPV4 && type != ETH_TYPE_ARP )
+   {
+      usb_eth_stat.rxethertype++;
+      return false;
+   }
+   return true;
 }
 
 //------------------------------------------------------------------------------
@@ -852,16 +1363,7 @@ static void USBD_RNDIS_handleSetMsg( void *pdev )
 
 		// Mandatory general OIDs
 		case OID_GEN_CURRENT_PACKET_FILTER:
-			oid_packet_filter = *INFBUF;
-			if (oid_packet_filter)
-			{
-				USBD_RNDIS_packetFilter(oid_packet_filter);
-				rndis_state = rndis_data_initialized;
-			} 
-			else 
-			{
-				rndis_state = rndis_initialized;
-			}
+			USBD_RNDIS_packetFilter(*INFBUF);
 			break;
 
 		case OID_GEN_CURRENT_LOOKAHEAD:
@@ -872,6 +1374,13 @@ static void USBD_RNDIS_handleSetMsg( void *pdev )
 
 		// Mandatory 802_3 OIDs
 		case OID_802_3_MULTICAST_LIST:
+			if(   m->InformationBufferLength > sizeof(encapsulated_buffer)
+			   || (uint32_t)((uint8_t *)INFBUF - encapsulated_buffer) + m->InformationBufferLength > sizeof(encapsulated_buffer) )
+			{
+				c->Status = RNDIS_STATUS_INVALID_DATA;
+				break;
+			}
+			c->Status = USBD_RNDIS_setMulticastList((const uint8_t *)INFBUF, m->InformationBufferLength);
 			break;
 
 		// Power Managment: fails for now
@@ -73,6 +73,18 @@
 #define CDC_DATA_FS_IN_PACKET_SIZE                  CDC_DATA_FS_MAX_PACKET_SIZE
 #define CDC_DATA_FS_OUT_PACKET_SIZE                 CDC_DATA_FS_MAX_PACKET_SIZE
 
+#define RNDIS_RX_MAX_PACKETS        ( 8u )      /* packet messages accepted in one out transfer */
+#define RNDIS_TX_MAX_PACKETS        ( 4u )      /* packet messages packed into one in transfer */
+#define RNDIS_TX_MAX_TRANSFER       ( 4096u )   /* upper limit of one in transfer, the host limit applies too */
+// In transfers of a multiple of the packet size need a short packet at the
+// end. 1: a zlp, 0: a padding byte for which the last message is extended.
+// Both are a transfer of their own with their own completion interrupt, the
+// zlp only saves the padding byte on the bus and keeps MessageLength exact.
+#ifndef RNDIS_TX_ZLP
+#define RNDIS_TX_ZLP                ( 1u )
+#endif
+#define RNDIS_MULTICAST_LIST_SIZE   ( 16u )     /* multicast addresses the host can set with OID_802_3_MULTICAST_LIST */
+
 // Exported types *************************************************************
 
 typedef struct _USBD_RNDIS_Itf
@@ -97,6 +109,14 @@ typedef struct BUS_UART_STATISTIC_s
 // Exported functions *********************************************************
 bool                 USBD_RNDIS_canSend            ( void );
 bool                 USBD_RNDIS_send               ( const void *data, uint16_t size );
+uint32_t             USBD_RNDIS_getTxInterrupts    ( void );
+uint32_t             USBD_RNDIS_getRxArmCycles     ( void );
+uint32_t             USBD_RNDIS_getRxIsrCycles     ( void );
+uint32_t             USBD_RNDIS_getRxFiltered      ( void );
+uint32_t             USBD_RNDIS_getRxNotEthII      ( void );
+uint32_t             USBD_RNDIS_getRxEtherType     ( void );
+void                 USBD_RNDIS_setDeviceAddress   ( const uint8_t *hwaddr );
+void                 USBD_RNDIS_registerMetrics    ( void );
 void                 USBD_RNDIS_setBuffer          ( uint8_t* buffer );
 USBD_ClassTypeDef*   USBD_RNDIS_getClass           ( void );
 uint8_t              USBD_RNDIS_RegisterInterface  ( USBD_HandleTypeDef *pdev, USBD_RNDIS_ItfTypeDef *fops );
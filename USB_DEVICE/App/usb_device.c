@@ -52,6 +52,8 @@
 #include "usbd_desc.h"
 #include "usbd_rndis.h"
 #include "queuex.h"
+#include "tcpip.h"
+#include "metrics.h"
 
 // Private defines ************************************************************
 
@@ -59,6 +61,7 @@
 
 // Private variables **********************************************************
 static RNDIS_USB_STATISTIC_t rndis_statistic;
+static const uint8_t         device_hwaddr[6] = { MAC_HWADDR };
 
 // Global variables ***********************************************************
 USBD_HandleTypeDef         hUsbDeviceFS = {0};  // USB Device Core handle declaration
@@ -67,6 +70,16 @@ extern queue_handle_t      usbQueue;
 
 // Private function prototypes ************************************************
 
+// the values on /metrics, the frames between the usb and the queues
+static const metrics_t usb_metrics[] =
+{
+   { "usb_rx_frames_total", NULL, "Frames of the host enqueued to the stack", METRICS_COUNTER, METRICS_FIELD( RNDIS_USB_STATISTIC_t, counterRxFrame ), NULL },
+   { "usb_rx_bytes_total",  NULL, "Bytes of the frames of the host",          METRICS_COUNTER, METRICS_FIELD( RNDIS_USB_STATISTIC_t, counterRxData ),  NULL },
+   { "usb_tx_frames_total", NULL, "Frames sent to the host",                  METRICS_COUNTER, METRICS_FIELD( RNDIS_USB_STATISTIC_t, counterTxFrame ), NULL },
+   { "usb_tx_bytes_total",  NULL, "Bytes of the frames sent to the host",     METRICS_COUNTER, METRICS_FIELD( RNDIS_USB_STATISTIC_t, counterTxData ),  NULL },
+};
+static metrics_group_t usbMetrics = { usb_metrics, sizeof( usb_metrics ) / sizeof( usb_metrics[0] ), &rndis_statistic, NULL, NULL };
+
 // Functions ******************************************************************
 /**
   * Init USB device Library, add supported class and start the library
@@ -86,6 +99,11 @@ void usb_init( void )
    {
       Error_Handler();
    }
+   USBD_RNDIS_setDeviceAddress( device_hwaddr );
+   
+   // publish the statistics on /metrics
+   metrics_register( &usbMetrics );
+   USBD_RNDIS_registerMetrics();
    if( USBD_Start(&hUsbDeviceFS) != USBD_OK )
    {
       Error_Handler();
@@ -104,18 +122,70 @@ void usb_deinit( void )
 }
 
 // ----------------------------------------------------------------------------
-/// \brief     Called if a complete frame has been received.
+/// \brief     Called if a complete frame has been received. Without a next
+///            buffer the queue reserves the buffer behind the frame and the 
+///            receive buffer is set to it. With a next buffer the next out 
+///            transfer has already been started, see on_usbOutRxReserve.
 ///
 /// \param     [in]  const char *data
 /// \param     [in]  int size
+/// \param     [in]  uint8_t *next
 ///
 /// \return    none
-inline void on_usbOutRxPacket(const char *data, int size)
+inline void on_usbOutRxPacket(const char *data, int size, uint8_t *next)
 {
+   uint8_t *controlBuffer;
+   
    rndis_statistic.counterRxFrame++;
    rndis_statistic.counterRxData+=(uint32_t)size;
-   queue_enqueue( (uint8_t*)data, size, &usbQueue );
-   USBD_RNDIS_setBuffer( queue_getHeadBuffer( &usbQueue ) );
+   
+   // Small control frames are copied into the control lane, the receive 
+   // buffer stays the head buffer of the bulk lane then.
+   if(   queue_classify( (uint8_t*)data, (uint16_t)size, &usbQueue ) == QUEUE_LANE_CONTROL
+      && queue_isLaneFull( QUEUE_LANE_CONTROL, &usbQueue ) == 1 )
+   {
+      controlBuffer = queue_getLaneHeadBuffer( QUEUE_LANE_CONTROL, &usbQueue );
+      memcpy( controlBuffer, data, (size_t)size );
+      queue_enqueueLane( controlBuffer, (uint16_t)size, QUEUE_LANE_CONTROL, &usbQueue );
+      return;
+   }
+   
+   // Apply the drop policy, a dropped frame is overwritten by the next one.
+   if( queue_admit( QUEUE_LANE_BULK, &usbQueue ) == 1 )
+   {
+      if( next != NULL )
+      {
+         queue_enqueueLaneAt( (uint8_t*)data, (uint16_t)size, next, QUEUE_LANE_BULK, &usbQueue );
+         return;
+      }
+      queue_enqueue( (uint8_t*)data, size, &usbQueue );
+      USBD_RNDIS_setBuffer( queue_getHeadBuffer( &usbQueue ) );
+   }
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Reserves the receive buffer for the next out transfer behind 
+///            the transfer just received, so the endpoint can be started 
+///            again before the frames are parsed.
+///
+/// \param     [in]  const char *end
+///
+/// \return    uint8_t* buffer, NULL if the queue has no space for it
+uint8_t* on_usbOutRxReserve( const char *end )
+{
+   return queue_reserveLane( (uint8_t*)end, QUEUE_LANE_BULK, &usbQueue );
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Called if all frames of an out transfer have been handled. The
+///            buffer from on_usbOutRxReserve becomes the head buffer.
+///
+/// \param     [in]  uint8_t *buffer
+///
+/// \return    none
+void on_usbOutRxCplt( uint8_t *buffer )
+{
+   queue_setLaneHeadBuffer( buffer, QUEUE_LANE_BULK, &usbQueue );
 }
 
 // ----------------------------------------------------------------------------
@@ -127,6 +197,7 @@ inline void on_usbOutRxPacket(const char *data, int size)
 inline void on_usbInTxCplt( void )
 {
    queue_dequeue(&tcpQueue);
+   tcpip_notifyTxSpace();
 }
 
 // ----------------------------------------------------------------------------
@@ -231,4 +302,81 @@ uint32_t usb_getRxData( void )
    return rndis_statistic.counterRxData;
 }
 
+// ----------------------------------------------------------------------------
+/// \brief     Return the data in completion interrupts of the usb.
+///
+/// \param     none
+///
+/// \return    uint32_t tx interrupts
+uint32_t usb_getTxInterrupts( void )
+{
+   return USBD_RNDIS_getTxInterrupts();
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Return the max. cycles until the out endpoint receives again.
+///
+/// \param     none
+///
+/// \return    uint32_t cycles
+uint32_t usb_getRxArmCycles( void )
+{
+   return USBD_RNDIS_getRxArmCycles();
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Return the max. cycles of the out endpoint interrupt.
+///
+/// \param     none
+///
+/// \return    uint32_t cycles
+uint32_t usb_getRxIsrCycles( void )
+{
+   return USBD_RNDIS_getRxIsrCycles();
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Return the received frames dropped by the packet filter.
+///
+/// \param     none
+///
+/// \return    uint32_t frames
+uint32_t usb_getRxFiltered( void )
+{
+   return USBD_RNDIS_getRxFiltered();
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Return the received frames dropped for not being Ethernet II.
+///
+/// \param     none
+///
+/// \return    uint32_t frames
+uint32_t usb_getRxNotEthII( void )
+{
+   return USBD_RNDIS_getRxNotEthII();
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Return the received frames dropped for their frame type.
+///
+/// \param     none
+///
+/// \return    uint32_t frames
+uint32_t usb_getRxEtherType( void )
+{
+   return USBD_RNDIS_getRxEtherType();
+}
+
+// ----------------------------------------------------------------------------
+/// \brief     Return the received frames dropped for lack of queue space.
+///
+/// \param     none
+///
+/// \return    uint32_t frames
+uint32_t usb_getRxDropped( void )
+{
+   return usbQueue.dropTail + usbQueue.dropHead + usbQueue.dropEarly;
+}
+
 /********************** (C) COPYRIGHT Reichle & De-Massari *****END OF FILE****/
@@ -61,7 +61,9 @@
 // Exported functions *********************************************************
 void     usb_init                ( void );
 void     usb_deinit              ( void );
-void     on_usbOutRxPacket       ( const char *data, int size );
+void     on_usbOutRxPacket       ( const char *data, int size, uint8_t *next );
+uint8_t* on_usbOutRxReserve      ( const char *end );
+void     on_usbOutRxCplt         ( uint8_t *buffer );
 void     on_usbInTxCplt          ( void );
 uint8_t  usb_output              ( uint8_t* dpointer, uint16_t length );
 void     usb_forceHostEnum       ( void );
@@ -69,6 +71,13 @@ uint32_t usb_getTxFrames         ( void );
 uint32_t usb_getTxData           ( void );
 uint32_t usb_getRxFrames         ( void );
 uint32_t usb_getRxData           ( void );
+uint32_t usb_getTxInterrupts     ( void );
+uint32_t usb_getRxArmCycles      ( void );
+uint32_t usb_getRxIsrCycles      ( void );
+uint32_t usb_getRxFiltered       ( void );
+uint32_t usb_getRxNotEthII       ( void );
+uint32_t usb_getRxEtherType      ( void );
+uint32_t usb_getRxDropped        ( void );
 
 #endif /* __USB_DEVICE__H__ */
 